@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2010 The University of Notre Dame. All Rights Reserved.
+ *
+ * The University of Notre Dame grants you ("Licensee") a
+ * non-exclusive, royalty free, license to use, modify and
+ * redistribute this software in source and binary code form, provided
+ * that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * This software is provided "AS IS," without a warranty of any
+ * kind. All express or implied conditions, representations and
+ * warranties, including any implied warranty of merchantability,
+ * fitness for a particular purpose or non-infringement, are hereby
+ * excluded.  The University of Notre Dame and its licensors shall not
+ * be liable for any damages suffered by licensee as a result of
+ * using, modifying or distributing the software or its
+ * derivatives. In no event will the University of Notre Dame or its
+ * licensors be liable for any lost revenue, profit or data, or for
+ * direct, indirect, special, consequential, incidental or punitive
+ * damages, however caused and regardless of the theory of liability,
+ * arising out of the use of or inability to use software, even if the
+ * University of Notre Dame has been advised of the possibility of
+ * such damages.
+ *
+ * SUPPORT OPEN SCIENCE!  If you use OpenMD or its source code in your
+ * research, please cite the appropriate papers when you publish your
+ * work.  Good starting points are:
+ *                                                                      
+ * [1]  Meineke, et al., J. Comp. Chem. 26, 252-271 (2005).             
+ * [2]  Fennell & Gezelter, J. Chem. Phys. 124, 234104 (2006).          
+ * [3]  Sun, Lin & Gezelter, J. Chem. Phys. 128, 234107 (2008).          
+ * [4]  Kuang & Gezelter,  J. Chem. Phys. 133, 164101 (2010).
+ * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
+ * [6]  Kuang & Gezelter, Mol. Phys., 110, 691-701 (2012).
+ */
+
+#include <iostream>
+#include <string>
+
+#include "brains/SimCreator.hpp"
+#include "brains/SimInfo.hpp"
+#include "io/DumpReader.hpp"
+#include "io/DumpWriter.hpp"
+#include "utils/simError.h"
+
+using namespace OpenMD;
+
+/**
+ * Translates a dump file between the text (.dump) and binary (.dumpb)
+ * trajectory formats.  The output format follows the extension of the
+ * output file name:
+ *
+ *   dumpConvert run.dump run.dumpb
+ *   dumpConvert run.dumpb run.dump
+ */
+int main(int argc, char* argv[]){
+
+  if (argc != 3) {
+    sprintf(painCave.errMsg,
+            "usage: %s <input dump file> <output dump file>\n"
+            "\tThe output is written in the binary format if its name\n"
+            "\tends in .dumpb, and in the text format otherwise.\n",
+            argv[0]);
+    painCave.isFatal = 1;
+    simError();
+  }
+
+  std::string inFileName(argv[1]);
+  std::string outFileName(argv[2]);
+
+  if (inFileName == outFileName) {
+    sprintf(painCave.errMsg,
+            "dumpConvert: the input and output files must be different.\n");
+    painCave.isFatal = 1;
+    simError();
+  }
+
+  //parse md file and set up the system
+  SimCreator creator;
+  SimInfo* info = creator.createSim(inFileName, false);
+
+  DumpReader* reader = new DumpReader(info, inFileName);
+  int nFrames = reader->getNFrames();
+
+  DumpWriter* writer = new DumpWriter(info, outFileName);
+
+  for (int i = 0; i < nFrames; i++) {
+    reader->readFrame(i);
+    writer->writeDump();
+  }
+
+  // deleting the writer will put the closing at the end of the dump file.
+  delete writer;
+  delete reader;
+  delete info;
+
+  std::cout << "dumpConvert: wrote " << nFrames << " frames to "
+            << outFileName << "\n";
+  return 0;
+}
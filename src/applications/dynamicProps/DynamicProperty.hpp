@@ -44,9 +44,20 @@
 
 #include <string>
 #include "brains/SimInfo.hpp"
+#include "utils/simError.h"
 
 namespace OpenMD {
 
+  /**
+   * The ways a time correlation function can be accumulated from the
+   * frames of a trajectory.
+   */
+  enum CorrelatorType {
+    DIRECT_CORRELATOR,       /**< every pair of frames, O(T^2) */
+    FFT_CORRELATOR,          /**< Wiener-Khinchin theorem, O(T log T) */
+    MULTIPLE_TAU_CORRELATOR  /**< block averaging at logarithmic lags */
+  };
+
   /**
    * @class DynamicProperty DynamicProperty.hpp "applications/dynamicProps/DynamicProperty"
    * @brief Base class for Dynamic properties
@@ -65,6 +76,21 @@ namespace OpenMD {
       return outputFilename_;
     }
 
+    /**
+     * Requests one of the faster correlators.  Properties that can
+     * only be accumulated directly ignore the request with a warning.
+     */
+    virtual void setCorrelator(CorrelatorType type) {
+      if (type != DIRECT_CORRELATOR) {
+        sprintf(painCave.errMsg,
+                "This correlation function can only be computed directly;\n"
+                "\tignoring the requested correlator.\n");
+        painCave.isFatal = 0;
+        painCave.severity = OPENMD_WARNING;
+        simError();
+      }
+    }
+
   protected:
     std::string outputFilename_;       
   };
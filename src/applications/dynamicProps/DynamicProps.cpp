@@ -274,6 +274,18 @@ int main(int argc, char* argv[]){
     corrFunc->setOutputName(args_info.output_arg);
   }
 
+  switch (args_info.correlator_arg) {
+  case correlator_arg_fft:
+    corrFunc->setCorrelator(FFT_CORRELATOR);
+    break;
+  case correlator_arg_multipletau:
+    corrFunc->setCorrelator(MULTIPLE_TAU_CORRELATOR);
+    break;
+  case correlator_arg_direct:
+  default:
+    break;
+  }
+
   corrFunc->doCorrelate();
 
   delete corrFunc;
@@ -47,6 +47,7 @@ const char *gengetopt_args_info_help[] = {
   "      --thetacut=DOUBLE         HOO cutoff angle (degrees)  (default=`30')",
   "      --OHcut=DOUBLE            Oxygen-Hydrogen cutoff radius (angstroms)\n                                  (default=`2.45')",
   "      --privilegedAxis=ENUM     which axis is special for spatial analysis\n                                  (default = z axis)  (possible values=\"x\",\n                                  \"y\", \"z\" default=`z')",
+  "      --correlator=ENUM         method for accumulating the correlation function\n                                  (possible values=\"direct\", \"fft\",\n                                  \"multipletau\" default=`direct')",
   "\n Group: correlation function\n   an option of this group is required",
   "  -s, --selecorr                selection correlation function",
   "  -r, --rcorr                   mean squared displacement",
@@ -124,6 +125,7 @@ free_cmd_list(void)
 
 
 const char *cmdline_parser_privilegedAxis_values[] = {"x", "y", "z", 0}; /*< Possible values for privilegedAxis. */
+const char *cmdline_parser_correlator_values[] = {"direct", "fft", "multipletau", 0}; /*< Possible values for correlator. */
 
 static char *
 gengetopt_strdup (const char *s);
@@ -145,6 +147,7 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->thetacut_given = 0 ;
   args_info->OHcut_given = 0 ;
   args_info->privilegedAxis_given = 0 ;
+  args_info->correlator_given = 0 ;
   args_info->selecorr_given = 0 ;
   args_info->rcorr_given = 0 ;
   args_info->rcorrZ_given = 0 ;
@@ -203,6 +206,8 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->OHcut_orig = NULL;
   args_info->privilegedAxis_arg = privilegedAxis_arg_z;
   args_info->privilegedAxis_orig = NULL;
+  args_info->correlator_arg = correlator_arg_direct;
+  args_info->correlator_orig = NULL;
   
 }
 
@@ -225,35 +230,36 @@ void init_args_info(struct gengetopt_args_info *args_info)
   args_info->thetacut_help = gengetopt_args_info_help[11] ;
   args_info->OHcut_help = gengetopt_args_info_help[12] ;
   args_info->privilegedAxis_help = gengetopt_args_info_help[13] ;
-  args_info->selecorr_help = gengetopt_args_info_help[15] ;
-  args_info->rcorr_help = gengetopt_args_info_help[16] ;
-  args_info->rcorrZ_help = gengetopt_args_info_help[17] ;
-  args_info->vcorr_help = gengetopt_args_info_help[18] ;
-  args_info->vcorrZ_help = gengetopt_args_info_help[19] ;
-  args_info->vcorrR_help = gengetopt_args_info_help[20] ;
-  args_info->dcorr_help = gengetopt_args_info_help[21] ;
-  args_info->lcorr_help = gengetopt_args_info_help[22] ;
-  args_info->lcorrZ_help = gengetopt_args_info_help[23] ;
-  args_info->cohZ_help = gengetopt_args_info_help[24] ;
-  args_info->sdcorr_help = gengetopt_args_info_help[25] ;
-  args_info->r_rcorr_help = gengetopt_args_info_help[26] ;
-  args_info->thetacorr_help = gengetopt_args_info_help[27] ;
-  args_info->drcorr_help = gengetopt_args_info_help[28] ;
-  args_info->helfandEcorr_help = gengetopt_args_info_help[29] ;
-  args_info->momentum_help = gengetopt_args_info_help[30] ;
-  args_info->stresscorr_help = gengetopt_args_info_help[31] ;
-  args_info->bondcorr_help = gengetopt_args_info_help[32] ;
-  args_info->freqfluccorr_help = gengetopt_args_info_help[33] ;
-  args_info->jumptime_help = gengetopt_args_info_help[34] ;
-  args_info->jumptimeZ_help = gengetopt_args_info_help[35] ;
-  args_info->persistence_help = gengetopt_args_info_help[36] ;
-  args_info->pjcorr_help = gengetopt_args_info_help[37] ;
-  args_info->ftcorr_help = gengetopt_args_info_help[38] ;
-  args_info->facorr_help = gengetopt_args_info_help[39] ;
-  args_info->tfcorr_help = gengetopt_args_info_help[40] ;
-  args_info->tacorr_help = gengetopt_args_info_help[41] ;
-  args_info->disp_help = gengetopt_args_info_help[42] ;
-  args_info->dispZ_help = gengetopt_args_info_help[43] ;
+  args_info->correlator_help = gengetopt_args_info_help[14] ;
+  args_info->selecorr_help = gengetopt_args_info_help[16] ;
+  args_info->rcorr_help = gengetopt_args_info_help[17] ;
+  args_info->rcorrZ_help = gengetopt_args_info_help[18] ;
+  args_info->vcorr_help = gengetopt_args_info_help[19] ;
+  args_info->vcorrZ_help = gengetopt_args_info_help[20] ;
+  args_info->vcorrR_help = gengetopt_args_info_help[21] ;
+  args_info->dcorr_help = gengetopt_args_info_help[22] ;
+  args_info->lcorr_help = gengetopt_args_info_help[23] ;
+  args_info->lcorrZ_help = gengetopt_args_info_help[24] ;
+  args_info->cohZ_help = gengetopt_args_info_help[25] ;
+  args_info->sdcorr_help = gengetopt_args_info_help[26] ;
+  args_info->r_rcorr_help = gengetopt_args_info_help[27] ;
+  args_info->thetacorr_help = gengetopt_args_info_help[28] ;
+  args_info->drcorr_help = gengetopt_args_info_help[29] ;
+  args_info->helfandEcorr_help = gengetopt_args_info_help[30] ;
+  args_info->momentum_help = gengetopt_args_info_help[31] ;
+  args_info->stresscorr_help = gengetopt_args_info_help[32] ;
+  args_info->bondcorr_help = gengetopt_args_info_help[33] ;
+  args_info->freqfluccorr_help = gengetopt_args_info_help[34] ;
+  args_info->jumptime_help = gengetopt_args_info_help[35] ;
+  args_info->jumptimeZ_help = gengetopt_args_info_help[36] ;
+  args_info->persistence_help = gengetopt_args_info_help[37] ;
+  args_info->pjcorr_help = gengetopt_args_info_help[38] ;
+  args_info->ftcorr_help = gengetopt_args_info_help[39] ;
+  args_info->facorr_help = gengetopt_args_info_help[40] ;
+  args_info->tfcorr_help = gengetopt_args_info_help[41] ;
+  args_info->tacorr_help = gengetopt_args_info_help[42] ;
+  args_info->disp_help = gengetopt_args_info_help[43] ;
+  args_info->dispZ_help = gengetopt_args_info_help[44] ;
   
 }
 
@@ -357,6 +363,7 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
   free_string_field (&(args_info->thetacut_orig));
   free_string_field (&(args_info->OHcut_orig));
   free_string_field (&(args_info->privilegedAxis_orig));
+  free_string_field (&(args_info->correlator_orig));
   
   
   for (i = 0; i < args_info->inputs_num; ++i)
@@ -461,6 +468,8 @@ cmdline_parser_dump(FILE *outfile, struct gengetopt_args_info *args_info)
     write_into_file(outfile, "OHcut", args_info->OHcut_orig, 0);
   if (args_info->privilegedAxis_given)
     write_into_file(outfile, "privilegedAxis", args_info->privilegedAxis_orig, cmdline_parser_privilegedAxis_values);
+  if (args_info->correlator_given)
+    write_into_file(outfile, "correlator", args_info->correlator_orig, cmdline_parser_correlator_values);
   if (args_info->selecorr_given)
     write_into_file(outfile, "selecorr", 0, 0 );
   if (args_info->rcorr_given)
@@ -1453,6 +1462,7 @@ cmdline_parser_internal (
         { "thetacut",	1, NULL, 0 },
         { "OHcut",	1, NULL, 0 },
         { "privilegedAxis",	1, NULL, 0 },
+        { "correlator",	1, NULL, 0 },
         { "selecorr",	0, NULL, 's' },
         { "rcorr",	0, NULL, 'r' },
         { "rcorrZ",	0, NULL, 0 },
@@ -1820,6 +1830,20 @@ cmdline_parser_internal (
                 additional_error))
               goto failure;
           
+          }
+          /* method for accumulating the correlation function.  */
+          else if (strcmp (long_options[option_index].name, "correlator") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->correlator_arg), 
+                 &(args_info->correlator_orig), &(args_info->correlator_given),
+                &(local_args_info.correlator_given), optarg, cmdline_parser_correlator_values, "direct", ARG_ENUM,
+                check_ambiguity, override, 0, 0,
+                "correlator", '-',
+                additional_error))
+              goto failure;
+          
           }
           /* mean squared displacement binned by Z.  */
           else if (strcmp (long_options[option_index].name, "rcorrZ") == 0)
@@ -35,6 +35,7 @@ extern "C" {
 #endif
 
 enum enum_privilegedAxis { privilegedAxis__NULL = -1, privilegedAxis_arg_x = 0, privilegedAxis_arg_y, privilegedAxis_arg_z };
+enum enum_correlator { correlator__NULL = -1, correlator_arg_direct = 0, correlator_arg_fft, correlator_arg_multipletau };
 
 /** @brief Where the command line options are stored */
 struct gengetopt_args_info
@@ -77,6 +78,9 @@ struct gengetopt_args_info
   enum enum_privilegedAxis privilegedAxis_arg;	/**< @brief which axis is special for spatial analysis (default = z axis) (default='z').  */
   char * privilegedAxis_orig;	/**< @brief which axis is special for spatial analysis (default = z axis) original value given at command line.  */
   const char *privilegedAxis_help; /**< @brief which axis is special for spatial analysis (default = z axis) help description.  */
+  enum enum_correlator correlator_arg;	/**< @brief method for accumulating the correlation function (default='direct').  */
+  char * correlator_orig;	/**< @brief method for accumulating the correlation function original value given at command line.  */
+  const char *correlator_help; /**< @brief method for accumulating the correlation function help description.  */
   const char *selecorr_help; /**< @brief selection correlation function help description.  */
   const char *rcorr_help; /**< @brief mean squared displacement help description.  */
   const char *rcorrZ_help; /**< @brief mean squared displacement binned by Z help description.  */
@@ -121,6 +125,7 @@ struct gengetopt_args_info
   unsigned int thetacut_given ;	/**< @brief Whether thetacut was given.  */
   unsigned int OHcut_given ;	/**< @brief Whether OHcut was given.  */
   unsigned int privilegedAxis_given ;	/**< @brief Whether privilegedAxis was given.  */
+  unsigned int correlator_given ;	/**< @brief Whether correlator was given.  */
   unsigned int selecorr_given ;	/**< @brief Whether selecorr was given.  */
   unsigned int rcorr_given ;	/**< @brief Whether rcorr was given.  */
   unsigned int rcorrZ_given ;	/**< @brief Whether rcorrZ was given.  */
@@ -303,6 +308,7 @@ int cmdline_parser_required (struct gengetopt_args_info *args_info,
   const char *prog_name);
 
 extern const char *cmdline_parser_privilegedAxis_values[];  /**< @brief Possible values for privilegedAxis. */
+extern const char *cmdline_parser_correlator_values[];  /**< @brief Possible values for correlator. */
 
 
 #ifdef __cplusplus
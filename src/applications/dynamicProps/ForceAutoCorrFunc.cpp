@@ -75,6 +75,16 @@ namespace OpenMD {
                                          int id1, int id2) {
     return outProduct( forces_[frame1][id1] , forces_[frame2][id2] );
   }
+  void ForceAutoCorrFunc::getCorrTerms1(int frame, int id, RealType* terms) {
+    for (int k = 0; k < 3; k++) terms[k] = forces_[frame][id][k];
+  }
+  Mat3x3d ForceAutoCorrFunc::combineCorrTerms(const std::vector<RealType>& products) {
+    Mat3x3d corr;
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 3; j++)
+        corr(i, j) = products[3 * i + j];
+    return corr;
+  }
   
   void ForceAutoCorrFunc::postCorrelate() {
     // Gets the average of the forces_
@@ -54,7 +54,8 @@ namespace OpenMD {
                                   DataStorage::dslPosition |
                                   DataStorage::dslAmat ),
     OOCut_(OOcut), thetaCut_(thetaCut), OHCut_(OHcut),
-    sele1_minus_common_(info), sele2_minus_common_(info), common_(info)  {
+    sele1_minus_common_(info), sele2_minus_common_(info), common_(info),
+    hbFinder_(info, OOcut, thetaCut, OHcut) {
     
     setCorrFuncType("HBondJump");
     setOutputName(getPrefix(dumpFilename_) + ".jump");
@@ -216,118 +217,76 @@ namespace OpenMD {
                                          SelectionManager& sman2) {
     Molecule* mol1;
     Molecule* mol2;
-    int i, j;    
+    SimInfo::MoleculeIterator mi;
     std::vector<Molecule::HBondDonor*>::iterator hbdi;
     Molecule::HBondDonor* hbd;
-    std::vector<Atom*>::iterator hbai;
-    Atom* hba;
     int hInd, index, aInd;
     
-    // This is the same as a non-overlapping pairwise loop structure:
+    // A hydrogen bond is selected if its donor is in a molecule from
+    // one selection and its acceptor is in a molecule from the
+    // other.  This is the same as checking every pair in a
+    // non-overlapping pairwise loop structure:
     // for (int i = 0;  i < ni ; ++i ) {
     //   for (int j = 0; j < nj; ++j) {} 
     // }
     
-    for (mol1 = sman1.beginSelectedMolecule(i); mol1 != NULL; 
-         mol1 = sman1.nextSelectedMolecule(i)) {
+    for (mol1 = info_->beginMolecule(mi); mol1 != NULL;
+         mol1 = info_->nextMolecule(mi)) {
+
+      bool in1 = sman1.isSelected(mol1);
+      bool in2 = sman2.isSelected(mol1);
+      if (!in1 && !in2) continue;
       
-      for (mol2 = sman2.beginSelectedMolecule(j); mol2 != NULL; 
-           mol2 = sman2.nextSelectedMolecule(j)) {
-        
-        // loop over the possible donors in molecule 1:
-        for (hbd = mol1->beginHBondDonor(hbdi); hbd != NULL;
-             hbd = mol1->nextHBondDonor(hbdi)) {
-          
-          hInd = hbd->donatedHydrogen->getGlobalIndex();
-          index = GIDtoH_[frame][hInd];
-          aInd = acceptor_[frame][index];
-                            
-          for (hba = mol2->beginHBondAcceptor(hbai); hba != NULL;
-               hba = mol2->nextHBondAcceptor(hbai)) {
-            
-            if (hba->getGlobalIndex() == aInd) {
-              selected_[frame][index] = true;
-            }
-          }
-        }
+      for (hbd = mol1->beginHBondDonor(hbdi); hbd != NULL;
+           hbd = mol1->nextHBondDonor(hbdi)) {
         
-        // loop over the possible donors in molecule 2:
-        for (hbd = mol2->beginHBondDonor(hbdi); hbd != NULL;
-             hbd = mol2->nextHBondDonor(hbdi)) {
-          
-          hInd = hbd->donatedHydrogen->getGlobalIndex();
-          index = GIDtoH_[frame][hInd];
-          aInd = acceptor_[frame][index];
-                            
-          for (hba = mol1->beginHBondAcceptor(hbai); hba != NULL;
-               hba = mol1->nextHBondAcceptor(hbai)) {
-            
-            if (hba->getGlobalIndex() == aInd) {
-              selected_[frame][index] = true;
-            }            
-          }
+        hInd = hbd->donatedHydrogen->getGlobalIndex();
+        index = GIDtoH_[frame][hInd];
+        aInd = acceptor_[frame][index];
+        if (aInd == -1) continue;
+
+        mol2 = info_->getMoleculeByGlobalIndex(info_->getGlobalMolMembership(aInd));
+
+        if ((in1 && sman2.isSelected(mol2)) ||
+            (in2 && sman1.isSelected(mol2))) {
+          selected_[frame][index] = true;
         }
-      }        
+      }
     }    
   }
 
   void HBondJump::processOverlapping( int frame, SelectionManager& sman) {
     Molecule* mol1;
     Molecule* mol2;
-    int i, j;    
-
+    SimInfo::MoleculeIterator mi;
     std::vector<Molecule::HBondDonor*>::iterator hbdi;
     Molecule::HBondDonor* hbd;
-    std::vector<Atom*>::iterator hbai;
-    Atom* hba;
     int hInd, index, aInd;
 
-    // This is the same as a pairwise loop structure:
+    // A hydrogen bond is selected if its donor and acceptor are in
+    // two different molecules from the selection.  This is the same
+    // as checking every pair in a pairwise loop structure:
     // for (int i = 0;  i < n-1 ; ++i ) {
     //   for (int j = i + 1; j < n; ++j) {} 
     // }
     
-    for (mol1 = sman.beginSelectedMolecule(i); mol1 != NULL; 
-         mol1 = sman.nextSelectedMolecule(i)) {
+    for (mol1 = info_->beginMolecule(mi); mol1 != NULL;
+         mol1 = info_->nextMolecule(mi)) {
+
+      if (!sman.isSelected(mol1)) continue;
 
-      // loop over the possible donors in molecule 1:
       for (hbd = mol1->beginHBondDonor(hbdi); hbd != NULL;
            hbd = mol1->nextHBondDonor(hbdi)) {
 
         hInd = hbd->donatedHydrogen->getGlobalIndex();
         index = GIDtoH_[frame][hInd];
         aInd = acceptor_[frame][index];
-        
-        for (j  = i, mol2 = sman.nextSelectedMolecule(j); mol2 != NULL; 
-             mol2 = sman.nextSelectedMolecule(j)) {
-          
-          for (hba = mol2->beginHBondAcceptor(hbai); hba != NULL;
-               hba = mol2->nextHBondAcceptor(hbai)) {
+        if (aInd == -1) continue;
 
-            if (hba->getGlobalIndex() == aInd) {
-              selected_[frame][index] = true;
-            }
-          }
-        }
-      }
-      
-      for (hba = mol1->beginHBondAcceptor(hbai); hba != NULL;
-           hba = mol1->nextHBondAcceptor(hbai)) {
-
-        aInd = hba->getGlobalIndex();
-        
-        for (j  = i, mol2 = sman.nextSelectedMolecule(j); mol2 != NULL; 
-             mol2 = sman.nextSelectedMolecule(j)) {
-          for (hbd = mol2->beginHBondDonor(hbdi); hbd != NULL;
-               hbd = mol2->nextHBondDonor(hbdi)) {
-            
-            hInd = hbd->donatedHydrogen->getGlobalIndex();
-            index = GIDtoH_[frame][hInd];
+        mol2 = info_->getMoleculeByGlobalIndex(info_->getGlobalMolMembership(aInd));
 
-            if (acceptor_[frame][index] == aInd) {
-              selected_[frame][index] = true;
-            }
-          }
+        if (mol2 != mol1 && sman.isSelected(mol2)) {
+          selected_[frame][index] = true;
         }
       }
     }
@@ -335,16 +294,12 @@ namespace OpenMD {
 
   void HBondJump::findHBonds( int frame ) {
     Molecule* mol1;
-    Molecule* mol2;
-    SimInfo::MoleculeIterator mi, mj;
+    SimInfo::MoleculeIterator mi;
     std::vector<Molecule::HBondDonor*>::iterator hbdi;
     Molecule::HBondDonor* hbd;
-    std::vector<Atom*>::iterator hbai;
-    Atom* hba;
-    Vector3d dPos, hPos, aPos;
+    std::vector<HBondFinder::HBond>::const_iterator hb;
     int hInd, index, aInd;
 
-
     // Register all the possible HBond donor hydrogens:
     for (mol1 = info_->beginMolecule(mi); mol1 != NULL;
          mol1 = info_->nextMolecule(mi)) {
@@ -354,94 +309,21 @@ namespace OpenMD {
         index = registerHydrogen(frame, hInd);
       }
     }
-    
-    for (mol1 = info_->beginMolecule(mi); mol1 != NULL;
-         mol1 = info_->nextMolecule(mi)) {
-      
-      for (hbd = mol1->beginHBondDonor(hbdi); hbd != NULL;
-           hbd = mol1->nextHBondDonor(hbdi)) {
 
-        hInd = hbd->donatedHydrogen->getGlobalIndex();
-        index = GIDtoH_[frame][hInd];
-        
-        dPos = hbd->donorAtom->getPos();
-        hPos = hbd->donatedHydrogen->getPos();
-
-        for (mj = mi, mol2 = info_->beginMolecule(mj); mol2 != NULL;
-             mol2 = info_->nextMolecule(mj)) {
-
-          for (hba = mol2->beginHBondAcceptor(hbai); hba != NULL;
-               hba = mol2->nextHBondAcceptor(hbai)) {
-
-            aPos = hba->getPos();
-            
-            if (isHBond(dPos, hPos, aPos)) {
-              aInd = hba->getGlobalIndex();            
-              registerHydrogenBond(frame, index, hInd, aInd);
-            }            
-          }
-        }
-      }
-      
-      for (hba = mol1->beginHBondAcceptor(hbai); hba != NULL;
-           hba = mol1->nextHBondAcceptor(hbai)) {
-        
-        aPos = hba->getPos();
-        
-        for (mj = mi, mol2 = info_->beginMolecule(mj); mol2 != NULL;
-             mol2 = info_->nextMolecule(mj)) {
-          
-          for (hbd = mol2->beginHBondDonor(hbdi); hbd != NULL;
-               hbd = mol2->nextHBondDonor(hbdi)) {
-            
-            hInd = hbd->donatedHydrogen->getGlobalIndex();
-            // no need to register, just look up the index:
-            index = GIDtoH_[frame][hInd];
-            
-            dPos = hbd->donorAtom->getPos();
-            hPos = hbd->donatedHydrogen->getPos();
-            
-            if (isHBond(dPos, hPos, aPos)) {
-              aInd = hba->getGlobalIndex();            
-              registerHydrogenBond(frame, index, hInd, aInd);
-            }
-          }
-        }
-      }
-    }
-  }
-  
-
-  bool HBondJump::isHBond( Vector3d donorPos, Vector3d hydrogenPos,
-                           Vector3d acceptorPos) {
-      
-    Vector3d DA = acceptorPos - donorPos;
-    currentSnapshot_->wrapVector(DA);
-    RealType DAdist = DA.length();
-        
-    // Distance criteria: are the donor and acceptor atoms
-    // close enough?
-    if (DAdist < OOCut_) {
-      Vector3d DH = hydrogenPos - donorPos; 
-      currentSnapshot_->wrapVector(DH);
-      RealType DHdist = DH.length();
-      
-      Vector3d HA = acceptorPos - hydrogenPos;
-      currentSnapshot_->wrapVector(HA);
-      RealType HAdist = HA.length();
-          
-      RealType ctheta = dot(DH, DA) / (DHdist * DAdist);
-      RealType theta = acos(ctheta) * 180.0 / Constants::PI;
-      
-      // Angle criteria: are the D-H and D-A and vectors close?
-      if (theta < thetaCut_ && HAdist < OHCut_) {
-        return true;
-      }
+    // If a hydrogen has more than one acceptor, the last one (in
+    // molecule order) is the one that is kept:
+    hbFinder_.findHBonds(currentSnapshot_);
+    const std::vector<HBondFinder::HBond>& hBonds = hbFinder_.getHBonds();
+    
+    for (hb = hBonds.begin(); hb != hBonds.end(); ++hb) {
+      hInd = hb->donor->donatedHydrogen->getGlobalIndex();
+      // no need to register, just look up the index:
+      index = GIDtoH_[frame][hInd];
+      aInd = hb->acceptor->getGlobalIndex();
+      registerHydrogenBond(frame, index, hInd, aInd);
     }
-    return false;
   }
 
-
   int HBondJump::registerHydrogen(int frame, int hIndex) {
     int index;
     
@@ -523,13 +405,11 @@ namespace OpenMD {
   
   void HBondJumpZ::findHBonds( int frame ) {
     Molecule* mol1;
-    Molecule* mol2;
-    SimInfo::MoleculeIterator mi, mj;
+    SimInfo::MoleculeIterator mi;
     std::vector<Molecule::HBondDonor*>::iterator hbdi;
     Molecule::HBondDonor* hbd;
-    std::vector<Atom*>::iterator hbai;
-    Atom* hba;
-    Vector3d dPos, hPos, aPos, pos;
+    std::vector<HBondFinder::HBond>::const_iterator hb;
+    Vector3d pos;
     int hInd, index, aInd, zBin;
     
     Mat3x3d hmat = currentSnapshot_->getHmat();
@@ -544,70 +424,22 @@ namespace OpenMD {
         index = registerHydrogen(frame, hInd);
       }
     }
-    
-    for (mol1 = info_->beginMolecule(mi); mol1 != NULL;
-         mol1 = info_->nextMolecule(mi)) {
-      
-      for (hbd = mol1->beginHBondDonor(hbdi); hbd != NULL;
-           hbd = mol1->nextHBondDonor(hbdi)) {
 
-        hInd = hbd->donatedHydrogen->getGlobalIndex();
-        index = GIDtoH_[frame][hInd];
-        
-        dPos = hbd->donorAtom->getPos();
-        hPos = hbd->donatedHydrogen->getPos();
-
-        for (mj = mi, mol2 = info_->beginMolecule(mj); mol2 != NULL;
-             mol2 = info_->nextMolecule(mj)) {
-
-          for (hba = mol2->beginHBondAcceptor(hbai); hba != NULL;
-               hba = mol2->nextHBondAcceptor(hbai)) {
-
-            aPos = hba->getPos();
-            
-            if (isHBond(dPos, hPos, aPos)) {
-              aInd = hba->getGlobalIndex();            
-              registerHydrogenBond(frame, index, hInd, aInd);
-              pos = hPos;
-              if (info_->getSimParams()->getUsePeriodicBoundaryConditions())
-                currentSnapshot_->wrapVector(pos);
-              zBin = int(nZBins_ * (halfBoxZ_ + pos[axis_]) / hmat(axis_,axis_));
-              zbin_[frame][index] = zBin;              
-            }            
-          }
-        }
-      }
+    hbFinder_.findHBonds(currentSnapshot_);
+    const std::vector<HBondFinder::HBond>& hBonds = hbFinder_.getHBonds();
+    
+    for (hb = hBonds.begin(); hb != hBonds.end(); ++hb) {
+      hInd = hb->donor->donatedHydrogen->getGlobalIndex();
+      // no need to register, just look up the index:
+      index = GIDtoH_[frame][hInd];
+      aInd = hb->acceptor->getGlobalIndex();
+      registerHydrogenBond(frame, index, hInd, aInd);
       
-      for (hba = mol1->beginHBondAcceptor(hbai); hba != NULL;
-           hba = mol1->nextHBondAcceptor(hbai)) {
-        
-        aPos = hba->getPos();
-        
-        for (mj = mi, mol2 = info_->beginMolecule(mj); mol2 != NULL;
-             mol2 = info_->nextMolecule(mj)) {
-          
-          for (hbd = mol2->beginHBondDonor(hbdi); hbd != NULL;
-               hbd = mol2->nextHBondDonor(hbdi)) {
-            
-            hInd = hbd->donatedHydrogen->getGlobalIndex();
-            // no need to register, just look up the index:
-            index = GIDtoH_[frame][hInd];
-            
-            dPos = hbd->donorAtom->getPos();
-            hPos = hbd->donatedHydrogen->getPos();
-            
-            if (isHBond(dPos, hPos, aPos)) {
-              aInd = hba->getGlobalIndex();            
-              registerHydrogenBond(frame, index, hInd, aInd);
-              pos = hPos;
-              if (info_->getSimParams()->getUsePeriodicBoundaryConditions())
-                currentSnapshot_->wrapVector(pos);
-              zBin = int(nZBins_ * (halfBoxZ_ + pos[axis_]) / hmat(axis_,axis_));
-              zbin_[frame][index] = zBin;
-            }
-          }
-        }
-      }
+      pos = hb->donor->donatedHydrogen->getPos();
+      if (info_->getSimParams()->getUsePeriodicBoundaryConditions())
+        currentSnapshot_->wrapVector(pos);
+      zBin = int(nZBins_ * (halfBoxZ_ + pos[axis_]) / hmat(axis_,axis_));
+      zbin_[frame][index] = zBin;
     }
   }
 
@@ -43,6 +43,8 @@
 #define APPLICATIONS_DYNAMICPROPS_HBONDJUMP_HPP
 
 #include "applications/dynamicProps/MultipassCorrFunc.hpp"
+#include "utils/HBondFinder.hpp"
+
 namespace OpenMD {
 
   class HBondJump : public MultipassCorrFunc<RealType> {
@@ -62,7 +64,6 @@ namespace OpenMD {
 
     virtual int  registerHydrogen(int frame, int hIndex);
     virtual void findHBonds( int frame );
-    bool isHBond(Vector3d donorPos, Vector3d hPos, Vector3d acceptorPos);
     void registerHydrogenBond(int frame, int index, int hIndex, int aIndex);
     void processNonOverlapping(int frame, SelectionManager& sman1, 
                                SelectionManager& sman2);
@@ -82,6 +83,8 @@ namespace OpenMD {
     SelectionManager sele1_minus_common_;
     SelectionManager sele2_minus_common_;
     SelectionManager common_;    
+
+    HBondFinder hbFinder_;
   };
 
   class HBondJumpZ : public HBondJump {
@@ -43,6 +43,7 @@
 #include "applications/dynamicProps/HBondPersistence.hpp"
 #include "utils/Constants.hpp"
 #include <algorithm>
+#include <utility>
 
 namespace OpenMD {
   HBondPersistence::HBondPersistence(SimInfo* info, const std::string& filename,
@@ -53,7 +54,8 @@ namespace OpenMD {
     : MultipassCorrFunc<RealType>(info, filename, sele1, sele2,
                                   DataStorage::dslPosition |
                                   DataStorage::dslAmat ),
-    OOCut_(OOcut), thetaCut_(thetaCut), OHCut_(OHcut) {
+    OOCut_(OOcut), thetaCut_(thetaCut), OHCut_(OHcut),
+    hbFinder_(info, OOcut, thetaCut, OHcut) {
     
     setCorrFuncType("HBondPersistence");
     setOutputName(getPrefix(dumpFilename_) + ".HBpersistence");
@@ -72,21 +74,9 @@ namespace OpenMD {
   }
   
   void HBondPersistence::computeFrame(int istep) {
-    Molecule* mol1;
-    Molecule* mol2;
-    std::vector<Molecule::HBondDonor*>::iterator hbdi;
-    Molecule::HBondDonor* hbd;
-    std::vector<Atom*>::iterator hbai;
-    Atom* hba;
-    Vector3d dPos;
-    Vector3d aPos;
-    Vector3d hPos;
-    Vector3d DH;
-    Vector3d DA;
-    Vector3d HA;
-    Vector3d uDA;
-    RealType DAdist, DHdist, HAdist, theta, ctheta;
-    int ii, jj;
+    std::vector<HBondFinder::HBond>::const_iterator hb;
+    std::pair<std::pair<int, int>, int> key, lastKey;
+    int dMol, aMol;
     int hInd, aInd, index;
 
     // Map of atomic global IDs to donor atoms:
@@ -104,100 +94,47 @@ namespace OpenMD {
       seleMan2_.setSelectionSet(evaluator2_.evaluate());
     }      
 
-    for (mol1 = seleMan1_.beginSelectedMolecule(ii);
-         mol1 != NULL; mol1 = seleMan1_.nextSelectedMolecule(ii)) {
+    hbFinder_.findHBonds(currentSnapshot_);
+    const std::vector<HBondFinder::HBond>& hBonds = hbFinder_.getHBonds();
 
-      for (mol2 = seleMan2_.beginSelectedMolecule(jj);
-           mol2 != NULL; mol2 = seleMan2_.nextSelectedMolecule(jj)) {
+    // A hydrogen bond is recorded once for molecule 1 as the donor
+    // and once for molecule 1 as the acceptor, whenever the other
+    // molecule is in selection 2.  If a hydrogen is bonded to more
+    // than one acceptor, the donor map keeps the bond that a loop
+    // over (molecule 1, molecule 2, donor side / acceptor side)
+    // would have recorded last.
+    
+    for (hb = hBonds.begin(); hb != hBonds.end(); ++hb) {
+      if (hb == hBonds.begin() || hb->donor != (hb - 1)->donor) {
+        lastKey = std::make_pair(std::make_pair(-1, -1), -1);
+      }
 
-        // loop over the possible donors in molecule 1:
-        for (hbd = mol1->beginHBondDonor(hbdi); hbd != NULL;
-             hbd = mol1->nextHBondDonor(hbdi)) {
-          dPos = hbd->donorAtom->getPos(); 
-          hPos = hbd->donatedHydrogen->getPos();
-          DH = hPos - dPos; 
-          currentSnapshot_->wrapVector(DH);
-          DHdist = DH.length();
-          
-          hInd = hbd->donatedHydrogen->getGlobalIndex();
-          aInd = -1;
-          
-          // loop over the possible acceptors in molecule 2:
-          for (hba = mol2->beginHBondAcceptor(hbai); hba != NULL;
-               hba = mol2->nextHBondAcceptor(hbai)) {
-            aPos = hba->getPos();
-            DA = aPos - dPos;
-            currentSnapshot_->wrapVector(DA);
-            DAdist = DA.length();
-            
-            // Distance criteria: are the donor and acceptor atoms
-            // close enough?
-            if (DAdist < OOCut_) {
-              HA = aPos - hPos;
-              currentSnapshot_->wrapVector(HA);
-              HAdist = HA.length();
-              
-              ctheta = dot(DH, DA) / (DHdist * DAdist);
-              theta = acos(ctheta) * 180.0 / Constants::PI;
-              
-              // Angle criteria: are the D-H and D-A and vectors close?
-              if (theta < thetaCut_ && HAdist < OHCut_) {
-                // molecule 2 is a Hbond acceptor:
-                aInd = hba->getGlobalIndex();
-                
-                index = acceptor_[istep].size();
-                GIDtoDonor_[istep][hInd] = index;
-                
-                acceptor_[istep].push_back(aInd);
-                DonorToGID_[istep].push_back(hInd);
-              }
-            }            
-          }                    
+      dMol = hb->donorMol->getGlobalIndex();
+      aMol = hb->acceptorMol->getGlobalIndex();
+      hInd = hb->donor->donatedHydrogen->getGlobalIndex();
+      aInd = hb->acceptor->getGlobalIndex();
+
+      for (int side = 0; side < 2; ++side) {
+        if (side == 0) {
+          // molecule 1 is the donor, molecule 2 is the acceptor:
+          if (!seleMan1_.isSelected(hb->donorMol) ||
+              !seleMan2_.isSelected(hb->acceptorMol)) continue;
+          key = std::make_pair(std::make_pair(dMol, aMol), side);
+        } else {
+          // molecule 1 is the acceptor, molecule 2 is the donor:
+          if (!seleMan1_.isSelected(hb->acceptorMol) ||
+              !seleMan2_.isSelected(hb->donorMol)) continue;
+          key = std::make_pair(std::make_pair(aMol, dMol), side);
         }
 
-        // loop over the possible donors in molecule 2:
-        for (hbd = mol2->beginHBondDonor(hbdi); hbd != NULL;
-             hbd = mol2->nextHBondDonor(hbdi)) {
-          dPos = hbd->donorAtom->getPos(); 
-          hPos = hbd->donatedHydrogen->getPos();
-          DH = hPos - dPos; 
-          currentSnapshot_->wrapVector(DH);
-          DHdist = DH.length();
-          
-          hInd = hbd->donatedHydrogen->getGlobalIndex();
-          aInd = -1;
-          
-          // loop over the possible acceptors in molecule 1:
-          for (hba = mol1->beginHBondAcceptor(hbai); hba != NULL;
-               hba = mol1->nextHBondAcceptor(hbai)) {
-            aPos = hba->getPos();
-            DA = aPos - dPos;
-            currentSnapshot_->wrapVector(DA);
-            DAdist = DA.length();
-            
-            // Distance criteria: are the donor and acceptor atoms
-            // close enough?
-            if (DAdist < OOCut_) {
-              HA = aPos - hPos;
-              currentSnapshot_->wrapVector(HA);
-              HAdist = HA.length();
+        index = acceptor_[istep].size();
+        acceptor_[istep].push_back(aInd);
+        DonorToGID_[istep].push_back(hInd);
 
-              ctheta = dot(DH, DA) / (DHdist * DAdist);
-              theta = acos(ctheta) * 180.0 / Constants::PI;
-              
-              // Angle criteria: are the D-H and D-A and vectors close?
-              if (theta < thetaCut_ && HAdist < OHCut_) {
-                // molecule 1 is a Hbond acceptor:
-                aInd = hba->getGlobalIndex();
-                index = acceptor_[istep].size();
-                GIDtoDonor_[istep][hInd] = index;
-                
-                acceptor_[istep].push_back(aInd);
-                DonorToGID_[istep].push_back(hInd);                
-              }
-            }            
-          }          
-        }        
+        if (key >= lastKey) {
+          GIDtoDonor_[istep][hInd] = index;
+          lastKey = key;
+        }
       }
     }
   }
@@ -43,6 +43,8 @@
 #define APPLICATIONS_DYNAMICPROPS_HBONDPERSISTENCE_HPP
 
 #include "applications/dynamicProps/MultipassCorrFunc.hpp"
+#include "utils/HBondFinder.hpp"
+
 namespace OpenMD {
 
   class HBondPersistence : public MultipassCorrFunc<RealType> {
@@ -67,6 +69,8 @@ namespace OpenMD {
     RealType OOCut_;
     RealType thetaCut_;
     RealType OHCut_;
+
+    HBondFinder hbFinder_;
   };
 
 }
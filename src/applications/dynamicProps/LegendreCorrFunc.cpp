@@ -99,6 +99,55 @@ namespace OpenMD {
     return Vector3d(ux, uy, uz);
   }
 
+  /**
+   * P1 and P2 of the cosine between the two orientations of a body
+   * axis u are linear in the products of the components,
+   *
+   *    P1 = sum_i u_i(0) u_i(t)
+   *    P2 = 3/2 sum_ij u_i(0) u_j(0) u_i(t) u_j(t) - 1/2,
+   *
+   * so the terms for each of the three axes are the 3 components u_i
+   * (order 1) or the 9 products u_i u_j (order 2).  A leading
+   * constant term of 1 supplies the number of pairs for the constant
+   * part of P2.  Higher orders are only computed directly.
+   */
+  int LegendreCorrFunc::getNCorrTerms() {
+    if (order_ == 1) return 1 + 3 * 3;
+    if (order_ == 2) return 1 + 3 * 9;
+    return 0;
+  }
+
+  void LegendreCorrFunc::getCorrTerms1(int frame, int id, RealType* terms) {
+    terms[0] = 1.0;
+    for (int axis = 0; axis < 3; axis++) {
+      Vector3d u = rotMats_[frame][id].getRow(axis);
+      u.normalize();
+      if (order_ == 1) {
+        for (int i = 0; i < 3; i++)
+          terms[1 + 3 * axis + i] = u[i];
+      } else {
+        for (int i = 0; i < 3; i++)
+          for (int j = 0; j < 3; j++)
+            terms[1 + 9 * axis + 3 * i + j] = u[i] * u[j];
+      }
+    }
+  }
+
+  Vector3d LegendreCorrFunc::combineCorrTerms(const std::vector<RealType>& products) {
+    int d = getNCorrTerms();
+    int m = (d - 1) / 3;
+    RealType c0 = legendre_.getCoefficient(0);
+    RealType cn = legendre_.getCoefficient(order_);
+    Vector3d corr;
+    for (int axis = 0; axis < 3; axis++) {
+      RealType sum(0.0);
+      for (int k = 1 + m * axis; k < 1 + m * (axis + 1); k++)
+        sum += products[k * d + k];
+      corr[axis] = cn * sum + c0 * products[0];
+    }
+    return corr;
+  }
+
 
   void LegendreCorrFunc::validateSelection(SelectionManager& seleMan) {
     StuntDouble* sd;
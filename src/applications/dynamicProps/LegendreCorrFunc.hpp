@@ -58,6 +58,9 @@ namespace OpenMD {
     virtual int computeProperty1(int frame, StuntDouble* sd);
     virtual Vector3d calcCorrVal(int frame1, int frame2, int id1, int id2);
     virtual void validateSelection(SelectionManager& seleMan);
+    virtual int getNCorrTerms();
+    virtual void getCorrTerms1(int frame, int id, RealType* terms);
+    virtual Vector3d combineCorrTerms(const std::vector<RealType>& products);
 
     int order_;
     DoublePolynomial legendre_;
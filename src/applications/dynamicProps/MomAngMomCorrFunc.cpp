@@ -79,6 +79,16 @@ namespace OpenMD {
     RealType pj = dot( momenta_[frame1][id1] , js_[frame2][id2] );
     return pj;
   }
+  void MomAngMomCorrFunc::getCorrTerms1(int frame, int id, RealType* terms) {
+    for (int k = 0; k < 3; k++) terms[k] = momenta_[frame][id][k];
+  }
+  void MomAngMomCorrFunc::getCorrTerms2(int frame, int id, RealType* terms) {
+    for (int k = 0; k < 3; k++) terms[k] = js_[frame][id][k];
+  }
+  RealType MomAngMomCorrFunc::combineCorrTerms(const std::vector<RealType>&
+                                               products) {
+    return products[0] + products[4] + products[8];
+  }
 
   void MomAngMomCorrFunc::validateSelection(SelectionManager& seleMan) {
     StuntDouble* sd;
@@ -54,6 +54,10 @@ namespace OpenMD {
     virtual int computeProperty1(int frame, StuntDouble* sd);
     virtual int computeProperty2(int frame, StuntDouble* sd);
     virtual RealType calcCorrVal(int frame1, int frame2, int id1, int id2);
+    virtual int getNCorrTerms() { return 3; }
+    virtual void getCorrTerms1(int frame, int id, RealType* terms);
+    virtual void getCorrTerms2(int frame, int id, RealType* terms);
+    virtual RealType combineCorrTerms(const std::vector<RealType>& products);
     virtual void validateSelection(SelectionManager& seleMan);
 
     std::vector<std::vector<Vector3d> > momenta_;
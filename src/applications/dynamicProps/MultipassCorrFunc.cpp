@@ -40,6 +40,13 @@
  * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
  */
 
+#include "config.h"
+#include <algorithm>
+
+#ifdef HAVE_FFTW3_H
+#include <fftw3.h>
+#endif
+
 #include "applications/dynamicProps/MultipassCorrFunc.hpp"
 #include "utils/simError.h"
 #include "utils/Revision.hpp"
@@ -48,6 +55,36 @@
 using namespace std;
 namespace OpenMD {
 
+  /**
+   * Each level of the multiple-tau correlator keeps tauPoints
+   * entries, and tauAverage entries are averaged into one entry of
+   * the next level.  Lags are exact up to tauPoints - 1 frames and
+   * are logarithmically spaced beyond that.
+   */
+  const int tauPoints = 16;
+  const int tauAverage = 2;
+
+#ifdef HAVE_FFTW3_H
+  /**
+   * Zero-pads a time series into the FFT buffer and stores its
+   * transform as interleaved (re, im) pairs in hat.
+   */
+  static void transformSeries(fftw_plan plan, const RealType* values,
+                              int nValues, vector<double>& buffer,
+                              fftw_complex* bufferHat,
+                              vector<double>& hat) {
+    int nHat = buffer.size() / 2 + 1;
+    std::fill(buffer.begin(), buffer.end(), 0.0);
+    for (int t = 0; t < nValues; ++t) buffer[t] = values[t];
+    fftw_execute(plan);
+    hat.resize(2 * nHat);
+    for (int w = 0; w < nHat; ++w) {
+      hat[2 * w] = bufferHat[w][0];
+      hat[2 * w + 1] = bufferHat[w][1];
+    }
+  }
+#endif
+
   template<typename T>
   MultipassCorrFunc<T>::MultipassCorrFunc(SimInfo* info,
                                           const string& filename,
@@ -57,7 +94,8 @@ namespace OpenMD {
     : storageLayout_(storageLayout), info_(info), dumpFilename_(filename),
       seleMan1_(info_), seleMan2_(info_),
       selectionScript1_(sele1), selectionScript2_(sele2),
-      evaluator1_(info_), evaluator2_(info_), autoCorrFunc_(false) {
+      evaluator1_(info_), evaluator2_(info_),
+      correlator_(DIRECT_CORRELATOR), autoCorrFunc_(false) {
 
     // Request maximum needed storage for the simulation (including of
     // whatever was passed down by the individual correlation
@@ -208,6 +246,33 @@ namespace OpenMD {
     writeCorrelate();
   }
 
+  template<typename T>
+  void MultipassCorrFunc<T>::setCorrelator(CorrelatorType type) {
+    if (type != DIRECT_CORRELATOR && getNCorrTerms() == 0) {
+      sprintf(painCave.errMsg,
+              "MultipassCorrFunc: %s can only be computed directly;\n"
+              "\tignoring the requested correlator.\n",
+              getCorrFuncType().c_str());
+      painCave.isFatal = 0;
+      painCave.severity = OPENMD_WARNING;
+      simError();
+      return;
+    }
+#ifndef HAVE_FFTW3_H
+    if (type == FFT_CORRELATOR) {
+      sprintf(painCave.errMsg,
+              "MultipassCorrFunc: OpenMD was built without FFTW3, so the\n"
+              "\tFFT correlator is not available.  Using the direct\n"
+              "\tcorrelator instead.\n");
+      painCave.isFatal = 0;
+      painCave.severity = OPENMD_WARNING;
+      simError();
+      return;
+    }
+#endif
+    correlator_ = type;
+  }
+
   template<typename T>
   void MultipassCorrFunc<T>::correlation() {
     T zeroType(0.0);
@@ -216,6 +281,17 @@ namespace OpenMD {
       count_[i] = 0;
     }
 
+    if (correlator_ == FFT_CORRELATOR) {
+      checkFrameTimes();
+      fftCorrelation();
+      return;
+    }
+    if (correlator_ == MULTIPLE_TAU_CORRELATOR) {
+      checkFrameTimes();
+      multipleTauCorrelation();
+      return;
+    }
+
     progressBar_->clear();
     RealType samples = 0.5 * (nFrames_ + 1) * nFrames_;
     int visited = 0;
@@ -295,6 +371,358 @@ namespace OpenMD {
     }
   }
   
+  /**
+   * The FFT and multiple-tau correlators index lags by frame, so the
+   * frames must be evenly spaced by the sample time.
+   */
+  template<typename T>
+  void MultipassCorrFunc<T>::checkFrameTimes() {
+    for (int i = 1; i < nFrames_; ++i) {
+      if ( fabs( (times_[i] - times_[0]) - i*deltaTime_ ) > 1.0e-4 ) {
+        sprintf(painCave.errMsg,
+                "MultipassCorrFunc::checkFrameTimes Error: sampleTime (%f)\n"
+                "\tin %s does not match actual time-spacing between\n"
+                "\tconfigurations %d (t = %f) and %d (t = %f).\n",
+                deltaTime_, dumpFilename_.c_str(), 0, times_[0], i,
+                times_[i]);
+        painCave.isFatal = 1;
+        simError();
+      }
+    }
+  }
+
+  /**
+   * Returns the sorted global indices of every object that appears
+   * in the first selection in any frame.
+   */
+  template<typename T>
+  vector<int> MultipassCorrFunc<T>::getCorrObjects() {
+    vector<int> objects;
+    for (int i = 0; i < nFrames_; ++i) {
+      objects.insert(objects.end(), sele1ToIndex_[i].begin(),
+                     sele1ToIndex_[i].end());
+    }
+    std::sort(objects.begin(), objects.end());
+    objects.erase(std::unique(objects.begin(), objects.end()),
+                  objects.end());
+    return objects;
+  }
+
+  /**
+   * Gathers the time series of the correlation terms of one object.
+   * Component k of frame t is stored at k * nFrames_ + t, and the
+   * weights wa and wb are 1 in the frames where the object belongs
+   * to the corresponding selection and 0 (with zeroed terms)
+   * elsewhere, so that with dynamic selections an object only
+   * contributes at the lags where it was selected at both ends.
+   */
+  template<typename T>
+  void MultipassCorrFunc<T>::getCorrSeries(int gid, vector<RealType>& a,
+                                           vector<RealType>& b,
+                                           vector<RealType>& wa,
+                                           vector<RealType>& wb) {
+    int d = getNCorrTerms();
+    vector<RealType> terms(d);
+    vector<int>::iterator i;
+
+    a.assign(d * nFrames_, 0.0);
+    b.assign(d * nFrames_, 0.0);
+    wa.assign(nFrames_, 0.0);
+    wb.assign(nFrames_, 0.0);
+
+    for (int t = 0; t < nFrames_; ++t) {
+      vector<int>& s1 = sele1ToIndex_[t];
+      vector<int>& s2 = uniqueSelections_ ? sele2ToIndex_[t] : s1;
+
+      i = std::lower_bound(s1.begin(), s1.end(), gid);
+      if (i != s1.end() && *i == gid) {
+        getCorrTerms1(t, i - s1.begin(), &terms[0]);
+        for (int k = 0; k < d; ++k) a[k * nFrames_ + t] = terms[k];
+        wa[t] = 1.0;
+      }
+
+      i = std::lower_bound(s2.begin(), s2.end(), gid);
+      if (i != s2.end() && *i == gid) {
+        getCorrTerms2(t, i - s2.begin(), &terms[0]);
+        for (int k = 0; k < d; ++k) b[k * nFrames_ + t] = terms[k];
+        wb[t] = 1.0;
+      }
+    }
+  }
+
+  /**
+   * Accumulates the correlation function with the Wiener-Khinchin
+   * theorem.  Each object's zero-padded term and weight series are
+   * transformed once, the cross spectra are summed over objects, and
+   * only the d*d summed spectra (and the weight spectrum that
+   * supplies the counts) are transformed back.
+   */
+  template<typename T>
+  void MultipassCorrFunc<T>::fftCorrelation() {
+#ifdef HAVE_FFTW3_H
+    int d = getNCorrTerms();
+    int d2 = d * d;
+    int nPad = 2 * nFrames_;
+    int nHat = nPad / 2 + 1;
+    bool sameSeries = autoCorrFunc_ && !uniqueSelections_;
+
+    vector<double> buffer(nPad, 0.0);
+    fftw_complex* bufferHat = (fftw_complex*) fftw_malloc(sizeof(fftw_complex)
+                                                          * nHat);
+    fftw_plan forward = fftw_plan_dft_r2c_1d(nPad, &buffer[0], bufferHat,
+                                             FFTW_ESTIMATE);
+    fftw_plan backward = fftw_plan_dft_c2r_1d(nPad, bufferHat, &buffer[0],
+                                              FFTW_ESTIMATE);
+
+    vector<double> spectra(2 * nHat * d2, 0.0);
+    vector<double> weightSpectrum(2 * nHat, 0.0);
+    vector<vector<double> > aHat(d), bHat(d);
+    vector<double> waHat, wbHat;
+    vector<RealType> a, b, wa, wb;
+
+    vector<int> objects = getCorrObjects();
+    int nObjects = objects.size();
+
+    progressBar_->clear();
+
+    for (int n = 0; n < nObjects; ++n) {
+      progressBar_->setStatus(n + 1, nObjects);
+      progressBar_->update();
+
+      getCorrSeries(objects[n], a, b, wa, wb);
+
+      for (int k = 0; k < d; ++k) {
+        transformSeries(forward, &a[k * nFrames_], nFrames_, buffer,
+                        bufferHat, aHat[k]);
+        if (!sameSeries)
+          transformSeries(forward, &b[k * nFrames_], nFrames_, buffer,
+                          bufferHat, bHat[k]);
+      }
+      transformSeries(forward, &wa[0], nFrames_, buffer, bufferHat, waHat);
+      if (!sameSeries)
+        transformSeries(forward, &wb[0], nFrames_, buffer, bufferHat, wbHat);
+
+      vector<vector<double> >& bh = sameSeries ? aHat : bHat;
+      vector<double>& wbh = sameSeries ? waHat : wbHat;
+
+      // sum_t a(t) b(t + tau) is the inverse transform of conj(A) B:
+      for (int k = 0; k < d; ++k) {
+        for (int l = 0; l < d; ++l) {
+          double* s = &spectra[2 * nHat * (k * d + l)];
+          for (int w = 0; w < nHat; ++w) {
+            double ar = aHat[k][2 * w], ai = aHat[k][2 * w + 1];
+            double br = bh[l][2 * w], bi = bh[l][2 * w + 1];
+            s[2 * w] += ar * br + ai * bi;
+            s[2 * w + 1] += ar * bi - ai * br;
+          }
+        }
+      }
+      for (int w = 0; w < nHat; ++w) {
+        double ar = waHat[2 * w], ai = waHat[2 * w + 1];
+        double br = wbh[2 * w], bi = wbh[2 * w + 1];
+        weightSpectrum[2 * w] += ar * br + ai * bi;
+        weightSpectrum[2 * w + 1] += ar * bi - ai * br;
+      }
+    }
+
+    // FFTW's transforms are unnormalized, so a round trip scales by nPad:
+    vector<RealType> sums(d2 * nFrames_);
+    for (int kl = 0; kl < d2; ++kl) {
+      for (int w = 0; w < nHat; ++w) {
+        bufferHat[w][0] = spectra[2 * nHat * kl + 2 * w];
+        bufferHat[w][1] = spectra[2 * nHat * kl + 2 * w + 1];
+      }
+      fftw_execute(backward);
+      for (int t = 0; t < nFrames_; ++t)
+        sums[kl * nFrames_ + t] = buffer[t] / nPad;
+    }
+    for (int w = 0; w < nHat; ++w) {
+      bufferHat[w][0] = weightSpectrum[2 * w];
+      bufferHat[w][1] = weightSpectrum[2 * w + 1];
+    }
+    fftw_execute(backward);
+
+    vector<RealType> products(d2);
+    for (int t = 0; t < nTimeBins_; ++t) {
+      for (int kl = 0; kl < d2; ++kl) products[kl] = sums[kl * nFrames_ + t];
+      histogram_[t] = combineCorrTerms(products);
+      count_[t] = int(buffer[t] / nPad + 0.5);
+    }
+
+    fftw_destroy_plan(forward);
+    fftw_destroy_plan(backward);
+    fftw_free(bufferHat);
+#endif
+  }
+
+  /**
+   * Accumulates the correlation function with a multiple-tau
+   * correlator.  The frames are streamed in order through a cascade
+   * of shift registers, one cascade per object, with each level
+   * holding block averages of tauAverage entries from the level
+   * below.  Only the registers and the d*d sums per resolved lag are
+   * kept, so the correlator needs O(N tauPoints log T d) storage for
+   * N objects instead of the O(N T d) series the FFT correlator
+   * gathers (the properties computed in the pre-correlate scan are
+   * still stored by the correlation function).  The work is
+   * O(N T tauPoints d^2), and the correlation is only reported at
+   * the lags the levels resolve.  Block-averaged weights let objects
+   * drift in and out of dynamic selections.
+   */
+  template<typename T>
+  void MultipassCorrFunc<T>::multipleTauCorrelation() {
+    int d = getNCorrTerms();
+    int d2 = d * d;
+    int p = tauPoints;
+    int m = tauAverage;
+
+    int nLevels = 1;
+    long long span = p - 1;
+    while (span < nFrames_ - 1) {
+      span *= m;
+      nLevels++;
+    }
+
+    vector<RealType> sums(nLevels * p * d2, 0.0);
+    vector<RealType> weights(nLevels * p, 0.0);
+    vector<int> counts(nLevels * p, 0);
+
+    vector<int> objects = getCorrObjects();
+    int nObjects = objects.size();
+    int nRegs = nLevels * p;
+
+    // Every object sees every frame (with zero weight when it is not
+    // selected), so the register positions are shared:
+    vector<int> head(nLevels, 0), nIn(nLevels, 0), nAcc(nLevels, 0);
+
+    vector<RealType> regA(nObjects * nRegs * d), regB(nObjects * nRegs * d);
+    vector<RealType> regWa(nObjects * nRegs), regWb(nObjects * nRegs);
+    vector<RealType> accA(nObjects * nLevels * d, 0.0);
+    vector<RealType> accB(nObjects * nLevels * d, 0.0);
+    vector<RealType> accWa(nObjects * nLevels, 0.0);
+    vector<RealType> accWb(nObjects * nLevels, 0.0);
+
+    vector<RealType> curA(nObjects * d), curB(nObjects * d);
+    vector<RealType> curWa(nObjects), curWb(nObjects);
+    vector<int>::iterator obj;
+
+    progressBar_->clear();
+
+    for (int t = 0; t < nFrames_; ++t) {
+      progressBar_->setStatus(t + 1, nFrames_);
+      progressBar_->update();
+
+      std::fill(curA.begin(), curA.end(), 0.0);
+      std::fill(curB.begin(), curB.end(), 0.0);
+      std::fill(curWa.begin(), curWa.end(), 0.0);
+      std::fill(curWb.begin(), curWb.end(), 0.0);
+
+      vector<int>& s1 = sele1ToIndex_[t];
+      vector<int>& s2 = uniqueSelections_ ? sele2ToIndex_[t] : s1;
+
+      for (unsigned int i = 0; i < s1.size(); ++i) {
+        obj = std::lower_bound(objects.begin(), objects.end(), s1[i]);
+        int n = obj - objects.begin();
+        getCorrTerms1(t, i, &curA[n * d]);
+        curWa[n] = 1.0;
+      }
+      for (unsigned int i = 0; i < s2.size(); ++i) {
+        obj = std::lower_bound(objects.begin(), objects.end(), s2[i]);
+        if (obj == objects.end() || *obj != s2[i]) continue;
+        int n = obj - objects.begin();
+        getCorrTerms2(t, i, &curB[n * d]);
+        curWb[n] = 1.0;
+      }
+
+      for (int level = 0; level < nLevels; ++level) {
+        int slot = (head[level] + 1) % p;
+        head[level] = slot;
+        if (nIn[level] < p) nIn[level]++;
+
+        // Shorter lags at the coarser levels are already resolved
+        // by the level below:
+        int jMin = (level == 0) ? 0 : p / m;
+        int base = level * p;
+
+        for (int n = 0; n < nObjects; ++n) {
+          int reg = n * nRegs + base;
+          RealType* ca = &curA[n * d];
+          RealType* cb = &curB[n * d];
+
+          for (int k = 0; k < d; ++k) {
+            regA[(reg + slot) * d + k] = ca[k];
+            regB[(reg + slot) * d + k] = cb[k];
+          }
+          regWa[reg + slot] = curWa[n];
+          regWb[reg + slot] = curWb[n];
+
+          for (int j = jMin; j < nIn[level]; ++j) {
+            int s = (slot - j + p) % p;
+            RealType w = regWa[reg + s] * curWb[n];
+            if (w > 0.0) {
+              weights[base + j] += w;
+              counts[base + j]++;
+              RealType* sum = &sums[(base + j) * d2];
+              for (int k = 0; k < d; ++k) {
+                RealType ak = regA[(reg + s) * d + k];
+                for (int l = 0; l < d; ++l)
+                  sum[k * d + l] += ak * cb[l];
+              }
+            }
+          }
+        }
+
+        if (level + 1 == nLevels) break;
+
+        for (int n = 0; n < nObjects; ++n) {
+          int acc = n * nLevels + level;
+          for (int k = 0; k < d; ++k) {
+            accA[acc * d + k] += curA[n * d + k];
+            accB[acc * d + k] += curB[n * d + k];
+          }
+          accWa[acc] += curWa[n];
+          accWb[acc] += curWb[n];
+        }
+        nAcc[level]++;
+        if (nAcc[level] < m) break;
+
+        for (int n = 0; n < nObjects; ++n) {
+          int acc = n * nLevels + level;
+          for (int k = 0; k < d; ++k) {
+            curA[n * d + k] = accA[acc * d + k] / m;
+            curB[n * d + k] = accB[acc * d + k] / m;
+            accA[acc * d + k] = 0.0;
+            accB[acc * d + k] = 0.0;
+          }
+          curWa[n] = accWa[acc] / m;
+          curWb[n] = accWb[acc] / m;
+          accWa[acc] = 0.0;
+          accWb[acc] = 0.0;
+        }
+        nAcc[level] = 0;
+      }
+    }
+
+    // postCorrelate divides by count_, so rescale the sums to make
+    // that division produce the weighted average:
+    vector<RealType> products(d2);
+    long long stride = 1;
+    for (int level = 0; level < nLevels; ++level) {
+      int jMin = (level == 0) ? 0 : p / m;
+      for (int j = jMin; j < p; ++j) {
+        long long lag = j * stride;
+        int base = level * p;
+        if (lag >= nTimeBins_ || counts[base + j] == 0) continue;
+        RealType scale = counts[base + j] / weights[base + j];
+        for (int kl = 0; kl < d2; ++kl)
+          products[kl] = sums[(base + j) * d2 + kl] * scale;
+        histogram_[lag] = combineCorrTerms(products);
+        count_[lag] = counts[base + j];
+      }
+      stride *= m;
+    }
+  }
+
   template<typename T>
   void MultipassCorrFunc<T>::postCorrelate() {
     T zeroType(0.0);
@@ -328,6 +756,9 @@ namespace OpenMD {
         ofs << "#time\tcorrVal\n";
 
       for (int i = 0; i < nTimeBins_; ++i) {
+        // the multiple-tau correlator only resolves some of the lags:
+        if (correlator_ == MULTIPLE_TAU_CORRELATOR && count_[i] == 0)
+          continue;
 	ofs << times_[i]-times_[0] << "\t" << histogram_[i] << "\n";
       }
 
@@ -364,6 +795,8 @@ namespace OpenMD {
         ofs << "#time\tcorrVal\n";
 
       for (int i = 0; i < nTimeBins_; ++i) {
+        if (correlator_ == MULTIPLE_TAU_CORRELATOR && count_[i] == 0)
+          continue;
         ofs << times_[i]-times_[0] << "\t";
         for (int j = 0; j < 3; j++) {
           ofs << histogram_[i](j) << '\t';        
@@ -405,6 +838,8 @@ namespace OpenMD {
         ofs << "#time\tcorrVal\n";
 
       for (int i = 0; i < nTimeBins_; ++i) {
+        if (correlator_ == MULTIPLE_TAU_CORRELATOR && count_[i] == 0)
+          continue;
         ofs << times_[i]-times_[0] << "\t";
         for (int j = 0; j < 3; j++) {
           for (int k = 0; k < 3; k++) {
@@ -83,6 +83,7 @@ namespace OpenMD {
       labelString_ = label;
     }
 
+    virtual void setCorrelator(CorrelatorType type);
     
   protected:
 
@@ -97,6 +98,34 @@ namespace OpenMD {
     virtual T calcCorrVal(int frame1, int frame2, int id1, int id2) = 0;
     virtual void writeCorrelate();
 
+    /**
+     * Correlation functions that are linear combinations of the
+     * products of the components of two properties,
+     *
+     *    C(t) = f( < a_k(0) b_l(t) > ),
+     *
+     * can also be accumulated with the FFT and multiple-tau
+     * correlators.  These functions report the number of components
+     * (d) here, return the components of a and b for a stored entry,
+     * and map the d*d sums of products (entry k*d + l) onto the
+     * correlation value.  The default of 0 components limits a
+     * function to the direct correlator.
+     */
+    virtual int getNCorrTerms() { return 0; }
+    virtual void getCorrTerms1(int frame, int id, RealType* terms) { }
+    virtual void getCorrTerms2(int frame, int id, RealType* terms) { }
+    virtual T combineCorrTerms(const std::vector<RealType>& products) {
+      return T(0.0);
+    }
+
+    void checkFrameTimes();
+    void getCorrSeries(int gid, std::vector<RealType>& a,
+                       std::vector<RealType>& b, std::vector<RealType>& wa,
+                       std::vector<RealType>& wb);
+    std::vector<int> getCorrObjects();
+    void fftCorrelation();
+    void multipleTauCorrelation();
+
     int storageLayout_;
 
     RealType deltaTime_;
@@ -122,6 +151,7 @@ namespace OpenMD {
     SelectionEvaluator evaluator1_;
     SelectionEvaluator evaluator2_;
 
+    CorrelatorType correlator_;
     bool autoCorrFunc_;
 
     std::string corrFuncType_;
@@ -145,6 +175,9 @@ namespace OpenMD {
   protected:
     virtual int computeProperty1(int frame, StuntDouble* sd) = 0;
     virtual int computeProperty2(int frame, StuntDouble* sd) { return -1; }
+    virtual void getCorrTerms2(int frame, int id, RealType* terms) {
+      this->getCorrTerms1(frame, id, terms);
+    }
   };
 
   template<typename T>
@@ -56,11 +56,12 @@ namespace OpenMD {
       selectionScript1_(sele1), selectionScript2_(sele2), 
       evaluator1_(info_), evaluator2_(info_) {
     
-    // Request maximum needed storage for the simulation (including of
-    // whatever was passed down by the individual correlation
-    // function).
+    // Only store what the individual correlation function asked for
+    // (and what the dump reader fills in along with it), so that more
+    // frames fit in each block.
 
-    storageLayout_ = info->getStorageLayout() | storageLayout;
+    storageLayout_ = BlockSnapshotManager::getRequiredLayout(info,
+                                                             storageLayout);
 
     bsMan_ = new BlockSnapshotManager(info, dumpFilename_, storageLayout_, 
                                       memSize_);
@@ -112,7 +113,21 @@ namespace OpenMD {
 
       for (int j = i; j < nblocks; ++j) {
 	bsMan_->loadBlock(j);
-	correlateBlocks(i, j);
+
+        // read the next block from disk while this pair is correlated:
+        int next = (j + 1 < nblocks) ? j + 1 : i + 1;
+#ifdef _OPENMP
+#pragma omp parallel sections num_threads(2)
+        {
+#pragma omp section
+          correlateBlocks(i, j);
+#pragma omp section
+          bsMan_->prefetchBlock(next);
+        }
+#else
+        correlateBlocks(i, j);
+        bsMan_->prefetchBlock(next);
+#endif
 	bsMan_->unloadBlock(j);
       }
         
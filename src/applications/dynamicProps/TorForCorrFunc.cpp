@@ -107,6 +107,19 @@ namespace OpenMD {
                                       int id1, int id2) {
     return outProduct( torques_[frame1][id1] , forces_[frame2][id2] );
   }
+  void TorForCorrFunc::getCorrTerms1(int frame, int id, RealType* terms) {
+    for (int k = 0; k < 3; k++) terms[k] = torques_[frame][id][k];
+  }
+  void TorForCorrFunc::getCorrTerms2(int frame, int id, RealType* terms) {
+    for (int k = 0; k < 3; k++) terms[k] = forces_[frame][id][k];
+  }
+  Mat3x3d TorForCorrFunc::combineCorrTerms(const std::vector<RealType>& products) {
+    Mat3x3d corr;
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 3; j++)
+        corr(i, j) = products[3 * i + j];
+    return corr;
+  }
 
   void TorForCorrFunc::postCorrelate() {
     //gets the average of the forces
@@ -55,6 +55,9 @@ namespace OpenMD {
     virtual void validateSelection(SelectionManager& seleMan);    
     virtual int computeProperty1(int frame, StuntDouble* sd);
     virtual Mat3x3d calcCorrVal(int frame1, int frame2, int id1, int id2);
+    virtual int getNCorrTerms() { return 3; }
+    virtual void getCorrTerms1(int frame, int id, RealType* terms);
+    virtual Mat3x3d combineCorrTerms(const std::vector<RealType>& products);
     virtual void postCorrelate();
 
     std::vector<std::vector<Vector3d> > torques_;
@@ -93,6 +93,12 @@ namespace OpenMD {
     RealType v2 = dot( velocities_[frame1][id1] , velocities_[frame2][id2]);
     return v2;
   }
+  void VCorrFunc::getCorrTerms1(int frame, int id, RealType* terms) {
+    for (int k = 0; k < 3; k++) terms[k] = velocities_[frame][id][k];
+  }
+  RealType VCorrFunc::combineCorrTerms(const std::vector<RealType>& products) {
+    return products[0] + products[4] + products[8];
+  }
 
   int VCorrFuncZ::computeProperty1(int frame, StuntDouble* sd) {
     velocities_[frame].push_back( sd->getVel().z() );
@@ -102,6 +108,12 @@ namespace OpenMD {
     RealType v2 = velocities_[frame1][id1] * velocities_[frame2][id2];
     return v2;
   }
+  void VCorrFuncZ::getCorrTerms1(int frame, int id, RealType* terms) {
+    terms[0] = velocities_[frame][id];
+  }
+  RealType VCorrFuncZ::combineCorrTerms(const std::vector<RealType>& products) {
+    return products[0];
+  }
 
   int VCorrFuncR::computeProperty1(int frame, StuntDouble* sd) {
     // get the radial vector from the frame's center of mass:
@@ -118,5 +130,11 @@ namespace OpenMD {
     v2  = velocities_[frame1][id1] * velocities_[frame2][id2];
     return v2;
   }
+  void VCorrFuncR::getCorrTerms1(int frame, int id, RealType* terms) {
+    terms[0] = velocities_[frame][id];
+  }
+  RealType VCorrFuncR::combineCorrTerms(const std::vector<RealType>& products) {
+    return products[0];
+  }
 }
 
@@ -52,6 +52,9 @@ namespace OpenMD {
   private:
     virtual int computeProperty1(int frame, StuntDouble* sd);
     virtual RealType calcCorrVal(int frame1, int frame2, int id1, int id2);
+    virtual int getNCorrTerms() { return 3; }
+    virtual void getCorrTerms1(int frame, int id, RealType* terms);
+    virtual RealType combineCorrTerms(const std::vector<RealType>& products);
     std::vector<std::vector<Vector3d> > velocities_;
   };
 
@@ -62,6 +65,9 @@ namespace OpenMD {
   private:
     virtual int computeProperty1(int frame, StuntDouble* sd);
     virtual RealType calcCorrVal(int frame1, int frame2, int id1, int id2);
+    virtual int getNCorrTerms() { return 1; }
+    virtual void getCorrTerms1(int frame, int id, RealType* terms);
+    virtual RealType combineCorrTerms(const std::vector<RealType>& products);
     std::vector<std::vector<RealType> > velocities_;
          
   };
@@ -73,6 +79,9 @@ namespace OpenMD {
   private:
     virtual int computeProperty1(int frame, StuntDouble* sd);
     virtual RealType calcCorrVal(int frame1, int frame2, int id1, int id2);
+    virtual int getNCorrTerms() { return 1; }
+    virtual void getCorrTerms1(int frame, int id, RealType* terms);
+    virtual RealType combineCorrTerms(const std::vector<RealType>& products);
     std::vector<std::vector<RealType> > velocities_;
     
   };
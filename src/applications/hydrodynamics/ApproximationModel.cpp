@@ -40,6 +40,8 @@
  * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
  */
 
+#include <algorithm>
+
 #include "applications/hydrodynamics/ApproximationModel.hpp" 
 #include "math/LU.hpp"
 #include "math/DynamicRectMatrix.hpp"
@@ -59,7 +61,8 @@ namespace OpenMD {
  * Biophysical Journal, 75(6), 3044, 1999
  */
 
-  ApproximationModel::ApproximationModel(StuntDouble* sd, SimInfo* info): HydrodynamicsModel(sd, info){    
+  ApproximationModel::ApproximationModel(StuntDouble* sd, SimInfo* info): HydrodynamicsModel(sd, info),
+                                                                          solver_(DIRECT_SOLVER), tolerance_(1.0e-8){    
   }
   
   void ApproximationModel::init() {
@@ -75,50 +78,25 @@ namespace OpenMD {
     
     HydroProp* cr = new HydroProp();
     HydroProp* cd = new HydroProp();
-    calcHydroPropsAtCR(beads_, viscosity, temperature, cr);
-    calcHydroPropsAtCD(beads_, viscosity, temperature, cd);
+    Mat3x3d Xitt;
+    Mat3x3d Xitr;
+    Mat3x3d Xirr;
+    calcResistanceAtOrigin(beads_, viscosity, Xitt, Xitr, Xirr);
+    calcHydroPropsAtCR(Xitt, Xitr, Xirr, temperature, cr);
+    calcHydroPropsAtCD(Xitt, Xitr, Xirr, viscosity, temperature, cd);
     setCR(cr);
     setCD(cd);
     return true;    
   }
   
-  bool ApproximationModel::calcHydroPropsAtCR(std::vector<BeadParam>& beads, RealType viscosity, RealType temperature, HydroProp* cr) {
+  void ApproximationModel::calcResistanceAtOrigin(std::vector<BeadParam>& beads, RealType viscosity, Mat3x3d& Xiott, Mat3x3d& Xiotr, Mat3x3d& Xiorr) {
     
     unsigned int nbeads = beads.size();
-    DynamicRectMatrix<RealType> B(3*nbeads, 3*nbeads);
-    DynamicRectMatrix<RealType> C(3*nbeads, 3*nbeads);
     Mat3x3d I;
     I(0, 0) = 1.0;
     I(1, 1) = 1.0;
     I(2, 2) = 1.0;
     
-    for (std::size_t i = 0; i < nbeads; ++i) {
-      for (std::size_t j = 0; j < nbeads; ++j) {
-        Mat3x3d Tij;
-            if (i != j ) {
-              Vector3d Rij = beads[i].pos - beads[j].pos;
-              RealType rij = Rij.length();
-              RealType rij2 = rij * rij;
-              RealType sumSigma2OverRij2 = ((beads[i].radius*beads[i].radius) + (beads[j].radius*beads[j].radius)) / rij2;                
-              Mat3x3d tmpMat;
-              tmpMat = outProduct(Rij, Rij) / rij2;
-              RealType constant = 8.0 * Constants::PI * viscosity * rij;
-	      RealType tmp1 = 1.0 + sumSigma2OverRij2/3.0;
-	      RealType tmp2 = 1.0 - sumSigma2OverRij2;
-              Tij = (tmp1 * I + tmp2 * tmpMat ) / constant;
-            }else {
-              RealType constant = 1.0 / (6.0 * Constants::PI * viscosity * beads[i].radius);
-              Tij(0, 0) = constant;
-              Tij(1, 1) = constant;
-              Tij(2, 2) = constant;
-            }
-            B.setSubMatrix(i*3, j*3, Tij);
-      }
-    }
-    
-    //invert B Matrix
-    invertMatrix(B, C);
-    
     //prepare U Matrix relative to arbitrary origin O(0.0, 0.0, 0.0)
     std::vector<Mat3x3d> U;
     for (unsigned int i = 0; i < nbeads; ++i) {
@@ -128,9 +106,9 @@ namespace OpenMD {
     }
     
     //calculate Xi matrix at arbitrary origin O
-    Mat3x3d Xiott;
-    Mat3x3d Xiorr;
-    Mat3x3d Xiotr;
+    Xiott = Mat3x3d(0.0);
+    Xiotr = Mat3x3d(0.0);
+    Xiorr = Mat3x3d(0.0);
     
     //calculate the total volume
     
@@ -138,16 +116,71 @@ namespace OpenMD {
     for (std::vector<BeadParam>::iterator iter = beads.begin(); iter != beads.end(); ++iter) {
       volume += 4.0/3.0 * Constants::PI * pow((*iter).radius,3);
     }
+
+    bool solved = false;
+    if (solver_ == CG_SOLVER) {
+      // Only the bead forces for unit translations (k = 0..2) and
+      // unit rotations (k = 3..5) of the body are needed, so the
+      // inverse of B is never formed.
+      std::vector<Vector3d> F[6];
+      solved = calcBeadForcesCG(beads, viscosity, F);
+      if (solved) {
+        for (std::size_t i = 0; i < nbeads; ++i) {
+          for (int k = 0; k < 3; k++) {
+            Vector3d UFt = U[i] * F[k][i];
+            Vector3d UFr = U[i] * F[k+3][i];
+            for (int a = 0; a < 3; a++) {
+              Xiott(a, k) += F[k][i][a];
+              Xiotr(a, k) += UFt[a];
+              // uncorrected here.  Volume correction is added below
+              Xiorr(a, k) += UFr[a];
+            }
+          }
+        }
+      }
+    }
+
+    if (!solved) {
+      DynamicRectMatrix<RealType> B(3*nbeads, 3*nbeads);
+      DynamicRectMatrix<RealType> C(3*nbeads, 3*nbeads);
+    
+      for (std::size_t i = 0; i < nbeads; ++i) {
+        for (std::size_t j = 0; j < nbeads; ++j) {
+          Mat3x3d Tij;
+          if (i != j ) {
+            Vector3d Rij = beads[i].pos - beads[j].pos;
+            RealType rij = Rij.length();
+            RealType rij2 = rij * rij;
+            RealType sumSigma2OverRij2 = ((beads[i].radius*beads[i].radius) + (beads[j].radius*beads[j].radius)) / rij2;                
+            Mat3x3d tmpMat;
+            tmpMat = outProduct(Rij, Rij) / rij2;
+            RealType constant = 8.0 * Constants::PI * viscosity * rij;
+            RealType tmp1 = 1.0 + sumSigma2OverRij2/3.0;
+            RealType tmp2 = 1.0 - sumSigma2OverRij2;
+            Tij = (tmp1 * I + tmp2 * tmpMat ) / constant;
+          }else {
+            RealType constant = 1.0 / (6.0 * Constants::PI * viscosity * beads[i].radius);
+            Tij(0, 0) = constant;
+            Tij(1, 1) = constant;
+            Tij(2, 2) = constant;
+          }
+          B.setSubMatrix(i*3, j*3, Tij);
+        }
+      }
+    
+      //invert B Matrix
+      invertMatrix(B, C);
     
-    for (std::size_t i = 0; i < nbeads; ++i) {
-      for (std::size_t j = 0; j < nbeads; ++j) {
-        Mat3x3d Cij;
-        C.getSubMatrix(i*3, j*3, Cij);
+      for (std::size_t i = 0; i < nbeads; ++i) {
+        for (std::size_t j = 0; j < nbeads; ++j) {
+          Mat3x3d Cij;
+          C.getSubMatrix(i*3, j*3, Cij);
         
-        Xiott += Cij;
-        Xiotr += U[i] * Cij;
-	// uncorrected here.  Volume correction is added after we assemble Xiorr
-        Xiorr += -U[i] * Cij * U[j]; 
+          Xiott += Cij;
+          Xiotr += U[i] * Cij;
+          // uncorrected here.  Volume correction is added after we assemble Xiorr
+          Xiorr += -U[i] * Cij * U[j]; 
+        }
       }
     }
 
@@ -157,6 +190,166 @@ namespace OpenMD {
     Xiott *= Constants::viscoConvert;
     Xiotr *= Constants::viscoConvert;
     Xiorr *= Constants::viscoConvert;
+  }
+
+  /**
+   * Applies the bead mobility matrix B to the active columns of x
+   * without storing it.  Each Rotne-Prager block T_ij is computed
+   * once and used for all of the columns, and the rows of beads are
+   * shared among the OpenMP threads.
+   */
+  void ApproximationModel::applyB(std::vector<BeadParam>& beads, RealType viscosity, std::vector<Vector3d>* x, std::vector<Vector3d>* y, bool* active) {
+    int nbeads = beads.size();
+    RealType eightPiEta = 8.0 * Constants::PI * viscosity;
+    RealType sixPiEta = 6.0 * Constants::PI * viscosity;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for (int i = 0; i < nbeads; ++i) {
+      Vector3d yi[6];
+      RealType ai2 = beads[i].radius * beads[i].radius;
+      RealType self = 1.0 / (sixPiEta * beads[i].radius);
+
+      for (int k = 0; k < 6; k++) {
+        if (active[k]) yi[k] = self * x[k][i];
+      }
+
+      for (int j = 0; j < nbeads; ++j) {
+        if (j == i) continue;
+        Vector3d Rij = beads[i].pos - beads[j].pos;
+        RealType rij2 = Rij.lengthSquare();
+        RealType rij = sqrt(rij2);
+        RealType sumSigma2OverRij2 = (ai2 + beads[j].radius*beads[j].radius) / rij2;
+        RealType constant = eightPiEta * rij;
+        // T_ij x = (tmp1 x + tmp2 Rij (Rij . x)) 
+        RealType tmp1 = (1.0 + sumSigma2OverRij2/3.0) / constant;
+        RealType tmp2 = (1.0 - sumSigma2OverRij2) / (constant * rij2);
+
+        for (int k = 0; k < 6; k++) {
+          if (active[k])
+            yi[k] += tmp1 * x[k][j] + (tmp2 * dot(Rij, x[k][j])) * Rij;
+        }
+      }
+
+      for (int k = 0; k < 6; k++) {
+        if (active[k]) y[k][i] = yi[k];
+      }
+    }
+  }
+
+  /**
+   * Solves B F = V for the bead forces F of the six rigid body
+   * motions (unit translations along, and unit rotations about, the
+   * axes) with a Jacobi-preconditioned conjugate gradient method.
+   * The six systems share the matrix-free products with B, so the
+   * memory needed is O(N) rather than the O(N^2) of the direct
+   * inversion.  Returns false if B turns out not to be positive
+   * definite (e.g. for strongly overlapping beads).
+   */
+  bool ApproximationModel::calcBeadForcesCG(std::vector<BeadParam>& beads, RealType viscosity, std::vector<Vector3d> F[6]) {
+    int nbeads = beads.size();
+    int maxIterations = std::min(3 * nbeads, 10000);
+    RealType sixPiEta = 6.0 * Constants::PI * viscosity;
+    std::vector<Vector3d> r[6], z[6], p[6], q[6];
+    RealType bnorm[6], rz[6], rnorm;
+    bool active[6];
+    int nActive, iter;
+
+    // the right hand sides are the bead velocities: e_k for the
+    // translations, and e_k x pos = -U e_k for the rotations.  The
+    // free-draining forces are the starting guess.
+    for (int k = 0; k < 6; k++) {
+      F[k].resize(nbeads);
+      r[k].resize(nbeads);
+      z[k].resize(nbeads);
+      p[k].resize(nbeads);
+      q[k].resize(nbeads);
+      bnorm[k] = 0.0;
+      for (int i = 0; i < nbeads; i++) {
+        Vector3d e(0.0);
+        e[k % 3] = 1.0;
+        r[k][i] = (k < 3) ? e : cross(e, beads[i].pos);
+        bnorm[k] += r[k][i].lengthSquare();
+        F[k][i] = (sixPiEta * beads[i].radius) * r[k][i];
+      }
+      bnorm[k] = sqrt(bnorm[k]);
+      active[k] = true;
+    }
+
+    applyB(beads, viscosity, F, q, active);
+    for (int k = 0; k < 6; k++) 
+      for (int i = 0; i < nbeads; i++) 
+        r[k][i] -= q[k][i];
+
+    for (iter = 0; iter < maxIterations; iter++) {
+      nActive = 0;
+      for (int k = 0; k < 6; k++) {
+        if (!active[k]) continue;
+        rnorm = 0.0;
+        for (int i = 0; i < nbeads; i++) rnorm += r[k][i].lengthSquare();
+        // a zero right hand side (rotation of a single bead at the
+        // origin) is converged from the start:
+        if (sqrt(rnorm) <= tolerance_ * bnorm[k]) {
+          active[k] = false;
+          continue;
+        }
+        nActive++;
+
+        RealType rzNew = 0.0;
+        for (int i = 0; i < nbeads; i++) {
+          z[k][i] = (sixPiEta * beads[i].radius) * r[k][i];
+          rzNew += dot(r[k][i], z[k][i]);
+        }
+        if (iter == 0) {
+          p[k] = z[k];
+        } else {
+          RealType beta = rzNew / rz[k];
+          for (int i = 0; i < nbeads; i++) p[k][i] = z[k][i] + beta * p[k][i];
+        }
+        rz[k] = rzNew;
+      }
+      if (nActive == 0) break;
+
+      applyB(beads, viscosity, p, q, active);
+
+      for (int k = 0; k < 6; k++) {
+        if (!active[k]) continue;
+        RealType pq = 0.0;
+        for (int i = 0; i < nbeads; i++) pq += dot(p[k][i], q[k][i]);
+        if (pq <= 0.0) {
+          sprintf(painCave.errMsg,
+                  "ApproximationModel: the bead mobility matrix is not positive\n"
+                  "\tdefinite, so the cg solver can't be used.  Falling back to\n"
+                  "\tthe direct solver.\n");
+          painCave.isFatal = 0;
+          painCave.severity = OPENMD_WARNING;
+          simError();
+          return false;
+        }
+        RealType alpha = rz[k] / pq;
+        for (int i = 0; i < nbeads; i++) {
+          F[k][i] += alpha * p[k][i];
+          r[k][i] -= alpha * q[k][i];
+        }
+      }
+    }
+
+    if (iter == maxIterations) {
+      sprintf(painCave.errMsg,
+              "ApproximationModel: the cg solver did not reach a relative\n"
+              "\tresidual of %g in %d iterations.\n", tolerance_, maxIterations);
+      painCave.isFatal = 0;
+      painCave.severity = OPENMD_WARNING;
+      simError();
+    } else {
+      std::cout << "cg solver converged in " << iter << " iterations" << std::endl;
+    }
+
+    return true;
+  }
+  
+  bool ApproximationModel::calcHydroPropsAtCR(const Mat3x3d& Xiott, const Mat3x3d& Xiotr, const Mat3x3d& Xiorr, RealType temperature, HydroProp* cr) {
     
     Mat3x3d tmp;
     Mat3x3d tmpInv;
@@ -255,80 +448,7 @@ namespace OpenMD {
     return true;
 }
   
-  bool ApproximationModel::calcHydroPropsAtCD(std::vector<BeadParam>& beads, RealType viscosity, RealType temperature, HydroProp* cd) {
-    
-    unsigned int nbeads = beads.size();
-    DynamicRectMatrix<RealType> B(3*nbeads, 3*nbeads);
-    DynamicRectMatrix<RealType> C(3*nbeads, 3*nbeads);
-    Mat3x3d I;
-    I(0, 0) = 1.0;
-    I(1, 1) = 1.0;
-    I(2, 2) = 1.0;
-    
-    for (std::size_t i = 0; i < nbeads; ++i) {
-      for (std::size_t j = 0; j < nbeads; ++j) {
-        Mat3x3d Tij;
-        if (i != j ) {
-          Vector3d Rij = beads[i].pos - beads[j].pos;
-          RealType rij = Rij.length();
-          RealType rij2 = rij * rij;
-          RealType sumSigma2OverRij2 = ((beads[i].radius*beads[i].radius) + (beads[j].radius*beads[j].radius)) / rij2;                
-          Mat3x3d tmpMat;
-          tmpMat = outProduct(Rij, Rij) / rij2;
-          RealType constant = 8.0 * Constants::PI * viscosity * rij;
-          RealType tmp1 = 1.0 + sumSigma2OverRij2/3.0;
-	  RealType tmp2 = 1.0 - sumSigma2OverRij2;
-	  Tij = (tmp1 * I + tmp2 * tmpMat ) / constant;
-        }else {
-          RealType constant = 1.0 / (6.0 * Constants::PI * viscosity * beads[i].radius);
-          Tij(0, 0) = constant;
-          Tij(1, 1) = constant;
-          Tij(2, 2) = constant;
-        }
-        B.setSubMatrix(i*3, j*3, Tij);
-      }
-    }
-    
-    //invert B Matrix
-    invertMatrix(B, C);
-    
-    //prepare U Matrix relative to arbitrary origin O(0.0, 0.0, 0.0)
-    std::vector<Mat3x3d> U;
-    for (unsigned int i = 0; i < nbeads; ++i) {
-      Mat3x3d currU;
-      currU.setupSkewMat(beads[i].pos);
-      U.push_back(currU);
-    }
-    
-    //calculate Xi matrix at arbitrary origin O
-    Mat3x3d Xitt;
-    Mat3x3d Xirr;
-    Mat3x3d Xitr;
-
-    //calculate the total volume
-
-    RealType volume = 0.0;
-    for (std::vector<BeadParam>::iterator iter = beads.begin(); iter != beads.end(); ++iter) {
-      volume += 4.0/3.0 * Constants::PI * pow((*iter).radius,3);
-    }
-    
-    for (std::size_t i = 0; i < nbeads; ++i) {
-      for (std::size_t j = 0; j < nbeads; ++j) {
-        Mat3x3d Cij;
-        C.getSubMatrix(i*3, j*3, Cij);
-            
-        Xitt += Cij;
-        Xitr += U[i] * Cij;
-	// uncorrected here.  Volume correction is added after we assemble Xiorr
-        Xirr += -U[i] * Cij * U[j];
-      }
-    }
-    // add the volume correction here:
-    Xirr += (RealType(6.0) * viscosity * volume) * I;    
-    
-    Xitt *= Constants::viscoConvert;
-    Xitr *= Constants::viscoConvert;
-    Xirr *= Constants::viscoConvert;
+  bool ApproximationModel::calcHydroPropsAtCD(const Mat3x3d& Xitt, const Mat3x3d& Xitr, const Mat3x3d& Xirr, RealType viscosity, RealType temperature, HydroProp* cd) {
     
     RealType kt = Constants::kb * temperature; // in kcal mol^-1
     
@@ -51,6 +51,12 @@
 #include "applications/hydrodynamics/HydrodynamicsModel.hpp"
 namespace OpenMD {
 
+  /** Methods for solving the bead friction equations */
+  enum BeadSolverType {
+    DIRECT_SOLVER,   /**< invert the full 3N x 3N B matrix */
+    CG_SOLVER        /**< matrix-free preconditioned conjugate gradient */
+  };
+
   class Shape;
   class ApproximationModel :  public HydrodynamicsModel {
   public:
@@ -59,12 +65,33 @@ namespace OpenMD {
     virtual bool calcHydroProps(Shape* shape, RealType viscosity, RealType temperature);
     virtual void init();
     virtual void writeBeads(std::ostream& os);
+
+    /**
+     * Selects how the bead friction equations are solved.  The
+     * tolerance is the relative residual at which the iterative
+     * solver stops.
+     */
+    void setSolver(BeadSolverType solver, RealType tolerance) {
+      solver_ = solver;
+      tolerance_ = tolerance;
+    }
   private:
     virtual bool createBeads(std::vector<BeadParam>& beads) = 0;
+
+    /**
+     * Computes the translational, coupling, and rotational blocks of
+     * the resistance tensor about the origin (with the volume
+     * correction applied, and in OpenMD units).
+     */
+    void calcResistanceAtOrigin(std::vector<BeadParam>& beads, RealType viscosity, Mat3x3d& Xitt, Mat3x3d& Xitr, Mat3x3d& Xirr);
+    bool calcBeadForcesCG(std::vector<BeadParam>& beads, RealType viscosity, std::vector<Vector3d> F[6]);
+    void applyB(std::vector<BeadParam>& beads, RealType viscosity, std::vector<Vector3d>* x, std::vector<Vector3d>* y, bool* active);
     
-    bool calcHydroPropsAtCR(std::vector<BeadParam>& beads, RealType viscosity, RealType temperature, HydroProp* cr);
-    bool calcHydroPropsAtCD(std::vector<BeadParam>& beads, RealType viscosity, RealType temperature, HydroProp* cd);
+    bool calcHydroPropsAtCR(const Mat3x3d& Xiott, const Mat3x3d& Xiotr, const Mat3x3d& Xiorr, RealType temperature, HydroProp* cr);
+    bool calcHydroPropsAtCD(const Mat3x3d& Xitt, const Mat3x3d& Xitr, const Mat3x3d& Xirr, RealType viscosity, RealType temperature, HydroProp* cd);
     std::vector<BeadParam> beads_;
+    BeadSolverType solver_;
+    RealType tolerance_;
 };
   
 
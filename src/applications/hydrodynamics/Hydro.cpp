@@ -49,6 +49,7 @@
 #include "applications/hydrodynamics/HydrodynamicsModelCreator.hpp"
 #include "applications/hydrodynamics/HydrodynamicsModelFactory.hpp"
 #include "applications/hydrodynamics/AnalyticalModel.hpp"
+#include "applications/hydrodynamics/ApproximationModel.hpp"
 #include "applications/hydrodynamics/BeadModel.hpp"
 #include "applications/hydrodynamics/RoughShell.hpp"
 #include "applications/hydrodynamics/ShapeBuilder.hpp"
@@ -171,6 +172,12 @@ int main(int argc, char* argv[]){
       model = new BeadModel(sd, info);
     }
     
+    // bead models can be solved iteratively instead of by inversion:
+    ApproximationModel* beadModel = dynamic_cast<ApproximationModel*>(model);
+    if (beadModel != NULL && args_info.solver_arg == solver_arg_cg) {
+      beadModel->setSolver(CG_SOLVER, args_info.tolerance_arg);
+    }
+
     model->init();
     
     std::ofstream ofs;
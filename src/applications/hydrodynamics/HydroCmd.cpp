@@ -39,12 +39,16 @@ const char *gengetopt_args_info_help[] = {
   "  -o, --output=STRING   output file prefix  (default=`hydro')",
   "      --model=STRING    hydrodynamics model (supports RoughShell and BeadModel)\n                          (mandatory)",
   "  -b, --beads           generate the beads only, hydrodynamics will be\n                          performed  (default=off)",
+  "      --solver=ENUM     method for solving the bead friction equations\n                          (possible values=\"direct\", \"cg\"\n                          default=`direct')",
+  "      --tolerance=DOUBLE  relative residual tolerance for the cg solver\n                          (default=`1e-8')",
     0
 };
 
 typedef enum {ARG_NO
   , ARG_FLAG
   , ARG_STRING
+  , ARG_DOUBLE
+  , ARG_ENUM
 } cmdline_parser_arg_type;
 
 static
@@ -83,6 +87,8 @@ free_cmd_list(void)
 }
 
 
+const char *cmdline_parser_solver_values[] = {"direct", "cg", 0}; /*< Possible values for solver. */
+
 static char *
 gengetopt_strdup (const char *s);
 
@@ -95,6 +101,8 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->output_given = 0 ;
   args_info->model_given = 0 ;
   args_info->beads_given = 0 ;
+  args_info->solver_given = 0 ;
+  args_info->tolerance_given = 0 ;
 }
 
 static
@@ -108,6 +116,10 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->model_arg = NULL;
   args_info->model_orig = NULL;
   args_info->beads_flag = 0;
+  args_info->solver_arg = solver_arg_direct;
+  args_info->solver_orig = NULL;
+  args_info->tolerance_arg = 1e-8;
+  args_info->tolerance_orig = NULL;
   
 }
 
@@ -122,6 +134,8 @@ void init_args_info(struct gengetopt_args_info *args_info)
   args_info->output_help = gengetopt_args_info_help[3] ;
   args_info->model_help = gengetopt_args_info_help[4] ;
   args_info->beads_help = gengetopt_args_info_help[5] ;
+  args_info->solver_help = gengetopt_args_info_help[6] ;
+  args_info->tolerance_help = gengetopt_args_info_help[7] ;
   
 }
 
@@ -214,6 +228,8 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
   free_string_field (&(args_info->output_orig));
   free_string_field (&(args_info->model_arg));
   free_string_field (&(args_info->model_orig));
+  free_string_field (&(args_info->solver_orig));
+  free_string_field (&(args_info->tolerance_orig));
   
   
   for (i = 0; i < args_info->inputs_num; ++i)
@@ -226,12 +242,54 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
 }
 
 
+/**
+ * @param val the value to check
+ * @param values the possible values
+ * @return the index of the matched value:
+ * -1 if no value matched,
+ * -2 if more than one value has matched
+ */
+static int
+check_possible_values(const char *val, const char *values[])
+{
+  int i, found, last;
+  size_t len;
+
+  if (!val)   /* otherwise strlen() crashes below */
+    return -1; /* -1 means no argument for the option */
+
+  found = last = 0;
+
+  for (i = 0, len = strlen(val); values[i]; ++i)
+    {
+      if (strncmp(val, values[i], len) == 0)
+        {
+          ++found;
+          last = i;
+          if (strlen(values[i]) == len)
+            return i; /* exact macth no need to check more */
+        }
+    }
+
+  if (found == 1) /* one match: OK */
+    return last;
+
+  return (found ? -2 : -1); /* return many values or none matched */
+}
+
+
 static void
 write_into_file(FILE *outfile, const char *opt, const char *arg, const char *values[])
 {
-  FIX_UNUSED (values);
+  int found = -1;
   if (arg) {
-    fprintf(outfile, "%s=\"%s\"\n", opt, arg);
+    if (values) {
+      found = check_possible_values(arg, values);      
+    }
+    if (found >= 0)
+      fprintf(outfile, "%s=\"%s\" # %s\n", opt, arg, values[found]);
+    else
+      fprintf(outfile, "%s=\"%s\"\n", opt, arg);
   } else {
     fprintf(outfile, "%s\n", opt);
   }
@@ -261,6 +319,10 @@ cmdline_parser_dump(FILE *outfile, struct gengetopt_args_info *args_info)
     write_into_file(outfile, "model", args_info->model_orig, 0);
   if (args_info->beads_given)
     write_into_file(outfile, "beads", 0, 0 );
+  if (args_info->solver_given)
+    write_into_file(outfile, "solver", args_info->solver_orig, cmdline_parser_solver_values);
+  if (args_info->tolerance_given)
+    write_into_file(outfile, "tolerance", args_info->tolerance_orig, 0);
   
 
   i = EXIT_SUCCESS;
@@ -1006,8 +1068,8 @@ int update_arg(void *field, char **orig_field,
   int found;
   char **string_field;
   FIX_UNUSED (field);
-  FIX_UNUSED (stop_char);
 
+  stop_char = 0;
   found = 0;
 
   if (!multiple_option && prev_given && (*prev_given || (check_ambiguity && *field_given)))
@@ -1023,7 +1085,18 @@ int update_arg(void *field, char **orig_field,
       return 1; /* failure */
     }
 
-  FIX_UNUSED (default_value);
+  if (possible_values && (found = check_possible_values((value ? value : default_value), possible_values)) < 0)
+    {
+      if (short_opt != '-')
+        fprintf (stderr, "%s: %s argument, \"%s\", for option `--%s' (`-%c')%s\n", 
+          package_name, (found == -2) ? "ambiguous" : "invalid", value, long_opt, short_opt,
+          (additional_error ? additional_error : ""));
+      else
+        fprintf (stderr, "%s: %s argument, \"%s\", for option `--%s'%s\n", 
+          package_name, (found == -2) ? "ambiguous" : "invalid", value, long_opt,
+          (additional_error ? additional_error : ""));
+      return 1; /* failure */
+    }
     
   if (field_given && *field_given && ! override)
     return 0;
@@ -1038,6 +1111,12 @@ int update_arg(void *field, char **orig_field,
   case ARG_FLAG:
     *((int *)field) = !*((int *)field);
     break;
+  case ARG_DOUBLE:
+    if (val) *((double *)field) = strtod (val, &stop_char);
+    break;
+  case ARG_ENUM:
+    if (val) *((int *)field) = found;
+    break;
   case ARG_STRING:
     if (val) {
       string_field = (char **)field;
@@ -1050,6 +1129,18 @@ int update_arg(void *field, char **orig_field,
     break;
   };
 
+  /* check numeric conversion */
+  switch(arg_type) {
+  case ARG_DOUBLE:
+    if (val && !(stop_char && *stop_char == '\0')) {
+      fprintf(stderr, "%s: invalid numeric value: %s\n", package_name, val);
+      return 1; /* failure */
+    }
+    break;
+  default:
+    ;
+  };
+
 
   /* store the original value */
   switch(arg_type) {
@@ -1120,6 +1211,8 @@ cmdline_parser_internal (
         { "output",	1, NULL, 'o' },
         { "model",	1, NULL, 0 },
         { "beads",	0, NULL, 'b' },
+        { "solver",	1, NULL, 0 },
+        { "tolerance",	1, NULL, 0 },
         { 0,  0, 0, 0 }
       };
 
@@ -1198,6 +1291,34 @@ cmdline_parser_internal (
                 additional_error))
               goto failure;
           
+          }
+          /* method for solving the bead friction equations.  */
+          else if (strcmp (long_options[option_index].name, "solver") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->solver_arg), 
+                 &(args_info->solver_orig), &(args_info->solver_given),
+                &(local_args_info.solver_given), optarg, cmdline_parser_solver_values, "direct", ARG_ENUM,
+                check_ambiguity, override, 0, 0,
+                "solver", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* relative residual tolerance for the cg solver.  */
+          else if (strcmp (long_options[option_index].name, "tolerance") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->tolerance_arg), 
+                 &(args_info->tolerance_orig), &(args_info->tolerance_given),
+                &(local_args_info.tolerance_given), optarg, 0, "1e-8", ARG_DOUBLE,
+                check_ambiguity, override, 0, 0,
+                "tolerance", '-',
+                additional_error))
+              goto failure;
+          
           }
           
           break;
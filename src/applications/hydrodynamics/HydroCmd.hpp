@@ -34,6 +34,8 @@ extern "C" {
 #define CMDLINE_PARSER_VERSION ""
 #endif
 
+enum enum_solver { solver__NULL = -1, solver_arg_direct = 0, solver_arg_cg };
+
 /** @brief Where the command line options are stored */
 struct gengetopt_args_info
 {
@@ -50,6 +52,12 @@ struct gengetopt_args_info
   const char *model_help; /**< @brief hydrodynamics model (supports RoughShell and BeadModel) help description.  */
   int beads_flag;	/**< @brief generate the beads only, hydrodynamics will be performed (default=off).  */
   const char *beads_help; /**< @brief generate the beads only, hydrodynamics will be performed help description.  */
+  enum enum_solver solver_arg;	/**< @brief method for solving the bead friction equations (default='direct').  */
+  char * solver_orig;	/**< @brief method for solving the bead friction equations original value given at command line.  */
+  const char *solver_help; /**< @brief method for solving the bead friction equations help description.  */
+  double tolerance_arg;	/**< @brief relative residual tolerance for the cg solver (default='1e-8').  */
+  char * tolerance_orig;	/**< @brief relative residual tolerance for the cg solver original value given at command line.  */
+  const char *tolerance_help; /**< @brief relative residual tolerance for the cg solver help description.  */
   
   unsigned int help_given ;	/**< @brief Whether help was given.  */
   unsigned int version_given ;	/**< @brief Whether version was given.  */
@@ -57,6 +65,8 @@ struct gengetopt_args_info
   unsigned int output_given ;	/**< @brief Whether output was given.  */
   unsigned int model_given ;	/**< @brief Whether model was given.  */
   unsigned int beads_given ;	/**< @brief Whether beads was given.  */
+  unsigned int solver_given ;	/**< @brief Whether solver was given.  */
+  unsigned int tolerance_given ;	/**< @brief Whether tolerance was given.  */
 
   char **inputs ; /**< @brief unamed options (options without names) */
   unsigned inputs_num ; /**< @brief unamed options number */
@@ -208,6 +218,8 @@ int cmdline_parser_config_file (const char *filename,
 int cmdline_parser_required (struct gengetopt_args_info *args_info,
   const char *prog_name);
 
+extern const char *cmdline_parser_solver_values[];  /**< @brief Possible values for solver. */
+
 
 #ifdef __cplusplus
 }
@@ -73,7 +73,14 @@ int main(int argc, char* argv[]){
   // first things first, all of the initializations
 
 #ifdef IS_MPI
+#ifdef _OPENMP
+  // only the master thread makes MPI calls; the other threads just
+  // share the non-bonded pair loop.
+  int threadSupport;
+  MPI_Init_thread( &argc, &argv, MPI_THREAD_FUNNELED, &threadSupport );
+#else
   MPI_Init( &argc, &argv ); // the MPI communicators
+#endif
 #endif
    
   initSimError();           // the error handler
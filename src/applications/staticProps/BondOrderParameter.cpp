@@ -143,7 +143,7 @@ namespace OpenMD {
   }
   
   void BondOrderParameter::initializeHistogram() {
-    for (int bin = 0; bin < nBins_; bin++) {
+    for (unsigned int bin = 0; bin < nBins_; bin++) {
       for (int l = 0; l <= lMax_; l++) {
         Q_histogram_[std::make_pair(bin,l)] = 0;
         W_histogram_[std::make_pair(bin,l)] = 0;
@@ -152,153 +152,26 @@ namespace OpenMD {
   }
 
   void BondOrderParameter::process() {
-    Molecule* mol;
-    Atom* atom;
-    int myIndex;
-    SimInfo::MoleculeIterator mi;
-    Molecule::AtomIterator ai;
-    StuntDouble* sd;
-    Vector3d vec;
-    RealType costheta;
-    RealType phi;
-    RealType r;
-    std::map<std::pair<int,int>,ComplexType> q;
-    std::vector<RealType> q_l;
-    std::vector<RealType> q2;
-    std::vector<ComplexType> w;
-    std::vector<ComplexType> w_hat;
-    std::map<std::pair<int,int>,ComplexType> QBar;
     std::vector<RealType> Q2;
     std::vector<RealType> Q;
     std::vector<ComplexType> W;
     std::vector<ComplexType> W_hat;
-    int nBonds, Nbonds;
-    SphericalHarmonic sphericalHarmonic;
-    int i;
-    bool usePeriodicBoundaryConditions_ = info_->getSimParams()->getUsePeriodicBoundaryConditions();
 
-    DumpReader reader(info_, dumpFilename_);    
-    int nFrames = reader.getNFrames();
     frameCounter_ = 0;
-
-    q_l.resize(lMax_+1);
-    q2.resize(lMax_+1);
-    w.resize(lMax_+1);
-    w_hat.resize(lMax_+1);
+    Nbonds_ = 0;
+    QBar_.clear();
 
     Q2.resize(lMax_+1);
     Q.resize(lMax_+1);
     W.resize(lMax_+1);
     W_hat.resize(lMax_+1);
-    Nbonds = 0;
-
-    for (int istep = 0; istep < nFrames; istep += step_) {
-      reader.readFrame(istep);
-      frameCounter_++;
-      currentSnapshot_ = info_->getSnapshotManager()->getCurrentSnapshot();
-      
-      if (evaluator_.isDynamic()) {
-        seleMan_.setSelectionSet(evaluator_.evaluate());
-      }
-            
-      // outer loop is over the selected StuntDoubles:
-
-      for (sd = seleMan_.beginSelected(i); sd != NULL; 
-           sd = seleMan_.nextSelected(i)) {
-
-        myIndex = sd->getGlobalIndex();
-        nBonds = 0;
-        
-        for (int l = 0; l <= lMax_; l++) {
-          for (int m = -l; m <= l; m++) {
-            q[std::make_pair(l,m)] = 0.0;
-          }
-        }
-        
-        // inner loop is over all other atoms in the system:
-        
-        for (mol = info_->beginMolecule(mi); mol != NULL; 
-             mol = info_->nextMolecule(mi)) {
-          for (atom = mol->beginAtom(ai); atom != NULL; 
-               atom = mol->nextAtom(ai)) {
-
-            if (atom->getGlobalIndex() != myIndex) {
-
-              vec = sd->getPos() - atom->getPos();       
-
-              if (usePeriodicBoundaryConditions_) 
-                currentSnapshot_->wrapVector(vec);
-              
-              // Calculate "bonds" and build Q_lm(r) where 
-              //      Q_lm = Y_lm(theta(r),phi(r))                
-              // The spherical harmonics are wrt any arbitrary coordinate
-              // system, we choose standard spherical coordinates 
-              
-              r = vec.length();
-              
-              // Check to see if neighbor is in bond cutoff 
-              
-              if (r < rCut_) { 
-                costheta = vec.z() / r; 
-                phi = atan2(vec.y(), vec.x());
-
-                for (int l = 0; l <= lMax_; l++) {
-                  sphericalHarmonic.setL(l);
-                  for(int m = -l; m <= l; m++){
-                    sphericalHarmonic.setM(m);
-                    q[std::make_pair(l,m)] += sphericalHarmonic.getValueAt(costheta, phi);
-
-                  }
-                }
-                nBonds++;
-              }  
-            }
-          }
-        }
-        
-        
-        for (int l = 0; l <= lMax_; l++) {
-          q2[l] = 0.0;
-          for (int m = -l; m <= l; m++){
-            q[std::make_pair(l,m)] /= (RealType)nBonds; 
 
-            q2[l] += norm(q[std::make_pair(l,m)]);
-          }
-          q_l[l] = sqrt(q2[l] * 4.0 * Constants::PI / (RealType)(2*l + 1));
-        }
-        
-        // Find Third Order Invariant W_l
-    
-        for (int l = 0; l <= lMax_; l++) {
-          w[l] = 0.0;
-          for (int m1 = -l; m1 <= l; m1++) {
-            std::pair<int,int> lm = std::make_pair(l, m1);
-            for (int mmm = 0; mmm <= (m2Max[lm] - m2Min[lm]); mmm++) {
-              int m2 = m2Min[lm] + mmm;
-              int m3 = -m1-m2;
-              w[l] += w3j[lm][mmm] * q[lm] * 
-                q[std::make_pair(l,m2)] *  q[std::make_pair(l,m3)];
-            }
-          }
-          
-          w_hat[l] = w[l] / pow(q2[l], RealType(1.5));
-        }
+    processFrames();
 
-        collectHistogram(q_l, w_hat);
-        
-        Nbonds += nBonds;
-        for (int l = 0; l <= lMax_;  l++) {
-          for (int m = -l; m <= l; m++) {
-            QBar[std::make_pair(l,m)] += (RealType)nBonds*q[std::make_pair(l,m)];
-          }
-        }
-      }
-    }
-      
     // Normalize Qbar2
     for (int l = 0; l <= lMax_; l++) {
       for (int m = -l; m <= l; m++){
-        QBar[std::make_pair(l,m)] /= Nbonds;
+        QBar_[std::make_pair(l,m)] /= Nbonds_;
       }
     }
     
@@ -307,7 +180,7 @@ namespace OpenMD {
     for (int l = 0; l <= lMax_; l++) {
       Q2[l] = 0.0;
       for (int m = -l; m <= l; m++){
-        Q2[l] += norm(QBar[std::make_pair(l,m)]);
+        Q2[l] += norm(QBar_[std::make_pair(l,m)]);
       }
       Q[l] = sqrt(Q2[l] * 4.0 * Constants::PI / (RealType)(2*l + 1));
     }
@@ -321,8 +194,8 @@ namespace OpenMD {
         for (int mmm = 0; mmm <= (m2Max[lm] - m2Min[lm]); mmm++) {
           int m2 = m2Min[lm] + mmm;
           int m3 = -m1-m2;
-          W[l] += w3j[lm][mmm] * QBar[lm] * 
-            QBar[std::make_pair(l,m2)] * QBar[std::make_pair(l,m3)];
+          W[l] += w3j[lm][mmm] * QBar_[lm] * 
+            QBar_[std::make_pair(l,m2)] * QBar_[std::make_pair(l,m3)];
         }
       }
       
@@ -332,6 +205,157 @@ namespace OpenMD {
     writeOrderParameter(Q, W_hat);    
   }
 
+  void BondOrderParameter::processFrame(int istep) {
+    Molecule* mol;
+    Atom* atom;
+    int myIndex;
+    SimInfo::MoleculeIterator mi;
+    Molecule::AtomIterator ai;
+    StuntDouble* sd;
+    Vector3d vec;
+    RealType costheta;
+    RealType phi;
+    RealType r;
+    std::map<std::pair<int,int>,ComplexType> q;
+    std::vector<RealType> q_l;
+    std::vector<RealType> q2;
+    std::vector<ComplexType> w;
+    std::vector<ComplexType> w_hat;
+    int nBonds;
+    SphericalHarmonic sphericalHarmonic;
+    int i;
+    bool usePeriodicBoundaryConditions_ = info_->getSimParams()->getUsePeriodicBoundaryConditions();
+
+    q_l.resize(lMax_+1);
+    q2.resize(lMax_+1);
+    w.resize(lMax_+1);
+    w_hat.resize(lMax_+1);
+
+    frameCounter_++;
+    currentSnapshot_ = info_->getSnapshotManager()->getCurrentSnapshot();
+    
+    if (evaluator_.isDynamic()) {
+      seleMan_.setSelectionSet(evaluator_.evaluate());
+    }
+          
+    // outer loop is over the selected StuntDoubles:
+
+    for (sd = seleMan_.beginSelected(i); sd != NULL; 
+         sd = seleMan_.nextSelected(i)) {
+
+      myIndex = sd->getGlobalIndex();
+      nBonds = 0;
+      
+      for (int l = 0; l <= lMax_; l++) {
+        for (int m = -l; m <= l; m++) {
+          q[std::make_pair(l,m)] = 0.0;
+        }
+      }
+      
+      // inner loop is over all other atoms in the system:
+      
+      for (mol = info_->beginMolecule(mi); mol != NULL; 
+           mol = info_->nextMolecule(mi)) {
+        for (atom = mol->beginAtom(ai); atom != NULL; 
+             atom = mol->nextAtom(ai)) {
+
+          if (atom->getGlobalIndex() != myIndex) {
+
+            vec = sd->getPos() - atom->getPos();       
+
+            if (usePeriodicBoundaryConditions_) 
+              currentSnapshot_->wrapVector(vec);
+            
+            // Calculate "bonds" and build Q_lm(r) where 
+            //      Q_lm = Y_lm(theta(r),phi(r))                
+            // The spherical harmonics are wrt any arbitrary coordinate
+            // system, we choose standard spherical coordinates 
+            
+            r = vec.length();
+            
+            // Check to see if neighbor is in bond cutoff 
+            
+            if (r < rCut_) { 
+              costheta = vec.z() / r; 
+              phi = atan2(vec.y(), vec.x());
+
+              for (int l = 0; l <= lMax_; l++) {
+                sphericalHarmonic.setL(l);
+                for(int m = -l; m <= l; m++){
+                  sphericalHarmonic.setM(m);
+                  q[std::make_pair(l,m)] += sphericalHarmonic.getValueAt(costheta, phi);
+
+                }
+              }
+              nBonds++;
+            }  
+          }
+        }
+      }
+      
+      
+      for (int l = 0; l <= lMax_; l++) {
+        q2[l] = 0.0;
+        for (int m = -l; m <= l; m++){
+          q[std::make_pair(l,m)] /= (RealType)nBonds; 
+
+          q2[l] += norm(q[std::make_pair(l,m)]);
+        }
+        q_l[l] = sqrt(q2[l] * 4.0 * Constants::PI / (RealType)(2*l + 1));
+      }
+      
+      // Find Third Order Invariant W_l
+  
+      for (int l = 0; l <= lMax_; l++) {
+        w[l] = 0.0;
+        for (int m1 = -l; m1 <= l; m1++) {
+          std::pair<int,int> lm = std::make_pair(l, m1);
+          for (int mmm = 0; mmm <= (m2Max[lm] - m2Min[lm]); mmm++) {
+            int m2 = m2Min[lm] + mmm;
+            int m3 = -m1-m2;
+            w[l] += w3j[lm][mmm] * q[lm] * 
+              q[std::make_pair(l,m2)] *  q[std::make_pair(l,m3)];
+          }
+        }
+        
+        w_hat[l] = w[l] / pow(q2[l], RealType(1.5));
+      }
+
+      collectHistogram(q_l, w_hat);
+      
+      Nbonds_ += nBonds;
+      for (int l = 0; l <= lMax_;  l++) {
+        for (int m = -l; m <= l; m++) {
+          QBar_[std::make_pair(l,m)] += (RealType)nBonds*q[std::make_pair(l,m)];
+        }
+      }
+    }
+  }
+
+  StaticAnalyser* BondOrderParameter::cloneWorker(SimInfo* info) {
+    return new BondOrderParameter(info, dumpFilename_, selectionScript_,
+                                  rCut_, nBins_);
+  }
+
+  void BondOrderParameter::mergeWorker(StaticAnalyser* worker) {
+    BondOrderParameter* other = static_cast<BondOrderParameter*>(worker);
+    std::map<std::pair<int,int>,int>::iterator i;
+    std::map<std::pair<int,int>,ComplexType>::iterator j;
+
+    for (i = other->Q_histogram_.begin(); i != other->Q_histogram_.end(); ++i)
+      Q_histogram_[i->first] += i->second;
+    for (i = other->W_histogram_.begin(); i != other->W_histogram_.end(); ++i)
+      W_histogram_[i->first] += i->second;
+    for (int l = 0; l <= lMax_; l++) {
+      Qcount_[l] += other->Qcount_[l];
+      Wcount_[l] += other->Wcount_[l];
+    }
+    for (j = other->QBar_.begin(); j != other->QBar_.end(); ++j)
+      QBar_[j->first] += j->second;
+    Nbonds_ += other->Nbonds_;
+    frameCounter_ += other->frameCounter_;
+  }
+
   void BondOrderParameter::collectHistogram(std::vector<RealType> q, 
                                             std::vector<ComplexType> what) {
 
@@ -385,7 +409,7 @@ namespace OpenMD {
         osq << "# <Q_" << l << ">: " << Q[l] << "\n";
       }
       // Normalize by number of frames and write it out:
-      for (int i = 0; i < nBins_; ++i) {
+      for (unsigned int i = 0; i < nBins_; ++i) {
         RealType Qval = MinQ_ + (i + 0.5) * deltaQ_;               
         osq << Qval;
         for (int l = 0; l <= lMax_; l++) {
@@ -420,7 +444,7 @@ namespace OpenMD {
             << imag(What[l]) << "\n";
       }
       // Normalize by number of frames and write it out:
-      for (int i = 0; i < nBins_; ++i) {
+      for (unsigned int i = 0; i < nBins_; ++i) {
         RealType Wval = MinW_ + (i + 0.5) * deltaW_;               
         osw << Wval;
         for (int l = 0; l <= lMax_; l++) {
@@ -91,6 +91,12 @@ namespace OpenMD {
     
     virtual ~BondOrderParameter();
     virtual void process();
+
+  protected:
+    virtual void processFrame(int frame);
+    virtual bool canCloneWorker() { return true; }
+    virtual StaticAnalyser* cloneWorker(SimInfo* info);
+    virtual void mergeWorker(StaticAnalyser* worker);
     
   private:
     virtual void initializeHistogram();
@@ -107,7 +113,6 @@ namespace OpenMD {
     RealType rCut_;
     static const int lMax_ = 12;
     int frameCounter_;
-    int nBins_;
     
     std::map<std::pair<int,int>,int> m2Min;
     std::map<std::pair<int,int>,int> m2Max;
@@ -124,6 +129,9 @@ namespace OpenMD {
     RealType deltaW_;
     std::vector<int> Wcount_;
     std::map<std::pair<int,int>,int> W_histogram_;
+
+    std::map<std::pair<int,int>,ComplexType> QBar_;
+    int Nbonds_;
   };
 }
 
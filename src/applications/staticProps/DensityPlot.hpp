@@ -61,6 +61,12 @@ namespace OpenMD {
             }
         
 
+        protected:
+            virtual void processFrame(int frame);
+            virtual bool canCloneWorker() { return true; }
+            virtual StaticAnalyser* cloneWorker(SimInfo* info);
+            virtual void mergeWorker(StaticAnalyser* worker);
+
         private:
             Vector3d calcNewOrigin();
             
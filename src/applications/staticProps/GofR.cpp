@@ -122,6 +122,17 @@ namespace OpenMD {
     
   }
   
+  StaticAnalyser* GofR::cloneWorker(SimInfo* info) {
+    return new GofR(info, dumpFilename_, selectionScript1_, selectionScript2_,
+                    len_, nBins_);
+  }
+
+  void GofR::mergeWorker(StaticAnalyser* worker) {
+    GofR* other = static_cast<GofR*>(worker);
+    for (unsigned int i = 0; i < avgGofr_.size(); ++i)
+      avgGofr_[i] += other->avgGofr_[i];
+  }
+  
   void GofR::collectHistogram(StuntDouble* sd1, StuntDouble* sd2) {
 
     if (sd1 == sd2) {
@@ -64,8 +64,12 @@ namespace OpenMD {
     virtual void preProcess();
     virtual void initializeHistogram();
     virtual void collectHistogram(StuntDouble* sd1, StuntDouble* sd2);
+    virtual RealType getPairCutoff() { return len_; }
     virtual void processHistogram();
     virtual void postProcess();
+    virtual bool canCloneWorker() { return true; }
+    virtual StaticAnalyser* cloneWorker(SimInfo* info);
+    virtual void mergeWorker(StaticAnalyser* worker);
 
     virtual void writeRdf();
 
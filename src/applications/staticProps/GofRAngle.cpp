@@ -186,6 +186,13 @@ namespace OpenMD {
     }
   }
 
+  void GofRAngle::mergeWorker(StaticAnalyser* worker) {
+    GofRAngle* other = static_cast<GofRAngle*>(worker);
+    for (unsigned int i = 0; i < avgGofr_.size(); ++i)
+      for (unsigned int j = 0; j < avgGofr_[i].size(); ++j)
+        avgGofr_[i][j] += other->avgGofr_[i][j];
+  }
+
   void GofRAngle::processHistogram() {
     int nPairs = getNPairs();
     RealType volume = info_->getSnapshotManager()->getCurrentSnapshot()->getVolume();
@@ -76,11 +76,13 @@ namespace OpenMD {
     virtual void initializeHistogram();
     virtual void processHistogram();
     virtual void collectHistogram(StuntDouble* sd1, StuntDouble* sd2);
+    virtual RealType getPairCutoff() { return len_; }
     virtual void collectHistogram(StuntDouble* sd1, StuntDouble* sd2, 
                                   StuntDouble* sd3);
     virtual RealType evaluateAngle(StuntDouble* sd1, StuntDouble* sd2) = 0;
     virtual RealType evaluateAngle(StuntDouble* sd1, StuntDouble* sd2, 
                                    StuntDouble* sd3) = 0;
+    virtual void mergeWorker(StaticAnalyser* worker);
     virtual void writeRdf();
 
 
@@ -120,6 +122,15 @@ namespace OpenMD {
       }
         
   private:
+    virtual bool canCloneWorker() { return true; }
+    virtual StaticAnalyser* cloneWorker(SimInfo* info) {
+      if (doSele3_)
+        return new GofRTheta(info, dumpFilename_, selectionScript1_,
+                             selectionScript2_, selectionScript3_, len_,
+                             nBins_, nAngleBins_);
+      return new GofRTheta(info, dumpFilename_, selectionScript1_,
+                           selectionScript2_, len_, nBins_, nAngleBins_);
+    }
     virtual void processHistogram();
     virtual RealType evaluateAngle(StuntDouble* sd1, StuntDouble* sd2);        
     virtual RealType evaluateAngle(StuntDouble* sd1, StuntDouble* sd2, 
@@ -145,6 +156,15 @@ namespace OpenMD {
       }
     
   private:
+    virtual bool canCloneWorker() { return true; }
+    virtual StaticAnalyser* cloneWorker(SimInfo* info) {
+      if (doSele3_)
+        return new GofROmega(info, dumpFilename_, selectionScript1_,
+                             selectionScript2_, selectionScript3_, len_,
+                             nBins_, nAngleBins_);
+      return new GofROmega(info, dumpFilename_, selectionScript1_,
+                           selectionScript2_, len_, nBins_, nAngleBins_);
+    }
     virtual RealType evaluateAngle(StuntDouble* sd1, StuntDouble* sd2);     
     virtual RealType evaluateAngle(StuntDouble* sd1, StuntDouble* sd2, 
                                    StuntDouble* sd3);        
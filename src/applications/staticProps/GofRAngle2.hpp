@@ -63,6 +63,7 @@ namespace OpenMD {
     virtual void processOverlapping( SelectionManager& sman );
     virtual void initializeHistogram();
     virtual void collectHistogram(StuntDouble* sd1, StuntDouble* sd2);
+    virtual RealType getPairCutoff() { return len_; }
     virtual void collectHistogram(StuntDouble* sd1, StuntDouble* sd2, 
                                   StuntDouble* sd3);
     virtual void processHistogram();
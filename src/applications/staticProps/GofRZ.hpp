@@ -66,6 +66,9 @@ namespace OpenMD {
       virtual void initializeHistogram();
       virtual void processHistogram();
       virtual void collectHistogram(StuntDouble* sd1, StuntDouble* sd2);
+      virtual RealType getPairCutoff() {
+	return sqrt(len_ * len_ + zLen_ * zLen_);
+      }
       
       virtual void writeRdf();
       
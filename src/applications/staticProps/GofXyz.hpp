@@ -64,6 +64,8 @@ namespace OpenMD {
     virtual void preProcess();
     void initializeHistogram();
     virtual void collectHistogram(StuntDouble* sd1, StuntDouble* sd2);
+    // the histogram is a cube, so the corners are the furthest pairs:
+    virtual RealType getPairCutoff() { return sqrt(3.0) * halfLen_; }
     virtual void writeRdf();
         
     //virtual void validateSelection1(SelectionManager& sman);
@@ -57,7 +57,8 @@ namespace OpenMD {
                                  double rCut, double thetaCut, int nbins) :
     StaticAnalyser(info, filename, nbins),
     selectionScript1_(sele1), seleMan1_(info), evaluator1_(info),
-    selectionScript2_(sele2), seleMan2_(info), evaluator2_(info) {
+    selectionScript2_(sele2), seleMan2_(info), evaluator2_(info),
+    hbFinder_(info, rCut, thetaCut, 0.0) {
     
     setOutputName(getPrefix(filename) + ".hbg");
 
@@ -100,28 +101,18 @@ namespace OpenMD {
   
   void HBondGeometric::process() {
     Molecule* mol1;
-    Molecule* mol2;
-    Molecule::HBondDonor* hbd1;
-    Molecule::HBondDonor* hbd2;
-    std::vector<Molecule::HBondDonor*>::iterator hbdi;
-    std::vector<Molecule::HBondDonor*>::iterator hbdj;
-    std::vector<Atom*>::iterator hbai;
-    std::vector<Atom*>::iterator hbaj;
-    Atom* hba1;
-    Atom* hba2;
-    Vector3d dPos;
-    Vector3d aPos;
-    Vector3d hPos;
-    Vector3d DH;
-    Vector3d DA;
-    RealType DAdist, DHdist, theta, ctheta;
-    int ii, jj;
-    int nHB, nA, nD;
+    std::vector<HBondFinder::HBond>::const_iterator hb;
+    int ii, donor, acceptor, index;
 
     DumpReader reader(info_, dumpFilename_);    
     int nFrames = reader.getNFrames();
     frameCounter_ = 0;
 
+    int nMolecules = info_->getNGlobalMolecules();
+    molHBonds_.resize(nMolecules);
+    molDonor_.resize(nMolecules);
+    molAcceptor_.resize(nMolecules);
+
     for (int istep = 0; istep < nFrames; istep += step_) {
       reader.readFrame(istep);
       frameCounter_++;
@@ -133,86 +124,38 @@ namespace OpenMD {
       if  (evaluator2_.isDynamic()) {
         seleMan2_.setSelectionSet(evaluator2_.evaluate());
       }
+
+      std::fill(molHBonds_.begin(),   molHBonds_.end(),   0);
+      std::fill(molDonor_.begin(),    molDonor_.end(),    0);
+      std::fill(molAcceptor_.begin(), molAcceptor_.end(), 0);
+
+      hbFinder_.findHBonds(currentSnapshot_);
+      const std::vector<HBondFinder::HBond>& hBonds = hbFinder_.getHBonds();
+
+      // We're collecting statistics on the molecules in selection 1,
+      // counting their hydrogen bonds with molecules in selection 2:
+      for (hb = hBonds.begin(); hb != hBonds.end(); ++hb) {
+        if (seleMan1_.isSelected(hb->donorMol) &&
+            seleMan2_.isSelected(hb->acceptorMol)) {
+          // molecule 1 is a Hbond donor:
+          donor = hb->donorMol->getGlobalIndex();
+          molHBonds_[donor]++;
+          molDonor_[donor]++;
+        }
+        if (seleMan1_.isSelected(hb->acceptorMol) &&
+            seleMan2_.isSelected(hb->donorMol)) {
+          // molecule 1 is a Hbond acceptor:
+          acceptor = hb->acceptorMol->getGlobalIndex();
+          molHBonds_[acceptor]++;
+          molAcceptor_[acceptor]++;
+        }
+      }
       
       for (mol1 = seleMan1_.beginSelectedMolecule(ii);
            mol1 != NULL; mol1 = seleMan1_.nextSelectedMolecule(ii)) {
-
-        // We're collecting statistics on the molecules in selection 1:
-        nHB = 0;
-        nA = 0;
-        nD = 0;
-        
-        for (mol2 = seleMan2_.beginSelectedMolecule(jj);
-             mol2 != NULL; mol2 = seleMan2_.nextSelectedMolecule(jj)) {
-          
-          // loop over the possible donors in molecule 1:
-          for (hbd1 = mol1->beginHBondDonor(hbdi); hbd1 != NULL;
-               hbd1 = mol1->nextHBondDonor(hbdi)) {
-            dPos = hbd1->donorAtom->getPos();
-            hPos = hbd1->donatedHydrogen->getPos();
-            DH = hPos - dPos; 
-            currentSnapshot_->wrapVector(DH);
-            DHdist = DH.length();
-
-            // loop over the possible acceptors in molecule 2:
-            for (hba2 = mol2->beginHBondAcceptor(hbaj); hba2 != NULL;
-                 hba2 = mol2->nextHBondAcceptor(hbaj)) {
-              aPos = hba2->getPos();
-              DA = aPos - dPos;              
-              currentSnapshot_->wrapVector(DA);
-              DAdist = DA.length();
-
-              // Distance criteria: are the donor and acceptor atoms
-              // close enough?
-              if (DAdist < rCut_) {
-
-                ctheta = dot(DH, DA) / (DHdist * DAdist);
-                theta = acos(ctheta) * 180.0 / Constants::PI;
-
-                // Angle criteria: are the D-H and D-A and vectors close?
-                if (theta < thetaCut_) {
-                  // molecule 1 is a Hbond donor:
-                  nHB++;
-                  nD++;
-                }
-              }            
-            }            
-          }
-
-          // now loop over the possible acceptors in molecule 1:
-          for (hba1 = mol1->beginHBondAcceptor(hbai); hba1 != NULL;
-               hba1 = mol1->nextHBondAcceptor(hbai)) {
-            aPos = hba1->getPos();
-            
-            // loop over the possible donors in molecule 2:
-            for (hbd2 = mol2->beginHBondDonor(hbdj); hbd2 != NULL;
-               hbd2 = mol2->nextHBondDonor(hbdj)) {
-              dPos = hbd2->donorAtom->getPos();
-
-              DA = aPos - dPos;
-              currentSnapshot_->wrapVector(DA);
-              DAdist = DA.length();
-              
-              // Distance criteria: are the donor and acceptor atoms
-              // close enough?
-              if (DAdist < rCut_) {
-                hPos = hbd2->donatedHydrogen->getPos();
-                DH = hPos - dPos; 
-                currentSnapshot_->wrapVector(DH);
-                DHdist = DH.length();
-                ctheta = dot(DH, DA) / (DHdist * DAdist);
-                theta = acos(ctheta) * 180.0 / Constants::PI;
-                // Angle criteria: are the D-H and D-A and vectors close?
-                if (theta < thetaCut_) {
-                  // molecule 1 is a Hbond acceptor:
-                  nHB++;
-                  nA++;
-                }                
-              }
-            }
-          }
-        }                 
-        collectHistogram(nHB, nA, nD);
+        index = mol1->getGlobalIndex();
+        collectHistogram(molHBonds_[index], molAcceptor_[index],
+                         molDonor_[index]);
       }
     }
     writeHistogram();
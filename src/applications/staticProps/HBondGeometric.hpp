@@ -49,6 +49,7 @@
 #include "selection/SelectionEvaluator.hpp"
 #include "selection/SelectionManager.hpp"
 #include "applications/staticProps/StaticAnalyser.hpp"
+#include "utils/HBondFinder.hpp"
 
 namespace OpenMD {
 
@@ -97,6 +98,12 @@ namespace OpenMD {
     std::vector<int> nDonor_;
     std::vector<int> nAcceptor_;
     int nSelected_;
+
+    HBondFinder hbFinder_;
+    /* per-molecule counts for the current frame, by global index */
+    std::vector<int> molHBonds_;
+    std::vector<int> molDonor_;
+    std::vector<int> molAcceptor_;
   };
 }
 
@@ -65,6 +65,7 @@ namespace OpenMD {
     virtual void initializeHistogram();
     virtual void collectHistogram(StuntDouble* sd1, StuntDouble* sd2);
     virtual void processHistogram();
+    virtual RealType getPairCutoff() { return len_; }
     virtual void writeRdf();
 
     RealType len_;
@@ -89,69 +89,67 @@ namespace OpenMD {
   void RadialDistrFunc::process() {
     
     preProcess();
-    
-    DumpReader reader(info_, dumpFilename_);    
-    int nFrames = reader.getNFrames();
+
+    int nFrames = processFrames();
     nProcessed_ = nFrames / step_;
 
-    for (int i = 0; i < nFrames; i += step_) {
-      reader.readFrame(i);
-      currentSnapshot_ = info_->getSnapshotManager()->getCurrentSnapshot();
+    postProcess();
+
+    writeRdf();
+  }
+
+  void RadialDistrFunc::processFrame(int frame) {
+
+    currentSnapshot_ = info_->getSnapshotManager()->getCurrentSnapshot();
 
-      if (evaluator1_.isDynamic()) {
+    if (evaluator1_.isDynamic()) {
 	seleMan1_.setSelectionSet(evaluator1_.evaluate());
 	validateSelection1(seleMan1_);
-      }
-      if (evaluator2_.isDynamic()) {
+    }
+    if (evaluator2_.isDynamic()) {
 	seleMan2_.setSelectionSet(evaluator2_.evaluate());
 	validateSelection2(seleMan2_);
-      }
-        
-      initializeHistogram();
-        
-      // Selections may overlap, and we need a bit of logic to deal
-      // with this.
-      //
-      // |     s1    |
-      // | s1 -c | c |
-      //         | c | s2 - c |
-      //         |    s2      |
-      //
-      // s1 : Set of StuntDoubles in selection1
-      // s2 : Set of StuntDoubles in selection2
-      // c  : Intersection of selection1 and selection2
-      // 
-      // When we loop over the pairs, we can divide the looping into 3
-      // stages:
-      //
-      // Stage 1 :     [s1-c]      [s2]
-      // Stage 2 :     [c]         [s2 - c]
-      // Stage 3 :     [c]         [c]
-      // Stages 1 and 2 are completely non-overlapping.
-      // Stage 3 is completely overlapping.
-
-      if (evaluator1_.isDynamic() || evaluator2_.isDynamic()) {
+    }
+      
+    initializeHistogram();
+      
+    // Selections may overlap, and we need a bit of logic to deal
+    // with this.
+    //
+    // |     s1    |
+    // | s1 -c | c |
+    //         | c | s2 - c |
+    //         |    s2      |
+    //
+    // s1 : Set of StuntDoubles in selection1
+    // s2 : Set of StuntDoubles in selection2
+    // c  : Intersection of selection1 and selection2
+    // 
+    // When we loop over the pairs, we can divide the looping into 3
+    // stages:
+    //
+    // Stage 1 :     [s1-c]      [s2]
+    // Stage 2 :     [c]         [s2 - c]
+    // Stage 3 :     [c]         [c]
+    // Stages 1 and 2 are completely non-overlapping.
+    // Stage 3 is completely overlapping.
+
+    if (evaluator1_.isDynamic() || evaluator2_.isDynamic()) {
 	common_ = seleMan1_ & seleMan2_;
 	sele1_minus_common_ = seleMan1_ - common_;
 	sele2_minus_common_ = seleMan2_ - common_;            
 	nSelected1_ = seleMan1_.getSelectionCount();
 	nSelected2_ = seleMan2_.getSelectionCount();
 	int nIntersect = common_.getSelectionCount();
-            
+          
 	nPairs_ = nSelected1_ * nSelected2_ - (nIntersect +1) * nIntersect/2;
-      }
-      
-      processNonOverlapping(sele1_minus_common_, seleMan2_);
-      processNonOverlapping(common_,             sele2_minus_common_);
-      processOverlapping(common_);
-      
-      processHistogram();
-        
     }
-
-    postProcess();
-
-    writeRdf();
+    
+    processNonOverlapping(sele1_minus_common_, seleMan2_);
+    processNonOverlapping(common_,             sele2_minus_common_);
+    processOverlapping(common_);
+    
+    processHistogram();
   }
 
   void RadialDistrFunc::processNonOverlapping( SelectionManager& sman1, 
@@ -160,6 +158,35 @@ namespace OpenMD {
     StuntDouble* sd2;
     int i;    
     int j;
+
+    RealType rCut = getPairCutoff();
+
+    if (rCut > 0.0) {
+      // Bin the second selection and only visit the members of the
+      // second selection which are near each member of the first.
+      cellSDs_.clear();
+      cellPositions_.clear();
+      for (sd2 = sman2.beginSelected(j); sd2 != NULL; 
+           sd2 = sman2.nextSelected(j)) {
+        cellSDs_.push_back(sd2);
+        cellPositions_.push_back(sd2->getPos());
+      }
+      cellList_.build(cellPositions_, currentSnapshot_->getHmat(),
+                      info_->getSimParams()->getUsePeriodicBoundaryConditions(),
+                      rCut);
+
+      if (cellList_.isActive()) {
+        for (sd1 = sman1.beginSelected(i); sd1 != NULL; 
+             sd1 = sman1.nextSelected(i)) {
+          cellList_.getNeighbors(sd1->getPos(), neighbors_);
+          for (std::vector<int>::iterator n = neighbors_.begin();
+               n != neighbors_.end(); ++n) {
+            collectHistogram(sd1, cellSDs_[*n]);
+          }
+        }
+        return;
+      }
+    }
     
     // This is the same as a non-overlapping pairwise loop structure:
     // for (int i = 0;  i < ni ; ++i ) {
@@ -181,6 +208,34 @@ namespace OpenMD {
     int i;    
     int j;
 
+    RealType rCut = getPairCutoff();
+
+    if (rCut > 0.0) {
+      // Bin the selection, and keep the i < j ordering of the pairs
+      // by only visiting neighbors which come later in the selection.
+      cellSDs_.clear();
+      cellPositions_.clear();
+      for (sd1 = sman.beginSelected(i); sd1 != NULL; 
+           sd1 = sman.nextSelected(i)) {
+        cellSDs_.push_back(sd1);
+        cellPositions_.push_back(sd1->getPos());
+      }
+      cellList_.build(cellPositions_, currentSnapshot_->getHmat(),
+                      info_->getSimParams()->getUsePeriodicBoundaryConditions(),
+                      rCut);
+
+      if (cellList_.isActive()) {
+        for (int a = 0; a < int(cellSDs_.size()); a++) {
+          cellList_.getNeighbors(cellPositions_[a], neighbors_);
+          for (std::vector<int>::iterator n = neighbors_.begin();
+               n != neighbors_.end(); ++n) {
+            if (*n > a) collectHistogram(cellSDs_[a], cellSDs_[*n]);
+          }
+        }
+        return;
+      }
+    }
+
     // This is the same as a pairwise loop structure:
     // for (int i = 0;  i < n-1 ; ++i ) {
     //   for (int j = i + 1; j < n; ++j) {} 
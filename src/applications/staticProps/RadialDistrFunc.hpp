@@ -48,6 +48,7 @@
 #include "selection/SelectionEvaluator.hpp"
 #include "selection/SelectionManager.hpp"
 #include "utils/Constants.hpp"
+#include "utils/CellList.hpp"
 #include "applications/staticProps/StaticAnalyser.hpp"
 
 namespace OpenMD {
@@ -74,6 +75,15 @@ namespace OpenMD {
     virtual void processNonOverlapping(SelectionManager& sman1, 
                                        SelectionManager& sman2);
     virtual void processOverlapping(SelectionManager& sman);
+    virtual void processFrame(int frame);
+
+    /**
+     * Returns the largest separation at which a pair can contribute
+     * to the histogram.  When this is positive, the pair loops only
+     * visit pairs found through a cell list built with this cutoff.
+     * The default (0) visits every pair of the two selections.
+     */
+    virtual RealType getPairCutoff() { return 0.0; }
 
     int getNPairs() { return nPairs_;}
     int getNSelected1() { return nSelected1_;}
@@ -106,6 +116,11 @@ namespace OpenMD {
     int nPairs_;
     int nSelected1_;
     int nSelected2_;
+
+    CellList cellList_;
+    std::vector<StuntDouble*> cellSDs_;
+    std::vector<Vector3d> cellPositions_;
+    std::vector<int> neighbors_;
   };
 
 
@@ -40,7 +40,13 @@
  * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
  */
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "applications/staticProps/StaticAnalyser.hpp"
+#include "brains/SimCreator.hpp"
+#include "io/DumpReader.hpp"
 #include "utils/simError.h"
 #include "utils/Revision.hpp"
 
@@ -59,6 +65,62 @@ namespace OpenMD {
       counts_->accumulator.push_back( new Accumulator() );     
   }
   
+  int StaticAnalyser::processFrames() {
+
+    DumpReader reader(info_, dumpFilename_);
+    int nFrames = reader.getNFrames();
+
+    std::vector<int> frames;
+    for (int i = 0; i < nFrames; i += step_)
+      frames.push_back(i);
+
+    int nWorkers = 1;
+#ifdef _OPENMP
+    if (canCloneWorker())
+      nWorkers = std::min(omp_get_max_threads(), int(frames.size()));
+#endif
+
+    // Worker copies (and their readers) are built serially: parsing
+    // the meta-data isn't thread safe, and the readers can share the
+    // frame index left behind by the first scan.
+    std::vector<StaticAnalyser*> workers(1, this);
+    std::vector<SimInfo*> workerInfos;
+    std::vector<DumpReader*> readers(1, &reader);
+
+    for (int w = 1; w < nWorkers; w++) {
+      SimCreator creator;
+      SimInfo* info = creator.createSim(dumpFilename_, false);
+      workerInfos.push_back(info);
+      workers.push_back(cloneWorker(info));
+      readers.push_back(new DumpReader(info, dumpFilename_));
+      readers.back()->getNFrames();
+    }
+    nWorkers = workers.size();
+
+    // block b is processed by workers[(b + 1) % nWorkers], which puts
+    // this analyser on the final block:
+#pragma omp parallel for num_threads(nWorkers) schedule(static, 1)
+    for (int b = 0; b < nWorkers; b++) {
+      int w = (b + 1) % nWorkers;
+      int begin = (frames.size() * b) / nWorkers;
+      int end = (frames.size() * (b + 1)) / nWorkers;
+
+      for (int k = begin; k < end; k++) {
+        readers[w]->readFrame(frames[k]);
+        workers[w]->processFrame(frames[k]);
+      }
+    }
+
+    for (int w = 1; w < nWorkers; w++) {
+      mergeWorker(workers[w]);
+      delete readers[w];
+      delete workers[w];
+      delete workerInfos[w - 1];
+    }
+
+    return nFrames;
+  }
+
   void StaticAnalyser::writeOutput() {
     vector<OutputData*>::iterator i;
     OutputData* outputData;
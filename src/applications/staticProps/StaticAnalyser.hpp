@@ -107,6 +107,37 @@ namespace OpenMD {
     }
 
   protected:
+    /**
+     * Reads every step_-th frame of the dump file and hands each one
+     * to processFrame.  For analysers that can clone workers, the
+     * frames are split into contiguous blocks that OpenMP threads
+     * process concurrently, each with its own SimInfo, DumpReader and
+     * copy of the analyser; the copies are folded back in with
+     * mergeWorker.  This analyser takes the last block, so it ends on
+     * the same frame a serial pass would.  Returns the number of
+     * frames in the dump file.
+     */
+    int processFrames();
+
+    /** Analyses the frame that was just read into info_ */
+    virtual void processFrame(int frame) {}
+
+    /**
+     * Returns true if the analyser can hand blocks of frames to
+     * cloneWorker copies.  The default is false for analysers that
+     * have to see every frame, in order, themselves.
+     */
+    virtual bool canCloneWorker() { return false; }
+
+    /**
+     * Returns a copy of this analyser bound to info and ready to
+     * accumulate frames.  Only called when canCloneWorker is true.
+     */
+    virtual StaticAnalyser* cloneWorker(SimInfo* info) { return NULL; }
+
+    /** Adds the results accumulated by a cloneWorker copy */
+    virtual void mergeWorker(StaticAnalyser* worker) {}
+
     virtual void writeOutput();
     virtual void writeData(ostream& os, OutputData* dat, unsigned int bin);
     virtual void writeErrorBars(ostream& os, OutputData* dat, unsigned int bin);
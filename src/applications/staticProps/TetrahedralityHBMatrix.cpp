@@ -62,7 +62,8 @@ namespace OpenMD {
                                                  int nbins) : 
     StaticAnalyser(info, filename, nbins), selectionScript_(sele), 
     seleMan_(info), evaluator_(info), rCut_(rCut),  OOCut_(OOcut),
-    thetaCut_(thetaCut), OHCut_(OHcut) {
+    thetaCut_(thetaCut), OHCut_(OHcut),
+    hbFinder_(info, OOcut, thetaCut, OHcut) {
 
     setAnalysisType("Tetrahedrality HBond Matrix");   
     setOutputName(getPrefix(filename) + ".hbq");
@@ -117,20 +118,10 @@ namespace OpenMD {
     Vector3d vec;
     Vector3d ri, rj, rk, rik, rkj, dposition, tposition;
     RealType r, cospsi;
-    std::vector<Molecule::HBondDonor*>::iterator hbdi;
-    Molecule::HBondDonor* hbd;
-    std::vector<Atom*>::iterator hbai;
-    Atom* hba;
-    Vector3d dPos;
-    Vector3d aPos;
-    Vector3d hPos;
-    Vector3d DH;
-    Vector3d DA;
-    Vector3d HA;
-    Vector3d uDA;
-    RealType DAdist, DHdist, HAdist, theta, ctheta, Qk, q1, q2;
+    std::vector<HBondFinder::HBond>::const_iterator hb;
+    RealType Qk, q1, q2;
     std::vector<std::pair<RealType,Molecule*> > myNeighbors;
-    int myIndex, ii, jj, index1, index2;
+    int myIndex, ii, index1, index2;
     
     bool usePeriodicBoundaryConditions_ = info_->getSimParams()->getUsePeriodicBoundaryConditions();
 
@@ -224,95 +215,25 @@ namespace OpenMD {
           
         }
       }
-      // Now to scan for histogram:
+      // Now to scan for histogram.  The hydrogen bonds are indexed
+      // by donor then acceptor, and each bond between two selected
+      // molecules is counted once from each side of the pair:
 
-      for (mol1 = seleMan_.beginSelectedMolecule(ii);
-           mol1 != NULL; mol1 = seleMan_.nextSelectedMolecule(ii)) {
-        
-        for (mol2 = seleMan_.beginSelectedMolecule(jj);
-             mol2 != NULL; mol2 = seleMan_.nextSelectedMolecule(jj)) {
-          
-          // loop over the possible donors in molecule 1:
-          for (hbd = mol1->beginHBondDonor(hbdi); hbd != NULL;
-               hbd = mol1->nextHBondDonor(hbdi)) {
-            dPos = hbd->donorAtom->getPos(); 
-            hPos = hbd->donatedHydrogen->getPos();
-            DH = hPos - dPos; 
-            currentSnapshot_->wrapVector(DH);
-            DHdist = DH.length();
-            
-            // loop over the possible acceptors in molecule 2:
-            for (hba = mol2->beginHBondAcceptor(hbai); hba != NULL;
-                 hba = mol2->nextHBondAcceptor(hbai)) {
-              aPos = hba->getPos();
-              DA = aPos - dPos;
-              currentSnapshot_->wrapVector(DA);
-              DAdist = DA.length();
-              
-              // Distance criteria: are the donor and acceptor atoms
-              // close enough?
-              if (DAdist < OOCut_) {
-                HA = aPos - hPos;
-                currentSnapshot_->wrapVector(HA);
-                HAdist = HA.length();
-                
-                ctheta = dot(DH, DA) / (DHdist * DAdist);
-                theta = acos(ctheta) * 180.0 / Constants::PI;
-              
-                // Angle criteria: are the D-H and D-A and vectors close?
-                if (theta < thetaCut_ && HAdist < OHCut_) {
-                  // We have a hydrogen bond!                
-                  index1 = mol1->getGlobalIndex();
-                  index2 = mol2->getGlobalIndex();
-                  q1 = Q_[index1];
-                  q2 = Q_[index2];
-                  collectHistogram(q1, q2);                
-                }
-              }
-            }
-          }
-          // now loop over the possible acceptors in molecule 1:
-          for (hba = mol1->beginHBondAcceptor(hbai); hba != NULL;
-               hba = mol1->nextHBondAcceptor(hbai)) {
-            aPos = hba->getPos();
-            
-            // loop over the possible donors in molecule 2:
-            for (hbd = mol2->beginHBondDonor(hbdi); hbd != NULL;
-                 hbd = mol2->nextHBondDonor(hbdi)) {
-              dPos = hbd->donorAtom->getPos();
-              
-              DA = aPos - dPos;
-              currentSnapshot_->wrapVector(DA);
-              DAdist = DA.length();
-              
-              // Distance criteria: are the donor and acceptor atoms
-              // close enough?
-              if (DAdist < OOCut_) {
-                hPos = hbd->donatedHydrogen->getPos();
-                HA = aPos - hPos;
-                currentSnapshot_->wrapVector(HA);
-                HAdist = HA.length();
-                
-                DH = hPos - dPos; 
-                currentSnapshot_->wrapVector(DH);
-                DHdist = DH.length();
-                ctheta = dot(DH, DA) / (DHdist * DAdist);
-                theta = acos(ctheta) * 180.0 / Constants::PI;              
-                // Angle criteria: are the D-H and D-A and vectors close?
-                if (theta < thetaCut_ && HAdist < OHCut_) {
-                  // We have a hydrogen bond!
-                  // keep these indexed by donor then acceptor:
-                  index1 = mol2->getGlobalIndex();
-                  index2 = mol1->getGlobalIndex();
-                  q1 = Q_[index1];
-                  q2 = Q_[index2];
-                  collectHistogram(q1, q2);
-                }
-              }
-            }
-          }
-        }           
-      }            
+      hbFinder_.findHBonds(currentSnapshot_);
+      const std::vector<HBondFinder::HBond>& hBonds = hbFinder_.getHBonds();
+
+      for (hb = hBonds.begin(); hb != hBonds.end(); ++hb) {
+        if (seleMan_.isSelected(hb->donorMol) &&
+            seleMan_.isSelected(hb->acceptorMol)) {
+          // We have a hydrogen bond!
+          index1 = hb->donorMol->getGlobalIndex();
+          index2 = hb->acceptorMol->getGlobalIndex();
+          q1 = Q_[index1];
+          q2 = Q_[index2];
+          collectHistogram(q1, q2);
+          collectHistogram(q1, q2);
+        }
+      }
     }
     writeOutput();
   }
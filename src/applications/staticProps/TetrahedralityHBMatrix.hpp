@@ -45,6 +45,7 @@
 #include "selection/SelectionManager.hpp"
 #include "applications/staticProps/StaticAnalyser.hpp"
 #include "math/Vector3.hpp"
+#include "utils/HBondFinder.hpp"
 
 namespace OpenMD {
 
@@ -102,6 +103,8 @@ namespace OpenMD {
     RealType deltaQ_;
 
     std::vector<RealType> Q_;
+
+    HBondFinder hbFinder_;
     
     std::vector<std::vector<unsigned int> > Q_histogram_;
   };
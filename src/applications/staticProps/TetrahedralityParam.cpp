@@ -89,6 +89,22 @@ namespace OpenMD {
   }
   
   void TetrahedralityParam::process() {
+
+    frameCounter_ = 0;
+
+    Distorted_.clear();
+    Tetrahedral_.clear();
+
+    processFrames();
+
+    writeOrderParameter();
+    std::cerr << "number of distorted StuntDoubles = " 
+	      << Distorted_.size() << "\n";
+    std::cerr << "number of tetrahedral StuntDoubles = " 
+	      << Tetrahedral_.size() << "\n";
+  }
+        
+  void TetrahedralityParam::processFrame(int istep) {
     Molecule* mol;
     StuntDouble* sd;
     StuntDouble* sd2;
@@ -106,52 +122,43 @@ namespace OpenMD {
     int isd;
     bool usePeriodicBoundaryConditions_ = info_->getSimParams()->getUsePeriodicBoundaryConditions();
 
-    DumpReader reader(info_, dumpFilename_);    
-    int nFrames = reader.getNFrames();
-    frameCounter_ = 0;
-
-    Distorted_.clear();
-    Tetrahedral_.clear();
-
-    for (int istep = 0; istep < nFrames; istep += step_) {
-      reader.readFrame(istep);
-      frameCounter_++;
-      currentSnapshot_ = info_->getSnapshotManager()->getCurrentSnapshot();
-      
-      if (evaluator_.isDynamic()) {
-        seleMan_.setSelectionSet(evaluator_.evaluate());
-      }
+    frameCounter_++;
+    currentSnapshot_ = info_->getSnapshotManager()->getCurrentSnapshot();
+    
+    if (evaluator_.isDynamic()) {
+      seleMan_.setSelectionSet(evaluator_.evaluate());
+    }
 
-      // outer loop is over the selected StuntDoubles:
+    // outer loop is over the selected StuntDoubles:
 
-      for (sd = seleMan_.beginSelected(isd); sd != NULL; 
-           sd = seleMan_.nextSelected(isd)) {
+    for (sd = seleMan_.beginSelected(isd); sd != NULL; 
+         sd = seleMan_.nextSelected(isd)) {
 	
-        myIndex = sd->getGlobalIndex();
+      myIndex = sd->getGlobalIndex();
 	Qk = 1.0;
 
 	myNeighbors.clear();
-                
-        // inner loop is over all StuntDoubles in the system:
-        
-        for (mol = info_->beginMolecule(mi); mol != NULL; 
-             mol = info_->nextMolecule(mi)) {
+              
+      // inner loop is over all StuntDoubles in the system:
+      
+      for (mol = info_->beginMolecule(mi); mol != NULL; 
+           mol = info_->nextMolecule(mi)) {
 
-          for (sd2 = mol->beginIntegrableObject(ioi); sd2 != NULL; 
-               sd2 = mol->nextIntegrableObject(ioi)) {
+        for (sd2 = mol->beginIntegrableObject(ioi); sd2 != NULL; 
+             sd2 = mol->nextIntegrableObject(ioi)) {
 	    
-            if (sd2->getGlobalIndex() != myIndex) {
+          if (sd2->getGlobalIndex() != myIndex) {
 	      
-              vec = sd->getPos() - sd2->getPos();       
+            vec = sd->getPos() - sd2->getPos();       
 	      
-              if (usePeriodicBoundaryConditions_) 
-                currentSnapshot_->wrapVector(vec);
+            if (usePeriodicBoundaryConditions_) 
+              currentSnapshot_->wrapVector(vec);
 	      
-              r = vec.length();             
+            r = vec.length();             
 
-              // Check to see if neighbor is in bond cutoff 
-              
-              if (r < rCut_) { 
+            // Check to see if neighbor is in bond cutoff 
+            
+            if (r < rCut_) { 
 		
 		myNeighbors.push_back(std::make_pair(r,sd2));
 	      }
@@ -226,19 +233,48 @@ namespace OpenMD {
 	  }
 
 	  //std::cerr<<Tetrahedral_.size()<<endl;
-       
+     
 	}
 
-      }
     }
-    
-    writeOrderParameter();
-    std::cerr << "number of distorted StuntDoubles = " 
-	      << Distorted_.size() << "\n";
-    std::cerr << "number of tetrahedral StuntDoubles = " 
-	      << Tetrahedral_.size() << "\n";
   }
-        
+
+  StaticAnalyser* TetrahedralityParam::cloneWorker(SimInfo* info) {
+    return new TetrahedralityParam(info, dumpFilename_, selectionScript_,
+                                   rCut_, nBins_);
+  }
+
+  void TetrahedralityParam::mergeWorker(StaticAnalyser* worker) {
+    TetrahedralityParam* other = static_cast<TetrahedralityParam*>(worker);
+    for (unsigned int i = 0; i < nBins_; i++)
+      Q_histogram_[i] += other->Q_histogram_[i];
+    frameCounter_ += other->frameCounter_;
+
+    // The worker's StuntDoubles belong to its own SimInfo, so keep
+    // the ones in info_ with the same global indices:
+    std::map<int, StuntDouble*> sds;
+    SimInfo::MoleculeIterator mi;
+    Molecule::AtomIterator ai;
+    Molecule::RigidBodyIterator rbi;
+    Molecule* mol;
+    Atom* atom;
+    RigidBody* rb;
+    for (mol = info_->beginMolecule(mi); mol != NULL;
+         mol = info_->nextMolecule(mi)) {
+      for (atom = mol->beginAtom(ai); atom != NULL; atom = mol->nextAtom(ai))
+        sds[atom->getGlobalIndex()] = atom;
+      for (rb = mol->beginRigidBody(rbi); rb != NULL;
+           rb = mol->nextRigidBody(rbi))
+        sds[rb->getGlobalIndex()] = rb;
+    }
+
+    std::vector<StuntDouble*>::iterator j;
+    for (j = other->Distorted_.begin(); j != other->Distorted_.end(); ++j)
+      Distorted_.push_back(sds[(*j)->getGlobalIndex()]);
+    for (j = other->Tetrahedral_.begin(); j != other->Tetrahedral_.end(); ++j)
+      Tetrahedral_.push_back(sds[(*j)->getGlobalIndex()]);
+  }
+
   void TetrahedralityParam::collectHistogram(RealType Qk) {
 
     if (Qk > MinQ_ && Qk < MaxQ_) {
@@ -253,7 +289,7 @@ namespace OpenMD {
     
     int nSelected = 0;
 
-    for (int i = 0; i < nBins_; ++i) {
+    for (unsigned int i = 0; i < nBins_; ++i) {
       nSelected = nSelected + int(Q_histogram_[i]*deltaQ_);
     }
     
@@ -265,7 +301,7 @@ namespace OpenMD {
       osq << "# selection: (" << selectionScript_ << ")\n";
       osq << "# \n";
       // Normalize by number of frames and write it out:
-      for (int i = 0; i < nBins_; ++i) {
+      for (unsigned int i = 0; i < nBins_; ++i) {
         RealType Qval = MinQ_ + (i + 0.5) * deltaQ_;               
         osq << Qval;
 	osq << "\t" << (RealType) (Q_histogram_[i]/deltaQ_)/nSelected;        
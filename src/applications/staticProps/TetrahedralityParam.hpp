@@ -87,6 +87,12 @@ namespace OpenMD {
     
     virtual ~TetrahedralityParam();
     virtual void process();
+
+  protected:
+    virtual void processFrame(int frame);
+    virtual bool canCloneWorker() { return true; }
+    virtual StaticAnalyser* cloneWorker(SimInfo* info);
+    virtual void mergeWorker(StaticAnalyser* worker);
     
   private:
     virtual void initializeHistogram();
@@ -100,7 +106,6 @@ namespace OpenMD {
             
     RealType rCut_;
     int frameCounter_;
-    int nBins_;
    
     RealType MinQ_;
     RealType MaxQ_;
@@ -46,6 +46,7 @@
 #include "utils/Algorithm.hpp"
 #include "brains/SimInfo.hpp"
 #include "io/DumpReader.hpp"
+#include "utils/simError.h"
 
 namespace OpenMD {
   BlockSnapshotManager::BlockSnapshotManager(SimInfo* info, 
@@ -56,7 +57,8 @@ namespace OpenMD {
     : SnapshotManager(storageLayout), info_(info), 
       blockCapacity_(blockCapacity), memSize_(memSize), 
       activeBlocks_(blockCapacity_, -1), 
-      activeRefCount_(blockCapacity_, 0) {
+      activeRefCount_(blockCapacity_, 0), lastUsed_(blockCapacity_, 0),
+      useClock_(0), prefetchFile_(NULL), prefetchedBlock_(-1) {
     
     nAtoms_ = info->getNGlobalAtoms();
     nRigidBodies_ = info->getNGlobalRigidBodies();
@@ -76,18 +78,40 @@ namespace OpenMD {
       + nCutoffGroups_ * bytesPerCutoffGroup 
       + bytesPerFrameData;
 
+    reader_ = new DumpReader(info, filename);
+    nframes_ = reader_->getNFrames();
+
+    // the prefetched block is held as raw records, which are usually
+    // longer than the parsed frames, so size them from the dump file:
+    long long int bytesPerRecord = 0;
+#ifndef IS_MPI
+    for (int i = 0; i < nframes_; ++i) {
+      long long int recordSize = reader_->getFrameRecordSize(i);
+      bytesPerRecord = std::max(bytesPerRecord, recordSize);
+    }
+#endif
+
     // total number of frames that can fit in memory
     //RealType frameCapacity = avaliablePhysMem / bytesPerFrame;
     RealType frameCapacity = (RealType) memSize_ / (RealType) bytesPerFrame;
 
-    // number of frames in each block given the need to hold multiple blocks 
-    // in memory at the same time:
-    nSnapshotPerBlock_ = int(frameCapacity) / blockCapacity_;
+    // number of frames in each block given the need to hold multiple
+    // blocks in memory at the same time, plus the raw records of the
+    // block being prefetched:
+    long long int bytesPerBlockFrame = blockCapacity_ *
+      (long long int) bytesPerFrame + bytesPerRecord;
+    nSnapshotPerBlock_ = int(memSize_ / bytesPerBlockFrame);
     if (nSnapshotPerBlock_ <= 0) {
-      std::cerr << "not enough memory to hold two configs!" << std::endl;
+      sprintf(painCave.errMsg,
+              "BlockSnapshotManager: not enough memory to hold %d blocks\n"
+              "\tof configurations and a prefetched block; using one\n"
+              "\tframe per block.\n",
+              blockCapacity_);
+      painCave.severity = OPENMD_WARNING;
+      painCave.isFatal = 0;
+      simError();
+      nSnapshotPerBlock_ = 1;
     }
-    reader_ = new DumpReader(info, filename);
-    nframes_ = reader_->getNFrames();
     int nblocks = nframes_ / nSnapshotPerBlock_;
     if (nframes_ % int(nSnapshotPerBlock_) != 0) {
       ++nblocks;
@@ -121,6 +145,8 @@ namespace OpenMD {
               << (unsigned long)bytesPerCutoffGroup << std::endl;
     std::cout << "            Bytes per Frame:\t" 
               << (unsigned long)bytesPerFrame << std::endl;
+    std::cout << "     Bytes per Frame Record:\t" 
+              << (unsigned long)bytesPerRecord << std::endl;
     std::cout << "             Frame Capacity:\t"
               << (unsigned long)frameCapacity << std::endl;
     std::cout << "       Frames in trajectory:\t" 
@@ -140,11 +166,13 @@ namespace OpenMD {
     previousSnapshot_ = NULL;
     
     delete reader_;
+    delete prefetchFile_;
 
+    // cached blocks may still be resident with no references:
     std::vector<int>::iterator i;
     for (i = activeBlocks_.begin(); i != activeBlocks_.end(); ++i) {
       if (*i != -1) {
-	unloadBlock(*i);
+	internalUnload(*i);
       }
     }
   }
@@ -175,6 +203,7 @@ namespace OpenMD {
       // If the block is already in memory, just increase the
       // reference count:
       ++activeRefCount_[i - activeBlocks_.begin()];
+      lastUsed_[i - activeBlocks_.begin()] = ++useClock_;
       loadSuccess = true;
     } else if (getNActiveBlocks() < blockCapacity_){
       // If the number of active blocks is less than the block
@@ -183,11 +212,12 @@ namespace OpenMD {
       loadSuccess = true;
     } else if ( hasZeroRefBlock() ) {
       // If we have already reached the block capacity, we need to
-      // unload a block with 0 references:
-      int zeroRefBlock = getFirstZeroRefBlock();
+      // evict the least recently used block with 0 references:
+      int zeroRefBlock = getLeastRecentZeroRefBlock();
       assert(zeroRefBlock != -1);
       internalUnload(zeroRefBlock);
       internalLoad(block);
+      loadSuccess = true;
     } else {
       // We have reached capacity and all blocks in memory are have
       // non-zero references:
@@ -207,10 +237,8 @@ namespace OpenMD {
 	activeRefCount_[i - activeBlocks_.begin()]  = 0;
       }
 
-      if (activeRefCount_[i-activeBlocks_.begin()] == 0) {
-        internalUnload(block);
-      }
-        
+      // A block with no references stays in memory until its slot is
+      // needed, so reloading it soon afterwards is free.
       unloadSuccess = true;
     } else {
       unloadSuccess = false;
@@ -219,17 +247,45 @@ namespace OpenMD {
     return unloadSuccess;
   }
 
+  void BlockSnapshotManager::prefetchBlock(int block) {
+#ifndef IS_MPI
+    if (block < 0 || block >= getNBlocks() || block == prefetchedBlock_ ||
+        isBlockActive(block))
+      return;
+
+    if (prefetchFile_ == NULL) {
+      prefetchFile_ = new std::ifstream(reader_->getFilename().c_str(),
+                                        std::ifstream::in |
+                                        std::ifstream::binary);
+    }
+    if (prefetchFile_->fail()) return;
+
+    prefetchedBlock_ = -1;
+    int first = blocks_[block].first;
+    prefetchedFrames_.resize(blocks_[block].second - first);
+    for (int i = first; i < blocks_[block].second; ++i) {
+      reader_->readFrameRecord(*prefetchFile_, i, prefetchedFrames_[i - first]);
+    }
+    prefetchedBlock_ = block;
+#endif
+  }
+
   void BlockSnapshotManager::internalLoad(int block) {
         
     for (int i = blocks_[block].first; i < blocks_[block].second; ++i) {
       snapshots_[i] = loadFrame(i);
     }
+    if (block == prefetchedBlock_) {
+      prefetchedBlock_ = -1;
+      prefetchedFrames_.clear();
+    }
     
     std::vector<int>::iterator j;
     j = std::find(activeBlocks_.begin(), activeBlocks_.end(), -1);
     assert(j != activeBlocks_.end());
     *j = block;    
-    ++activeRefCount_[j - activeBlocks_.begin()];
+    activeRefCount_[j - activeBlocks_.begin()] = 1;
+    lastUsed_[j - activeBlocks_.begin()] = ++useClock_;
   }
 
   void BlockSnapshotManager::internalUnload(int block) {
@@ -241,18 +297,24 @@ namespace OpenMD {
     j = std::find(activeBlocks_.begin(), activeBlocks_.end(), block);
     assert(j != activeBlocks_.end());
     *j = -1;
+    activeRefCount_[j - activeBlocks_.begin()] = 0;
   }
 
   bool BlockSnapshotManager::hasZeroRefBlock(){
-    return std::find(activeRefCount_.begin(), activeRefCount_.end(), 0)
-      != activeRefCount_.end() ?  true : false;
+    return getLeastRecentZeroRefBlock() != -1;
   }
   
-  int BlockSnapshotManager::getFirstZeroRefBlock(){
-    std::vector<int>::iterator i = std::find(activeRefCount_.begin(),
-                                             activeRefCount_.end(), 0);
-    return i != activeRefCount_.end() ?
-      activeBlocks_[i - activeRefCount_.begin()] : -1;
+  int BlockSnapshotManager::getLeastRecentZeroRefBlock(){
+    int result = -1;
+    long long int oldest = 0;
+    for (int i = 0; i < blockCapacity_; ++i) {
+      if (activeBlocks_[i] != -1 && activeRefCount_[i] == 0 &&
+          (result == -1 || lastUsed_[i] < oldest)) {
+        result = activeBlocks_[i];
+        oldest = lastUsed_[i];
+      }
+    }
+    return result;
   }
 
   std::vector<int> BlockSnapshotManager::getActiveBlocks() {
@@ -270,11 +332,38 @@ namespace OpenMD {
     snapshot->clearDerivedProperties();
     
     currentSnapshot_ = snapshot;   
-    reader_->readFrame(frame);
+    if (prefetchedBlock_ != -1 && frame >= blocks_[prefetchedBlock_].first &&
+        frame < blocks_[prefetchedBlock_].second &&
+        !prefetchedFrames_[frame - blocks_[prefetchedBlock_].first].empty()) {
+      reader_->readFrame(frame, prefetchedFrames_[frame -
+                                                  blocks_[prefetchedBlock_].first]);
+    } else {
+      reader_->readFrame(frame);
+    }
 
     return snapshot;
   }
 
+  int BlockSnapshotManager::getRequiredLayout(SimInfo* info, int requested) {
+    int simLayout = info->getStorageLayout();
+    int layout = requested | DataStorage::dslPosition;
+
+    // Reading positions also rebuilds the orientations, dipoles and
+    // quadrupoles of directional atoms and the atoms in rigid bodies,
+    // and the selections (and charge-based properties) look at the
+    // fluctuating charges:
+    layout |= simLayout & (DataStorage::dslAmat | DataStorage::dslDipole |
+                           DataStorage::dslQuadrupole |
+                           DataStorage::dslFlucQPosition);
+
+    // Rigid body velocities are propagated to their atoms using the
+    // angular momenta:
+    if (layout & DataStorage::dslVelocity)
+      layout |= simLayout & DataStorage::dslAngularMomentum;
+
+    return layout;
+  }
+
   int BlockSnapshotManager::getNFrames() {
     return reader_->getNFrames();
   }
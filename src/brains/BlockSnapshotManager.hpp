@@ -42,6 +42,8 @@
 #ifndef BRAINS_BLOCKSNAPSHOTMANAGER_HPP
 #define BRAINS_BLOCKSNAPSHOTMANAGER_HPP
 #include <vector>
+#include <string>
+#include <fstream>
 
 #include "brains/SnapshotManager.hpp"
 namespace OpenMD {
@@ -53,7 +55,14 @@ namespace OpenMD {
 
   /**
    * @class BlockSnapshotManager
-   * @todo document
+   * Holds the frames of a dump file in memory a block at a time.
+   *
+   * The memory budget is shared by blockCapacity blocks of parsed
+   * snapshots and the raw records of one prefetched block.  A block
+   * that has been unloaded stays cached until its space is needed,
+   * and then the least recently used unreferenced block is evicted.
+   * Snapshots only store the fields the analysis asked for (and the
+   * ones the DumpReader fills in along with them).
    */
   class BlockSnapshotManager : public SnapshotManager{
 
@@ -88,6 +97,22 @@ namespace OpenMD {
         
     bool unloadBlock(int block);
 
+    /**
+     * Reads the raw records of a block that will be loaded soon, so
+     * that the next loadBlock only has to parse them.  This does not
+     * touch any snapshots, so it can run on another thread while the
+     * active blocks are being analyzed, as long as no other member
+     * function is called until it returns.
+     */
+    void prefetchBlock(int block);
+
+    /**
+     * Returns the simulation's storage layout trimmed to the requested
+     * fields, plus the fields that are written along with them when
+     * a frame is read.
+     */
+    static int getRequiredLayout(SimInfo* info, int requested);
+
     std::vector<int> getActiveBlocks();
 
     int getBlockCapacity() {
@@ -104,7 +129,7 @@ namespace OpenMD {
 
     bool hasZeroRefBlock();
 
-    int getFirstZeroRefBlock();
+    int getLeastRecentZeroRefBlock();
 
     void internalLoad(int block);
     void internalUnload(int block);
@@ -118,6 +143,8 @@ namespace OpenMD {
     std::vector<SnapshotBlock> blocks_;        
     std::vector<int> activeBlocks_;
     std::vector<int> activeRefCount_;
+    std::vector<long long int> lastUsed_;  /**< use clock of each slot */
+    long long int useClock_;
         
     int nAtoms_;
     int nRigidBodies_;
@@ -128,6 +155,10 @@ namespace OpenMD {
     int nframes_;
     int nSnapshotPerBlock_;
 
+    std::ifstream* prefetchFile_;  /**< the prefetcher's own stream */
+    int prefetchedBlock_;          /**< block in prefetchedFrames_, or -1 */
+    std::vector<std::string> prefetchedFrames_;
+
   };
 
 }
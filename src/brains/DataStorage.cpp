@@ -230,6 +230,15 @@ namespace OpenMD {
       internalResize(sitePotential, newSize);
     }
 
+    if (storageLayout_ & dslComponentArrays) {
+      if (storageLayout_ & dslPosition)
+        internalResize(positionComponents, newSize);
+      if (storageLayout_ & dslVelocity)
+        internalResize(velocityComponents, newSize);
+      if (storageLayout_ & dslForce)
+        internalResize(forceComponents, newSize);
+    }
+
     size_ = newSize;
   }
 
@@ -305,6 +314,18 @@ namespace OpenMD {
     if (storageLayout_ & dslSitePotential) {
       sitePotential.reserve(size);
     }
+
+    if (storageLayout_ & dslComponentArrays) {
+      for (int i = 0; i < 3; i++) {
+        int which = dslPosition << i;
+        if (storageLayout_ & which) {
+          ComponentArrays* c = internalGetComponents(which);
+          c->x.reserve(size);
+          c->y.reserve(size);
+          c->z.reserve(size);
+        }
+      }
+    }
   }
 
   void DataStorage::copy(int source, std::size_t num, std::size_t target) {
@@ -382,6 +403,98 @@ namespace OpenMD {
     if (storageLayout_ & dslSitePotential) {
       internalCopy(sitePotential, source, num, target);
     }
+
+    if (storageLayout_ & dslComponentArrays) {
+      if (storageLayout_ & dslPosition)
+        internalCopy(positionComponents, source, num, target);
+      if (storageLayout_ & dslVelocity)
+        internalCopy(velocityComponents, source, num, target);
+      if (storageLayout_ & dslForce)
+        internalCopy(forceComponents, source, num, target);
+    }
+  }
+
+  void DataStorage::assign(const DataStorage& from, int whichArrays) {
+    if (size_ != from.size_) {
+      resize(from.size_);
+    }
+
+    int layout = whichArrays & storageLayout_ & from.storageLayout_;
+
+    if (layout & dslPosition) {
+      position = from.position;
+    }
+
+    if (layout & dslVelocity) {
+      velocity = from.velocity;
+    }
+
+    if (layout & dslForce) {
+      force = from.force;
+    }
+
+    if (layout & dslAmat) {
+      aMat = from.aMat;
+    }
+
+    if (layout & dslAngularMomentum) {
+      angularMomentum = from.angularMomentum;
+    }
+
+    if (layout & dslTorque) {
+      torque = from.torque;
+    }
+
+    if (layout & dslParticlePot) {
+      particlePot = from.particlePot;
+    }
+
+    if (layout & dslDensity) {
+      density = from.density;
+    }
+
+    if (layout & dslFunctional) {
+      functional = from.functional;
+    }
+
+    if (layout & dslFunctionalDerivative) {
+      functionalDerivative = from.functionalDerivative;
+    }
+
+    if (layout & dslDipole) {
+      dipole = from.dipole;
+    }
+
+    if (layout & dslQuadrupole) {
+      quadrupole = from.quadrupole;
+    }
+
+    if (layout & dslElectricField) {
+      electricField = from.electricField;
+    }
+
+    if (layout & dslSkippedCharge) {
+      skippedCharge = from.skippedCharge;
+    }
+
+    if (layout & dslFlucQPosition) {
+      flucQPos = from.flucQPos;
+    }
+
+    if (layout & dslFlucQVelocity) {
+      flucQVel = from.flucQVel;
+    }
+
+    if (layout & dslFlucQForce) {
+      flucQFrc = from.flucQFrc;
+    }
+
+    if (layout & dslSitePotential) {
+      sitePotential = from.sitePotential;
+    }
+
+    // The component arrays are scratch copies that are only as current
+    // as the last packComponents, so they are never carried over.
   }
 
   int DataStorage::getStorageLayout() {
@@ -456,6 +569,78 @@ namespace OpenMD {
     }
   }    
 
+  void DataStorage::packComponents(int whichArrays) {
+    if (!(storageLayout_ & dslComponentArrays)) return;
+
+    for (int i = 0; i < 3; i++) {
+      int which = dslPosition << i;
+      if (!(whichArrays & storageLayout_ & which)) continue;
+
+      const RealType* v = getArrayPointer(which);
+      ComponentArrays* c = internalGetComponents(which);
+      RealType* x = c->x.empty() ? NULL : &(c->x[0]);
+      RealType* y = c->y.empty() ? NULL : &(c->y[0]);
+      RealType* z = c->z.empty() ? NULL : &(c->z[0]);
+
+      for (std::size_t j = 0; j < size_; j++) {
+        x[j] = v[3*j];
+        y[j] = v[3*j + 1];
+        z[j] = v[3*j + 2];
+      }
+    }
+  }
+
+  void DataStorage::unpackComponents(int whichArrays) {
+    if (!(storageLayout_ & dslComponentArrays)) return;
+
+    for (int i = 0; i < 3; i++) {
+      int which = dslPosition << i;
+      if (!(whichArrays & storageLayout_ & which)) continue;
+
+      RealType* v = getArrayPointer(which);
+      ComponentArrays* c = internalGetComponents(which);
+      const RealType* x = c->x.empty() ? NULL : &(c->x[0]);
+      const RealType* y = c->y.empty() ? NULL : &(c->y[0]);
+      const RealType* z = c->z.empty() ? NULL : &(c->z[0]);
+
+      for (std::size_t j = 0; j < size_; j++) {
+        v[3*j] = x[j];
+        v[3*j + 1] = y[j];
+        v[3*j + 2] = z[j];
+      }
+    }
+  }
+
+  RealType* DataStorage::getComponentPointer(int whichArray, int component) {
+    ComponentArrays* c = internalGetComponents(whichArray);
+
+    if (c == NULL || c->x.empty()) return NULL;
+
+    switch (component) {
+    case 0:
+      return &(c->x[0]);
+    case 1:
+      return &(c->y[0]);
+    case 2:
+      return &(c->z[0]);
+    default:
+      return NULL;
+    }
+  }
+
+  DataStorage::ComponentArrays* DataStorage::internalGetComponents(int whichArray) {
+    switch (whichArray) {
+    case dslPosition:
+      return &positionComponents;
+    case dslVelocity:
+      return &velocityComponents;
+    case dslForce:
+      return &forceComponents;
+    default:
+      return NULL;
+    }
+  }
+
   RealType* DataStorage::internalGetArrayPointer(std::vector<Vector3d>& v) {
     if (v.empty()) {
       return NULL;
@@ -498,6 +683,23 @@ namespace OpenMD {
     }
   }
 
+  void DataStorage::internalResize(ComponentArrays& c, std::size_t newSize) {
+    c.x.resize(newSize, 0.0);
+    c.y.resize(newSize, 0.0);
+    c.z.resize(newSize, 0.0);
+  }
+
+  void DataStorage::internalCopy(ComponentArrays& c, int source,
+                                 std::size_t num, std::size_t target) {
+    // same half opened range as the template version below
+    std::copy(c.x.begin() + source, c.x.begin() + num + 1,
+              c.x.begin() + target);
+    std::copy(c.y.begin() + source, c.y.begin() + num + 1,
+              c.y.begin() + target);
+    std::copy(c.z.begin() + source, c.z.begin() + num + 1,
+              c.z.begin() + target);
+  }
+
   template<typename T>
   void DataStorage::internalCopy(std::vector<T>& v, int source,
                                  std::size_t num, std::size_t target) {
@@ -573,6 +775,17 @@ namespace OpenMD {
     if (layout & dslSitePotential) {
       bytes += sizeof(RealType);
     }
+    if (layout & dslComponentArrays) {
+      if (layout & dslPosition) {
+        bytes += 3 * sizeof(RealType);
+      }
+      if (layout & dslVelocity) {
+        bytes += 3 * sizeof(RealType);
+      }
+      if (layout & dslForce) {
+        bytes += 3 * sizeof(RealType);
+      }
+    }
 
     return bytes;
   }
@@ -53,6 +53,7 @@
 #include <vector>
 #include <math/Vector3.hpp>
 #include <math/SquareMatrix3.hpp>
+#include <utils/AlignedAllocator.hpp>
 
 using namespace std;
 namespace OpenMD {
@@ -84,7 +85,20 @@ namespace OpenMD {
       dslFlucQPosition = 16384,
       dslFlucQVelocity = 32768,
       dslFlucQForce = 65536,
-      dslSitePotential = 131072
+      dslSitePotential = 131072,
+      dslComponentArrays = 262144
+    };
+
+    typedef vector<RealType, AlignedAllocator<RealType> > AlignedArray;
+
+    /**
+     * Structure-of-arrays copy of a Vector3d array, with each
+     * Cartesian component in its own 64-byte aligned array.
+     */
+    struct ComponentArrays {
+      AlignedArray x;
+      AlignedArray y;
+      AlignedArray z;
     };
 
     DataStorage();
@@ -117,12 +131,44 @@ namespace OpenMD {
      * @param target
      */
     void copy(int source, std::size_t num, std::size_t target);
+    /**
+     * Copies whole arrays from another DataStorage of the same size.
+     * Only the arrays in whichArrays (a bitwise or of the dsl
+     * values) that both storages hold are copied; the others are
+     * left as they were.
+     *
+     * @param from DataStorage to copy from
+     * @param whichArrays arrays to copy
+     */
+    void assign(const DataStorage& from, int whichArrays);
     /** Returns the storage layout  */
     int getStorageLayout();
     /** Sets the storage layout  */
     void setStorageLayout(int layout);
     /** Returns the pointer of internal array */
     RealType *getArrayPointer(int whichArray);
+    /**
+     * Copies position, velocity, and/or force into their component
+     * arrays.  Only meaningful when dslComponentArrays is part of the
+     * storage layout.
+     *
+     * @param whichArrays bitwise or of dslPosition, dslVelocity and
+     * dslForce
+     */
+    void packComponents(int whichArrays);
+    /**
+     * Copies the component arrays back into position, velocity,
+     * and/or force.
+     *
+     * @param whichArrays bitwise or of dslPosition, dslVelocity and
+     * dslForce
+     */
+    void unpackComponents(int whichArrays);
+    /**
+     * Returns the aligned pointer to one Cartesian component (0, 1,
+     * or 2) of position, velocity, or force.
+     */
+    RealType *getComponentPointer(int whichArray, int component);
 
     vector<Vector3d> position;        /** position array */
     vector<Vector3d> velocity;        /** velocity array */
@@ -143,6 +189,17 @@ namespace OpenMD {
     vector<RealType> flucQFrc;        /** fluctuating charge forces */
     vector<RealType> sitePotential;   /** electrostatic site potentials */
 
+    /*
+     * With dslComponentArrays, the position, velocity and force
+     * arrays above remain the primary storage (every StuntDouble
+     * accessor goes through them), and these hold structure-of-arrays
+     * copies for vectorized loops.  They are only as current as the
+     * last call to packComponents.
+     */
+    ComponentArrays positionComponents;
+    ComponentArrays velocityComponents;
+    ComponentArrays forceComponents;
+
     static std::size_t getBytesPerStuntDouble(int layout);
 
   private:
@@ -150,6 +207,10 @@ namespace OpenMD {
     RealType* internalGetArrayPointer(vector<Vector3d>& v);
     RealType* internalGetArrayPointer(vector<Mat3x3d>& v);
     RealType* internalGetArrayPointer(vector<RealType>& v);
+    ComponentArrays* internalGetComponents(int whichArray);
+    void internalResize(ComponentArrays& c, std::size_t newSize);
+    void internalCopy(ComponentArrays& c, int source, std::size_t num,
+                      std::size_t target);
             
     template<typename T>
     void internalResize(std::vector<T>& v, std::size_t newSize);
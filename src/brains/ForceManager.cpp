@@ -60,19 +60,48 @@
 #include "perturbations/UniformField.hpp"
 #include "perturbations/UniformGradient.hpp"
 #include "parallel/ForceMatrixDecomposition.hpp"
+#include "parallel/SpatialDecomposition.hpp"
 
 #include <cstdio>
 #include <iostream>
 #include <iomanip>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 namespace OpenMD {
 
-  ForceManager::ForceManager(SimInfo * info) : initialized_(false), info_(info),
+  ForceManager::ForceManager(SimInfo * info) : initialized_(false),
+                                               forceGroups_(ALL_FORCES),
+                                               pairLoopTime_(0.0),
+                                               info_(info),
                                                switcher_(NULL), seleMan_(info), evaluator_(info) {
     forceField_ = info_->getForceField();
     interactionMan_ = new InteractionManager();
-    fDecomp_ = new ForceMatrixDecomposition(info_, interactionMan_);
+
+    // On a single processor, the force-matrix decomposition is
+    // already a single domain.
+    fDecomp_ = NULL;
+#ifdef IS_MPI
+    Globals* simParams = info_->getSimParams();
+    string decomp = toUpperCopy(simParams->getForceDecompositionMethod());
+    if (decomp == "SPATIAL") {
+      if (simParams->getUsePeriodicBoundaryConditions()) {
+        fDecomp_ = new SpatialDecomposition(info_, interactionMan_);
+      } else {
+        sprintf(painCave.errMsg,
+                "ForceManager: The SPATIAL forceDecomposition needs a\n"
+                "\tperiodic box.  OpenMD will use FORCE_MATRIX instead.\n");
+        painCave.severity = OPENMD_WARNING;
+        painCave.isFatal = 0;
+        simError();
+      }
+    }
+#endif
+    if (fDecomp_ == NULL)
+      fDecomp_ = new ForceMatrixDecomposition(info_, interactionMan_);
     thermo = new Thermo(info_);
   }
 
@@ -271,6 +300,15 @@ namespace OpenMD {
       }
     }
 
+    // The reciprocal space sum is needed for the full Ewald sum, and
+    // for the smooth particle mesh Ewald electrostatics:
+
+    doReciprocalSum_ = (cutoffMethod_ == EWALD_FULL);
+    if (simParams_->haveElectrostaticSummationMethod()) {
+      string esm = toUpperCopy(simParams_->getElectrostaticSummationMethod());
+      if (esm == "EWALD_SPME") doReciprocalSum_ = true;
+    }
+
     // create the switching function object:
 
     switcher_ = new SwitchingFunction();
@@ -415,6 +453,24 @@ namespace OpenMD {
 
     fDecomp_->distributeInitialData();
 
+    // The non-bonded pair loop is shared among OpenMP threads
+    // (OMP_NUM_THREADS).
+    nThreads_ = 1;
+#ifdef _OPENMP
+    nThreads_ = omp_get_max_threads();
+#endif
+    fDecomp_->setNumThreads(nThreads_);
+
+    useAtomPairList_ = info_->getSimParams()->getUseAtomPairList();
+    atomPairs_.start.clear();
+
+    // the density cache is aligned with the atom pair list, and is
+    // only useful when there is a density (prepair) pass:
+    useDensityCache_ = info_->getSimParams()->getUseDensityCache() &&
+      info_->requiresPrepair();
+    if (useDensityCache_) useAtomPairList_ = true;
+    densityCacheFilled_ = false;
+
     doPotentialSelection_ = false;
     if (info_->getSimParams()->havePotentialSelection()) {
       doPotentialSelection_ = true;
@@ -431,8 +487,23 @@ namespace OpenMD {
   }
 
   void ForceManager::calcForces() {
+    calcForceGroups(ALL_FORCES);
+  }
+
+  void ForceManager::calcForceGroups(int groups) {
 
     if (!initialized_) initialize();
+
+    forceGroups_ = groups;
+
+    // refresh the structure-of-arrays copies of the coordinates for
+    // any vectorized consumers during this force evaluation:
+    if (info_->getStorageLayout() & DataStorage::dslComponentArrays) {
+      Snapshot* snap = info_->getSnapshotManager()->getCurrentSnapshot();
+      snap->atomData.packComponents(DataStorage::dslPosition |
+                                    DataStorage::dslVelocity);
+    }
+
     preCalculation();
     shortRangeInteractions();
     longRangeInteractions();
@@ -454,16 +525,36 @@ namespace OpenMD {
 
     Snapshot* snap = info_->getSnapshotManager()->getCurrentSnapshot();
 
-    snap->setBondPotential(0.0);
-    snap->setBendPotential(0.0);
-    snap->setTorsionPotential(0.0);
-    snap->setInversionPotential(0.0);
+    // only the potentials of the force groups being evaluated are
+    // zeroed; the others keep their values from an earlier evaluation.
+
+    potVec selectionPotential(0.0);
+    if (doPotentialSelection_ && forceGroups_ != ALL_FORCES)
+      selectionPotential = snap->getSelectionPotentials();
+
+    if (forceGroups_ & BONDED_FORCES) {
+      snap->setBondPotential(0.0);
+      snap->setBendPotential(0.0);
+      snap->setTorsionPotential(0.0);
+      snap->setInversionPotential(0.0);
+      selectionPotential[BONDED_FAMILY] = 0.0;
+    }
+
+    if (forceGroups_ & PAIR_FORCES) {
+      potVec zeroPot(0.0);
+      snap->setLongRangePotential(zeroPot);
+      snap->setExcludedPotentials(zeroPot);
+      for (int i = 0; i < N_INTERACTION_FAMILIES; i++)
+        if (i != BONDED_FAMILY) selectionPotential[i] = 0.0;
+    }
+
+    if (forceGroups_ & RECIPROCAL_FORCES) {
+      snap->setReciprocalPotential(0.0);
+      snap->setSurfacePotential(0.0);
+    }
 
-    potVec zeroPot(0.0);
-    snap->setLongRangePotential(zeroPot);
-    snap->setExcludedPotentials(zeroPot);
     if (doPotentialSelection_)
-      snap->setSelectionPotentials(zeroPot);
+      snap->setSelectionPotentials(selectionPotential);
 
     snap->setRestraintPotential(0.0);
     snap->setRawPotential(0.0);
@@ -493,7 +584,8 @@ namespace OpenMD {
     // Zero out the virial tensor
     virialTensor *= 0.0;
     // Zero out the heatFlux
-    fDecomp_->setHeatFlux( Vector3d(0.0) );
+    if (forceGroups_ & PAIR_FORCES)
+      fDecomp_->setHeatFlux( Vector3d(0.0) );
 
     if (doPotentialSelection_) {
       if (evaluator_.isDynamic()) {
@@ -532,6 +624,8 @@ namespace OpenMD {
         rb->updateAtoms();
       }
 
+      if (!(forceGroups_ & BONDED_FORCES)) continue;
+
       for (bond = mol->beginBond(bondIter); bond != NULL;
            bond = mol->nextBond(bondIter)) {
         bond->calcForce(doParticlePot_);
@@ -642,6 +736,8 @@ namespace OpenMD {
       }
     }
 
+    if (!(forceGroups_ & BONDED_FORCES)) return;
+
 #ifdef IS_MPI
     // Collect from all nodes.  This should eventually be moved into a
     // SystemDecomposition, but this is a better place than in
@@ -665,7 +761,11 @@ namespace OpenMD {
     curSnapshot->setBendPotential(bendPotential);
     curSnapshot->setTorsionPotential(torsionPotential);
     curSnapshot->setInversionPotential(inversionPotential);
-    curSnapshot->setSelectionPotentials(selectionPotential);
+    if (doPotentialSelection_) {
+      potVec selePot = curSnapshot->getSelectionPotentials();
+      selePot[BONDED_FAMILY] = selectionPotential[BONDED_FAMILY];
+      curSnapshot->setSelectionPotentials(selePot);
+    }
 
     // RealType shortRangePotential = bondPotential + bendPotential +
     //   torsionPotential +  inversionPotential;
@@ -679,6 +779,16 @@ namespace OpenMD {
     DataStorage* config = &(curSnapshot->atomData);
     DataStorage* cgConfig = &(curSnapshot->cgData);
 
+    if (!(forceGroups_ & PAIR_FORCES)) {
+      if ((forceGroups_ & RECIPROCAL_FORCES) && doReciprocalSum_) {
+        RealType reciprocalPotential(0.0);
+        interactionMan_->doReciprocalSpaceSum(reciprocalPotential,
+                                              virialTensor);
+        curSnapshot->setReciprocalPotential(reciprocalPotential);
+      }
+      return;
+    }
+
     //calculate the center of mass of cutoff group
 
     SimInfo::MoleculeIterator mi;
@@ -701,65 +811,22 @@ namespace OpenMD {
       cgConfig->velocity = config->velocity;
     }
 
+    // the row and column data are in flight while the work arrays
+    // are zeroed and the neighbor list is checked
+    fDecomp_->beginDistributeData();
     fDecomp_->zeroWorkArrays();
-    fDecomp_->distributeData();
-
-    int cg1, cg2, atom1, atom2, topoDist;
-    Vector3d d_grp, dag, d, gvel2, vel2;
-    RealType rgrpsq, rgrp, r2, r;
-    RealType electroMult, vdwMult;
-    RealType vij(0.0);
-    Vector3d fij, fg, f1;
-    bool in_switching_region;
-    RealType sw, dswdr, swderiv;
-    vector<int> atomListColumn, atomListRow;
-    InteractionData idat;
+
     SelfData sdat;
-    RealType mf;
-    RealType vpair;
-    RealType dVdFQ1(0.0);
-    RealType dVdFQ2(0.0);
-    potVec longRangePotential(0.0);
     RealType reciprocalPotential(0.0);
     RealType surfacePotential(0.0);
-    potVec workPot(0.0);
-    potVec exPot(0.0);
+    potVec longRangePotential(0.0);
     potVec selectionPotential(0.0);
-    Vector3d eField1(0.0);
-    Vector3d eField2(0.0);
-    RealType sPot1(0.0);
-    RealType sPot2(0.0);
-    bool newAtom1;
-    int gid1, gid2;
-
-    vector<int>::iterator ia, jb;
-
+    int gid1;
     int loopStart, loopEnd;
 
-    idat.rcut = &rCut_;
-    idat.vdwMult = &vdwMult;
-    idat.electroMult = &electroMult;
-    idat.pot = &workPot;
-    idat.excludedPot = &exPot;
-    idat.selePot = &selectionPotential;
     sdat.selfPot = fDecomp_->getSelfPotential();
     sdat.excludedPot = fDecomp_->getExcludedSelfPotential();
     sdat.selePot = fDecomp_->getSelectedSelfPotential();
-    idat.vpair = &vpair;
-    idat.dVdFQ1 = &dVdFQ1;
-    idat.dVdFQ2 = &dVdFQ2;
-    idat.eField1 = &eField1;
-    idat.eField2 = &eField2;
-    idat.sPot1 = &sPot1;
-    idat.sPot2 = &sPot2;
-    idat.f1 = &f1;
-    idat.sw = &sw;
-    idat.shiftedPot = (cutoffMethod_ == SHIFTED_POTENTIAL) ? true : false;
-    idat.shiftedForce = (cutoffMethod_ == SHIFTED_FORCE ||
-                         cutoffMethod_ == TAYLOR_SHIFTED) ? true : false;
-    idat.doParticlePot = doParticlePot_;
-    idat.doElectricField = doElectricField_;
-    idat.doSitePotential = doSitePotential_;
     sdat.doParticlePot = doParticlePot_;
 
     loopEnd = PAIR_LOOP;
@@ -772,14 +839,144 @@ namespace OpenMD {
 
       if (iLoop == loopStart) {
         bool update_nlist = fDecomp_->checkNeighborList();
+        fDecomp_->finishDistributeData();
         if (update_nlist) {
           if (!usePeriodicBoundaryConditions_)
             Mat3x3d bbox = thermo->getBoundingBox();
           fDecomp_->buildNeighborList(neighborList_, point_);
+          if (useAtomPairList_) buildAtomPairList();
         }
       }
 
-      for (cg1 = 0; cg1 < int(point_.size()) - 1; cg1++) {
+      pairLoop(iLoop);
+
+      if (iLoop == PREPAIR_LOOP) {
+        if (info_->requiresPrepair()) {
+
+          fDecomp_->collectIntermediateData();
+
+          for (unsigned int atom1 = 0; atom1 < info_->getNAtoms(); atom1++) {
+            if (doPotentialSelection_) {
+              gid1 = fDecomp_->getGlobalID(atom1);
+              sdat.isSelected = seleMan_.isGlobalIDSelected(gid1);
+            }
+
+            fDecomp_->fillSelfData(sdat, atom1);
+            interactionMan_->doPreForce(sdat);
+          }
+
+          fDecomp_->distributeIntermediateData();
+
+        }
+      }
+    }
+
+    // collects pairwise information, overlapping the exchange with
+    // the reciprocal space sum which only adds to the local forces
+    fDecomp_->beginCollectData();
+    if ((forceGroups_ & RECIPROCAL_FORCES) && doReciprocalSum_) {
+      interactionMan_->doReciprocalSpaceSum(reciprocalPotential,
+                                            virialTensor);
+      curSnapshot->setReciprocalPotential(reciprocalPotential);
+
+      // interactionMan_->doSurfaceTerm(surfacePotential);
+      curSnapshot->setSurfacePotential(surfacePotential);
+    }
+    fDecomp_->finishCollectData();
+
+    if (info_->requiresSelfCorrection()) {
+      for (unsigned int atom1 = 0; atom1 < info_->getNAtoms(); atom1++) {
+        if (doPotentialSelection_) {
+          gid1 = fDecomp_->getGlobalID(atom1);
+          sdat.isSelected = seleMan_.isGlobalIDSelected(gid1);
+        }
+
+        fDecomp_->fillSelfData(sdat, atom1);
+        interactionMan_->doSelfCorrection(sdat);
+      }
+    }
+
+    // collects single-atom information
+    fDecomp_->collectSelfData();
+
+    longRangePotential = *(fDecomp_->getSelfPotential()) +
+      *(fDecomp_->getPairwisePotential());
+
+    curSnapshot->setLongRangePotential(longRangePotential);
+
+    curSnapshot->setExcludedPotentials(*(fDecomp_->getExcludedSelfPotential()) +
+                                       *(fDecomp_->getExcludedPotential()));
+
+    if (doPotentialSelection_) {
+      selectionPotential  = curSnapshot->getSelectionPotentials();
+      selectionPotential += *(fDecomp_->getSelectedSelfPotential());
+      selectionPotential += *(fDecomp_->getSelectedPotential());
+      curSnapshot->setSelectionPotentials(selectionPotential);
+    }
+  }
+
+  /**
+   * Makes a single pass (PREPAIR_LOOP or PAIR_LOOP) over the
+   * non-bonded pairs, through either the atom pair list or the
+   * cutoff group neighbor list.  In parallel, the time spent here is
+   * accumulated for reportLoadBalance.
+   */
+  void ForceManager::pairLoop(int iLoop) {
+#ifdef IS_MPI
+    double loopStartTime = MPI_Wtime();
+#endif
+
+    if (useAtomPairList_)
+      atomPairLoop(iLoop);
+    else
+      groupPairLoop(iLoop);
+
+#ifdef IS_MPI
+    pairLoopTime_ += MPI_Wtime() - loopStartTime;
+#endif
+  }
+
+  /**
+   * Makes a single pass (PREPAIR_LOOP or PAIR_LOOP) through the
+   * cutoff group neighbor list.  The row cutoff groups are shared
+   * among nThreads_ threads.  Each thread keeps its own interaction
+   * data, virial, and heat flux, and the force decomposition routes
+   * the per-atom quantities accumulated by each thread into private
+   * work arrays that are reduced at the end of the pass.
+   */
+  void ForceManager::groupPairLoop(int iLoop) {
+
+    int nGroupsInRow = int(point_.size()) - 1;
+    Vector3d heatFlux(0.0);
+
+    fDecomp_->setPrePairLoop(iLoop == PREPAIR_LOOP);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nThreads_)
+#endif
+    {
+      int tid = 0;
+#ifdef _OPENMP
+      tid = omp_get_thread_num();
+#endif
+      int cg1, cg2, atom1, atom2, topoDist;
+      Vector3d d_grp, gvel2;
+      RealType rgrpsq, rgrp;
+      bool in_switching_region, singleAtoms;
+      RealType dswdr;
+      vector<int> atomListColumn, atomListRow;
+      bool newAtom1;
+      int gid1, gid2;
+      PairWork w;
+
+      vector<int>::iterator ia, jb;
+
+      setupPairWork(w);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+      for (cg1 = 0; cg1 < nGroupsInRow; cg1++) {
 
         atomListRow = fDecomp_->getAtomsInGroupRow(cg1);
         newAtom1 = true;
@@ -795,19 +992,14 @@ namespace OpenMD {
           rgrpsq = d_grp.lengthSquare();
 
           if (rgrpsq < rCutSq_) {
-            if (iLoop == PAIR_LOOP) {
-              vij = 0.0;
-              fij.zero();
-              eField1.zero();
-              eField2.zero();
-              sPot1 = 0.0;
-              sPot2 = 0.0;
-            }
+            if (iLoop == PAIR_LOOP) clearGroupPair(w);
 
-            in_switching_region = switcher_->getSwitch(rgrpsq, sw, dswdr,
+            in_switching_region = switcher_->getSwitch(rgrpsq, w.sw, dswdr,
                                                        rgrp);
 
             atomListColumn = fDecomp_->getAtomsInGroupColumn(cg2);
+            singleAtoms = (atomListRow.size() == 1 &&
+                           atomListColumn.size() == 1);
 
             if (doHeatFlux_)
               gvel2 = fDecomp_->getGroupVelocityColumn(cg2);
@@ -818,7 +1010,7 @@ namespace OpenMD {
 
               if (doPotentialSelection_) {
                 gid1 = fDecomp_->getGlobalIDRow(atom1);
-                idat.isSelected = seleMan_.isGlobalIDSelected(gid1);
+                w.idat.isSelected = seleMan_.isGlobalIDSelected(gid1);
               }
 
               for (jb = atomListColumn.begin();
@@ -827,192 +1019,553 @@ namespace OpenMD {
 
                 if (doPotentialSelection_) {
                   gid2 = fDecomp_->getGlobalIDCol(atom2);
-                  idat.isSelected |= seleMan_.isGlobalIDSelected(gid2);
+                  w.idat.isSelected |= seleMan_.isGlobalIDSelected(gid2);
                 }
 
                 if (!fDecomp_->skipAtomPair(atom1, atom2, cg1, cg2)) {
 
-                  vpair = 0.0;
-                  workPot = 0.0;
-                  exPot = 0.0;
-                  selectionPotential = 0.0;
-                  f1.zero();
-                  dVdFQ1 = 0.0;
-                  dVdFQ2 = 0.0;
-
-                  fDecomp_->fillInteractionData(idat, atom1, atom2, newAtom1);
-
+                  w.idat.excluded = fDecomp_->excludeAtomPair(atom1, atom2);
                   topoDist = fDecomp_->getTopologicalDistance(atom1, atom2);
-                  vdwMult = vdwScale_[topoDist];
-                  electroMult = electrostaticScale_[topoDist];
-
-                  if (atomListRow.size() == 1 && atomListColumn.size() == 1) {
-                    idat.d = &d_grp;
-                    idat.r2 = &rgrpsq;
-                    if (doHeatFlux_)
-                      vel2 = gvel2;
-                  } else {
-                    d = fDecomp_->getInteratomicVector(atom1, atom2);
-                    curSnapshot->wrapVector( d );
-                    r2 = d.lengthSquare();
-                    idat.d = &d;
-                    idat.r2 = &r2;
-                    if (doHeatFlux_)
-                      vel2 = fDecomp_->getAtomVelocityColumn(atom2);
-                  }
-
-                  r = sqrt( *(idat.r2) );
-                  idat.rij = &r;
-
-                  if (iLoop == PREPAIR_LOOP) {
-                    interactionMan_->doPrePair(idat);
-                  } else {
-                    interactionMan_->doPair(idat);
-                    fDecomp_->unpackInteractionData(idat, atom1, atom2);
-                    vij += vpair;
-                    fij += f1;
-                    virialTensor -= outProduct( *(idat.d), f1);
-                    if (doHeatFlux_)
-                      fDecomp_->addToHeatFlux(*(idat.d) * dot(f1, vel2));
-                  }
+                  w.vdwMult = vdwScale_[topoDist];
+                  w.electroMult = electrostaticScale_[topoDist];
+
+                  calcAtomPair(w, iLoop, atom1, atom2, newAtom1, singleAtoms,
+                               d_grp, rgrpsq, gvel2, tid);
                 }
               }
             }
 
-            if (iLoop == PAIR_LOOP) {
-              if (in_switching_region) {
-                swderiv = vij * dswdr / rgrp;
-                fg = swderiv * d_grp;
-                fij += fg;
-
-                if (atomListRow.size() == 1 && atomListColumn.size() == 1) {
-                  if (!fDecomp_->skipAtomPair(atomListRow[0],
-                                              atomListColumn[0],
-                                              cg1, cg2)) {
-                  virialTensor -= outProduct( *(idat.d), fg);
-                  if (doHeatFlux_)
-                    fDecomp_->addToHeatFlux(*(idat.d) * dot(fg, vel2));
-                  }
-                }
-
-                for (ia = atomListRow.begin();
-                     ia != atomListRow.end(); ++ia) {
-                  atom1 = (*ia);
-                  mf = fDecomp_->getMassFactorRow(atom1);
-                  // fg is the force on atom ia due to cutoff group's
-                  // presence in switching region
-                  fg = swderiv * d_grp * mf;
-                  fDecomp_->addForceToAtomRow(atom1, fg);
-                  if (atomListRow.size() > 1) {
-                    if (info_->usesAtomicVirial()) {
-                      // find the distance between the atom
-                      // and the center of the cutoff group:
-                      dag = fDecomp_->getAtomToGroupVectorRow(atom1, cg1);
-                      virialTensor -= outProduct(dag, fg);
-                      if (doHeatFlux_)
-                        fDecomp_->addToHeatFlux( dag * dot(fg, vel2));
-                    }
-                  }
-                }
-                for (jb = atomListColumn.begin();
-                     jb != atomListColumn.end(); ++jb) {
-                  atom2 = (*jb);
-                  mf = fDecomp_->getMassFactorColumn(atom2);
-                  // fg is the force on atom jb due to cutoff group's
-                  // presence in switching region
-                  fg = -swderiv * d_grp * mf;
-                  fDecomp_->addForceToAtomColumn(atom2, fg);
-
-                  if (atomListColumn.size() > 1) {
-                    if (info_->usesAtomicVirial()) {
-                      // find the distance between the atom
-                      // and the center of the cutoff group:
-                      dag = fDecomp_->getAtomToGroupVectorColumn(atom2, cg2);
-                      virialTensor -= outProduct(dag, fg);
-                      if (doHeatFlux_)
-                        fDecomp_->addToHeatFlux( dag * dot(fg, vel2));
-                    }
-                  }
-                }
-              }
-              //if (!info_->usesAtomicVirial()) {
-              //  virialTensor -= outProduct(d_grp, fij);
-              //  if (doHeatFlux_)
-              //     fDecomp_->addToHeatFlux( d_grp * dot(fij, vel2));
-              //}
+            if (iLoop == PAIR_LOOP && in_switching_region) {
+              // a lone pair that the decomposition skips has no
+              // pair vector to carry the switching virial:
+              bool pairVirial = singleAtoms &&
+                !fDecomp_->skipAtomPair(atomListRow[0], atomListColumn[0],
+                                        cg1, cg2);
+              addSwitchingForces(w, cg1, cg2, pairVirial, d_grp, rgrp,
+                                 dswdr, tid);
             }
           }
         }
         newAtom1 = false;
       }
 
-      if (iLoop == PREPAIR_LOOP) {
-        if (info_->requiresPrepair()) {
+#ifdef _OPENMP
+#pragma omp critical (ForceManagerPairLoop)
+#endif
+      {
+        virialTensor += w.virial;
+        heatFlux += w.heatFlux;
+      }
+    }
 
-          fDecomp_->collectIntermediateData();
+    if (doHeatFlux_) fDecomp_->addToHeatFlux(heatFlux);
+    fDecomp_->reduceThreadData();
+  }
 
-          for (unsigned int atom1 = 0; atom1 < info_->getNAtoms(); atom1++) {
-            if (doPotentialSelection_) {
-              gid1 = fDecomp_->getGlobalID(atom1);
-              sdat.isSelected = seleMan_.isGlobalIDSelected(gid1);
-            }
+  /**
+   * Points the interaction data of a pair loop thread at the scratch
+   * values in w, and clears the thread's virial and heat flux.
+   */
+  void ForceManager::setupPairWork(PairWork& w) {
+    InteractionData& idat = w.idat;
+
+    w.snapshot = info_->getSnapshotManager()->getCurrentSnapshot();
+    w.vij = 0.0;
+    w.virial = Mat3x3d(0.0);
+    w.heatFlux = V3Zero;
+    w.dVdFQ1 = 0.0;
+    w.dVdFQ2 = 0.0;
+    w.sPot1 = 0.0;
+    w.sPot2 = 0.0;
 
-            fDecomp_->fillSelfData(sdat, atom1);
-            interactionMan_->doPreForce(sdat);
-          }
+    idat.rcut = &rCut_;
+    idat.vdwMult = &w.vdwMult;
+    idat.electroMult = &w.electroMult;
+    idat.pot = &w.workPot;
+    idat.excludedPot = &w.exPot;
+    idat.selePot = &w.selectionPotential;
+    idat.vpair = &w.vpair;
+    idat.dVdFQ1 = &w.dVdFQ1;
+    idat.dVdFQ2 = &w.dVdFQ2;
+    idat.eField1 = &w.eField1;
+    idat.eField2 = &w.eField2;
+    idat.sPot1 = &w.sPot1;
+    idat.sPot2 = &w.sPot2;
+    idat.f1 = &w.f1;
+    idat.sw = &w.sw;
+    idat.shiftedPot = (cutoffMethod_ == SHIFTED_POTENTIAL) ? true : false;
+    idat.shiftedForce = (cutoffMethod_ == SHIFTED_FORCE ||
+                         cutoffMethod_ == TAYLOR_SHIFTED) ? true : false;
+    idat.doParticlePot = doParticlePot_;
+    idat.doElectricField = doElectricField_;
+    idat.doSitePotential = doSitePotential_;
+    idat.isSelected = false;
+    idat.pairDensity = NULL;
+  }
 
-          fDecomp_->distributeIntermediateData();
+  /**
+   * Clears the values that accumulate over the atom pairs of one
+   * cutoff group pair in the force pass.
+   */
+  void ForceManager::clearGroupPair(PairWork& w) {
+    w.vij = 0.0;
+    w.fij.zero();
+    w.eField1.zero();
+    w.eField2.zero();
+    w.sPot1 = 0.0;
+    w.sPot2 = 0.0;
+  }
+
+  /**
+   * Evaluates one atom pair of the cutoff group pair separated by
+   * d_grp.  The caller has already set the exclusion, selection and
+   * density cache fields of w.idat and the topological multipliers.
+   * In the force pass, the results are handed to the force
+   * decomposition and added to the group pair's vij and fij and to
+   * the thread's virial and heat flux.
+   */
+  void ForceManager::calcAtomPair(PairWork& w, int iLoop, int atom1,
+                                  int atom2, bool newAtom1, bool singleAtoms,
+                                  Vector3d& d_grp, RealType& rgrpsq,
+                                  const Vector3d& gvel2, int tid) {
+    InteractionData& idat = w.idat;
+
+    w.vpair = 0.0;
+    w.workPot = 0.0;
+    w.exPot = 0.0;
+    w.selectionPotential = 0.0;
+    w.f1.zero();
+    w.dVdFQ1 = 0.0;
+    w.dVdFQ2 = 0.0;
+
+    fDecomp_->fillInteractionData(idat, atom1, atom2, newAtom1, tid);
+
+    if (singleAtoms) {
+      idat.d = &d_grp;
+      idat.r2 = &rgrpsq;
+      if (doHeatFlux_)
+        w.vel2 = gvel2;
+    } else {
+      w.d = fDecomp_->getInteratomicVector(atom1, atom2);
+      w.snapshot->wrapVector( w.d );
+      w.r2 = w.d.lengthSquare();
+      idat.d = &w.d;
+      idat.r2 = &w.r2;
+      if (doHeatFlux_)
+        w.vel2 = fDecomp_->getAtomVelocityColumn(atom2);
+    }
+
+    w.r = sqrt( *(idat.r2) );
+    idat.rij = &w.r;
+
+    if (iLoop == PREPAIR_LOOP) {
+      interactionMan_->doPrePair(idat);
+    } else {
+      interactionMan_->doPair(idat);
+      fDecomp_->unpackInteractionData(idat, atom1, atom2, tid);
+      w.vij += w.vpair;
+      w.fij += w.f1;
+      w.virial -= outProduct( *(idat.d), w.f1);
+      if (doHeatFlux_)
+        w.heatFlux += *(idat.d) * dot(w.f1, w.vel2);
+    }
+  }
 
+  /**
+   * Distributes the force from the switching function over the atoms
+   * of a cutoff group pair in the switching region, using the
+   * group pair's accumulated vij.  When pairVirial is set, the two
+   * groups are a single atom pair and the switching force enters the
+   * virial along the pair vector.
+   */
+  void ForceManager::addSwitchingForces(PairWork& w, int cg1, int cg2,
+                                        bool pairVirial,
+                                        const Vector3d& d_grp, RealType rgrp,
+                                        RealType dswdr, int tid) {
+    vector<int>::iterator ia, jb;
+    int atom1, atom2;
+    RealType mf;
+    Vector3d fg, dag;
+
+    RealType swderiv = w.vij * dswdr / rgrp;
+    fg = swderiv * d_grp;
+    w.fij += fg;
+
+    if (pairVirial) {
+      w.virial -= outProduct(d_grp, fg);
+      if (doHeatFlux_)
+        w.heatFlux += d_grp * dot(fg, w.vel2);
+    }
+
+    vector<int>& atomListRow = fDecomp_->getAtomsInGroupRow(cg1);
+    vector<int>& atomListColumn = fDecomp_->getAtomsInGroupColumn(cg2);
+
+    for (ia = atomListRow.begin(); ia != atomListRow.end(); ++ia) {
+      atom1 = (*ia);
+      mf = fDecomp_->getMassFactorRow(atom1);
+      // fg is the force on atom ia due to cutoff group's
+      // presence in switching region
+      fg = swderiv * d_grp * mf;
+      fDecomp_->addForceToAtomRow(atom1, fg, tid);
+      if (atomListRow.size() > 1) {
+        if (info_->usesAtomicVirial()) {
+          // find the distance between the atom
+          // and the center of the cutoff group:
+          dag = fDecomp_->getAtomToGroupVectorRow(atom1, cg1);
+          w.virial -= outProduct(dag, fg);
+          if (doHeatFlux_)
+            w.heatFlux += dag * dot(fg, w.vel2);
+        }
+      }
+    }
+    for (jb = atomListColumn.begin(); jb != atomListColumn.end(); ++jb) {
+      atom2 = (*jb);
+      mf = fDecomp_->getMassFactorColumn(atom2);
+      // fg is the force on atom jb due to cutoff group's
+      // presence in switching region
+      fg = -swderiv * d_grp * mf;
+      fDecomp_->addForceToAtomColumn(atom2, fg, tid);
+      if (atomListColumn.size() > 1) {
+        if (info_->usesAtomicVirial()) {
+          // find the distance between the atom
+          // and the center of the cutoff group:
+          dag = fDecomp_->getAtomToGroupVectorColumn(atom2, cg2);
+          w.virial -= outProduct(dag, fg);
+          if (doHeatFlux_)
+            w.heatFlux += dag * dot(fg, w.vel2);
         }
       }
     }
+  }
 
-    // collects pairwise information
-    fDecomp_->collectData();
-    if (cutoffMethod_ == EWALD_FULL) {
-      interactionMan_->doReciprocalSpaceSum(reciprocalPotential);
-      curSnapshot->setReciprocalPotential(reciprocalPotential);
+  /**
+   * Compares the pair loop time of the slowest processor with the
+   * average over all processors.
+   */
+  void ForceManager::reportLoadBalance() {
+#ifdef IS_MPI
+    int nProcessors;
+    double slowest, total;
+    MPI_Comm_size(MPI_COMM_WORLD, &nProcessors);
+    MPI_Allreduce(&pairLoopTime_, &slowest, 1, MPI_DOUBLE, MPI_MAX,
+                  MPI_COMM_WORLD);
+    MPI_Allreduce(&pairLoopTime_, &total, 1, MPI_DOUBLE, MPI_SUM,
+                  MPI_COMM_WORLD);
+
+    if (nProcessors < 2 || total <= 0.0) return;
+
+    sprintf(painCave.errMsg,
+            "ForceManager: the slowest processor spent %.2f s in the pair\n"
+            "\tloop, %.3f times the average of %.2f s.  Restarting from the\n"
+            "\tend-of-run file with balanceMolecules = true redistributes\n"
+            "\tthe molecules for the current configuration.\n",
+            slowest, slowest * nProcessors / total, total / nProcessors);
+    painCave.isFatal = 0;
+    painCave.severity = OPENMD_INFO;
+    simError();
+#endif
+  }
 
-      // interactionMan_->doSurfaceTerm(surfacePotential);
-      curSnapshot->setSurfacePotential(surfacePotential);
+  /**
+   * Builds the atom-level Verlet list from the current cutoff group
+   * neighbor list.  Everything about a pair that does not change
+   * between neighbor list updates (whether the decomposition skips
+   * it, whether it is excluded, and its topological multipliers) is
+   * looked up here once.
+   */
+  void ForceManager::buildAtomPairList() {
+    int nGroupsInRow = int(point_.size()) - 1;
+    int cg2, topoDist;
+    vector<int>::iterator ia, jb;
+
+    atomPairs_.cg1.clear();
+    atomPairs_.cg2.clear();
+    atomPairs_.start.clear();
+    atomPairs_.singleAtoms.clear();
+    atomPairs_.batch.clear();
+    atomPairs_.atom1.clear();
+    atomPairs_.atom2.clear();
+    atomPairs_.excluded.clear();
+    atomPairs_.vdwMult.clear();
+    atomPairs_.electroMult.clear();
+
+    atomPairs_.start.push_back(0);
+
+    for (int cg1 = 0; cg1 < nGroupsInRow; cg1++) {
+      vector<int>& atomListRow = fDecomp_->getAtomsInGroupRow(cg1);
+
+      for (int m2 = point_[cg1]; m2 < point_[cg1+1]; m2++) {
+        cg2 = neighborList_[m2];
+        vector<int>& atomListColumn = fDecomp_->getAtomsInGroupColumn(cg2);
+
+        for (ia = atomListRow.begin(); ia != atomListRow.end(); ++ia) {
+          for (jb = atomListColumn.begin(); jb != atomListColumn.end(); ++jb) {
+            if (fDecomp_->skipAtomPair(*ia, *jb, cg1, cg2)) continue;
+
+            topoDist = fDecomp_->getTopologicalDistance(*ia, *jb);
+            atomPairs_.atom1.push_back(*ia);
+            atomPairs_.atom2.push_back(*jb);
+            atomPairs_.excluded.push_back(fDecomp_->excludeAtomPair(*ia, *jb));
+            atomPairs_.vdwMult.push_back(vdwScale_[topoDist]);
+            atomPairs_.electroMult.push_back(electrostaticScale_[topoDist]);
+          }
+        }
+
+        // group pairs without any surviving atom pairs contribute
+        // nothing (not even switching forces), so they are dropped:
+        if (int(atomPairs_.atom1.size()) > atomPairs_.start.back()) {
+          bool singleAtoms = (atomListRow.size() == 1 &&
+                              atomListColumn.size() == 1);
+
+          // a lone, non-excluded pair with a single van der Waals
+          // interaction can be evaluated in packed batches:
+          NonBondedInteraction* batch = NULL;
+          if (singleAtoms && !doPotentialSelection_ &&
+              !atomPairs_.excluded.back()) {
+            batch = interactionMan_->getBatchInteraction(
+                      fDecomp_->getAtypeIdentRow(atomListRow[0]),
+                      fDecomp_->getAtypeIdentCol(atomListColumn[0]));
+          }
+
+          atomPairs_.cg1.push_back(cg1);
+          atomPairs_.cg2.push_back(cg2);
+          atomPairs_.singleAtoms.push_back(singleAtoms);
+          atomPairs_.batch.push_back(batch);
+          atomPairs_.start.push_back(atomPairs_.atom1.size());
+        }
+      }
     }
+  }
 
-    if (info_->requiresSelfCorrection()) {
-      for (unsigned int atom1 = 0; atom1 < info_->getNAtoms(); atom1++) {
-        if (doPotentialSelection_) {
-          gid1 = fDecomp_->getGlobalID(atom1);
-          sdat.isSelected = seleMan_.isGlobalIDSelected(gid1);
+  /**
+   * The same pass as groupPairLoop, but streaming through the cached atom
+   * pair list instead of expanding each cutoff group pair.  The
+   * group-based cutoff and switching function are still evaluated
+   * every step.
+   */
+  void ForceManager::atomPairLoop(int iLoop) {
+
+    if (atomPairs_.start.empty()) buildAtomPairList();
+
+    int nGroupPairs = int(atomPairs_.cg1.size());
+    Vector3d heatFlux(0.0);
+
+    // The positions don't change between the two passes, so the
+    // density pass can leave the group vectors and pair densities
+    // behind for the force pass:
+    bool fillCache = useDensityCache_ && iLoop == PREPAIR_LOOP;
+    bool readCache = useDensityCache_ && iLoop == PAIR_LOOP &&
+      densityCacheFilled_;
+    if (fillCache) {
+      groupVectorCache_.resize(nGroupPairs);
+      pairDensityCache_.resize(4 * atomPairs_.atom1.size());
+    }
+
+    fDecomp_->setPrePairLoop(iLoop == PREPAIR_LOOP);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nThreads_)
+#endif
+    {
+      int tid = 0;
+#ifdef _OPENMP
+      tid = omp_get_thread_num();
+#endif
+      int cg1, cg2, atom1, atom2;
+      Vector3d d_grp, gvel2;
+      RealType rgrpsq, rgrp;
+      bool in_switching_region, singleAtoms;
+      RealType dswdr;
+      int gid1, gid2;
+      PairWork w;
+
+      NonBondedInteraction* batchInteraction;
+      PairBatchBuffer* batch = new PairBatchBuffer;
+      batch->interaction = NULL;
+      batch->n = 0;
+
+      setupPairWork(w);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+      for (int p = 0; p < nGroupPairs; p++) {
+
+        cg1 = atomPairs_.cg1[p];
+        cg2 = atomPairs_.cg2[p];
+        singleAtoms = atomPairs_.singleAtoms[p];
+
+        if (readCache) {
+          d_grp = groupVectorCache_[p];
+        } else {
+          d_grp  = fDecomp_->getIntergroupVector(cg1, cg2);
+          if (fillCache) groupVectorCache_[p] = d_grp;
+        }
+        rgrpsq = d_grp.lengthSquare();
+
+        if (rgrpsq >= rCutSq_) continue;
+
+        if (iLoop == PAIR_LOOP) clearGroupPair(w);
+
+        in_switching_region = switcher_->getSwitch(rgrpsq, w.sw, dswdr, rgrp);
+
+        if (doHeatFlux_)
+          gvel2 = fDecomp_->getGroupVelocityColumn(cg2);
+
+        batchInteraction = atomPairs_.batch[p];
+        if (batchInteraction != NULL) {
+          // nothing to do here for a pure van der Waals pair:
+          if (iLoop == PREPAIR_LOOP) continue;
+
+          if (batch->n == PairBatch::MaxPairs ||
+              (batch->n > 0 && batch->interaction != batchInteraction))
+            flushPairBatch(*batch, tid, w.virial, w.heatFlux);
+
+          int k = batch->n++;
+          int m = atomPairs_.start[p];
+          batch->interaction = batchInteraction;
+          batch->atom1[k] = atomPairs_.atom1[m];
+          batch->atom2[k] = atomPairs_.atom2[m];
+          batch->atid1[k] = fDecomp_->getAtypeIdentRow(batch->atom1[k]);
+          batch->atid2[k] = fDecomp_->getAtypeIdentCol(batch->atom2[k]);
+          batch->d[k] = d_grp;
+          batch->rij[k] = sqrt(rgrpsq);
+          batch->sw[k] = w.sw;
+          batch->dswdr[k] = in_switching_region ? dswdr : 0.0;
+          batch->vdwMult[k] = atomPairs_.vdwMult[m];
+          if (doHeatFlux_)
+            batch->vel2[k] = gvel2;
+          continue;
         }
 
-        fDecomp_->fillSelfData(sdat, atom1);
-        interactionMan_->doSelfCorrection(sdat);
+        for (int m = atomPairs_.start[p]; m < atomPairs_.start[p+1]; m++) {
+          atom1 = atomPairs_.atom1[m];
+          atom2 = atomPairs_.atom2[m];
+
+          if (doPotentialSelection_) {
+            gid1 = fDecomp_->getGlobalIDRow(atom1);
+            gid2 = fDecomp_->getGlobalIDCol(atom2);
+            w.idat.isSelected = seleMan_.isGlobalIDSelected(gid1) ||
+              seleMan_.isGlobalIDSelected(gid2);
+          }
+
+          w.idat.excluded = atomPairs_.excluded[m];
+          if (fillCache || readCache)
+            w.idat.pairDensity = &pairDensityCache_[4 * m];
+          w.vdwMult = atomPairs_.vdwMult[m];
+          w.electroMult = atomPairs_.electroMult[m];
+
+          calcAtomPair(w, iLoop, atom1, atom2, true, singleAtoms,
+                       d_grp, rgrpsq, gvel2, tid);
+        }
+
+        if (iLoop == PAIR_LOOP && in_switching_region)
+          addSwitchingForces(w, cg1, cg2, singleAtoms, d_grp, rgrp, dswdr,
+                             tid);
+      }
+
+      if (batch->n > 0)
+        flushPairBatch(*batch, tid, w.virial, w.heatFlux);
+      delete batch;
+
+#ifdef _OPENMP
+#pragma omp critical (ForceManagerPairLoop)
+#endif
+      {
+        virialTensor += w.virial;
+        heatFlux += w.heatFlux;
       }
     }
 
-    // collects single-atom information
-    fDecomp_->collectSelfData();
+    densityCacheFilled_ = fillCache;
 
-    longRangePotential = *(fDecomp_->getSelfPotential()) +
-      *(fDecomp_->getPairwisePotential());
+    if (doHeatFlux_) fDecomp_->addToHeatFlux(heatFlux);
+    fDecomp_->reduceThreadData();
+  }
 
-    curSnapshot->setLongRangePotential(longRangePotential);
+  /**
+   * Evaluates the staged pairs with a single calcForceBatch call, and
+   * scatters the results exactly as the pair loop would.  Every pair
+   * in the batch is the lone pair of its cutoff group pair, so the
+   * switching function force acts along the same vector.
+   */
+  void ForceManager::flushPairBatch(PairBatchBuffer& b, int tid,
+                                    Mat3x3d& virial, Vector3d& heatFlux) {
+    PairBatch batch;
+    batch.n = b.n;
+    batch.atid1 = b.atid1;
+    batch.atid2 = b.atid2;
+    batch.rij = b.rij;
+    batch.sw = b.sw;
+    batch.vdwMult = b.vdwMult;
+    batch.rcut = rCut_;
+    batch.shiftedPot = (cutoffMethod_ == SHIFTED_POTENTIAL) ? true : false;
+    batch.shiftedForce = (cutoffMethod_ == SHIFTED_FORCE ||
+                          cutoffMethod_ == TAYLOR_SHIFTED) ? true : false;
+    batch.vpair = b.vpair;
+    batch.dudr = b.dudr;
+
+    b.interaction->calcForceBatch(batch);
 
-    curSnapshot->setExcludedPotentials(*(fDecomp_->getExcludedSelfPotential()) +
-                                       *(fDecomp_->getExcludedPotential()));
+    InteractionData idat;
+    potVec workPot(0.0);
+    potVec exPot(0.0);
+    potVec selectionPotential(0.0);
+    RealType vpair, sw;
+    RealType dVdFQ1(0.0);
+    RealType dVdFQ2(0.0);
+    Vector3d eField1(0.0);
+    Vector3d eField2(0.0);
+    RealType sPot1(0.0);
+    RealType sPot2(0.0);
+    Vector3d f1, fg;
+    RealType swderiv;
 
-    if (doPotentialSelection_) {
-      selectionPotential  = curSnapshot->getSelectionPotentials();
-      selectionPotential += *(fDecomp_->getSelectedSelfPotential());
-      selectionPotential += *(fDecomp_->getSelectedPotential());
-      curSnapshot->setSelectionPotentials(selectionPotential);
+    idat.pot = &workPot;
+    idat.excludedPot = &exPot;
+    idat.selePot = &selectionPotential;
+    idat.vpair = &vpair;
+    idat.sw = &sw;
+    idat.f1 = &f1;
+    idat.dVdFQ1 = &dVdFQ1;
+    idat.dVdFQ2 = &dVdFQ2;
+    idat.eField1 = &eField1;
+    idat.eField2 = &eField2;
+    idat.sPot1 = &sPot1;
+    idat.sPot2 = &sPot2;
+    idat.doParticlePot = doParticlePot_;
+
+    for (int k = 0; k < b.n; k++) {
+      vpair = b.vpair[k];
+      sw = b.sw[k];
+      workPot[VANDERWAALS_FAMILY] = sw * vpair;
+      f1 = b.d[k] * b.dudr[k] / b.rij[k];
+
+      fDecomp_->unpackInteractionData(idat, b.atom1[k], b.atom2[k], tid);
+      virial -= outProduct(b.d[k], f1);
+      if (doHeatFlux_)
+        heatFlux += b.d[k] * dot(f1, b.vel2[k]);
+
+      if (b.dswdr[k] != 0.0) {
+        swderiv = vpair * b.dswdr[k] / b.rij[k];
+        fg = swderiv * b.d[k];
+        virial -= outProduct(b.d[k], fg);
+        if (doHeatFlux_)
+          heatFlux += b.d[k] * dot(fg, b.vel2[k]);
+        fDecomp_->addForceToAtomRow(b.atom1[k], fg, tid);
+        fDecomp_->addForceToAtomColumn(b.atom2[k], -fg, tid);
+      }
     }
+    b.n = 0;
   }
 
   void ForceManager::postCalculation() {
 
-    vector<Perturbation*>::iterator pi;
-    for (pi = perturbations_.begin(); pi != perturbations_.end(); ++pi) {
-      (*pi)->applyPerturbation();
+    if (forceGroups_ & PAIR_FORCES) {
+      vector<Perturbation*>::iterator pi;
+      for (pi = perturbations_.begin(); pi != perturbations_.end(); ++pi) {
+        (*pi)->applyPerturbation();
+      }
     }
 
     SimInfo::MoleculeIterator mi;
@@ -1466,65 +2019,22 @@ namespace OpenMD {
       cgConfig->velocity = config->velocity;
     }
 
+    // the row and column data are in flight while the work arrays
+    // are zeroed and the neighbor list is checked
+    fDecomp_->beginDistributeData();
     fDecomp_->zeroWorkArrays();
-    fDecomp_->distributeData();
-
-    int cg1, cg2, atom1, atom2, topoDist;
-    Vector3d d_grp, dag, d, gvel2, vel2;
-    RealType rgrpsq, rgrp, r2, r;
-    RealType electroMult, vdwMult;
-    RealType vij(0.0);
-    Vector3d fij, fg, f1;
-    bool in_switching_region;
-    RealType sw, dswdr, swderiv;
-    vector<int> atomListColumn, atomListRow;
-    InteractionData idat;
+
     SelfData sdat;
-    RealType mf;
-    RealType vpair;
-    RealType dVdFQ1(0.0);
-    RealType dVdFQ2(0.0);
-    potVec longRangePotential(0.0);
     RealType reciprocalPotential(0.0);
     RealType surfacePotential(0.0);
-    potVec workPot(0.0);
-    potVec exPot(0.0);
+    potVec longRangePotential(0.0);
     potVec selectionPotential(0.0);
-    Vector3d eField1(0.0);
-    Vector3d eField2(0.0);
-    RealType sPot1(0.0);
-    RealType sPot2(0.0);
-    bool newAtom1;
-    int gid1, gid2;
-
-    vector<int>::iterator ia, jb;
-
+    int gid1;
     int loopStart, loopEnd;
 
-    idat.rcut = &rCut_;
-    idat.vdwMult = &vdwMult;
-    idat.electroMult = &electroMult;
-    idat.pot = &workPot;
-    idat.excludedPot = &exPot;
-    idat.selePot = &selectionPotential;
     sdat.selfPot = fDecomp_->getSelfPotential();
     sdat.excludedPot = fDecomp_->getExcludedSelfPotential();
     sdat.selePot = fDecomp_->getSelectedSelfPotential();
-    idat.vpair = &vpair;
-    idat.dVdFQ1 = &dVdFQ1;
-    idat.dVdFQ2 = &dVdFQ2;
-    idat.eField1 = &eField1;
-    idat.eField2 = &eField2;
-    idat.sPot1 = &sPot1;
-    idat.sPot2 = &sPot2;
-    idat.f1 = &f1;
-    idat.sw = &sw;
-    idat.shiftedPot = (cutoffMethod_ == SHIFTED_POTENTIAL) ? true : false;
-    idat.shiftedForce = (cutoffMethod_ == SHIFTED_FORCE ||
-                         cutoffMethod_ == TAYLOR_SHIFTED) ? true : false;
-    idat.doParticlePot = doParticlePot_;
-    idat.doElectricField = doElectricField_;
-    idat.doSitePotential = doSitePotential_;
     sdat.doParticlePot = doParticlePot_;
 
     loopEnd = PAIR_LOOP;
@@ -1537,180 +2047,16 @@ namespace OpenMD {
 
       if (iLoop == loopStart) {
         bool update_nlist = fDecomp_->checkNeighborList();
-
-  if (update_nlist) {
+        fDecomp_->finishDistributeData();
+        if (update_nlist) {
           if (!usePeriodicBoundaryConditions_)
             Mat3x3d bbox = thermo->getBoundingBox();
           fDecomp_->buildNeighborList(neighborList_, point_);
+          if (useAtomPairList_) buildAtomPairList();
         }
       }
 
-      for (cg1 = 0; cg1 < int(point_.size()) - 1; cg1++) {
-
-        atomListRow = fDecomp_->getAtomsInGroupRow(cg1);
-        newAtom1 = true;
-
-        for (int m2 = point_[cg1]; m2 < point_[cg1+1]; m2++) {
-
-          cg2 = neighborList_[m2];
-
-          d_grp  = fDecomp_->getIntergroupVector(cg1, cg2);
-
-          // already wrapped in the getIntergroupVector call:
-          // curSnapshot->wrapVector(d_grp);
-          rgrpsq = d_grp.lengthSquare();
-
-          if (rgrpsq < rCutSq_) {
-            if (iLoop == PAIR_LOOP) {
-              vij = 0.0;
-              fij.zero();
-              eField1.zero();
-              eField2.zero();
-              sPot1 = 0.0;
-              sPot2 = 0.0;
-            }
-
-            in_switching_region = switcher_->getSwitch(rgrpsq, sw, dswdr,
-                                                       rgrp);
-
-            atomListColumn = fDecomp_->getAtomsInGroupColumn(cg2);
-
-            if (doHeatFlux_)
-              gvel2 = fDecomp_->getGroupVelocityColumn(cg2);
-
-            for (ia = atomListRow.begin();
-                 ia != atomListRow.end(); ++ia) {
-              atom1 = (*ia);
-
-              if (doPotentialSelection_) {
-                gid1 = fDecomp_->getGlobalIDRow(atom1);
-                idat.isSelected = seleMan_.isGlobalIDSelected(gid1);
-              }
-
-              for (jb = atomListColumn.begin();
-                   jb != atomListColumn.end(); ++jb) {
-                atom2 = (*jb);
-
-                if (doPotentialSelection_) {
-                  gid2 = fDecomp_->getGlobalIDCol(atom2);
-                  idat.isSelected |= seleMan_.isGlobalIDSelected(gid2);
-                }
-
-                if (!fDecomp_->skipAtomPair(atom1, atom2, cg1, cg2)) {
-
-                  vpair = 0.0;
-                  workPot = 0.0;
-                  exPot = 0.0;
-                  selectionPotential = 0.0;
-                  f1.zero();
-                  dVdFQ1 = 0.0;
-                  dVdFQ2 = 0.0;
-
-                  fDecomp_->fillInteractionData(idat, atom1, atom2, newAtom1);
-
-                  topoDist = fDecomp_->getTopologicalDistance(atom1, atom2);
-                  vdwMult = vdwScale_[topoDist];
-                  electroMult = electrostaticScale_[topoDist];
-
-                  if (atomListRow.size() == 1 && atomListColumn.size() == 1) {
-                    idat.d = &d_grp;
-                    idat.r2 = &rgrpsq;
-                    if (doHeatFlux_)
-                      vel2 = gvel2;
-                  } else {
-                    d = fDecomp_->getInteratomicVector(atom1, atom2);
-                    curSnapshot->wrapVector( d );
-                    r2 = d.lengthSquare();
-                    idat.d = &d;
-                    idat.r2 = &r2;
-                    if (doHeatFlux_)
-                      vel2 = fDecomp_->getAtomVelocityColumn(atom2);
-                  }
-
-                  r = sqrt( *(idat.r2) );
-                  idat.rij = &r;
-
-                  if (iLoop == PREPAIR_LOOP) {
-                    interactionMan_->doPrePair(idat);
-                  } else {
-                    interactionMan_->doPair(idat);
-                    fDecomp_->unpackInteractionData(idat, atom1, atom2);
-                    vij += vpair;
-                    fij += f1;
-                    virialTensor -= outProduct( *(idat.d), f1);
-                    if (doHeatFlux_)
-                      fDecomp_->addToHeatFlux(*(idat.d) * dot(f1, vel2));
-                  }
-                }
-              }
-            }
-
-            if (iLoop == PAIR_LOOP) {
-              if (in_switching_region) {
-                swderiv = vij * dswdr / rgrp;
-                fg = swderiv * d_grp;
-                fij += fg;
-
-                if (atomListRow.size() == 1 && atomListColumn.size() == 1) {
-                  if (!fDecomp_->skipAtomPair(atomListRow[0],
-                                              atomListColumn[0],
-                                              cg1, cg2)) {
-                  virialTensor -= outProduct( *(idat.d), fg);
-                  if (doHeatFlux_)
-                    fDecomp_->addToHeatFlux(*(idat.d) * dot(fg, vel2));
-                  }
-                }
-
-                for (ia = atomListRow.begin();
-                     ia != atomListRow.end(); ++ia) {
-                  atom1 = (*ia);
-                  mf = fDecomp_->getMassFactorRow(atom1);
-                  // fg is the force on atom ia due to cutoff group's
-                  // presence in switching region
-                  fg = swderiv * d_grp * mf;
-                  fDecomp_->addForceToAtomRow(atom1, fg);
-                  if (atomListRow.size() > 1) {
-                    if (info_->usesAtomicVirial()) {
-                      // find the distance between the atom
-                      // and the center of the cutoff group:
-                      dag = fDecomp_->getAtomToGroupVectorRow(atom1, cg1);
-                      virialTensor -= outProduct(dag, fg);
-                      if (doHeatFlux_)
-                        fDecomp_->addToHeatFlux( dag * dot(fg, vel2));
-                    }
-                  }
-                }
-                for (jb = atomListColumn.begin();
-                     jb != atomListColumn.end(); ++jb) {
-                  atom2 = (*jb);
-                  mf = fDecomp_->getMassFactorColumn(atom2);
-                  // fg is the force on atom jb due to cutoff group's
-                  // presence in switching region
-                  fg = -swderiv * d_grp * mf;
-                  fDecomp_->addForceToAtomColumn(atom2, fg);
-
-                  if (atomListColumn.size() > 1) {
-                    if (info_->usesAtomicVirial()) {
-                      // find the distance between the atom
-                      // and the center of the cutoff group:
-                      dag = fDecomp_->getAtomToGroupVectorColumn(atom2, cg2);
-                      virialTensor -= outProduct(dag, fg);
-                      if (doHeatFlux_)
-                        fDecomp_->addToHeatFlux( dag * dot(fg, vel2));
-                    }
-                  }
-                }
-              }
-              //if (!info_->usesAtomicVirial()) {
-              //  virialTensor -= outProduct(d_grp, fij);
-              //  if (doHeatFlux_)
-              //     fDecomp_->addToHeatFlux( d_grp * dot(fij, vel2));
-              //}
-            }
-          }
-        }
-        newAtom1 = false;
-      }
+      pairLoop(iLoop);
 
       if (iLoop == PREPAIR_LOOP) {
         if (info_->requiresPrepair()) {
@@ -1735,8 +2081,9 @@ namespace OpenMD {
 
     // collects pairwise information
     fDecomp_->collectData();
-    if (cutoffMethod_ == EWALD_FULL) {
-      interactionMan_->doReciprocalSpaceSum(reciprocalPotential);
+    if (doReciprocalSum_) {
+      interactionMan_->doReciprocalSpaceSum(reciprocalPotential,
+                                            virialTensor);
       curSnapshot->setReciprocalPotential(reciprocalPotential);
 
       // interactionMan_->doSurfaceTerm(surfacePotential);
@@ -66,6 +66,20 @@
 
 using namespace std;
 namespace OpenMD {
+
+  /**
+   * The groups of forces that ForceManager::calcForceGroups can
+   * evaluate separately.  Multiple time step integrators use these to
+   * evaluate the fast-varying, inexpensive forces more often than the
+   * slowly-varying, expensive ones.
+   */
+  enum ForceGroup {
+    BONDED_FORCES = 1,     /**< bonds, bends, torsions, and inversions */
+    PAIR_FORCES = 2,       /**< real-space non-bonded pairs and perturbations */
+    RECIPROCAL_FORCES = 4, /**< Ewald and SPME reciprocal space sums */
+    ALL_FORCES = 7
+  };
+
   /**
    * @class ForceManager ForceManager.hpp "brains/ForceManager.hpp"
    * ForceManager is responsible for calculating both the short range
@@ -81,8 +95,22 @@ namespace OpenMD {
     ForceManager(SimInfo * info);                          
     virtual ~ForceManager();
     virtual void calcForces();
+    /**
+     * Evaluates only the forces in the requested ForceGroups (a
+     * bitwise or of ForceGroup values).  Forces, torques, and the
+     * virial are zeroed first, so on return they hold only the
+     * contributions from these groups.  The potentials belonging to
+     * the other groups are left untouched in the current snapshot.
+     */
+    virtual void calcForceGroups(int groups);
     virtual void calcSelectedForces(Molecule* mol1, Molecule* mol2);
     void initialize();
+    /**
+     * Reports how evenly the pair loop work has been spread over the
+     * processors so far.  Collective in parallel; does nothing in
+     * serial.
+     */
+    void reportLoadBalance();
 
   protected: 
     bool initialized_; 
@@ -92,11 +120,32 @@ namespace OpenMD {
     bool doHeatFlux_;
     bool doLongRangeCorrections_;
     bool usePeriodicBoundaryConditions_;
+    int nThreads_;             /**< threads sharing the pair loop */
+    bool useAtomPairList_;     /**< stream through a cached atom pair list? */
+    bool useDensityCache_;     /**< reuse prepair pass results in the pair pass? */
+    int forceGroups_;          /**< ForceGroups in the current evaluation */
+    double pairLoopTime_;      /**< wall time spent in the pair loop here */
 
     virtual void setupCutoffs();
     virtual void preCalculation();        
     virtual void shortRangeInteractions();
     virtual void longRangeInteractions();
+    virtual void pairLoop(int iLoop);
+    virtual void groupPairLoop(int iLoop);
+    virtual void atomPairLoop(int iLoop);
+    void buildAtomPairList();
+    struct PairWork;
+    void setupPairWork(PairWork& w);
+    void clearGroupPair(PairWork& w);
+    void calcAtomPair(PairWork& w, int iLoop, int atom1, int atom2,
+                      bool newAtom1, bool singleAtoms, Vector3d& d_grp,
+                      RealType& rgrpsq, const Vector3d& gvel2, int tid);
+    void addSwitchingForces(PairWork& w, int cg1, int cg2, bool pairVirial,
+                            const Vector3d& d_grp, RealType rgrp,
+                            RealType dswdr, int tid);
+    struct PairBatchBuffer;
+    void flushPairBatch(PairBatchBuffer& b, int tid, Mat3x3d& virial,
+                        Vector3d& heatFlux);
     virtual void postCalculation();
 
     virtual void selectedPreCalculation(Molecule* mol1, Molecule* mol2);        
@@ -116,6 +165,7 @@ namespace OpenMD {
     RealType rCutSq_;
     RealType rSwitch_;         /**< inner radius of switching function */
     CutoffMethod cutoffMethod_;/**< Cutoff Method for most non-bonded interactions */
+    bool doReciprocalSum_;     /**< Ewald or SPME reciprocal space sum needed? */
 
     set<AtomType*> atomTypes_;
     vector<pair<AtomType*, AtomType*> > interactions_;
@@ -126,6 +176,86 @@ namespace OpenMD {
     vector<int> neighborList_;
     vector<int> point_;
 
+    /**
+     * The atom-level Verlet list, rebuilt only when the cutoff group
+     * neighbor list is rebuilt.  Group pair p couples row group
+     * cg1[p] with column group cg2[p], and its atom pairs are entries
+     * start[p] ... start[p+1]-1 of the per-pair arrays.  Pairs that
+     * the force decomposition skips are never stored, and the
+     * exclusion flags and topological multipliers are looked up once.
+     */
+    struct AtomPairList {
+      vector<int> cg1;
+      vector<int> cg2;
+      vector<int> start;
+      vector<char> singleAtoms;  /**< both groups hold one atom */
+      vector<NonBondedInteraction*> batch; /**< batched interaction, or NULL */
+      vector<int> atom1;
+      vector<int> atom2;
+      vector<char> excluded;
+      vector<RealType> vdwMult;
+      vector<RealType> electroMult;
+    };
+    AtomPairList atomPairs_;
+
+    /**
+     * Results of the PREPAIR_LOOP pass over the atom pair list that
+     * the PAIR_LOOP pass of the same force evaluation reuses: the
+     * wrapped vector of each group pair, and four slots per atom pair
+     * for the metallic densities and their derivatives.  Only
+     * allocated when useDensityCache is set.
+     */
+    vector<Vector3d> groupVectorCache_;
+    vector<RealType> pairDensityCache_;
+    bool densityCacheFilled_;
+
+    /**
+     * Per-thread staging area for single-atom group pairs whose only
+     * interaction can be evaluated in packed batches.  The pairs are
+     * collected here and handed to the interaction PairBatch::MaxPairs
+     * at a time.
+     */
+    struct PairBatchBuffer {
+      NonBondedInteraction* interaction;
+      int n;
+      int atom1[PairBatch::MaxPairs];
+      int atom2[PairBatch::MaxPairs];
+      int atid1[PairBatch::MaxPairs];
+      int atid2[PairBatch::MaxPairs];
+      Vector3d d[PairBatch::MaxPairs];
+      Vector3d vel2[PairBatch::MaxPairs];
+      RealType rij[PairBatch::MaxPairs];
+      RealType sw[PairBatch::MaxPairs];
+      RealType dswdr[PairBatch::MaxPairs];
+      RealType vdwMult[PairBatch::MaxPairs];
+      RealType vpair[PairBatch::MaxPairs];
+      RealType dudr[PairBatch::MaxPairs];
+    };
+
+    /**
+     * Per-thread scratch space shared by groupPairLoop and
+     * atomPairLoop.  idat points into the other members, so a
+     * PairWork is never copied.  vij and fij accumulate over the atom
+     * pairs of the current cutoff group pair; virial and heatFlux over
+     * the thread's share of the pass.
+     */
+    struct PairWork {
+      Snapshot* snapshot;
+      InteractionData idat;
+      Vector3d d, vel2, f1;
+      RealType r2, r;
+      RealType vdwMult, electroMult;
+      RealType vpair, sw;
+      RealType dVdFQ1, dVdFQ2;
+      potVec workPot, exPot, selectionPotential;
+      Vector3d eField1, eField2;
+      RealType sPot1, sPot2;
+      RealType vij;
+      Vector3d fij;
+      Mat3x3d virial;
+      Vector3d heatFlux;
+    };
+
     vector<RealType> vdwScale_;
     vector<RealType> electrostaticScale_;
 
@@ -90,6 +90,12 @@ namespace OpenMD {
     /** Returns the pairs in a plain array*/
     int *getPairList();
 
+    typedef std::set<std::pair<int, int> >::const_iterator const_iterator;
+
+    /** Iterators over the stored pairs, (i, j) with i < j */
+    const_iterator begin() const { return pairSet_.begin(); }
+    const_iterator end() const { return pairSet_.end(); }
+
     /** write out the exclusion list to an ostream */
     friend std::ostream& operator <<(std::ostream& o, PairList& e);
 
@@ -55,6 +55,7 @@
 #include "integrators/NPrT.hpp"
 #include "integrators/NPA.hpp"
 #include "integrators/NgammaT.hpp"
+#include "integrators/Respa.hpp"
 #include "integrators/LangevinDynamics.hpp"
 #if defined(HAVE_QHULL)
 #include "integrators/LangevinHullDynamics.hpp"
@@ -88,6 +89,11 @@ namespace OpenMD {
     IntegratorFactory::getInstance()->registerIntegrator(new IntegratorBuilder<NPrT>("NPGT"));
     IntegratorFactory::getInstance()->registerIntegrator(new IntegratorBuilder<NgammaT>("NGT"));
     IntegratorFactory::getInstance()->registerIntegrator(new IntegratorBuilder<NgammaT>("NGAMMAT"));
+    IntegratorFactory::getInstance()->registerIntegrator(new IntegratorBuilder<Respa<NVE> >("RESPA_NVE"));
+    IntegratorFactory::getInstance()->registerIntegrator(new IntegratorBuilder<Respa<NVT> >("RESPA_NVT"));
+    IntegratorFactory::getInstance()->registerIntegrator(new IntegratorBuilder<Respa<NPTi> >("RESPA_NPTI"));
+    IntegratorFactory::getInstance()->registerIntegrator(new IntegratorBuilder<Respa<NPTf> >("RESPA_NPTF"));
+    IntegratorFactory::getInstance()->registerIntegrator(new IntegratorBuilder<Respa<NPTxyz> >("RESPA_NPTXYZ"));
     IntegratorFactory::getInstance()->registerIntegrator(new IntegratorBuilder<LangevinDynamics>("LANGEVINDYNAMICS"));
     IntegratorFactory::getInstance()->registerIntegrator(new IntegratorBuilder<LangevinDynamics>("LD"));
 #if defined(HAVE_QHULL)
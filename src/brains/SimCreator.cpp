@@ -60,6 +60,7 @@
 #include "brains/MoleculeCreator.hpp"
 #include "brains/SimCreator.hpp"
 #include "brains/SimSnapshotManager.hpp"
+#include "parallel/LoadBalancer.hpp"
 #include "io/DumpReader.hpp"
 #include "brains/ForceField.hpp"
 #include "utils/simError.h"
@@ -489,8 +490,13 @@ namespace OpenMD {
       info->addInteractionPairs(mol);
     }
     
-    if (loadInitCoords)
+    if (loadInitCoords) {
       loadCoordinates(info, mdFileName);    
+#ifdef IS_MPI
+      if (simParams->getBalanceMolecules())
+        balanceMolecules(info, mdFileName);
+#endif
+    }
     return info;
   }
   
@@ -511,7 +517,10 @@ namespace OpenMD {
       }
       
       info->setFinalConfigFileName(prefix + ".eor");
-      info->setDumpFileName(prefix + ".dump");
+      if (toUpperCopy(simParams->getDumpFileFormat()) == "BINARY")
+        info->setDumpFileName(prefix + ".dumpb");
+      else
+        info->setDumpFileName(prefix + ".dump");
       info->setStatFileName(prefix + ".stat");
       info->setReportFileName(prefix + ".report");
       info->setRestFileName(prefix + ".zang");
@@ -663,6 +672,66 @@ namespace OpenMD {
     errorCheckPoint();
   }
   
+
+  void SimCreator::balanceMolecules(SimInfo *info, 
+                                    const std::string& mdFileName) {
+    int nProcessors;
+    MPI_Comm_size( MPI_COMM_WORLD, &nProcessors);
+    if (nProcessors < 2) return;
+
+    int nGlobalMols = info->getNGlobalMolecules();
+    std::vector<int> oldMap(nGlobalMols);
+    for (int i = 0; i < nGlobalMols; i++) 
+      oldMap[i] = info->getMolToProc(i);
+
+    // Every processor gets the same costs, and the division is
+    // deterministic, so the new map is the same everywhere.
+    LoadBalancer balancer(info);
+    std::vector<RealType> costs = balancer.getMoleculeCosts();
+    std::vector<int> newMap = balancer.divide(costs, nProcessors);
+
+    RealType oldImbalance = balancer.getImbalance(costs, oldMap, nProcessors);
+    RealType newImbalance = balancer.getImbalance(costs, newMap, nProcessors);
+
+    // Re-creating the molecules means reading the coordinates again,
+    // which is only worth it for a real improvement:
+    if (newImbalance > 0.95 * oldImbalance) return;
+
+    sprintf(painCave.errMsg,
+            "Redistributing the molecules by their estimated pair costs.\n"
+            "\tThe busiest processor goes from %.3f to %.3f times the\n"
+            "\taverage load.\n", oldImbalance, newImbalance);
+    painCave.isFatal = 0;
+    painCave.severity = OPENMD_INFO;
+    simError();
+
+    std::vector<Molecule*> localMols;
+    SimInfo::MoleculeIterator mi;
+    Molecule* mol;
+    for (mol = info->beginMolecule(mi); mol != NULL; 
+         mol = info->nextMolecule(mi)) {
+      localMols.push_back(mol);
+    }
+    for (std::size_t i = 0; i < localMols.size(); i++)
+      info->removeMolecule(localMols[i]);
+    info->getLocalIndexManager()->clear();
+
+    info->setMolToProcMap(newMap);
+    createMolecules(info);
+    info->setSnapshotManager(new SimSnapshotManager(info, 
+                                                    computeStorageLayout(info)));
+    setGlobalIndex(info);
+    for (mol = info->beginMolecule(mi); mol != NULL;
+         mol = info->nextMolecule(mi)) {
+      info->addInteractionPairs(mol);
+    }
+    loadCoordinates(info, mdFileName);
+
+    sprintf(checkPointMsg,
+            "Successfully redistributed the molecules.\n");
+    errorCheckPoint();
+  }
+  
 #endif
   
   void SimCreator::createMolecules(SimInfo *info) {
@@ -807,6 +876,10 @@ namespace OpenMD {
       storageLayout |= DataStorage::dslFlucQForce;
     }
 
+    if (simParams->getUseComponentArrays()) {
+      storageLayout |= DataStorage::dslComponentArrays;
+    }
+
     info->setStorageLayout(storageLayout);
 
     return storageLayout;
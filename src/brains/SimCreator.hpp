@@ -117,6 +117,13 @@ namespace OpenMD {
          
     void divideMolecules(SimInfo* info);
 
+    /**
+     * Re-divides the molecules by their estimated pair loop costs once
+     * the initial coordinates are known, and re-creates the local
+     * molecules if that evens out the work noticeably.
+     */
+    void balanceMolecules(SimInfo* info, const std::string& mdFileName);
+
     /** Load initial coordinates */
     void loadCoordinates(SimInfo* info, const std::string& mdFileName);     
 
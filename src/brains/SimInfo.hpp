@@ -731,7 +731,8 @@ namespace OpenMD{
     /** 
      * The size of molToProcMap_ is equal to total number of molecules
      * in the system.  It maps a molecule to the processor on which it
-     * resides. it is filled by SimCreator once and only once.
+     * resides. it is filled by SimCreator while the simulation is created
+     * and does not change afterwards.
      */        
     vector<int> molToProcMap_; 
 
@@ -66,9 +66,15 @@ namespace OpenMD {
     previousSnapshot_ = NULL;
     currentSnapshot_ = NULL;
   }
+  /**
+   * Only the frame data and the arrays declared through
+   * requirePrevious are copied into the previous snapshot, so a
+   * simulation without any readers of the previous positions or
+   * velocities does no per-atom work here.
+   */
   bool SimSnapshotManager::advance() {
 
-    *previousSnapshot_ = *currentSnapshot_;
+    previousSnapshot_->assign(*currentSnapshot_, getPrevStorageLayout());
     currentSnapshot_->setID(currentSnapshot_->getID() + 1);    
     currentSnapshot_->clearDerivedProperties();
     return true;
@@ -77,7 +83,7 @@ namespace OpenMD {
   bool SimSnapshotManager::resetToPrevious() {
     
     int prevID = previousSnapshot_->getID();
-    *currentSnapshot_ = *previousSnapshot_;
+    currentSnapshot_->assign(*previousSnapshot_, getPrevStorageLayout());
     currentSnapshot_->setID(prevID);
     return true;
   }
@@ -129,6 +129,15 @@ namespace OpenMD {
     clearDerivedProperties();
   }
 
+  void Snapshot::assign(Snapshot& s, int whichArrays) {
+    atomData.assign(s.atomData, whichArrays);
+    rigidbodyData.assign(s.rigidbodyData, whichArrays);
+    cgData.assign(s.cgData, whichArrays);
+    frameData = s.frameData;
+    orthoTolerance_ = s.orthoTolerance_;
+    clearDerivedProperties();
+  }
+
   void Snapshot::clearDerivedProperties() {
     frameData.totalEnergy = 0.0;     
     frameData.translationalKinetic = 0.0;   
@@ -134,6 +134,13 @@ namespace OpenMD{
     /** sets the state of the computed properties to false */
     void     clearDerivedProperties();
 
+    /**
+     * Copies the frame data and the DataStorage arrays in whichArrays
+     * from another snapshot.  Derived properties are not carried over
+     * and are recomputed when they are next requested.
+     */
+    void     assign(Snapshot& s, int whichArrays);
+
     int      getSize();
     /** Returns the number of atoms */
     int      getNumberOfAtoms();
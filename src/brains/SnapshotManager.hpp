@@ -95,13 +95,33 @@ namespace OpenMD{
     int getStorageLayout() {
       return storageLayout_;
     }
+
+    /**
+     * Returns the DataStorage arrays that advance() carries over into
+     * the previous snapshot.
+     */
+    int getPrevStorageLayout() {
+      return prevStorageLayout_;
+    }
+
+    /**
+     * Declares that the caller reads (or restores, through
+     * resetToPrevious) these DataStorage arrays from the previous
+     * snapshot.  Arrays nobody has asked for are not copied when the
+     * snapshots advance.
+     * @param layout bitwise or of DataStorage::dsl* values
+     */
+    void requirePrevious(int layout) {
+      prevStorageLayout_ |= layout;
+    }
     
   private:
     int storageLayout_;
+    int prevStorageLayout_;
 
   protected:
 
-    SnapshotManager(int storageLayout) : storageLayout_(storageLayout), currentSnapshot_(NULL), previousSnapshot_(NULL) {
+    SnapshotManager(int storageLayout) : storageLayout_(storageLayout), prevStorageLayout_(0), currentSnapshot_(NULL), previousSnapshot_(NULL) {
     }
             
     Snapshot* currentSnapshot_;
@@ -71,6 +71,9 @@ namespace OpenMD {
     }    
 
     currentSnapshot_ = info_->getSnapshotManager()->getCurrentSnapshot();
+    // constraintPairA starts from the positions at the previous step:
+    info_->getSnapshotManager()->requirePrevious(DataStorage::dslPosition);
+
     if (simParams->haveConstraintTime()){
       constraintTime_ = simParams->getConstraintTime();
     } else {
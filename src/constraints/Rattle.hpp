@@ -71,6 +71,9 @@ namespace OpenMD {
     RealType getConsTolerance() { return consTolerance_; } 
     void setConsTolerance(RealType tolerance) { consTolerance_ = tolerance;}        
 
+    RealType getTimeStep() { return dt_; }
+    void setTimeStep(RealType dt) { dt_ = dt; }
+
   private:
     typedef int (Rattle::*ConstraintPairFuncPtr)(ConstraintPair*);
     void doConstraint(ConstraintPairFuncPtr func);
@@ -61,6 +61,9 @@ namespace OpenMD {
     Globals* simParams = info_->getSimParams();
 
     currentSnapshot_ = info_->getSnapshotManager()->getCurrentSnapshot();
+    // constraintPairR starts from the positions at the previous step:
+    info_->getSnapshotManager()->requirePrevious(DataStorage::dslPosition);
+
     if (simParams->haveConstraintTime()){
       constraintTime_ = simParams->getConstraintTime();
     } else {
@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2005 The University of Notre Dame. All Rights Reserved.
+ *
+ * The University of Notre Dame grants you ("Licensee") a
+ * non-exclusive, royalty free, license to use, modify and
+ * redistribute this software in source and binary code form, provided
+ * that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * This software is provided "AS IS," without a warranty of any
+ * kind. All express or implied conditions, representations and
+ * warranties, including any implied warranty of merchantability,
+ * fitness for a particular purpose or non-infringement, are hereby
+ * excluded.  The University of Notre Dame and its licensors shall not
+ * be liable for any damages suffered by licensee as a result of
+ * using, modifying or distributing the software or its
+ * derivatives. In no event will the University of Notre Dame or its
+ * licensors be liable for any lost revenue, profit or data, or for
+ * direct, indirect, special, consequential, incidental or punitive
+ * damages, however caused and regardless of the theory of liability,
+ * arising out of the use of or inability to use software, even if the
+ * University of Notre Dame has been advised of the possibility of
+ * such damages.
+ *
+ * SUPPORT OPEN SCIENCE!  If you use OpenMD or its source code in your
+ * research, please cite the appropriate papers when you publish your
+ * work.  Good starting points are:
+ *                                                                      
+ * [1]  Meineke, et al., J. Comp. Chem. 26, 252-271 (2005).             
+ * [2]  Fennell & Gezelter, J. Chem. Phys. 124, 234104 (2006).          
+ * [3]  Sun, Lin & Gezelter, J. Chem. Phys. 128, 234107 (2008).          
+ * [4]  Kuang & Gezelter,  J. Chem. Phys. 133, 164101 (2010).
+ * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
+ */
+ 
+/**
+ * @file Respa.hpp
+ * @version 1.0
+ */
+
+#ifndef INTEGRATORS_RESPA_HPP
+#define INTEGRATORS_RESPA_HPP
+
+#include <vector>
+#include "integrators/VelocityVerletIntegrator.hpp"
+#include "primitives/Molecule.hpp"
+#include "utils/Constants.hpp"
+#include "utils/simError.h"
+
+namespace OpenMD {
+
+  /**
+   * @class Respa Respa.hpp "integrators/Respa.hpp"
+   * @brief Reversible multiple time step (r-RESPA) integrator
+   *
+   * Respa wraps one of the velocity Verlet integrators (NVE, NVT,
+   * NPTi, NPTf, or NPTxyz) and splits the forces into three levels:
+   *
+   *  - bonded forces, which the wrapped integrator propagates on the
+   *    inner step, dt / (respaPairSteps * respaBondedSteps),
+   *  - real-space non-bonded pair forces, which are applied as
+   *    impulses on the middle step, dt / respaPairSteps, and
+   *  - reciprocal space forces, which are applied as impulses on the
+   *    outer step, dt.
+   *
+   * The thermostat and barostat of the wrapped integrator act on the
+   * inner step.  Per-atom quantities accumulated during a force
+   * evaluation (particle potentials, electric fields, and site
+   * potentials) only hold the contributions from the last group of
+   * forces that was evaluated.
+   */
+  template<class Base>
+  class Respa : public Base {
+  public:
+    Respa(SimInfo* info) : Base(info), inner_(false) {
+      Globals* simParams = info->getSimParams();
+
+      nBondedSteps_ = simParams->getRespaBondedSteps();
+      nPairSteps_ = simParams->getRespaPairSteps();
+      for (int i = 0; i < N_LEVELS; i++)
+        virial_[i] = Mat3x3d(0.0);
+
+      // These replace the ForceManager with one that adds its own
+      // forces in calcForces, which the split evaluation never calls:
+      if (simParams->getUseThermodynamicIntegration() ||
+          simParams->getUseRestraints() ||
+          simParams->getNZconsStamps() > 0) {
+        sprintf(painCave.errMsg,
+                "Respa: Multiple time step integration can not be used\n"
+                "\twith restraints, z-constraints, or thermodynamic\n"
+                "\tintegration.\n");
+        painCave.isFatal = 1;
+        simError();
+      }
+
+      // The fluctuating charge propagators step on the full dt.  The
+      // topology (and SimInfo::usesFluctuatingCharges) is not set up
+      // yet, so look at the atoms themselves:
+      SimInfo::MoleculeIterator mi;
+      Molecule::AtomIterator ai;
+      Molecule* mol;
+      Atom* atom;
+      for (mol = info->beginMolecule(mi); mol != NULL;
+           mol = info->nextMolecule(mi)) {
+        for (atom = mol->beginAtom(ai); atom != NULL;
+             atom = mol->nextAtom(ai)) {
+          if (atom->isFluctuatingCharge()) {
+            sprintf(painCave.errMsg,
+                    "Respa: Multiple time step integration can not be used\n"
+                    "\twith fluctuating charges.\n");
+            painCave.isFatal = 1;
+            simError();
+          }
+        }
+      }
+    }
+
+  protected:
+
+    virtual void integrateStep() {
+      RealType outerDt = this->dt;
+      RealType pairDt = outerDt / RealType(nPairSteps_);
+      RealType bondedDt = pairDt / RealType(nBondedSteps_);
+
+      kick(RECIPROCAL_LEVEL, 0.5 * outerDt);
+
+      for (int i = 0; i < nPairSteps_; i++) {
+        kick(PAIR_LEVEL, 0.5 * pairDt);
+
+        // the wrapped integrator only sees the bonded forces:
+        setForces(BONDED_LEVEL);
+        setTimeStep(bondedDt);
+        inner_ = true;
+        for (int j = 0; j < nBondedSteps_; j++) {
+          // velocities have changed since the last kinetic energy
+          this->snap->clearDerivedProperties();
+          Base::integrateStep();
+        }
+        inner_ = false;
+        setTimeStep(outerDt);
+
+        evaluate(PAIR_LEVEL);
+        kick(PAIR_LEVEL, 0.5 * pairDt);
+      }
+
+      evaluate(RECIPROCAL_LEVEL);
+      kick(RECIPROCAL_LEVEL, 0.5 * outerDt);
+      this->rattle_->constraintB();
+
+      // leave the total forces in place for the dump and stat files
+      setForces(N_LEVELS);
+      this->snap->clearDerivedProperties();
+    }
+
+  private:
+
+    enum RespaLevel {
+      BONDED_LEVEL = 0,    /**< evaluates BONDED_FORCES */
+      PAIR_LEVEL = 1,      /**< evaluates PAIR_FORCES */
+      RECIPROCAL_LEVEL = 2,/**< evaluates RECIPROCAL_FORCES */
+      N_LEVELS = 3
+    };
+
+    /**
+     * Called by the wrapped integrator's integrateStep (and during
+     * initialization).  On the inner step only the bonded forces are
+     * recomputed; otherwise every level is refreshed.
+     */
+    virtual void calcForce() {
+      if (inner_) {
+        evaluate(BONDED_LEVEL);
+        return;
+      }
+      evaluate(RECIPROCAL_LEVEL);
+      evaluate(PAIR_LEVEL);
+      evaluate(BONDED_LEVEL);
+      setForces(N_LEVELS);
+    }
+
+    /**
+     * Computes the forces of one level and stores them with the
+     * integrable objects.  The snapshot's virial is the sum over the
+     * most recent evaluation of every level.
+     */
+    void evaluate(int level) {
+      SimInfo::MoleculeIterator i;
+      Molecule::IntegrableObjectIterator j;
+      Molecule* mol;
+      StuntDouble* sd;
+      int index = 0;
+
+      this->forceMan_->calcForceGroups(1 << level);
+
+      frc_[level].resize(this->info_->getNIntegrableObjects());
+      trq_[level].resize(this->info_->getNIntegrableObjects());
+
+      for (mol = this->info_->beginMolecule(i); mol != NULL;
+           mol = this->info_->nextMolecule(i)) {
+        for (sd = mol->beginIntegrableObject(j); sd != NULL;
+             sd = mol->nextIntegrableObject(j)) {
+          frc_[level][index] = sd->getFrc();
+          if (sd->isDirectional())
+            trq_[level][index] = sd->getTrq();
+          ++index;
+        }
+      }
+
+      virial_[level] = this->snap->getVirialTensor();
+      Mat3x3d virial = virial_[BONDED_LEVEL];
+      virial += virial_[PAIR_LEVEL];
+      virial += virial_[RECIPROCAL_LEVEL];
+      this->snap->setVirialTensor(virial);
+    }
+
+    /**
+     * Loads the stored forces of one level (or the sum of all of
+     * them when level is N_LEVELS) back into the integrable objects.
+     */
+    void setForces(int level) {
+      SimInfo::MoleculeIterator i;
+      Molecule::IntegrableObjectIterator j;
+      Molecule* mol;
+      StuntDouble* sd;
+      Vector3d frc;
+      Vector3d trq;
+      int index = 0;
+
+      for (mol = this->info_->beginMolecule(i); mol != NULL;
+           mol = this->info_->nextMolecule(i)) {
+        for (sd = mol->beginIntegrableObject(j); sd != NULL;
+             sd = mol->nextIntegrableObject(j)) {
+          if (level == N_LEVELS) {
+            frc = frc_[BONDED_LEVEL][index] + frc_[PAIR_LEVEL][index]
+              + frc_[RECIPROCAL_LEVEL][index];
+            if (sd->isDirectional())
+              trq = trq_[BONDED_LEVEL][index] + trq_[PAIR_LEVEL][index]
+                + trq_[RECIPROCAL_LEVEL][index];
+          } else {
+            frc = frc_[level][index];
+            trq = trq_[level][index];
+          }
+          sd->setFrc(frc);
+          if (sd->isDirectional())
+            sd->setTrq(trq);
+          ++index;
+        }
+      }
+    }
+
+    /**
+     * Applies the stored forces and torques of one level as an
+     * impulse over the time h.
+     */
+    void kick(int level, RealType h) {
+      SimInfo::MoleculeIterator i;
+      Molecule::IntegrableObjectIterator j;
+      Molecule* mol;
+      StuntDouble* sd;
+      Vector3d vel;
+      Vector3d ji;
+      RealType mass;
+      int index = 0;
+
+      for (mol = this->info_->beginMolecule(i); mol != NULL;
+           mol = this->info_->nextMolecule(i)) {
+        for (sd = mol->beginIntegrableObject(j); sd != NULL;
+             sd = mol->nextIntegrableObject(j)) {
+          mass = sd->getMass();
+          vel = sd->getVel();
+          vel += (h / mass * Constants::energyConvert) * frc_[level][index];
+          sd->setVel(vel);
+
+          if (sd->isDirectional()) {
+            ji = sd->getJ();
+            ji += (h * Constants::energyConvert) *
+              sd->lab2Body(trq_[level][index]);
+            sd->setJ(ji);
+          }
+          ++index;
+        }
+      }
+    }
+
+    void setTimeStep(RealType h) {
+      this->dt = h;
+      this->dt2 = 0.5 * h;
+      this->rattle_->setTimeStep(h);
+    }
+
+    bool inner_;        /**< inside the bonded steps? */
+    int nBondedSteps_;  /**< bonded steps per pair step */
+    int nPairSteps_;    /**< pair steps per reciprocal step */
+
+    std::vector<Vector3d> frc_[N_LEVELS];
+    std::vector<Vector3d> trq_[N_LEVELS];
+    Mat3x3d virial_[N_LEVELS];
+  };
+
+} //end namespace OpenMD
+
+#endif //INTEGRATORS_RESPA_HPP
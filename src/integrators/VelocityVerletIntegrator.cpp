@@ -203,6 +203,7 @@ namespace OpenMD {
     progressBar->update();
 
     statWriter->writeStatReport();
+    forceMan_->reportLoadBalance();
  
     delete dumpWriter;
     delete statWriter;
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2005 The University of Notre Dame. All Rights Reserved.
+ *
+ * The University of Notre Dame grants you ("Licensee") a
+ * non-exclusive, royalty free, license to use, modify and
+ * redistribute this software in source and binary code form, provided
+ * that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * This software is provided "AS IS," without a warranty of any
+ * kind. All express or implied conditions, representations and
+ * warranties, including any implied warranty of merchantability,
+ * fitness for a particular purpose or non-infringement, are hereby
+ * excluded.  The University of Notre Dame and its licensors shall not
+ * be liable for any damages suffered by licensee as a result of
+ * using, modifying or distributing the software or its
+ * derivatives. In no event will the University of Notre Dame or its
+ * licensors be liable for any lost revenue, profit or data, or for
+ * direct, indirect, special, consequential, incidental or punitive
+ * damages, however caused and regardless of the theory of liability,
+ * arising out of the use of or inability to use software, even if the
+ * University of Notre Dame has been advised of the possibility of
+ * such damages.
+ *
+ * SUPPORT OPEN SCIENCE!  If you use OpenMD or its source code in your
+ * research, please cite the appropriate papers when you publish your
+ * work.  Good starting points are:
+ *                                                                      
+ * [1]  Meineke, et al., J. Comp. Chem. 26, 252-271 (2005).             
+ * [2]  Fennell & Gezelter, J. Chem. Phys. 124, 234104 (2006).          
+ * [3]  Sun, Lin & Gezelter, J. Chem. Phys. 128, 234107 (2008).          
+ * [4]  Kuang & Gezelter,  J. Chem. Phys. 133, 164101 (2010).
+ * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
+ */
+ 
+ 
+/**
+ * @file BinaryDump.hpp
+ * @version 1.0
+ */ 
+
+#ifndef IO_BINARYDUMP_HPP
+#define IO_BINARYDUMP_HPP
+
+#include <stdint.h>
+#include <cstring>
+#include <string>
+
+namespace OpenMD {
+
+  /**
+   * @namespace BinaryDump
+   * Layout and encoding helpers for the binary (.dumpb) trajectory
+   * format written by DumpWriter and read by DumpReader.
+   *
+   * A binary dump starts with the same text header as a text dump
+   * (an <OpenMD version=2 format=binary> line followed by the
+   * <MetaData> block), so SimCreator can build a system from it
+   * unchanged.  A "  <BinaryFrames>" line marks the start of the
+   * binary section, which holds one record per frame followed by a
+   * frame index.  All integers and reals are little-endian; reals
+   * are IEEE doubles.
+   *
+   * Frame record:
+   *   char[4] "OMDF", int32 frame number, int64 record length in bytes,
+   *   int32 nStuntDoubles, int32 nSites,
+   *   double time, hmat[9], thermostat[2], barostat[9]
+   *   (the matrices are stored in the order they appear in text dumps),
+   *   nStuntDoubles x { int32 ioIndex, int32 fields, double values... },
+   *   nSites x { int32 ioIndex, int32 siteIndex, int32 fields,
+   *              double values... }
+   *
+   * The fields bitmask plays the role of the type string ("pvqj...")
+   * of a text dump line; values appear in the order of the bits.  A
+   * siteIndex of -1 carries data for the integrable object itself.
+   *
+   * Index record (written when the dump is closed):
+   *   char[4] "OMDI", int64 nFrames, int64 frameOffset[nFrames],
+   *   int64 offset of the index record, char[4] "OMDE"
+   *
+   * A file without an index (e.g. from a run that did not finish)
+   * is still readable by walking the frame records.
+   */
+  namespace BinaryDump {
+
+    enum FieldBits {
+      fPosition       = 1 << 0,   /**< p: 3 values */
+      fVelocity       = 1 << 1,   /**< v: 3 values */
+      fQuaternion     = 1 << 2,   /**< q: 4 values */
+      fAngMomentum    = 1 << 3,   /**< j: 3 values */
+      fForce          = 1 << 4,   /**< f: 3 values */
+      fTorque         = 1 << 5,   /**< t: 3 values */
+      fFlucQPos       = 1 << 6,   /**< c: 1 value */
+      fFlucQVel       = 1 << 7,   /**< w: 1 value */
+      fFlucQFrc       = 1 << 8,   /**< g: 1 value */
+      fElectricField  = 1 << 9,   /**< e: 3 values */
+      fSitePotential  = 1 << 10,  /**< s: 1 value */
+      fParticlePot    = 1 << 11,  /**< u: 1 value */
+      fDensity        = 1 << 12,  /**< d: 1 value */
+      nFieldBits      = 13
+    };
+
+    const char formatTag[] = "format=binary";
+    const char framesTag[] = "<BinaryFrames>";
+    const char frameMagic[4] = {'O', 'M', 'D', 'F'};
+    const char indexMagic[4] = {'O', 'M', 'D', 'I'};
+    const char endMagic[4]   = {'O', 'M', 'D', 'E'};
+
+    /** bytes in a frame record before the first StuntDouble record */
+    const int frameHeaderSize = 4 + 4 + 8 + 4 + 4 + 8 * 21;
+    /** bytes at the very end of an indexed file */
+    const int trailerSize = 8 + 4;
+
+    /** Returns the number of doubles carried by a fields bitmask */
+    inline int countValues(int fields) {
+      static const int widths[nFieldBits] = {3, 3, 4, 3, 3, 3, 1, 1, 1,
+                                             3, 1, 1, 1};
+      int n = 0;
+      for (int i = 0; i < nFieldBits; i++)
+        if (fields & (1 << i)) n += widths[i];
+      return n;
+    }
+
+    /** True if a file name selects the binary format */
+    inline bool isBinaryFileName(const std::string& filename) {
+      const std::string ext(".dumpb");
+      return filename.size() >= ext.size() &&
+        filename.compare(filename.size() - ext.size(), ext.size(), ext) == 0;
+    }
+
+    inline void putUInt64(std::string& buf, uint64_t u, int nBytes = 8) {
+      char b[8];
+      for (int i = 0; i < nBytes; i++) b[i] = static_cast<char>(u >> (8 * i));
+      buf.append(b, nBytes);
+    }
+
+    inline void putInt32(std::string& buf, int32_t v) {
+      putUInt64(buf, static_cast<uint32_t>(v), 4);
+    }
+
+    inline void putInt64(std::string& buf, int64_t v) {
+      putUInt64(buf, static_cast<uint64_t>(v));
+    }
+
+    inline void putDouble(std::string& buf, double v) {
+      uint64_t u;
+      memcpy(&u, &v, sizeof(u));
+      putUInt64(buf, u);
+    }
+
+    inline uint64_t getUInt64(const char* p, int nBytes = 8) {
+      uint64_t u = 0;
+      for (int i = 0; i < nBytes; i++)
+        u |= static_cast<uint64_t>(static_cast<unsigned char>(p[i])) << (8*i);
+      return u;
+    }
+
+    inline int32_t getInt32(const char* p) {
+      return static_cast<int32_t>(static_cast<uint32_t>(getUInt64(p, 4)));
+    }
+
+    inline int64_t getInt64(const char* p) {
+      return static_cast<int64_t>(getUInt64(p));
+    }
+
+    inline double getDouble(const char* p) {
+      uint64_t u = getUInt64(p);
+      double v;
+      memcpy(&v, &u, sizeof(v));
+      return v;
+    }
+  }
+}
+#endif
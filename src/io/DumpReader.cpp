@@ -51,6 +51,7 @@
 #include <sys/stat.h> 
  
 #include <iostream> 
+#include <sstream>
 #include <cmath> 
  
 #include <cstdio> 
@@ -63,13 +64,14 @@
 #include "utils/MemoryUtils.hpp" 
 #include "utils/StringTokenizer.hpp" 
 #include "brains/Thermo.hpp"
+#include "io/BinaryDump.hpp"
  
  
 namespace OpenMD { 
    
   DumpReader::DumpReader(SimInfo* info, const std::string& filename) 
-    : info_(info), filename_(filename), isScanned_(false), nframes_(0),
-      needCOMprops_(false) { 
+    : info_(info), filename_(filename), isScanned_(false), isBinary_(false),
+      nframes_(0), needCOMprops_(false), storageLayout_(0) { 
     
 #ifdef IS_MPI     
     if (worldRank == 0) { 
@@ -85,11 +87,22 @@ namespace OpenMD {
 	painCave.isFatal = 1; 
 	simError(); 
       } 
+
+      // binary dumps announce themselves on the <OpenMD> line:
+      inFile_->getline(buffer, bufferSize);
+      isBinary_ = (std::string(buffer).find(BinaryDump::formatTag) !=
+                   std::string::npos);
+      inFile_->clear();
+      inFile_->seekg(0);
       
 #ifdef IS_MPI       
     }     
     strcpy(checkPointMsg, "Dump file opened for reading successfully."); 
     errorCheckPoint();     
+
+    int binary = isBinary_;
+    MPI_Bcast(&binary, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    isBinary_ = binary;
 #endif 
     
     return; 
@@ -122,25 +135,45 @@ namespace OpenMD {
    
   void DumpReader::scanFile(void) { 
 
+    if (isBinary_) {
+      scanBinaryFile();
+      return;
+    }
+
     std::streampos prevPos;
     std::streampos  currPos; 
     
 #ifdef IS_MPI     
     if (worldRank == 0) { 
 #endif // is_mpi 
-      
+
+      // a current index lets us skip the scan entirely; an index of a
+      // dump that has since grown lets us resume where it left off.
+      std::streamoff resumePos = 0;
+      bool useIndex = isIndexable();
+      bool indexIsCurrent = useIndex && readIndex(resumePos);
+
+      inFile_->clear();
+      inFile_->seekg(resumePos);
       currPos = inFile_->tellg();
       prevPos = currPos;
+      std::streampos scannedPos = currPos;
       bool foundOpenSnapshotTag = false;
       bool foundClosedSnapshotTag = false;
+      bool needTime = false;
 
       int lineNo = 0; 
-      while(inFile_->getline(buffer, bufferSize)) {
+      while(!indexIsCurrent && inFile_->getline(buffer, bufferSize)) {
         ++lineNo;
         
         std::string line = buffer;
         currPos = inFile_->tellg(); 
-        if (line.find("<Snapshot>")!= std::string::npos) {
+        if (needTime && line.find("Time:") != std::string::npos) {
+          StringTokenizer tokenizer(line, " ;\t\n\r{}:,");
+          tokenizer.nextToken();
+          frameTimes_.back() = tokenizer.nextTokenAsDouble();
+          needTime = false;
+        } else if (line.find("<Snapshot>")!= std::string::npos) {
           if (foundOpenSnapshotTag) {
             sprintf(painCave.errMsg, 
                     "DumpReader:<Snapshot> is multiply nested at line %d "
@@ -151,6 +184,8 @@ namespace OpenMD {
           foundOpenSnapshotTag = true;
           foundClosedSnapshotTag = false;
           framePos_.push_back(prevPos);
+          frameTimes_.push_back(0.0);
+          needTime = true;
           
         } else if (line.find("</Snapshot>") != std::string::npos){
           if (!foundOpenSnapshotTag) {
@@ -170,6 +205,8 @@ namespace OpenMD {
           }
           foundClosedSnapshotTag = true;
           foundOpenSnapshotTag = false;
+          needTime = false;
+          scannedPos = currPos;
         }
         prevPos = currPos;
       }
@@ -182,6 +219,11 @@ namespace OpenMD {
         painCave.isFatal = 0; 
         simError();       
         framePos_.pop_back();
+        frameTimes_.pop_back();
+      }
+
+      if (useIndex && !indexIsCurrent) {
+        writeIndex(scannedPos);
       }
       
       nframes_ = framePos_.size(); 
@@ -202,11 +244,215 @@ namespace OpenMD {
     isScanned_ = true; 
   } 
    
+  /**
+   * Only multi-frame text dumps get an index sidecar; the .omd and
+   * .eor files used to start a simulation are read once and binary
+   * dumps carry their own index.
+   */
+  bool DumpReader::isIndexable() {
+    const std::string ext(".dump");
+    return filename_.size() >= ext.size() &&
+      filename_.compare(filename_.size() - ext.size(), ext.size(), ext) == 0;
+  }
+
+  /**
+   * Reads the <filename>.idx sidecar into framePos_ and frameTimes_.
+   * Returns true if the index describes the whole dump file.  If the
+   * dump has only grown since the index was written, the indexed
+   * frames are kept and resumePos is set to the end of the last
+   * complete frame so the scan can pick up from there.  Otherwise
+   * the index is discarded and resumePos is 0.
+   */
+  bool DumpReader::readIndex(std::streamoff& resumePos) {
+
+    resumePos = 0;
+    framePos_.clear();
+    frameTimes_.clear();
+
+    struct stat fileStat;
+    if (stat(filename_.c_str(), &fileStat) != 0) return false;
+
+    std::ifstream indexFile((filename_ + ".idx").c_str());
+    if (!indexFile) return false;
+
+    std::string tag;
+    int version;
+    long long fileSize, modified, scanned;
+    int nFrames;
+
+    if (!(indexFile >> tag >> version) || tag != "OpenMD_DumpIndex" ||
+        version != 1) return false;
+    if (!(indexFile >> tag >> fileSize) || tag != "fileSize") return false;
+    if (!(indexFile >> tag >> modified) || tag != "modified") return false;
+    if (!(indexFile >> tag >> scanned) || tag != "scanned") return false;
+    if (!(indexFile >> tag >> nFrames) || tag != "frames") return false;
+
+    for (int i = 0; i < nFrames; i++) {
+      long long pos;
+      RealType time;
+      if (!(indexFile >> pos >> time)) break;
+      framePos_.push_back(std::streampos(std::streamoff(pos)));
+      frameTimes_.push_back(time);
+    }
+
+    // a dump that shrank, or whose first and last indexed frames have
+    // moved, has been rewritten since the index was made:
+    bool valid = ((int)framePos_.size() == nFrames &&
+                  fileStat.st_size >= fileSize && scanned <= fileSize);
+    if (valid && nFrames > 0) {
+      valid = checkIndexedFrame(0) && checkIndexedFrame(nFrames - 1);
+    }
+    if (!valid) {
+      framePos_.clear();
+      frameTimes_.clear();
+      return false;
+    }
+
+    if (fileStat.st_size == fileSize && fileStat.st_mtime == modified) {
+      return true;
+    }
+
+    resumePos = scanned;
+    return false;
+  }
+
+  /**
+   * Checks that an indexed frame still starts with a <Snapshot> tag
+   * at the indexed offset and carries the indexed time.
+   */
+  bool DumpReader::checkIndexedFrame(int whichFrame) {
+
+    inFile_->clear();
+    inFile_->seekg(framePos_[whichFrame]);
+
+    if (!inFile_->getline(buffer, bufferSize) ||
+        std::string(buffer).find("<Snapshot>") == std::string::npos) {
+      return false;
+    }
+
+    // the time is on the line after <FrameData>:
+    for (int i = 0; i < 2 && inFile_->getline(buffer, bufferSize); i++) {
+      std::string line(buffer);
+      if (line.find("Time:") != std::string::npos) {
+        StringTokenizer tokenizer(line, " ;\t\n\r{}:,");
+        tokenizer.nextToken();
+        return tokenizer.nextTokenAsDouble() == frameTimes_[whichFrame];
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Writes the frame offsets and times to the <filename>.idx sidecar.
+   * scannedPos is the end of the last complete frame.  Failing to
+   * write the index (e.g. in a read-only directory) is not an error.
+   */
+  void DumpReader::writeIndex(std::streampos scannedPos) {
+
+    struct stat fileStat;
+    if (stat(filename_.c_str(), &fileStat) != 0) return;
+
+    std::ofstream indexFile((filename_ + ".idx").c_str());
+    if (!indexFile) return;
+
+    indexFile << "OpenMD_DumpIndex 1\n";
+    indexFile << "fileSize " << (long long) fileStat.st_size << "\n";
+    indexFile << "modified " << (long long) fileStat.st_mtime << "\n";
+    indexFile << "scanned " << (long long) std::streamoff(scannedPos) << "\n";
+    indexFile << "frames " << framePos_.size() << "\n";
+    indexFile.precision(17);
+    for (unsigned int i = 0; i < framePos_.size(); i++) {
+      indexFile << (long long) std::streamoff(framePos_[i]) << " "
+                << frameTimes_[i] << "\n";
+    }
+  }
+
   void DumpReader::readFrame(int whichFrame) { 
     if (!isScanned_) 
       scanFile(); 
-         
+
+    setFieldsNeeded();
+    readSet(whichFrame); 
+    computeCOMprops();
+  }
+
+  /**
+   * Parses a frame that was already read into memory by
+   * readFrameRecord, so that the I/O can happen elsewhere (e.g. on a
+   * prefetching thread).
+   */
+  void DumpReader::readFrame(int whichFrame, const std::string& record) {
+    if (!isScanned_) 
+      scanFile(); 
+
+    setFieldsNeeded();
+    if (isBinary_) {
+      parseBinaryFrame(record.data(), record.size());
+    } else {
+      std::istringstream inputStream(record);
+      parseSet(inputStream);
+    }
+    computeCOMprops();
+  }
+
+  /**
+   * Reads the raw text or binary record of one frame from a stream
+   * opened on this dump file.  This touches no simulation state (or
+   * the reader's own stream), so it is safe to call from another
+   * thread while frames are being parsed or analyzed.
+   */
+  void DumpReader::readFrameRecord(std::istream& in, int whichFrame,
+                                   std::string& record) {
+    record.clear();
+    in.clear();
+    in.seekg(framePos_[whichFrame]);
+
+    if (isBinary_) {
+      char header[16];
+      in.read(header, 16);
+      int recordSize = BinaryDump::getInt64(header + 8);
+      if (in && recordSize >= 16) {
+        record.resize(recordSize);
+        memcpy(&record[0], header, 16);
+        in.read(&record[16], recordSize - 16);
+      }
+      if (!in) record.clear();
+    } else {
+      std::string line;
+      while (std::getline(in, line)) {
+        record += line;
+        record += '\n';
+        if (line.find("</Snapshot>") != std::string::npos) break;
+      }
+    }
+  }
+
+  /**
+   * Returns the length in bytes of the raw record of one frame: the
+   * distance to the start of the next frame, or to the end of the
+   * file for the last one.  readFrameRecord never returns more than
+   * this.  Under MPI only the primary node has the frame positions.
+   */
+  std::streamoff DumpReader::getFrameRecordSize(int whichFrame) {
+    getNFrames();
+    std::streampos end;
+    if (whichFrame + 1 < nframes_) {
+      end = framePos_[whichFrame + 1];
+    } else {
+      inFile_->clear();
+      inFile_->seekg(0, std::ios::end);
+      end = inFile_->tellg();
+    }
+    return end - framePos_[whichFrame];
+  }
+
+  /**
+   * Decides which of the fields in the dump file will be stored,
+   * based on the storage layout of the current snapshot.
+   */
+  void DumpReader::setFieldsNeeded() {
     int storageLayout = info_->getSnapshotManager()->getStorageLayout(); 
+    storageLayout_ = storageLayout;
      
     if (storageLayout & DataStorage::dslPosition) { 
       needPos_ = true; 
@@ -233,9 +479,9 @@ namespace OpenMD {
     } else { 
       needAngMom_ = false;     
     } 
-     
-    readSet(whichFrame); 
+  }
 
+  void DumpReader::computeCOMprops() {
     if (needCOMprops_) {
       Thermo thermo(info_);
       Vector3d com;
@@ -252,7 +498,10 @@ namespace OpenMD {
   } 
    
   void DumpReader::readSet(int whichFrame) {     
-    std::string line;
+    if (isBinary_) {
+      readBinarySet(whichFrame);
+      return;
+    }
 
 #ifndef IS_MPI 
     inFile_->clear();  
@@ -264,6 +513,7 @@ namespace OpenMD {
     int masterNode = 0;
     std::stringstream sstream;
     if (worldRank == masterNode) {
+      std::string line;
       std::string sendBuffer;
 
       inFile_->clear();  
@@ -300,6 +550,12 @@ namespace OpenMD {
     std::istream& inputStream = sstream;  
 #endif
 
+    parseSet(inputStream);
+  }
+
+  void DumpReader::parseSet(std::istream& inputStream) {
+    std::string line;
+
     inputStream.getline(buffer, bufferSize);
 
     line = buffer;
@@ -454,7 +710,7 @@ namespace OpenMD {
         force[0] = tokenizer.nextTokenAsDouble(); 
         force[1] = tokenizer.nextTokenAsDouble(); 
         force[2] = tokenizer.nextTokenAsDouble();           
-        sd->setFrc(force); 
+        if (storageLayout_ & DataStorage::dslForce) sd->setFrc(force);
         break;
       }
       case 't' : {
@@ -463,35 +719,39 @@ namespace OpenMD {
         torque[0] = tokenizer.nextTokenAsDouble(); 
         torque[1] = tokenizer.nextTokenAsDouble(); 
         torque[2] = tokenizer.nextTokenAsDouble();           
-        sd->setTrq(torque);          
+        if (storageLayout_ & DataStorage::dslTorque) sd->setTrq(torque);
         break;
       }
       case 'u' : {
 
         RealType particlePot;
         particlePot = tokenizer.nextTokenAsDouble(); 
-        sd->setParticlePot(particlePot);          
+        if (storageLayout_ & DataStorage::dslParticlePot)
+          sd->setParticlePot(particlePot);
         break;
       }
       case 'c' : {
 
         RealType flucQPos;
         flucQPos = tokenizer.nextTokenAsDouble(); 
-        sd->setFlucQPos(flucQPos);          
+        if (storageLayout_ & DataStorage::dslFlucQPosition)
+          sd->setFlucQPos(flucQPos);
         break;
       }
       case 'w' : {
 
         RealType flucQVel;
         flucQVel = tokenizer.nextTokenAsDouble(); 
-        sd->setFlucQVel(flucQVel);          
+        if (storageLayout_ & DataStorage::dslFlucQVelocity)
+          sd->setFlucQVel(flucQVel);
         break;
       }
       case 'g' : {
 
         RealType flucQFrc;
         flucQFrc = tokenizer.nextTokenAsDouble(); 
-        sd->setFlucQFrc(flucQFrc);          
+        if (storageLayout_ & DataStorage::dslFlucQForce)
+          sd->setFlucQFrc(flucQFrc);
         break;
       }
       case 'e' : {
@@ -500,21 +760,23 @@ namespace OpenMD {
         eField[0] = tokenizer.nextTokenAsDouble(); 
         eField[1] = tokenizer.nextTokenAsDouble(); 
         eField[2] = tokenizer.nextTokenAsDouble();           
-        sd->setElectricField(eField);          
+        if (storageLayout_ & DataStorage::dslElectricField)
+          sd->setElectricField(eField);
         break;
       }
       case 's' : {
 
         RealType sPot;
         sPot = tokenizer.nextTokenAsDouble(); 
-        sd->setSitePotential(sPot);          
+        if (storageLayout_ & DataStorage::dslSitePotential)
+          sd->setSitePotential(sPot);
         break;
       }
       case 'd' : {
         
         RealType density;
         density = tokenizer.nextTokenAsDouble(); 
-        sd->setDensity(density);          
+        if (storageLayout_ & DataStorage::dslDensity) sd->setDensity(density);
         break;
       }
 
@@ -598,28 +860,32 @@ namespace OpenMD {
         
         RealType particlePot;
         particlePot = tokenizer.nextTokenAsDouble(); 
-        sd->setParticlePot(particlePot);
+        if (storageLayout_ & DataStorage::dslParticlePot)
+          sd->setParticlePot(particlePot);
         break;
       }
       case 'c' : {
         
         RealType flucQPos;
         flucQPos = tokenizer.nextTokenAsDouble(); 
-        sd->setFlucQPos(flucQPos);
+        if (storageLayout_ & DataStorage::dslFlucQPosition)
+          sd->setFlucQPos(flucQPos);
         break;
       }
       case 'w' : {
         
         RealType flucQVel;
         flucQVel = tokenizer.nextTokenAsDouble(); 
-        sd->setFlucQVel(flucQVel);
+        if (storageLayout_ & DataStorage::dslFlucQVelocity)
+          sd->setFlucQVel(flucQVel);
         break;
       }
       case 'g' : {
         
         RealType flucQFrc;
         flucQFrc = tokenizer.nextTokenAsDouble(); 
-        sd->setFlucQFrc(flucQFrc);
+        if (storageLayout_ & DataStorage::dslFlucQForce)
+          sd->setFlucQFrc(flucQFrc);
         break;
       }
       case 'e' : {
@@ -628,21 +894,23 @@ namespace OpenMD {
         eField[0] = tokenizer.nextTokenAsDouble(); 
         eField[1] = tokenizer.nextTokenAsDouble(); 
         eField[2] = tokenizer.nextTokenAsDouble();  
-        sd->setElectricField(eField);          
+        if (storageLayout_ & DataStorage::dslElectricField)
+          sd->setElectricField(eField);
         break;
       }
       case 's' : {
         
         RealType sPot;
         sPot = tokenizer.nextTokenAsDouble(); 
-        sd->setSitePotential(sPot);          
+        if (storageLayout_ & DataStorage::dslSitePotential)
+          sd->setSitePotential(sPot);
         break;
       }
       case 'd' : {
         
         RealType dens;
         dens = tokenizer.nextTokenAsDouble(); 
-        sd->setDensity(dens);          
+        if (storageLayout_ & DataStorage::dslDensity) sd->setDensity(dens);
         break;
       }        
       default: {
@@ -771,4 +1039,334 @@ namespace OpenMD {
       } 
     }
   }   
-}//end namespace OpenMD 
+
+  void DumpReader::scanBinaryFile() {
+
+#ifdef IS_MPI     
+    if (worldRank == 0) { 
+#endif // is_mpi 
+
+      // the frame records start right after the <BinaryFrames> line:
+      std::streamoff dataStart = -1;
+      inFile_->clear();
+      inFile_->seekg(0);
+      while (inFile_->getline(buffer, bufferSize)) {
+        std::string line = buffer;
+        if (line.find(BinaryDump::framesTag) != std::string::npos) {
+          dataStart = inFile_->tellg();
+          break;
+        }
+      }
+
+      if (dataStart < 0) {
+        sprintf(painCave.errMsg, 
+                "DumpReader: %s has no %s section\n", filename_.c_str(),
+                BinaryDump::framesTag); 
+        painCave.isFatal = 1; 
+        simError();      
+      }
+
+      inFile_->clear();
+      inFile_->seekg(0, std::ios::end);
+      std::streamoff fileSize = inFile_->tellg();
+      char rec[BinaryDump::frameHeaderSize];
+      bool foundIndex = false;
+
+      // a completed dump ends with an index of the frame offsets:
+      if (fileSize - dataStart >= BinaryDump::trailerSize) {
+        inFile_->seekg(fileSize - BinaryDump::trailerSize);
+        inFile_->read(rec, BinaryDump::trailerSize);
+
+        if (*inFile_ && memcmp(rec + 8, BinaryDump::endMagic, 4) == 0) {
+          std::streamoff indexPos = BinaryDump::getInt64(rec);
+          inFile_->seekg(indexPos);
+          inFile_->read(rec, 12);
+
+          if (*inFile_ && memcmp(rec, BinaryDump::indexMagic, 4) == 0) {
+            int64_t nIndexed = BinaryDump::getInt64(rec + 4);
+            std::vector<char> offsets(8 * nIndexed + 1);
+            inFile_->read(&offsets[0], 8 * nIndexed);
+            if (*inFile_) {
+              for (int64_t i = 0; i < nIndexed; i++) {
+                std::streamoff pos = BinaryDump::getInt64(&offsets[8 * i]);
+                framePos_.push_back(std::streampos(pos));
+              }
+              foundIndex = true;
+            }
+          }
+        }
+      }
+
+      // otherwise (e.g. the run did not finish), walk the frame records:
+      if (!foundIndex) {
+        std::streamoff pos = dataStart;
+        inFile_->clear();
+        while (pos + 16 <= fileSize) {
+          inFile_->seekg(pos);
+          inFile_->read(rec, 16);
+          if (!*inFile_ || memcmp(rec, BinaryDump::frameMagic, 4) != 0)
+            break;
+
+          int64_t length = BinaryDump::getInt64(rec + 8);
+          if (length < BinaryDump::frameHeaderSize ||
+              pos + length > fileSize) {
+            sprintf(painCave.errMsg, 
+                    "DumpReader: last frame in %s is invalid\n",
+                    filename_.c_str());
+            painCave.isFatal = 0; 
+            simError();       
+            break;
+          }
+          framePos_.push_back(std::streampos(pos));
+          pos += length;
+        }
+      }
+
+      nframes_ = framePos_.size(); 
+      
+      if (nframes_ == 0) {
+        sprintf(painCave.errMsg, 
+                "DumpReader: %s does not contain a valid frame\n",
+                filename_.c_str()); 
+        painCave.isFatal = 1; 
+        simError();      
+      }
+      
+#ifdef IS_MPI 
+    }      
+    MPI_Bcast(&nframes_, 1, MPI_INT, 0, MPI_COMM_WORLD);    
+#endif // is_mpi 
+    
+    isScanned_ = true; 
+  }
+
+  void DumpReader::readBinarySet(int whichFrame) {
+    std::vector<char> record;
+    int recordSize = 0;
+
+#ifdef IS_MPI
+    int masterNode = 0;
+    if (worldRank == masterNode) {
+#endif
+      char header[16];
+      inFile_->clear();
+      inFile_->seekg(framePos_[whichFrame]);
+      inFile_->read(header, 16);
+      recordSize = BinaryDump::getInt64(header + 8);
+
+      record.resize(recordSize);
+      memcpy(&record[0], header, 16);
+      inFile_->read(&record[16], recordSize - 16);
+
+      if (!*inFile_) {
+        sprintf(painCave.errMsg, 
+                "DumpReader Error: frame %d of %s is truncated\n",
+                whichFrame, filename_.c_str()); 
+        painCave.isFatal = 1; 
+        simError(); 
+      }
+#ifdef IS_MPI
+    }
+    MPI_Bcast(&recordSize, 1, MPI_INT, masterNode, MPI_COMM_WORLD);
+    record.resize(recordSize);
+    MPI_Bcast(&record[0], recordSize, MPI_CHAR, masterNode, MPI_COMM_WORLD);
+#endif
+
+    parseBinaryFrame(&record[0], recordSize);
+  }
+
+  void DumpReader::parseBinaryFrame(const char* record, int recordSize) {
+
+    const char* p = record;
+    const char* end = record + recordSize;
+    RealType values[32];
+
+    if (recordSize < BinaryDump::frameHeaderSize ||
+        memcmp(p, BinaryDump::frameMagic, 4) != 0) {
+      sprintf(painCave.errMsg, 
+              "DumpReader Error: can not find a binary frame record\n"); 
+      painCave.isFatal = 1; 
+      simError(); 
+    }
+
+    int nStuntDoubles = BinaryDump::getInt32(p + 16);
+    int nSites = BinaryDump::getInt32(p + 20);
+    p += 24;
+
+    // frame properties, filled in the same order as readFrameProperties:
+    Snapshot* s = info_->getSnapshotManager()->getCurrentSnapshot();
+    s->setTime(BinaryDump::getDouble(p));
+    p += 8;
+
+    Mat3x3d hmat;
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 3; j++, p += 8)
+        hmat(i, j) = BinaryDump::getDouble(p);
+    s->setHmat(hmat);
+
+    pair<RealType, RealType> thermostat;
+    thermostat.first = BinaryDump::getDouble(p);
+    thermostat.second = BinaryDump::getDouble(p + 8);
+    p += 16;
+    s->setThermostat(thermostat);
+
+    Mat3x3d eta;
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 3; j++, p += 8)
+        eta(i, j) = BinaryDump::getDouble(p);
+    s->setBarostat(eta);
+
+    for (int n = 0; n < nStuntDoubles + nSites; n++) {
+      bool isSite = (n >= nStuntDoubles);
+      int headerSize = isSite ? 12 : 8;
+
+      if (end - p < headerSize) {
+        sprintf(painCave.errMsg, 
+                "DumpReader Error: binary frame record is truncated\n"); 
+        painCave.isFatal = 1; 
+        simError(); 
+      }
+
+      int index = BinaryDump::getInt32(p);
+      int siteIndex = isSite ? BinaryDump::getInt32(p + 4) : -1;
+      int fields = BinaryDump::getInt32(p + headerSize - 4);
+      p += headerSize;
+
+      if (fields >> BinaryDump::nFieldBits) {
+        sprintf(painCave.errMsg, 
+                "DumpReader Error: %d is an unrecognized set of fields\n",
+                fields); 
+        painCave.isFatal = 1; 
+        simError(); 
+      }
+
+      int nValues = BinaryDump::countValues(fields);
+      if (end - p < 8 * nValues) {
+        sprintf(painCave.errMsg, 
+                "DumpReader Error: binary frame record is truncated\n"); 
+        painCave.isFatal = 1; 
+        simError(); 
+      }
+      for (int i = 0; i < nValues; i++, p += 8)
+        values[i] = BinaryDump::getDouble(p);
+
+      StuntDouble* sd = info_->getIOIndexToIntegrableObject(index);
+      if (sd == NULL) continue;
+
+      if (isSite) {
+        if (siteIndex >= 0 && sd->isRigidBody()) {
+          RigidBody* rb = static_cast<RigidBody*>(sd);
+          sd = rb->getAtoms()[siteIndex];
+        }
+        setBinaryFields(sd, fields, values);
+        continue;
+      }
+
+      if (needPos_ && !(fields & BinaryDump::fPosition)) {
+        sprintf(painCave.errMsg, 
+                "DumpReader Error: StuntDouble %d has no Position\n"
+                "\tField (\"p\") specified.\n", index);  
+        painCave.isFatal = 1; 
+        simError(); 
+      }
+
+      if (sd->isDirectional() && needQuaternion_ &&
+          !(fields & BinaryDump::fQuaternion)) {
+        sprintf(painCave.errMsg, 
+                "DumpReader Error: Directional StuntDouble %d has no\n"
+                "\tQuaternion Field (\"q\") specified.\n", index);  
+        painCave.isFatal = 1; 
+        simError(); 
+      }
+
+      setBinaryFields(sd, fields, values);
+
+      if (sd->isRigidBody()) {
+        RigidBody* rb = static_cast<RigidBody*>(sd);
+        if (needPos_) {
+          rb->updateAtoms();
+        }
+        if (needVel_) {
+          rb->updateAtomVel();
+        }
+      }
+    }
+  }
+
+  /**
+   * Applies the values from one binary record, with the same rules
+   * parseDumpLine and parseSiteLine use for the text type fields.
+   */
+  void DumpReader::setBinaryFields(StuntDouble* sd, int fields,
+                                   const RealType* v) {
+
+    if (fields & BinaryDump::fPosition) {
+      if (needPos_) sd->setPos(Vector3d(v[0], v[1], v[2]));
+      v += 3;
+    }
+    if (fields & BinaryDump::fVelocity) {
+      if (needVel_) sd->setVel(Vector3d(v[0], v[1], v[2]));
+      v += 3;
+    }
+    if (fields & BinaryDump::fQuaternion) {
+      if (sd->isDirectional()) {
+        Quat4d q(v[0], v[1], v[2], v[3]);
+        if (q.length() < OpenMD::epsilon) {
+          sprintf(painCave.errMsg, 
+                  "DumpReader Error: initial quaternion error "
+                  "(q0^2 + q1^2 + q2^2 + q3^2) ~ 0\n"); 
+          painCave.isFatal = 1; 
+          simError(); 
+        }
+        q.normalize(); 
+        if (needQuaternion_) sd->setQ(q);
+      }
+      v += 4;
+    }
+    if (fields & BinaryDump::fAngMomentum) {
+      if (sd->isDirectional() && needAngMom_)
+        sd->setJ(Vector3d(v[0], v[1], v[2]));
+      v += 3;
+    }
+    if (fields & BinaryDump::fForce) {
+      if (storageLayout_ & DataStorage::dslForce)
+        sd->setFrc(Vector3d(v[0], v[1], v[2]));
+      v += 3;
+    }
+    if (fields & BinaryDump::fTorque) {
+      if (storageLayout_ & DataStorage::dslTorque)
+        sd->setTrq(Vector3d(v[0], v[1], v[2]));
+      v += 3;
+    }
+    if (fields & BinaryDump::fFlucQPos) {
+      if (storageLayout_ & DataStorage::dslFlucQPosition) sd->setFlucQPos(*v);
+      v++;
+    }
+    if (fields & BinaryDump::fFlucQVel) {
+      if (storageLayout_ & DataStorage::dslFlucQVelocity) sd->setFlucQVel(*v);
+      v++;
+    }
+    if (fields & BinaryDump::fFlucQFrc) {
+      if (storageLayout_ & DataStorage::dslFlucQForce) sd->setFlucQFrc(*v);
+      v++;
+    }
+    if (fields & BinaryDump::fElectricField) {
+      if (storageLayout_ & DataStorage::dslElectricField)
+        sd->setElectricField(Vector3d(v[0], v[1], v[2]));
+      v += 3;
+    }
+    if (fields & BinaryDump::fSitePotential) {
+      if (storageLayout_ & DataStorage::dslSitePotential)
+        sd->setSitePotential(*v);
+      v++;
+    }
+    if (fields & BinaryDump::fParticlePot) {
+      if (storageLayout_ & DataStorage::dslParticlePot) sd->setParticlePot(*v);
+      v++;
+    }
+    if (fields & BinaryDump::fDensity) {
+      if (storageLayout_ & DataStorage::dslDensity) sd->setDensity(*v);
+      v++;
+    }
+  }
+}//end namespace OpenMD
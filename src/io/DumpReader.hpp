@@ -76,33 +76,57 @@ namespace OpenMD {
     }
          
     virtual void readFrame(int whichFrame); 
+    void readFrame(int whichFrame, const std::string& record);
+    void readFrameRecord(std::istream& in, int whichFrame,
+                         std::string& record);
+    std::streamoff getFrameRecordSize(int whichFrame);
+
+    const std::string& getFilename() const {
+      return filename_;
+    }
  
   protected: 
  
     void scanFile();  
+    bool isIndexable();
+    bool readIndex(std::streamoff& resumePos);
+    bool checkIndexedFrame(int whichFrame);
+    void writeIndex(std::streampos scannedPos);
+    void setFieldsNeeded();
+    void computeCOMprops();
     void readSet(int whichFrame); 
+    void parseSet(std::istream& inputStream);
     virtual void parseDumpLine(const std::string&); 
     virtual void parseSiteLine(const std::string&);  
     virtual void readFrameProperties(std::istream& inputStream);
     void readStuntDoubles(std::istream& inputStream);
     void readSiteData(std::istream& inputStream);
+
+    /** binary (.dumpb) counterparts of scanFile and readSet */
+    void scanBinaryFile();
+    void readBinarySet(int whichFrame);
+    void parseBinaryFrame(const char* record, int recordSize);
+    void setBinaryFields(StuntDouble* sd, int fields, const RealType* values);
          
     SimInfo* info_; 
  
     std::string filename_; 
     bool isScanned_; 
+    bool isBinary_;
  
     int nframes_; 
  
     std::istream* inFile_; 
      
     std::vector<std::streampos> framePos_; 
+    std::vector<RealType> frameTimes_;
  
     bool needPos_; 
     bool needVel_; 
     bool needQuaternion_; 
     bool needAngMom_;
     bool needCOMprops_;
+    int storageLayout_;        /**< fields stored by the current snapshot */
 
     const static int bufferSize = 4096;
     char buffer[bufferSize];
@@ -54,6 +54,8 @@
 #include "io/gzstream.hpp"
 #endif
 #include "io/Globals.hpp"
+#include "io/BinaryDump.hpp"
+#include "utils/CaseConversion.hpp"
 
 #ifdef _MSC_VER
 #define isnan(x) _isnan((x))
@@ -87,9 +89,12 @@ namespace OpenMD {
     }
 
     createDumpFile_ = true;
+    // only the master node knows the dump file name, so use the keyword
+    // here.  Binary dumps are written uncompressed so they stay seekable:
+    binaryDump_ = (toUpperCopy(simParams->getDumpFileFormat()) == "BINARY");
 #ifdef HAVE_LIBZ
     if (needCompression_) {
-      filename_ += ".gz";
+      if (!binaryDump_) filename_ += ".gz";
       eorFilename_ += ".gz";
     }
 #endif
@@ -99,7 +104,8 @@ namespace OpenMD {
     if (worldRank == 0) {
 #endif // is_mpi
 
-      dumpFile_ = createOStream(filename_);
+      dumpFile_ = binaryDump_ ? createBinaryOStream(filename_) :
+        createOStream(filename_);
 
       if (!dumpFile_) {
         sprintf(painCave.errMsg, "Could not open \"%s\" for dump output.\n",
@@ -139,9 +145,11 @@ namespace OpenMD {
     }
 
     createDumpFile_ = true;
+    // binary dumps are written uncompressed so they stay seekable:
+    binaryDump_ = BinaryDump::isBinaryFileName(filename_);
 #ifdef HAVE_LIBZ
     if (needCompression_) {
-      filename_ += ".gz";
+      if (!binaryDump_) filename_ += ".gz";
       eorFilename_ += ".gz";
     }
 #endif
@@ -152,7 +160,8 @@ namespace OpenMD {
 #endif // is_mpi
 
 
-      dumpFile_ = createOStream(filename_);
+      dumpFile_ = binaryDump_ ? createBinaryOStream(filename_) :
+        createOStream(filename_);
 
       if (!dumpFile_) {
         sprintf(painCave.errMsg, "Could not open \"%s\" for dump output.\n",
@@ -191,9 +200,11 @@ namespace OpenMD {
       doSiteData_ = false;
     }
 
+    // binary dumps are written uncompressed so they stay seekable:
+    binaryDump_ = BinaryDump::isBinaryFileName(filename_);
 #ifdef HAVE_LIBZ
     if (needCompression_) {
-      filename_ += ".gz";
+      if (!binaryDump_) filename_ += ".gz";
       eorFilename_ += ".gz";
     }
 #endif
@@ -205,7 +216,8 @@ namespace OpenMD {
 
       createDumpFile_ = writeDumpFile;
       if (createDumpFile_) {
-        dumpFile_ = createOStream(filename_);
+        dumpFile_ = binaryDump_ ? createBinaryOStream(filename_) :
+          createOStream(filename_);
 
         if (!dumpFile_) {
           sprintf(painCave.errMsg, "Could not open \"%s\" for dump output.\n",
@@ -230,7 +242,10 @@ namespace OpenMD {
     if (worldRank == 0) {
 #endif // is_mpi
       if (createDumpFile_){
-        writeClosing(*dumpFile_);
+        if (binaryDump_)
+          writeBinaryClosing(*dumpFile_);
+        else
+          writeClosing(*dumpFile_);
         delete dumpFile_;
       }
 #ifdef IS_MPI
@@ -783,7 +798,10 @@ namespace OpenMD {
   }
 
   void DumpWriter::writeDump() {
-    writeFrame(*dumpFile_);
+    if (binaryDump_)
+      writeBinaryFrame(*dumpFile_);
+    else
+      writeFrame(*dumpFile_);
   }
 
   void DumpWriter::writeEor() {
@@ -817,6 +835,13 @@ namespace OpenMD {
 
 
   void DumpWriter::writeDumpAndEor() {
+    // the .eor file is always text, so a binary dump can't share a TeeBuf
+    if (binaryDump_) {
+      writeDump();
+      writeEor();
+      return;
+    }
+
     std::vector<std::streambuf*> buffers;
     std::ostream* eorStream = NULL;
 #ifdef IS_MPI
@@ -869,4 +894,260 @@ namespace OpenMD {
     os.flush();
   }
 
+  void DumpWriter::putChecked(std::string& buffer, RealType value,
+                              const char* what, int index) {
+    if (isinf(value) || isnan(value)) {
+      if (index < 0)
+        sprintf( painCave.errMsg,
+                 "DumpWriter detected a numerical error writing the %s",
+                 what);
+      else
+        sprintf( painCave.errMsg,
+                 "DumpWriter detected a numerical error writing the %s"
+                 " for object %d", what, index);
+      painCave.isFatal = 1;
+      simError();
+    }
+    BinaryDump::putDouble(buffer, value);
+  }
+
+  void DumpWriter::prepareBinaryRecord(StuntDouble* sd, std::string& buffer) {
+
+    int index = sd->getGlobalIntegrableObjectIndex();
+    int fields = BinaryDump::fPosition | BinaryDump::fVelocity;
+
+    if (sd->isDirectional())
+      fields |= BinaryDump::fQuaternion | BinaryDump::fAngMomentum;
+    if (needForceVector_) {
+      fields |= BinaryDump::fForce;
+      if (sd->isDirectional()) fields |= BinaryDump::fTorque;
+    }
+
+    BinaryDump::putInt32(buffer, index);
+    BinaryDump::putInt32(buffer, fields);
+
+    Vector3d pos = sd->getPos();
+    Vector3d vel = sd->getVel();
+    for (int i = 0; i < 3; i++) putChecked(buffer, pos[i], "position", index);
+    for (int i = 0; i < 3; i++) putChecked(buffer, vel[i], "velocity", index);
+
+    if (fields & BinaryDump::fQuaternion) {
+      Quat4d q = sd->getQ();
+      Vector3d ji = sd->getJ();
+      for (int i = 0; i < 4; i++)
+        putChecked(buffer, q[i], "quaternion", index);
+      for (int i = 0; i < 3; i++)
+        putChecked(buffer, ji[i], "angular momentum", index);
+    }
+
+    if (fields & BinaryDump::fForce) {
+      Vector3d frc = sd->getFrc();
+      for (int i = 0; i < 3; i++) putChecked(buffer, frc[i], "force", index);
+    }
+
+    if (fields & BinaryDump::fTorque) {
+      Vector3d trq = sd->getTrq();
+      for (int i = 0; i < 3; i++) putChecked(buffer, trq[i], "torque", index);
+    }
+  }
+
+  void DumpWriter::prepareBinarySiteRecord(StuntDouble* sd, int ioIndex,
+                                           int siteIndex,
+                                           std::string& buffer) {
+    int storageLayout = info_->getSnapshotManager()->getStorageLayout();
+    int fields = 0;
+
+    if (needFlucQ_) {
+      if (storageLayout & DataStorage::dslFlucQPosition)
+        fields |= BinaryDump::fFlucQPos;
+      if (storageLayout & DataStorage::dslFlucQVelocity)
+        fields |= BinaryDump::fFlucQVel;
+      if (needForceVector_ && (storageLayout & DataStorage::dslFlucQForce))
+        fields |= BinaryDump::fFlucQFrc;
+    }
+    if (needElectricField_ && (storageLayout & DataStorage::dslElectricField))
+      fields |= BinaryDump::fElectricField;
+    if (needSitePotential_ && (storageLayout & DataStorage::dslSitePotential))
+      fields |= BinaryDump::fSitePotential;
+    if (needParticlePot_ && (storageLayout & DataStorage::dslParticlePot))
+      fields |= BinaryDump::fParticlePot;
+    if (needDensity_ && (storageLayout & DataStorage::dslDensity))
+      fields |= BinaryDump::fDensity;
+
+    BinaryDump::putInt32(buffer, ioIndex);
+    BinaryDump::putInt32(buffer, siteIndex);
+    BinaryDump::putInt32(buffer, fields);
+
+    if (fields & BinaryDump::fFlucQPos)
+      putChecked(buffer, sd->getFlucQPos(), "fluctuating charge", ioIndex);
+    if (fields & BinaryDump::fFlucQVel)
+      putChecked(buffer, sd->getFlucQVel(), "fluctuating charge velocity",
+                 ioIndex);
+    if (fields & BinaryDump::fFlucQFrc)
+      putChecked(buffer, sd->getFlucQFrc(), "fluctuating charge force",
+                 ioIndex);
+    if (fields & BinaryDump::fElectricField) {
+      Vector3d eField = sd->getElectricField();
+      for (int i = 0; i < 3; i++)
+        putChecked(buffer, eField[i], "electric field", ioIndex);
+    }
+    if (fields & BinaryDump::fSitePotential)
+      putChecked(buffer, sd->getSitePotential(), "site potential", ioIndex);
+    if (fields & BinaryDump::fParticlePot)
+      putChecked(buffer, sd->getParticlePot(), "particle potential", ioIndex);
+    if (fields & BinaryDump::fDensity)
+      putChecked(buffer, sd->getDensity(), "density", ioIndex);
+  }
+
+#ifdef IS_MPI
+  /**
+   * Collects the binary records prepared by every processor on the
+   * master node, in processor order.  On return, the master node's
+   * buffer and count hold the records from all processors.
+   */
+  void DumpWriter::gatherBinaryRecords(std::string& buffer, int& count) {
+    const int masterNode = 0;
+    int nProc;
+    MPI_Comm_size(MPI_COMM_WORLD, &nProc);
+
+    int myLength = buffer.size();
+    std::vector<int> lengths(nProc, 0);
+    std::vector<int> displs(nProc, 0);
+    int totalCount = 0;
+
+    MPI_Gather(&myLength, 1, MPI_INT, &lengths[0], 1, MPI_INT, masterNode,
+               MPI_COMM_WORLD);
+    MPI_Reduce(&count, &totalCount, 1, MPI_INT, MPI_SUM, masterNode,
+               MPI_COMM_WORLD);
+
+    std::vector<char> recvBuffer;
+    if (worldRank == masterNode) {
+      for (int i = 1; i < nProc; i++)
+        displs[i] = displs[i-1] + lengths[i-1];
+      recvBuffer.resize(displs[nProc-1] + lengths[nProc-1] + 1);
+    }
+
+    MPI_Gatherv(const_cast<char*>(buffer.data()), myLength, MPI_CHAR,
+                recvBuffer.empty() ? NULL : &recvBuffer[0], &lengths[0],
+                &displs[0], MPI_CHAR, masterNode, MPI_COMM_WORLD);
+
+    if (worldRank == masterNode) {
+      buffer.assign(&recvBuffer[0], recvBuffer.size() - 1);
+      count = totalCount;
+    }
+  }
+#endif
+
+  void DumpWriter::writeBinaryFrame(std::ostream& os) {
+
+    Molecule* mol;
+    StuntDouble* sd;
+    SimInfo::MoleculeIterator mi;
+    Molecule::IntegrableObjectIterator ii;
+    RigidBody::AtomIterator ai;
+
+    // every node prepares the records for the integrable objects it owns
+    std::string sdBuffer;
+    std::string siteBuffer;
+    int nStuntDoubles = 0;
+    int nSites = 0;
+
+    for (mol = info_->beginMolecule(mi); mol != NULL;
+         mol = info_->nextMolecule(mi)) {
+      for (sd = mol->beginIntegrableObject(ii); sd != NULL;
+           sd = mol->nextIntegrableObject(ii)) {
+
+        prepareBinaryRecord(sd, sdBuffer);
+        nStuntDoubles++;
+
+        if (doSiteData_) {
+          int ioIndex = sd->getGlobalIntegrableObjectIndex();
+          // do one for the IO itself
+          prepareBinarySiteRecord(sd, ioIndex, -1, siteBuffer);
+          nSites++;
+
+          if (sd->isRigidBody()) {
+            RigidBody* rb = static_cast<RigidBody*>(sd);
+            int siteIndex = 0;
+            for (Atom* atom = rb->beginAtom(ai); atom != NULL;
+                 atom = rb->nextAtom(ai)) {
+              prepareBinarySiteRecord(atom, ioIndex, siteIndex, siteBuffer);
+              nSites++;
+              siteIndex++;
+            }
+          }
+        }
+      }
+    }
+
+#ifdef IS_MPI
+    gatherBinaryRecords(sdBuffer, nStuntDoubles);
+    if (doSiteData_) gatherBinaryRecords(siteBuffer, nSites);
+
+    if (worldRank == 0) {
+#endif
+      Snapshot* s = info_->getSnapshotManager()->getCurrentSnapshot();
+      std::string header(BinaryDump::frameMagic, 4);
+      BinaryDump::putInt32(header, frameOffsets_.size());
+      BinaryDump::putInt64(header, BinaryDump::frameHeaderSize +
+                           sdBuffer.size() + siteBuffer.size());
+      BinaryDump::putInt32(header, nStuntDoubles);
+      BinaryDump::putInt32(header, nSites);
+
+      putChecked(header, s->getTime(), "time", -1);
+
+      // matrices go out in the same order as the text FrameData:
+      Mat3x3d hmat = s->getHmat();
+      for (unsigned int j = 0; j < 3; j++)
+        for (unsigned int i = 0; i < 3; i++)
+          putChecked(header, hmat(i, j), "box", -1);
+
+      pair<RealType, RealType> thermostat = s->getThermostat();
+      putChecked(header, thermostat.first, "thermostat", -1);
+      putChecked(header, thermostat.second, "thermostat", -1);
+
+      Mat3x3d eta = s->getBarostat();
+      for (unsigned int j = 0; j < 3; j++)
+        for (unsigned int i = 0; i < 3; i++)
+          putChecked(header, eta(i, j), "barostat", -1);
+
+      frameOffsets_.push_back(os.tellp());
+      os.write(header.data(), header.size());
+      os.write(sdBuffer.data(), sdBuffer.size());
+      os.write(siteBuffer.data(), siteBuffer.size());
+      os.flush();
+#ifdef IS_MPI
+    }
+#endif
+  }
+
+  std::ostream* DumpWriter::createBinaryOStream(const std::string& filename) {
+
+    std::ostream* newOStream = new std::ofstream(filename.c_str(),
+                                                 std::ios::out |
+                                                 std::ios::binary);
+    //write out MetaData first, just as in a text dump
+    (*newOStream) << "<OpenMD version=2 " << BinaryDump::formatTag << ">"
+                  << std::endl;
+    (*newOStream) << "  <MetaData>" << std::endl;
+    (*newOStream) << info_->getRawMetaData();
+    (*newOStream) << "  </MetaData>" << std::endl;
+    (*newOStream) << "  " << BinaryDump::framesTag << std::endl;
+    return newOStream;
+  }
+
+  void DumpWriter::writeBinaryClosing(std::ostream& os) {
+
+    int64_t indexOffset = os.tellp();
+    std::string index(BinaryDump::indexMagic, 4);
+    BinaryDump::putInt64(index, frameOffsets_.size());
+    for (unsigned int i = 0; i < frameOffsets_.size(); i++)
+      BinaryDump::putInt64(index, frameOffsets_[i]);
+    BinaryDump::putInt64(index, indexOffset);
+    index.append(BinaryDump::endMagic, 4);
+
+    os.write(index.data(), index.size());
+    os.flush();
+  }
+
 }//end namespace OpenMD
@@ -55,6 +55,8 @@
 #include <cstdlib>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <stdint.h>
+#include <vector>
 
 #include "primitives/Atom.hpp"
 #include "brains/SimInfo.hpp"
@@ -87,6 +89,19 @@ namespace OpenMD {
     std::string prepareSiteLine(StuntDouble* sd, int ioIndex, int siteIndex);
     std::ostream* createOStream(const std::string& filename);
     void writeClosing(std::ostream& os);
+
+    /** binary (.dumpb) counterparts of the text routines above */
+    void writeBinaryFrame(std::ostream& os);
+    void prepareBinaryRecord(StuntDouble* sd, std::string& buffer);
+    void prepareBinarySiteRecord(StuntDouble* sd, int ioIndex, int siteIndex,
+                                 std::string& buffer);
+    void putChecked(std::string& buffer, RealType value, const char* what,
+                    int index);
+    std::ostream* createBinaryOStream(const std::string& filename);
+    void writeBinaryClosing(std::ostream& os);
+#ifdef IS_MPI
+    void gatherBinaryRecords(std::string& buffer, int& count);
+#endif
     
     SimInfo* info_;
     std::string filename_;
@@ -101,6 +116,8 @@ namespace OpenMD {
     bool needDensity_;
     bool doSiteData_;
     bool createDumpFile_;
+    bool binaryDump_;
+    std::vector<int64_t> frameOffsets_;
   };
 
 }
@@ -88,6 +88,9 @@ namespace OpenMD {
     DefineOptionalParameter(ForceFieldVariant, "forceFieldVariant");
     DefineOptionalParameter(ForceFieldFileName, "forceFieldFileName");
     DefineOptionalParameter(DampingAlpha, "dampingAlpha");
+    DefineOptionalParameterWithDefaultValue(SpmeGridSpacing,
+                                            "spmeGridSpacing", 1.0);
+    DefineOptionalParameter(SpmeOrder, "spmeOrder");
     DefineOptionalParameter(SurfaceTension, "surfaceTension");
     DefineOptionalParameter(PrintPressureTensor, "printPressureTensor");
     DefineOptionalParameter(PrintVirialTensor, "printVirialTensor");
@@ -130,6 +133,12 @@ namespace OpenMD {
                                             true);
     DefineOptionalParameterWithDefaultValue(UseLongRangeCorrections,
                                             "useLongRangeCorrections", true);
+    DefineOptionalParameterWithDefaultValue(UseAtomPairList,
+                                            "useAtomPairList", false);
+    DefineOptionalParameterWithDefaultValue(UseDensityCache,
+                                            "useDensityCache", false);
+    DefineOptionalParameterWithDefaultValue(UseComponentArrays,
+                                            "useComponentArrays", false);
     DefineOptionalParameterWithDefaultValue(UseInitalTime, "useInitialTime",
                                             false);
     DefineOptionalParameterWithDefaultValue(UseIntialExtendedSystemState,
@@ -145,6 +154,8 @@ namespace OpenMD {
     DefineOptionalParameterWithDefaultValue(Dielectric, "dielectric", 80.0);
     DefineOptionalParameterWithDefaultValue(CompressDumpFile,
                                             "compressDumpFile", false);
+    DefineOptionalParameterWithDefaultValue(DumpFileFormat,
+                                            "dumpFileFormat", "TEXT");
     DefineOptionalParameterWithDefaultValue(PrintHeatFlux, "printHeatFlux",
                                             false);
     DefineOptionalParameterWithDefaultValue(OutputForceVector,
@@ -161,6 +172,15 @@ namespace OpenMD {
                                             "outputDensity", false);
     DefineOptionalParameterWithDefaultValue(SkinThickness, "skinThickness",
                                             1.0);
+    DefineOptionalParameterWithDefaultValue(RespaBondedSteps,
+                                            "respaBondedSteps", 2);
+    DefineOptionalParameterWithDefaultValue(RespaPairSteps,
+                                            "respaPairSteps", 1);
+    DefineOptionalParameterWithDefaultValue(BalanceMolecules,
+                                            "balanceMolecules", false);
+    DefineOptionalParameterWithDefaultValue(ForceDecompositionMethod,
+                                            "forceDecomposition",
+                                            "FORCE_MATRIX");
     DefineOptionalParameterWithDefaultValue(StatFileFormat,
                                             "statFileFormat",
                                             "TIME|TOTAL_ENERGY|POTENTIAL_ENERGY|KINETIC_ENERGY|TEMPERATURE|PRESSURE|VOLUME|CONSERVED_QUANTITY");
@@ -227,7 +247,12 @@ namespace OpenMD {
                    isEqualIgnoreCase("NPGT") || isEqualIgnoreCase("NGammaT") ||
                    isEqualIgnoreCase("NGT") ||
                    isEqualIgnoreCase("LANGEVINHULL") ||
-                   isEqualIgnoreCase("LHULL") || isEqualIgnoreCase("SMIPD"));
+                   isEqualIgnoreCase("LHULL") || isEqualIgnoreCase("SMIPD") ||
+                   isEqualIgnoreCase("RESPA_NVE") ||
+                   isEqualIgnoreCase("RESPA_NVT") ||
+                   isEqualIgnoreCase("RESPA_NPTi") ||
+                   isEqualIgnoreCase("RESPA_NPTf") ||
+                   isEqualIgnoreCase("RESPA_NPTxyz"));
     CheckParameter(Dt, isPositive());
     CheckParameter(RunTime, isPositive());
     CheckParameter(FinalConfig, isNotEmpty());
@@ -261,15 +286,25 @@ namespace OpenMD {
                    isEqualIgnoreCase("SHIFTED_POTENTIAL") ||
                    isEqualIgnoreCase("SHIFTED_FORCE") ||
                    isEqualIgnoreCase("REACTION_FIELD") ||
-                   isEqualIgnoreCase("TAYLOR_SHIFTED"));
+                   isEqualIgnoreCase("TAYLOR_SHIFTED") ||
+                   isEqualIgnoreCase("EWALD_SPME"));
     CheckParameter(ElectrostaticScreeningMethod,
                    isEqualIgnoreCase("UNDAMPED") ||
                    isEqualIgnoreCase("DAMPED"));
+    CheckParameter(DumpFileFormat, isEqualIgnoreCase("TEXT") ||
+                   isEqualIgnoreCase("BINARY"));
+    CheckParameter(ForceDecompositionMethod,
+                   isEqualIgnoreCase("FORCE_MATRIX") ||
+                   isEqualIgnoreCase("SPATIAL"));
     CheckParameter(SwitchingFunctionType, isEqualIgnoreCase("CUBIC") ||
                    isEqualIgnoreCase("FIFTH_ORDER_POLYNOMIAL"));
     CheckParameter(OrthoBoxTolerance, isPositive());
     CheckParameter(DampingAlpha,isNonNegative());
+    CheckParameter(SpmeGridSpacing, isPositive());
+    CheckParameter(SpmeOrder, isPositive());
     CheckParameter(SkinThickness, isPositive());
+    CheckParameter(RespaBondedSteps, isPositive());
+    CheckParameter(RespaPairSteps, isPositive());
     CheckParameter(Viscosity, isNonNegative());
     CheckParameter(BeadSize, isPositive());
     CheckParameter(FrozenBufferRadius, isPositive());
@@ -84,6 +84,9 @@ namespace OpenMD {
     DeclareParameter(TargetPressure, RealType);
     DeclareParameter(UseAtomicVirial, bool);
     DeclareParameter(UseLongRangeCorrections, bool);
+    DeclareParameter(UseAtomPairList, bool);
+    DeclareParameter(UseDensityCache, bool);
+    DeclareParameter(UseComponentArrays, bool);
     DeclareParameter(TauThermostat, RealType);
     DeclareParameter(TauBarostat, RealType);
     DeclareParameter(ZconsTime, RealType);
@@ -110,10 +113,13 @@ namespace OpenMD {
     DeclareParameter(ElectrostaticSummationMethod, std::string);
     DeclareParameter(ElectrostaticScreeningMethod, std::string);
     DeclareParameter(DampingAlpha, RealType);
+    DeclareParameter(SpmeGridSpacing, RealType);
+    DeclareParameter(SpmeOrder, int);
     DeclareParameter(Dielectric, RealType);
     DeclareParameter(CutoffMethod, std::string);
     DeclareParameter(SwitchingFunctionType, std::string);
     DeclareParameter(CompressDumpFile, bool);
+    DeclareParameter(DumpFileFormat, std::string);
     DeclareParameter(OutputForceVector, bool);
     DeclareParameter(OutputParticlePotential, bool);
     DeclareParameter(OutputElectricField, bool);
@@ -121,6 +127,10 @@ namespace OpenMD {
     DeclareParameter(OutputSitePotential, bool);
     DeclareParameter(OutputDensity, bool);
     DeclareParameter(SkinThickness, RealType);
+    DeclareParameter(RespaBondedSteps, int);
+    DeclareParameter(RespaPairSteps, int);
+    DeclareParameter(BalanceMolecules, bool);
+    DeclareParameter(ForceDecompositionMethod, std::string);
     DeclareParameter(StatFileFormat, std::string);
     DeclareParameter(StatFilePrecision, int);
     DeclareParameter(HydroPropFile, std::string);
@@ -58,6 +58,7 @@ CubicSpline::CubicSpline() : isUniform(true), generated(false) {
 void CubicSpline::addPoint(const RealType xp, const RealType yp) {
   x_.push_back(xp);
   y_.push_back(yp);
+  generated = false;
 }
 
 void CubicSpline::addPoints(const vector<RealType>& xps, 
@@ -69,6 +70,7 @@ void CubicSpline::addPoints(const vector<RealType>& xps,
     x_.push_back(xps[i]);
     y_.push_back(yps[i]);
   }
+  generate();
 }
 
 void CubicSpline::generate() { 
@@ -205,17 +207,20 @@ RealType CubicSpline::getValueAt(const RealType& t) {
   // Output:
   //   value of spline at t.
   
-  if (!generated) generate();
+  assert(generated);
   
   assert(t >= x_.front());
   assert(t <= x_.back());
 
   //  Find the interval ( x[j], x[j+1] ) that contains or is nearest
-  //  to t.
+  //  to t.  j and dt are locals so that a generated spline can be
+  //  evaluated from several threads at once.
+
+  int j;
 
   if (isUniform) {    
     
-    j = max(0, min(n-1, int((t - x_[0]) * dx)));   
+    j = max(0, min(n-1, int((t - x_[0]) * dx)));
 
   } else { 
 
@@ -231,7 +236,7 @@ RealType CubicSpline::getValueAt(const RealType& t) {
   
   //  Evaluate the cubic polynomial.
   
-  dt = t - x_[j];
+  RealType dt = t - x_[j];
   return y_[j] + dt*(b[j] + dt*(c[j] + dt*d[j]));  
 }
 
@@ -244,17 +249,20 @@ void CubicSpline::getValueAt(const RealType& t, RealType& v) {
   // Output:
   //   value of spline at t.
   
-  if (!generated) generate();
+  assert(generated);
   
   assert(t >= x_.front());
   assert(t <= x_.back());
 
   //  Find the interval ( x[j], x[j+1] ) that contains or is nearest
-  //  to t.
+  //  to t.  j and dt are locals so that a generated spline can be
+  //  evaluated from several threads at once.
+
+  int j;
 
   if (isUniform) {    
     
-    j = max(0, min(n-1, int((t - x_[0]) * dx)));   
+    j = max(0, min(n-1, int((t - x_[0]) * dx)));
 
   } else { 
 
@@ -270,17 +278,17 @@ void CubicSpline::getValueAt(const RealType& t, RealType& v) {
   
   //  Evaluate the cubic polynomial.
   
-  dt = t - x_[j];
+  RealType dt = t - x_[j];
   v = y_[j] + dt*(b[j] + dt*(c[j] + dt*d[j]));  
 }
 
 pair<RealType, RealType> CubicSpline::getLimits(){
-  if (!generated) generate();
+  assert(generated);
   return make_pair( x_.front(), x_.back() );
 }
 
 RealType CubicSpline::getSpacing(){
-  if (!generated) generate();
+  assert(generated);
   assert(isUniform);
   if (isUniform) return 1.0/dx;
   else return 0.0;
@@ -293,17 +301,20 @@ void CubicSpline::getValueAndDerivativeAt(const RealType& t, RealType& v,
   // Input parameters
   //   t = point where spline is to be evaluated.
 
-  if (!generated) generate();
+  assert(generated);
   
   assert(t >= x_.front());
   assert(t <= x_.back());
 
   //  Find the interval ( x[j], x[j+1] ) that contains or is nearest
-  //  to t.
+  //  to t.  j and dt are locals so that a generated spline can be
+  //  evaluated from several threads at once.
+
+  int j;
 
   if (isUniform) {    
     
-    j = max(0, min(n-1, int((t - x_[0]) * dx)));   
+    j = max(0, min(n-1, int((t - x_[0]) * dx)));
 
   } else { 
 
@@ -319,7 +330,7 @@ void CubicSpline::getValueAndDerivativeAt(const RealType& t, RealType& v,
   
   //  Evaluate the cubic polynomial.
   
-  dt = t - x_[j];
+  RealType dt = t - x_[j];
 
   v = y_[j] + dt*(b[j] + dt*(c[j] + dt*d[j]));
   dv = b[j] + dt*(2.0 * c[j] + 3.0 * dt * d[j]); 
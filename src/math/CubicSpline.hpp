@@ -50,12 +50,20 @@ using namespace std;
 namespace OpenMD {
 
   class CubicSpline {       
+    friend class TabulatedSpline;
     
   public:    
     CubicSpline();
     virtual ~CubicSpline() {} 
     void addPoint(const RealType xp, const RealType yp);
     void addPoints(const vector<RealType>& xps, const vector<RealType>& yps);
+    /**
+     * Computes the spline coefficients.  addPoints does this itself;
+     * after a series of addPoint calls, generate must be called
+     * before the spline is evaluated.  The getters never modify the
+     * spline, so it can then be evaluated from several threads.
+     */
+    void generate();
     RealType getValueAt(const RealType& t);
     pair<RealType, RealType> getLimits();
     void getValueAt(const RealType& t, RealType& v);
@@ -63,15 +71,14 @@ namespace OpenMD {
     RealType getSpacing();
     
   private:
-    void generate();
     std::vector<int> sort_permutation(std::vector<RealType>& v);
     std::vector<RealType> apply_permutation(std::vector<RealType> const& v,
                                             std::vector<int> const& p);
     
     bool isUniform;
     bool generated;
-    RealType dx, dt, yval, dydx;
-    int n, j;
+    RealType dx;
+    int n;
     vector<RealType> x_;
     vector<RealType> y_;
     vector<RealType> b;
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2005 The University of Notre Dame. All Rights Reserved.
+ *
+ * The University of Notre Dame grants you ("Licensee") a
+ * non-exclusive, royalty free, license to use, modify and
+ * redistribute this software in source and binary code form, provided
+ * that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * This software is provided "AS IS," without a warranty of any
+ * kind. All express or implied conditions, representations and
+ * warranties, including any implied warranty of merchantability,
+ * fitness for a particular purpose or non-infringement, are hereby
+ * excluded.  The University of Notre Dame and its licensors shall not
+ * be liable for any damages suffered by licensee as a result of
+ * using, modifying or distributing the software or its
+ * derivatives. In no event will the University of Notre Dame or its
+ * licensors be liable for any lost revenue, profit or data, or for
+ * direct, indirect, special, consequential, incidental or punitive
+ * damages, however caused and regardless of the theory of liability,
+ * arising out of the use of or inability to use software, even if the
+ * University of Notre Dame has been advised of the possibility of
+ * such damages.
+ *
+ * SUPPORT OPEN SCIENCE!  If you use OpenMD or its source code in your
+ * research, please cite the appropriate papers when you publish your
+ * work.  Good starting points are:
+ *                                                                      
+ * [1]  Meineke, et al., J. Comp. Chem. 26, 252-271 (2005).             
+ * [2]  Fennell & Gezelter, J. Chem. Phys. 124, 234104 (2006).          
+ * [3]  Sun, Lin & Gezelter, J. Chem. Phys. 128, 234107 (2008).          
+ * [4]  Kuang & Gezelter,  J. Chem. Phys. 133, 164101 (2010).
+ * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
+ */
+
+#include "math/TabulatedSpline.hpp"
+#include <cstdio>
+#include <cstddef>
+#include "utils/simError.h"
+
+namespace OpenMD {
+
+  TabulatedSpline::TabulatedSpline() : n_(0), nColumns_(0), stride_(0),
+                                       offset_(0), isUniform_(true),
+                                       dx_(0.0), xFirst_(0.0), xLast_(0.0) {
+  }
+
+  TabulatedSpline::TabulatedSpline(CubicSpline& cs) : n_(0), nColumns_(0),
+                                                      stride_(0), offset_(0),
+                                                      isUniform_(true),
+                                                      dx_(0.0), xFirst_(0.0),
+                                                      xLast_(0.0) {
+    addColumn(cs);
+  }
+
+  void TabulatedSpline::addColumn(CubicSpline& cs) {
+    if (!cs.generated) cs.generate();
+
+    if (nColumns_ > 0) {
+      bool sameGrid = (cs.n == n_);
+      for (int j = 0; sameGrid && j < n_; j++)
+        sameGrid = (cs.x_[j] == table_[offset_ + j * stride_]);
+
+      if (!sameGrid) {
+        sprintf( painCave.errMsg,
+                 "TabulatedSpline::addColumn was given a spline with a\n"
+                 "\tdifferent grid than the existing columns.\n");
+        painCave.severity = OPENMD_ERROR;
+        painCave.isFatal = 1;
+        simError();
+      }
+    }
+
+    // Each record holds x_j and then (y, b, c, d) for every column.
+    // Records are padded to a multiple of 4 RealTypes, and the table
+    // starts on a 64-byte boundary, so a single-column record fills
+    // exactly one cache line.
+    int nColumns = nColumns_ + 1;
+    int stride = ((1 + 4 * nColumns + 3) / 4) * 4;
+    int align = 64 / sizeof(RealType);
+
+    std::vector<RealType> table(cs.n * stride + align, 0.0);
+    std::size_t address = reinterpret_cast<std::size_t>(&table[0]);
+    int offset = int(((64 - address % 64) % 64) / sizeof(RealType));
+
+    for (int j = 0; j < cs.n; j++) {
+      RealType* p = &table[offset + j * stride];
+      if (nColumns_ > 0) {
+        const RealType* old = &table_[offset_ + j * stride_];
+        std::copy(old, old + 1 + 4 * nColumns_, p);
+      }
+      p[0] = cs.x_[j];
+      RealType* c = p + 1 + 4 * nColumns_;
+      c[0] = cs.y_[j];
+      c[1] = cs.b[j];
+      c[2] = cs.c[j];
+      c[3] = cs.d[j];
+    }
+
+    table_.swap(table);
+    n_ = cs.n;
+    nColumns_ = nColumns;
+    stride_ = stride;
+    offset_ = offset;
+    isUniform_ = cs.isUniform;
+    dx_ = isUniform_ ? cs.dx : 0.0;
+    xFirst_ = cs.x_.front();
+    xLast_ = cs.x_.back();
+  }
+
+  int TabulatedSpline::findInterval(RealType t) const {
+    // bisection for the last knot at or below t (CubicSpline uses a
+    // linear scan with the same result):
+    if (t >= xLast_) return n_ - 1;
+
+    int lo = 0;
+    int hi = n_ - 1;
+    while (hi - lo > 1) {
+      int mid = (lo + hi) / 2;
+      if (t < table_[offset_ + mid * stride_])
+        hi = mid;
+      else
+        lo = mid;
+    }
+    return lo;
+  }
+
+  void TabulatedSpline::getValuesAndDerivativesAt(int n, const RealType* t,
+                                                  RealType* v,
+                                                  RealType* dv) const {
+    if (!isUniform_) {
+      for (int i = 0; i < n; i++)
+        getValueAndDerivativeAt(t[i], v[i], dv[i]);
+      return;
+    }
+
+    const RealType* base = &table_[offset_];
+    int stride = stride_;
+    int last = n_ - 1;
+    RealType x0 = xFirst_;
+    RealType dx = dx_;
+
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+    for (int i = 0; i < n; i++) {
+      int j = std::max(0, std::min(last, int((t[i] - x0) * dx)));
+      const RealType* p = base + j * stride;
+      RealType dt = t[i] - p[0];
+      v[i] = p[1] + dt*(p[2] + dt*(p[3] + dt*p[4]));
+      dv[i] = p[2] + dt*(2.0 * p[3] + 3.0 * dt * p[4]);
+    }
+  }
+}
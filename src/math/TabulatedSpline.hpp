@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2005 The University of Notre Dame. All Rights Reserved.
+ *
+ * The University of Notre Dame grants you ("Licensee") a
+ * non-exclusive, royalty free, license to use, modify and
+ * redistribute this software in source and binary code form, provided
+ * that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * This software is provided "AS IS," without a warranty of any
+ * kind. All express or implied conditions, representations and
+ * warranties, including any implied warranty of merchantability,
+ * fitness for a particular purpose or non-infringement, are hereby
+ * excluded.  The University of Notre Dame and its licensors shall not
+ * be liable for any damages suffered by licensee as a result of
+ * using, modifying or distributing the software or its
+ * derivatives. In no event will the University of Notre Dame or its
+ * licensors be liable for any lost revenue, profit or data, or for
+ * direct, indirect, special, consequential, incidental or punitive
+ * damages, however caused and regardless of the theory of liability,
+ * arising out of the use of or inability to use software, even if the
+ * University of Notre Dame has been advised of the possibility of
+ * such damages.
+ *
+ * SUPPORT OPEN SCIENCE!  If you use OpenMD or its source code in your
+ * research, please cite the appropriate papers when you publish your
+ * work.  Good starting points are:
+ *                                                                      
+ * [1]  Meineke, et al., J. Comp. Chem. 26, 252-271 (2005).             
+ * [2]  Fennell & Gezelter, J. Chem. Phys. 124, 234104 (2006).          
+ * [3]  Sun, Lin & Gezelter, J. Chem. Phys. 128, 234107 (2008).          
+ * [4]  Kuang & Gezelter,  J. Chem. Phys. 133, 164101 (2010).
+ * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
+ */
+
+#ifndef MATH_TABULATEDSPLINE_HPP
+#define MATH_TABULATEDSPLINE_HPP
+
+#include "config.h"
+#include <vector>
+#include <algorithm>
+#include "math/CubicSpline.hpp"
+
+namespace OpenMD {
+
+  /**
+   * @class TabulatedSpline
+   * A read-only, packed copy of one or more generated CubicSplines
+   * that share the same grid, for use inside the force loops.
+   *
+   * The knot position and the four polynomial coefficients of every
+   * column are stored next to each other for each interval, so a
+   * lookup touches a single (aligned) record instead of five separate
+   * arrays.  All of the evaluation methods are const and keep no
+   * state, so one table can be shared by all of the threads in a pair
+   * loop.  The interval search and the polynomials are the same as
+   * CubicSpline's, so the values are identical.
+   */
+  class TabulatedSpline {
+
+  public:
+    TabulatedSpline();
+    /** Tabulates a single spline */
+    explicit TabulatedSpline(CubicSpline& cs);
+
+    /**
+     * Appends another spline as a new column of the table.  It must
+     * have been built on the same grid as the existing columns.
+     */
+    void addColumn(CubicSpline& cs);
+
+    int getNColumns() const { return nColumns_; }
+    std::pair<RealType, RealType> getLimits() const {
+      return std::make_pair(xFirst_, xLast_);
+    }
+
+    /** Value of the first column at t */
+    RealType getValueAt(RealType t) const {
+      const RealType* p = getRecord(t);
+      RealType dt = t - p[0];
+      return p[1] + dt*(p[2] + dt*(p[3] + dt*p[4]));
+    }
+
+    /** Value and first derivative of the first column at t */
+    void getValueAndDerivativeAt(RealType t, RealType& v,
+                                 RealType& dv) const {
+      const RealType* p = getRecord(t);
+      RealType dt = t - p[0];
+      v = p[1] + dt*(p[2] + dt*(p[3] + dt*p[4]));
+      dv = p[2] + dt*(2.0 * p[3] + 3.0 * dt * p[4]);
+    }
+
+    /** Value and first derivative of column k at t */
+    void getColumnValueAndDerivativeAt(int k, RealType t, RealType& v,
+                                       RealType& dv) const {
+      const RealType* p = getRecord(t);
+      RealType dt = t - p[0];
+      const RealType* c = p + 1 + 4*k;
+      v = c[0] + dt*(c[1] + dt*(c[2] + dt*c[3]));
+      dv = c[1] + dt*(2.0 * c[2] + 3.0 * dt * c[3]);
+    }
+
+    /** Values of all of the columns at t */
+    void getAllValuesAt(RealType t, RealType* v) const {
+      const RealType* p = getRecord(t);
+      RealType dt = t - p[0];
+      for (int k = 0; k < nColumns_; k++) {
+        const RealType* c = p + 1 + 4*k;
+        v[k] = c[0] + dt*(c[1] + dt*(c[2] + dt*c[3]));
+      }
+    }
+
+    /** Values and first derivatives of all of the columns at t */
+    void getAllValuesAndDerivativesAt(RealType t, RealType* v,
+                                      RealType* dv) const {
+      const RealType* p = getRecord(t);
+      RealType dt = t - p[0];
+      for (int k = 0; k < nColumns_; k++) {
+        const RealType* c = p + 1 + 4*k;
+        v[k] = c[0] + dt*(c[1] + dt*(c[2] + dt*c[3]));
+        dv[k] = c[1] + dt*(2.0 * c[2] + 3.0 * dt * c[3]);
+      }
+    }
+
+    /**
+     * Values and first derivatives of the first column at n points.
+     * On uniform grids the lookups and polynomials are vectorized.
+     */
+    void getValuesAndDerivativesAt(int n, const RealType* t, RealType* v,
+                                   RealType* dv) const;
+
+  private:
+    /** the record of the interval that contains (or is nearest to) t */
+    const RealType* getRecord(RealType t) const {
+      int j;
+      if (isUniform_) {
+        j = std::max(0, std::min(n_ - 1, int((t - xFirst_) * dx_)));
+      } else {
+        j = findInterval(t);
+      }
+      return &table_[offset_ + j * stride_];
+    }
+
+    int findInterval(RealType t) const;
+
+    int n_;              /**< number of knots */
+    int nColumns_;
+    int stride_;         /**< RealTypes per record (padded) */
+    int offset_;         /**< index of the first, aligned, record */
+    bool isUniform_;
+    RealType dx_;        /**< inverse grid spacing (uniform grids only) */
+    RealType xFirst_;
+    RealType xLast_;
+    std::vector<RealType> table_;
+  };
+}
+
+#endif
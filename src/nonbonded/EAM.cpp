@@ -456,6 +456,20 @@ namespace OpenMD {
         }
       }
     }
+
+    // pack the splines that are evaluated in the force loops:
+    for (unsigned int i = 0; i < EAMdata.size(); i++) {
+      if (EAMdata[i].rho != NULL)
+        EAMdata[i].rhoTable = TabulatedSpline(*(EAMdata[i].rho));
+      if (EAMdata[i].F != NULL)
+        EAMdata[i].FTable = TabulatedSpline(*(EAMdata[i].F));
+    }
+    for (unsigned int i = 0; i < MixingMap.size(); i++) {
+      for (unsigned int j = 0; j < MixingMap[i].size(); j++) {
+        if (MixingMap[i][j].phi != NULL)
+          MixingMap[i][j].phiTable = TabulatedSpline(*(MixingMap[i][j].phi));
+      }
+    }
     initialized_ = true;
   }
 
@@ -790,17 +804,27 @@ namespace OpenMD {
 
     EAMAtomData &data1 = EAMdata[EAMtids[idat.atid1]];
     EAMAtomData &data2 = EAMdata[EAMtids[idat.atid2]];
-    RealType m;
+    RealType* cache = idat.pairDensity;
+    RealType m, rho;
 
     if (haveCutoffRadius_)
       if ( *(idat.rij) > eamRcut_) return;
 
+    // With a density cache, the derivatives are stored along with the
+    // densities so that calcForce doesn't need to look them up again.
     if ( *(idat.rij) < data1.rcut) {
       m = 1.0;
       if (data1.isFluctuatingCharge) {
         m -= *(idat.flucQ1) / data1.nValence;
       }
-      *(idat.rho2) += m * data1.rho->getValueAt( *(idat.rij) );
+      if (cache != NULL) {
+        data1.rhoTable.getValueAndDerivativeAt( *(idat.rij), cache[0],
+                                                cache[1]);
+        rho = cache[0];
+      } else {
+        rho = data1.rhoTable.getValueAt( *(idat.rij) );
+      }
+      *(idat.rho2) += m * rho;
     }
 
     if ( *(idat.rij) < data2.rcut) {
@@ -808,7 +832,14 @@ namespace OpenMD {
       if (data2.isFluctuatingCharge) {
         m -= *(idat.flucQ2) / data2.nValence;
       }
-      *(idat.rho1) += m * data2.rho->getValueAt( *(idat.rij));
+      if (cache != NULL) {
+        data2.rhoTable.getValueAndDerivativeAt( *(idat.rij), cache[2],
+                                                cache[3]);
+        rho = cache[2];
+      } else {
+        rho = data2.rhoTable.getValueAt( *(idat.rij) );
+      }
+      *(idat.rho1) += m * rho;
     }
 
     return;
@@ -819,8 +850,8 @@ namespace OpenMD {
     if (!initialized_) initialize();
     EAMAtomData &data1 = EAMdata[ EAMtids[sdat.atid] ];
 
-    data1.F->getValueAndDerivativeAt( *(sdat.rho), *(sdat.frho),
-                                      *(sdat.dfrhodrho) );
+    data1.FTable.getValueAndDerivativeAt( *(sdat.rho), *(sdat.frho),
+                                          *(sdat.dfrhodrho) );
 
     (*(sdat.selfPot))[METALLIC_FAMILY] += *(sdat.frho);
     if (sdat.isSelected)
@@ -856,17 +887,27 @@ namespace OpenMD {
     RealType phab(0.0), dvpdr(0.0);
     RealType drhoidr(0.0), drhojdr(0.0), dudr(0.0);
 
-    rhat =  *(idat.d) / *(idat.rij);
+    Vector3d rhat =  *(idat.d) / *(idat.rij);
     if ( *(idat.rij) < rci) {
-      data1.rho->getValueAndDerivativeAt( *(idat.rij), rha, drha);
-      CubicSpline* phi = MixingMap[eamtid1][eamtid1].phi;
-      phi->getValueAndDerivativeAt( *(idat.rij), pha, dpha);
+      if (idat.pairDensity != NULL) {
+        rha = idat.pairDensity[0];
+        drha = idat.pairDensity[1];
+      } else {
+        data1.rhoTable.getValueAndDerivativeAt( *(idat.rij), rha, drha);
+      }
+      MixingMap[eamtid1][eamtid1].phiTable.getValueAndDerivativeAt(
+        *(idat.rij), pha, dpha);
     }
     
     if ( *(idat.rij) < rcj) {
-      data2.rho->getValueAndDerivativeAt( *(idat.rij), rhb, drhb );
-      CubicSpline* phi = MixingMap[eamtid2][eamtid2].phi;
-      phi->getValueAndDerivativeAt( *(idat.rij), phb, dphb);
+      if (idat.pairDensity != NULL) {
+        rhb = idat.pairDensity[2];
+        drhb = idat.pairDensity[3];
+      } else {
+        data2.rhoTable.getValueAndDerivativeAt( *(idat.rij), rhb, drhb );
+      }
+      MixingMap[eamtid2][eamtid2].phiTable.getValueAndDerivativeAt(
+        *(idat.rij), phb, dphb);
     }
 
     bool hasFlucQ = data1.isFluctuatingCharge || data2.isFluctuatingCharge;
@@ -916,8 +957,8 @@ namespace OpenMD {
     } else {
       if ( *(idat.rij) < MixingMap[eamtid1][eamtid2].rcut) {
         
-        CubicSpline* phi = MixingMap[eamtid1][eamtid2].phi;
-        phi->getValueAndDerivativeAt( *(idat.rij), phab, dvpdr);
+        MixingMap[eamtid1][eamtid2].phiTable.getValueAndDerivativeAt(
+          *(idat.rij), phab, dvpdr);
       }
     }
     
@@ -938,10 +979,10 @@ namespace OpenMD {
       // contribute.  This then requires recomputing the density
       // functional for atom2 as well.
 
-      *(idat.particlePot1) += data2.F->getValueAt( *(idat.rho2) - rha )
+      *(idat.particlePot1) += data2.FTable.getValueAt( *(idat.rho2) - rha )
         - *(idat.frho2);
 
-      *(idat.particlePot2) += data1.F->getValueAt( *(idat.rho1) - rhb )
+      *(idat.particlePot2) += data1.FTable.getValueAt( *(idat.rho1) - rhb )
         - *(idat.frho1);
     }
 
@@ -49,6 +49,7 @@
 #include "brains/ForceField.hpp"
 #include "math/Vector3.hpp"
 #include "math/CubicSpline.hpp"
+#include "math/TabulatedSpline.hpp"
 
 namespace OpenMD {
 
@@ -56,6 +57,8 @@ namespace OpenMD {
     CubicSpline* rho;
     CubicSpline* F;
     CubicSpline* Z;
+    TabulatedSpline rhoTable;  /**< packed rho for the force loops */
+    TabulatedSpline FTable;    /**< packed F for the force loops */
     RealType rcut;
     RealType nValence;
     bool isFluctuatingCharge;
@@ -63,6 +66,7 @@ namespace OpenMD {
 
   struct EAMInteractionData {
     CubicSpline* phi;
+    TabulatedSpline phiTable;  /**< packed phi for the force loops */
     RealType rcut;
     bool explicitlySet;
   };
@@ -139,7 +143,6 @@ namespace OpenMD {
     set<AtomType*> simTypes_;
     RealType pre11_;
     RealType eamRcut_;
-    Vector3d rhat;
 
     EAMMixingMethod mixMeth_;
     string name_;
@@ -70,7 +70,8 @@ namespace OpenMD {
                                   haveDampingAlpha_(false), 
                                   haveDielectric_(false),
                                   haveElectroSplines_(false),
-                                  info_(NULL), forceField_(NULL)
+                                  info_(NULL), forceField_(NULL),
+                                  spme_(NULL)
                                   
   {
     flucQ_ = new FluctuatingChargeForces(info_);
@@ -211,7 +212,8 @@ namespace OpenMD {
       simError();
     }
            
-    if (screeningMethod_ == DAMPED || summationMethod_ == esm_EWALD_FULL) {
+    if (screeningMethod_ == DAMPED || summationMethod_ == esm_EWALD_FULL ||
+        summationMethod_ == esm_EWALD_SPME) {
       if (!simParams_->haveDampingAlpha()) {
         // first set a cutoff dependent alpha value
         // we assume alpha depends linearly with rcut from 0 to 20.5 ang
@@ -256,6 +258,41 @@ namespace OpenMD {
     for (at = simTypes_.begin(); at != simTypes_.end(); ++at) {
       if ((*at)->isElectrostatic()) addType(*at);
     }   
+
+    if (summationMethod_ == esm_EWALD_SPME) {
+#ifndef HAVE_FFTW3_H
+      sprintf( painCave.errMsg,
+               "Electrostatic::initialize: electrostaticSummationMethod\n"
+               "\t\"ewald_spme\" requires OpenMD to be built with FFTW3.\n");
+      painCave.severity = OPENMD_ERROR;
+      painCave.isFatal = 1;
+      simError();
+#endif
+      bool haveMultipoles = false;
+      for (unsigned int i = 0; i < ElectrostaticMap.size(); i++) {
+        if (ElectrostaticMap[i].is_Dipole || ElectrostaticMap[i].is_Quadrupole)
+          haveMultipoles = true;
+      }
+
+      // The quadrupole forces need third derivatives of the
+      // B-splines, so multipolar systems default to a higher order.
+      int order = haveMultipoles ? 6 : 4;
+      if (simParams_->haveSpmeOrder()) order = simParams_->getSpmeOrder();
+      if (order < 4) {
+        sprintf( painCave.errMsg,
+                 "Electrostatic::initialize: spmeOrder (%d) must be 4 or\n"
+                 "\tlarger.\n", order);
+        painCave.severity = OPENMD_ERROR;
+        painCave.isFatal = 1;
+        simError();
+      }
+
+      if (spme_ != NULL) delete spme_;
+      spme_ = new SPME();
+      spme_->setDampingAlpha(dampingAlpha_);
+      spme_->setOrder(order);
+      spme_->setGridSpacing(simParams_->getSpmeGridSpacing());
+    }
     
     if (summationMethod_ == esm_REACTION_FIELD) {
       preRF_ = (dielectric_ - 1.0) / 
@@ -306,7 +343,8 @@ namespace OpenMD {
     db0c_4 =          3.0*b2c  - 6.0*r2*b3c     + r2*r2*b4c;
     db0c_5 =                    -15.0*r*b3c + 10.0*r2*r*b4c - r2*r2*r*b5c;   
 
-    if (summationMethod_ != esm_EWALD_FULL) {
+    if (summationMethod_ != esm_EWALD_FULL &&
+        summationMethod_ != esm_EWALD_SPME) {
       selfMult1_ -= b0c;
       selfMult2_ += (db0c_2 + 2.0*db0c_1*ric) /  3.0;
       selfMult4_ -= (db0c_4 + 4.0*db0c_3*ric) / 15.0;
@@ -314,14 +352,15 @@ namespace OpenMD {
 
     // working variables for the splines:
     RealType ri, ri2;
-    RealType b0, b1, b2, b3, b4, b5;
-    RealType db0_1, db0_2, db0_3, db0_4, db0_5;
+    RealType v01, v11, v21, v22, v31, v32, v41, v42, v43;
+    RealType b0, b1, b2, b3, b4;
+    RealType db0_1, db0_2, db0_3, db0_4;
     RealType f, fc, f0;
     RealType g, gc, g0, g1, g2, g3, g4;
     RealType h, hc, h1, h2, h3, h4;
     RealType s, sc, s2, s3, s4;
     RealType t, tc, t3, t4;
-    RealType u, uc, u4;
+    RealType uc;
 
     // working variables for Taylor expansion:
     RealType rmRc, rmRc2, rmRc3, rmRc4;
@@ -370,14 +409,12 @@ namespace OpenMD {
         b2 = (3.0 * b1 + pow(2.0*a2, 2) * expTerm * invArootPi) * ri2;
         b3 = (5.0 * b2 + pow(2.0*a2, 3) * expTerm * invArootPi) * ri2;
         b4 = (7.0 * b3 + pow(2.0*a2, 4) * expTerm * invArootPi) * ri2;
-        b5 = (9.0 * b4 + pow(2.0*a2, 5) * expTerm * invArootPi) * ri2;
       } else {
         b0 = ri;
         b1 = (      b0) * ri2;
         b2 = (3.0 * b1) * ri2;
         b3 = (5.0 * b2) * ri2;
         b4 = (7.0 * b3) * ri2;
-        b5 = (9.0 * b4) * ri2;
       }
                 
       // higher derivatives of B_0 at r:
@@ -385,7 +422,6 @@ namespace OpenMD {
       db0_2 =     -b1 + r2 * b2;
       db0_3 =          3.0*r*b2   - r2*r*b3;
       db0_4 =          3.0*b2   - 6.0*r2*b3     + r2*r2*b4;
-      db0_5 =                    -15.0*r*b3 + 10.0*r2*r*b4 - r2*r2*r*b5;
 
       f = b0;
       fc = b0c;
@@ -417,9 +453,7 @@ namespace OpenMD {
       t3 = t - tc;
       t4 = t3 - rmRc *db0c_5;
       
-      u = db0_5;         
       uc = db0c_5;
-      u4 = u - uc;
 
       // in what follows below, the various v functions are used for
       // potentials and torques, while the w functions show up in the
@@ -444,19 +478,6 @@ namespace OpenMD {
           - (tc - 3.0*(2.0*sc - 5.0*(hc - gc*ric)*ric)*ric)
           - rmRc*(uc-3.0*(2.0*tc - (7.0*sc - 15.0*(hc - gc*ric)*ric)*ric)*ric);
 
-        dv01 = g - gc;
-        dv11 = h - hc;
-        dv21 = (h - g*ri)*ri - (hc - gc*ric)*ric;
-        dv22 = (s - (h - g*ri)*ri) - (sc - (hc - gc*ric)*ric);        
-        dv31 = (s - 2.0*(h-g*ri)*ri)*ri - (sc - 2.0*(hc-gc*ric)*ric)*ric;
-        dv32 = (t - 3.0*(s-2.0*(h-g*ri)*ri)*ri) 
-          - (tc - 3.0*(sc-2.0*(hc-gc*ric)*ric)*ric);
-        dv41 = (s - 3.0*(h - g*ri)*ri)*ri2 - (sc - 3.0*(hc - gc*ric)*ric)*ric2;
-        dv42 = (t - (4.0*s - 9.0*(h-g*ri)*ri)*ri)*ri 
-          - (tc - (4.0*sc - 9.0*(hc-gc*ric)*ric)*ric)*ric; 
-        dv43 = (u - 3.0*(2.0*t - (7.0*s - 15.0*(h - g*ri)*ri)*ri)*ri)
-          - (uc - 3.0*(2.0*tc - (7.0*sc - 15.0*(hc - gc*ric)*ric)*ric)*ric);
-        
         break;
 
       case esm_TAYLOR_SHIFTED:
@@ -471,16 +492,6 @@ namespace OpenMD {
         v42 = s4 * ri - 3.0*v41;
         v43 = t4 - 6.0*v42 - 3.0*v41;
 
-        dv01 = g0;
-        dv11 = h1;
-        dv21 = (h2 - g2*ri)*ri;
-        dv22 = (s2 - (h2 - g2*ri)*ri);
-        dv31 = (s3 - 2.0*(h3-g3*ri)*ri)*ri;
-        dv32 = (t3 - 3.0*(s3-2.0*(h3-g3*ri)*ri)*ri); 
-        dv41 = (s4 - 3.0*(h4 - g4*ri)*ri)*ri2;
-        dv42 = (t4 - (4.0*s4 - 9.0*(h4-g4*ri)*ri)*ri)*ri; 
-        dv43 = (u4 - 3.0*(2.0*t4 - (7.0*s4 - 15.0*(h4 - g4*ri)*ri)*ri)*ri);
-
         break;
 
       case esm_SHIFTED_POTENTIAL:
@@ -496,21 +507,12 @@ namespace OpenMD {
         v43 = (t - 3.0*(2.0*s - 5.0*(h - g*ri)*ri)*ri) 
           - (tc - 3.0*(2.0*sc - 5.0*(hc - gc*ric)*ric)*ric);
 
-        dv01 = g;
-        dv11 = h;
-        dv21 = (h - g*ri)*ri;
-        dv22 = (s - (h - g*ri)*ri);
-        dv31 = (s - 2.0*(h-g*ri)*ri)*ri;
-        dv32 = (t - 3.0*(s-2.0*(h-g*ri)*ri)*ri); 
-        dv41 = (s - 3.0*(h - g*ri)*ri)*ri2;
-        dv42 = (t - (4.0*s - 9.0*(h-g*ri)*ri)*ri)*ri; 
-        dv43 = (u - 3.0*(2.0*t - (7.0*s - 15.0*(h - g*ri)*ri)*ri)*ri);
-
         break;
 
       case esm_SWITCHING_FUNCTION:
       case esm_HARD:
       case esm_EWALD_FULL:
+      case esm_EWALD_SPME:
 
         v01 = f;
         v11 = g;
@@ -522,16 +524,6 @@ namespace OpenMD {
         v42 = (s-3.0*(h-g*ri)*ri)*ri;        
         v43 = (t - 3.0*(2.0*s - 5.0*(h - g*ri)*ri)*ri);
 
-        dv01 = g;
-        dv11 = h;
-        dv21 = (h - g*ri)*ri;
-        dv22 = (s - (h - g*ri)*ri);
-        dv31 = (s - 2.0*(h-g*ri)*ri)*ri;
-        dv32 = (t - 3.0*(s-2.0*(h-g*ri)*ri)*ri); 
-        dv41 = (s - 3.0*(h - g*ri)*ri)*ri2;
-        dv42 = (t - (4.0*s - 9.0*(h-g*ri)*ri)*ri)*ri; 
-        dv43 = (u - 3.0*(2.0*t - (7.0*s - 15.0*(h - g*ri)*ri)*ri)*ri);
-
         break;
 
       case esm_REACTION_FIELD:
@@ -557,20 +549,9 @@ namespace OpenMD {
         v43 = (t - 3.0*(2.0*s - 5.0*(h - g*ri)*ri)*ri) 
           - (tc - 3.0*(2.0*sc - 5.0*(hc - gc*ric)*ric)*ric);
 
-        dv01 = g;
-        dv11 = h;
-        dv21 = (h - g*ri)*ri;
-        dv22 = (s - (h - g*ri)*ri);
-        dv31 = (s - 2.0*(h-g*ri)*ri)*ri;
-        dv32 = (t - 3.0*(s-2.0*(h-g*ri)*ri)*ri); 
-        dv41 = (s - 3.0*(h - g*ri)*ri)*ri2;
-        dv42 = (t - (4.0*s - 9.0*(h-g*ri)*ri)*ri)*ri; 
-        dv43 = (u - 3.0*(2.0*t - (7.0*s - 15.0*(h - g*ri)*ri)*ri)*ri);
-
         break;
                 
       case esm_EWALD_PME:
-      case esm_EWALD_SPME:
       default :
         map<string, ElectrostaticSummationMethod>::iterator i;
         std::string meth;
@@ -580,7 +561,8 @@ namespace OpenMD {
         sprintf( painCave.errMsg,
                  "Electrostatic::initialize: electrostaticSummationMethod %s \n"
                  "\thas not been implemented yet. Please select one of:\n"
-                 "\t\"hard\", \"shifted_potential\", or \"shifted_force\"\n", 
+                 "\t\"hard\", \"shifted_potential\", \"shifted_force\",\n"
+                 "\t\"ewald_full\", or \"ewald_spme\"\n", 
                  meth.c_str() );
         painCave.isFatal = 1;
         simError();
@@ -602,24 +584,26 @@ namespace OpenMD {
     // construct the spline structures and fill them with the values we've
     // computed:
 
-    v01s = new CubicSpline();
-    v01s->addPoints(rv, v01v);
-    v11s = new CubicSpline();
-    v11s->addPoints(rv, v11v);
-    v21s = new CubicSpline();
-    v21s->addPoints(rv, v21v);
-    v22s = new CubicSpline();
-    v22s->addPoints(rv, v22v);
-    v31s = new CubicSpline();
-    v31s->addPoints(rv, v31v);
-    v32s = new CubicSpline();
-    v32s->addPoints(rv, v32v);
-    v41s = new CubicSpline();
-    v41s->addPoints(rv, v41v);
-    v42s = new CubicSpline();
-    v42s->addPoints(rv, v42v);
-    v43s = new CubicSpline();
-    v43s->addPoints(rv, v43v);
+    CubicSpline v01c, v11c, v21c, v22c, v31c, v32c, v41c, v42c, v43c;
+    v01c.addPoints(rv, v01v);
+    v11c.addPoints(rv, v11v);
+    v21c.addPoints(rv, v21v);
+    v22c.addPoints(rv, v22v);
+    v31c.addPoints(rv, v31v);
+    v32c.addPoints(rv, v32v);
+    v41c.addPoints(rv, v41v);
+    v42c.addPoints(rv, v42v);
+    v43c.addPoints(rv, v43v);
+
+    v01s = TabulatedSpline(v01c);
+    v11s = TabulatedSpline(v11c);
+    v2s = TabulatedSpline(v21c);
+    v2s.addColumn(v22c);
+    v3s = TabulatedSpline(v31c);
+    v3s.addColumn(v32c);
+    v4s = TabulatedSpline(v41c);
+    v4s.addColumn(v42c);
+    v4s.addColumn(v43c);
 
     haveElectroSplines_ = true;
 
@@ -726,8 +710,9 @@ namespace OpenMD {
                           Constants::hartreeToKcal );
         }
         
-        CubicSpline* J = new CubicSpline();
-        J->addPoints(rvals, Jvals);
+        CubicSpline Jspline;
+        Jspline.addPoints(rvals, Jvals);
+        TabulatedSpline* J = new TabulatedSpline(Jspline);
         Jij[fqtid][fqtid2] = J;
         Jij[fqtid2].resize( nFlucq_ );
         Jij[fqtid2][fqtid] = J;
@@ -760,50 +745,83 @@ namespace OpenMD {
 
     if (!initialized_) initialize();
 
-    if (Etids[idat.atid1] != -1) { 
-      data1 = ElectrostaticMap[Etids[idat.atid1]];
-      a_is_Charge = data1.is_Charge;
-      a_is_Dipole = data1.is_Dipole;
-      a_is_Quadrupole = data1.is_Quadrupole;
-      a_is_Fluctuating = data1.is_Fluctuating;
-    } else {
-      a_is_Charge = false;
-      a_is_Dipole = false;
-      a_is_Quadrupole = false;
-      a_is_Fluctuating = false;
-    }
-    if (Etids[idat.atid2] != -1) { 
-      data2 = ElectrostaticMap[Etids[idat.atid2]];
-      b_is_Charge = data2.is_Charge;
-      b_is_Dipole = data2.is_Dipole;
-      b_is_Quadrupole = data2.is_Quadrupole;
-      b_is_Fluctuating = data2.is_Fluctuating;
-    } else {
-      b_is_Charge = false;
-      b_is_Dipole = false;
-      b_is_Quadrupole = false;
-      b_is_Fluctuating = false;
-    }
+    // All of the intermediate values live on the stack, so several
+    // threads may call calcForce on the same object at once.
+
+    ElectrostaticAtomData* data1 = NULL;
+    ElectrostaticAtomData* data2 = NULL;
+
+    RealType C_a(0.0), C_b(0.0);  // Charges 
+    Vector3d D_a, D_b;            // Dipoles (space-fixed)
+    Mat3x3d  Q_a, Q_b;            // Quadrupoles (space-fixed)
+
+    RealType ri;                                 // Distance utility scalar
+    RealType rdDa(0.0), rdDb(0.0);               // Dipole utility scalars
+    Vector3d rxDa, rxDb;                         // Dipole utility vectors
+    RealType rdQar(0.0), rdQbr(0.0);             // Quadrupole utility scalars
+    RealType trQa(0.0), trQb(0.0);
+    Vector3d Qar, Qbr, rQa, rQb, rxQar, rxQbr;   // Quadrupole utility vectors
+    RealType pref;
+
+    RealType DadDb, trQaQb, DadQbr, DbdQar;       // Cross-interaction scalars
+    RealType rQaQbr;
+    Vector3d DaxDb, DadQb, DbdQa, DaxQbr, DbxQar; // Cross-interaction vectors
+    Vector3d rQaQb, QaQbr, QaxQb, rQaxQbr;
+    Mat3x3d  QaQb;                                // Cross-interaction matrices
+
+    // Radial functions and their derivatives from the splines
+    RealType v01(0.0), v11(0.0), v21(0.0), v22(0.0), v31(0.0), v32(0.0);
+    RealType v41(0.0), v42(0.0), v43(0.0);
+    RealType dv01(0.0), dv11(0.0), dv21(0.0), dv22(0.0), dv31(0.0);
+    RealType dv32(0.0), dv41(0.0), dv42(0.0), dv43(0.0);
+    RealType v11or(0.0), v22or(0.0), v31or(0.0), v32or(0.0);
+    RealType v42or(0.0), v43or(0.0);
+
+    RealType U(0.0);     // Potential
+    Vector3d F(0.0);     // Force
+    Vector3d Ta(0.0);    // Torque on site a
+    Vector3d Tb(0.0);    // Torque on site b
+    Vector3d Ea(0.0);    // Electric field at site a
+    Vector3d Eb(0.0);    // Electric field at site b
+    RealType Pa(0.0);    // Site potential at site a
+    RealType Pb(0.0);    // Site potential at site b
+    RealType dUdCa(0.0); // fluctuating charge force at site a
+    RealType dUdCb(0.0); // fluctuating charge force at site b
 
-    U = 0.0;  // Potential
-    F.zero();  // Force
-    Ta.zero(); // Torque on site a
-    Tb.zero(); // Torque on site b
-    Ea.zero(); // Electric field at site a
-    Eb.zero(); // Electric field at site b
-    Pa = 0.0;  // Site potential at site a
-    Pb = 0.0;  // Site potential at site b
-    dUdCa = 0.0; // fluctuating charge force at site a
-    dUdCb = 0.0; // fluctuating charge force at site a
-    
     // Indirect interactions mediated by the reaction field.
-    indirect_Pot = 0.0;   // Potential
-    indirect_F.zero();    // Force
-    indirect_Ta.zero();   // Torque on site a
-    indirect_Tb.zero();   // Torque on site b
+    RealType indirect_Pot(0.0);  // Potential
+    Vector3d indirect_F(0.0);    // Force
+    Vector3d indirect_Ta(0.0);   // Torque on site a
+    Vector3d indirect_Tb(0.0);   // Torque on site b
 
     // Excluded potential that is still computed for fluctuating charges
-    excluded_Pot= 0.0;
+    RealType excluded_Pot(0.0);
+
+    RealType rfContrib, coulInt;
+
+    // spline for coulomb integral
+    TabulatedSpline* J = NULL;
+    Vector3d rhat;
+
+    bool a_is_Charge(false), a_is_Dipole(false);
+    bool a_is_Quadrupole(false), a_is_Fluctuating(false);
+    bool b_is_Charge(false), b_is_Dipole(false);
+    bool b_is_Quadrupole(false), b_is_Fluctuating(false);
+
+    if (Etids[idat.atid1] != -1) { 
+      data1 = &ElectrostaticMap[Etids[idat.atid1]];
+      a_is_Charge = data1->is_Charge;
+      a_is_Dipole = data1->is_Dipole;
+      a_is_Quadrupole = data1->is_Quadrupole;
+      a_is_Fluctuating = data1->is_Fluctuating;
+    }
+    if (Etids[idat.atid2] != -1) { 
+      data2 = &ElectrostaticMap[Etids[idat.atid2]];
+      b_is_Charge = data2->is_Charge;
+      b_is_Dipole = data2->is_Dipole;
+      b_is_Quadrupole = data2->is_Quadrupole;
+      b_is_Fluctuating = data2->is_Fluctuating;
+    }
 
     // some variables we'll need independent of electrostatic type:
 
@@ -814,31 +832,36 @@ namespace OpenMD {
     // spline structures:
     
     // needed for fields (and forces):
+    RealType vals[3], derivs[3];
+
     if (a_is_Charge || b_is_Charge) {
-      v01s->getValueAndDerivativeAt( *(idat.rij), v01, dv01);
+      v01s.getValueAndDerivativeAt( *(idat.rij), v01, dv01);
     }
     if (a_is_Dipole || b_is_Dipole) {
-      v11s->getValueAndDerivativeAt( *(idat.rij), v11, dv11);
+      v11s.getValueAndDerivativeAt( *(idat.rij), v11, dv11);
       v11or = ri * v11;
     }
     if (a_is_Quadrupole || b_is_Quadrupole ||  (a_is_Dipole && b_is_Dipole)) {
-      v21s->getValueAndDerivativeAt( *(idat.rij), v21, dv21);
-      v22s->getValueAndDerivativeAt( *(idat.rij), v22, dv22);
+      v2s.getAllValuesAndDerivativesAt( *(idat.rij), vals, derivs);
+      v21 = vals[0];  dv21 = derivs[0];
+      v22 = vals[1];  dv22 = derivs[1];
       v22or = ri * v22;
     }      
 
     // needed for potentials (and forces and torques):
     if ((a_is_Dipole && b_is_Quadrupole) || 
         (b_is_Dipole && a_is_Quadrupole)) {
-      v31s->getValueAndDerivativeAt( *(idat.rij), v31, dv31);
-      v32s->getValueAndDerivativeAt( *(idat.rij), v32, dv32);
+      v3s.getAllValuesAndDerivativesAt( *(idat.rij), vals, derivs);
+      v31 = vals[0];  dv31 = derivs[0];
+      v32 = vals[1];  dv32 = derivs[1];
       v31or = v31 * ri;
       v32or = v32 * ri;
     }
     if (a_is_Quadrupole && b_is_Quadrupole) {
-      v41s->getValueAndDerivativeAt( *(idat.rij), v41, dv41);
-      v42s->getValueAndDerivativeAt( *(idat.rij), v42, dv42);
-      v43s->getValueAndDerivativeAt( *(idat.rij), v43, dv43);
+      v4s.getAllValuesAndDerivativesAt( *(idat.rij), vals, derivs);
+      v41 = vals[0];  dv41 = derivs[0];
+      v42 = vals[1];  dv42 = derivs[1];
+      v43 = vals[2];  dv43 = derivs[2];
       v42or = v42 * ri;
       v43or = v43 * ri;
     }
@@ -846,7 +869,7 @@ namespace OpenMD {
     // calculate the single-site contributions (fields, etc).
     
     if (a_is_Charge) {
-      C_a = data1.fixedCharge;
+      C_a = data1->fixedCharge;
       
       if (a_is_Fluctuating) {
         C_a += *(idat.flucQ1);
@@ -887,7 +910,7 @@ namespace OpenMD {
     }
     
     if (b_is_Charge) {
-      C_b = data2.fixedCharge;
+      C_b = data2->fixedCharge;
       
       if (b_is_Fluctuating) {
         C_b += *(idat.flucQ2);                
@@ -1224,6 +1247,7 @@ namespace OpenMD {
     case esm_SHIFTED_POTENTIAL:
     case esm_TAYLOR_SHIFTED:
     case esm_EWALD_FULL:
+    case esm_EWALD_SPME:
       if (i_is_Charge) {
         self += selfMult1_ * pre11_ * C_a * (C_a + *(sdat.skippedCharge));        
         if (i_is_Fluctuating) {
@@ -1359,7 +1383,14 @@ namespace OpenMD {
   }
 
 
-  void Electrostatic::ReciprocalSpaceSum(RealType& pot) {
+  void Electrostatic::ReciprocalSpaceSum(RealType& pot, Mat3x3d& virial) {
+
+    if (!initialized_) initialize();
+
+    if (summationMethod_ == esm_EWALD_SPME) {
+      SPMESum(pot, virial);
+      return;
+    }
     
     RealType kPot = 0.0;
     RealType kVir = 0.0;
@@ -1689,6 +1720,75 @@ namespace OpenMD {
     pot += kPot;  
   }
 
+  void Electrostatic::SPMESum(RealType& pot, Mat3x3d& virial) {
+
+    const RealType mPoleConverter = 0.20819434; // Debye or Debye-angstroms
+                                                // to electron angstroms
+                                                // or electron-angstroms^2
+
+    bool doDipoles = false;
+    bool doQuadrupoles = false;
+    for (unsigned int i = 0; i < ElectrostaticMap.size(); i++) {
+      if (ElectrostaticMap[i].is_Dipole) doDipoles = true;
+      if (ElectrostaticMap[i].is_Quadrupole) doQuadrupoles = true;
+    }
+
+    Mat3x3d hmat = info_->getSnapshotManager()->getCurrentSnapshot()->getHmat();
+
+    SimInfo::MoleculeIterator mi;
+    Molecule::AtomIterator ai;
+    vector<Atom*> sites;
+    vector<Vector3d> pos;
+    vector<RealType> C;
+    vector<Vector3d> D;
+    vector<Mat3x3d> Q;
+
+    for (Molecule* mol = info_->beginMolecule(mi); mol != NULL; 
+         mol = info_->nextMolecule(mi)) {
+      for(Atom* atom = mol->beginAtom(ai); atom != NULL; 
+          atom = mol->nextAtom(ai)) {
+        int etid = Etids[atom->getAtomType()->getIdent()];
+        if (etid == -1) continue;
+        ElectrostaticAtomData &data = ElectrostaticMap[etid];
+
+        sites.push_back(atom);
+        pos.push_back(atom->getPos());
+
+        RealType c(0.0);
+        if (data.is_Charge) c = data.fixedCharge;
+        if (data.is_Fluctuating) c += atom->getFlucQPos();
+        C.push_back(c);
+
+        if (doDipoles) {
+          if (data.is_Dipole)
+            D.push_back(atom->getDipole() * mPoleConverter);
+          else
+            D.push_back(V3Zero);
+        }
+        if (doQuadrupoles) {
+          if (data.is_Quadrupole)
+            Q.push_back(Mat3x3d(atom->getQuadrupole() * mPoleConverter));
+          else
+            Q.push_back(Mat3x3d(0.0));
+        }
+      }
+    }
+
+    vector<Vector3d> frc;
+    vector<Vector3d> trq;
+    vector<RealType> phi;
+    spme_->calcReciprocalSpace(hmat, pos, C, D, Q, pot, virial, frc, trq,
+                               phi);
+
+    for (unsigned int i = 0; i < sites.size(); i++) {
+      ElectrostaticAtomData &data =
+        ElectrostaticMap[Etids[sites[i]->getAtomType()->getIdent()]];
+      sites[i]->addFrc(frc[i]);
+      if (data.is_Dipole || data.is_Quadrupole) sites[i]->addTrq(trq[i]);
+      if (data.is_Fluctuating) sites[i]->addFlucQFrc(-phi[i]);
+    }
+  }
+
   void Electrostatic::getSitePotentials(Atom* a1, Atom* a2, bool excluded, 
                                         RealType &spot1, RealType &spot2) {
 
@@ -1702,11 +1802,17 @@ namespace OpenMD {
     AtomType* atype2 = a2->getAtomType();
     int atid1 = atype1->getIdent();
     int atid2 = atype2->getIdent();
-    data1 = ElectrostaticMap[Etids[atid1]];
-    data2 = ElectrostaticMap[Etids[atid2]];
-
-    Pa = 0.0;  // Site potential at site a
-    Pb = 0.0;  // Site potential at site b
+    ElectrostaticAtomData &data1 = ElectrostaticMap[Etids[atid1]];
+    ElectrostaticAtomData &data2 = ElectrostaticMap[Etids[atid2]];
+
+    RealType Pa(0.0);  // Site potential at site a
+    RealType Pb(0.0);  // Site potential at site b
+    RealType C_a, C_b;
+    Vector3d D_a, D_b;
+    Mat3x3d Q_a, Q_b;
+    RealType rdDa, rdDb, rdQar, rdQbr, trQa, trQb;
+    Vector3d Qar, Qbr;
+    RealType v01(0.0), v11(0.0), v21(0.0), v22(0.0);
 
     Vector3d d = a2->getPos() - a1->getPos();
     info_->getSnapshotManager()->getCurrentSnapshot()->wrapVector(d);
@@ -1714,7 +1820,7 @@ namespace OpenMD {
     // some variables we'll need independent of electrostatic type:
 
     RealType ri = 1.0 /  rij;
-    rhat = d  * ri;
+    Vector3d rhat = d  * ri;
       
 
     if ((rij >= cutoffRadius_) || excluded) {
@@ -1725,31 +1831,31 @@ namespace OpenMD {
 
     // logicals
 
-    a_is_Charge = data1.is_Charge;
-    a_is_Dipole = data1.is_Dipole;
-    a_is_Quadrupole = data1.is_Quadrupole;
-    a_is_Fluctuating = data1.is_Fluctuating;
+    bool a_is_Charge = data1.is_Charge;
+    bool a_is_Dipole = data1.is_Dipole;
+    bool a_is_Quadrupole = data1.is_Quadrupole;
+    bool a_is_Fluctuating = data1.is_Fluctuating;
 
-    b_is_Charge = data2.is_Charge;
-    b_is_Dipole = data2.is_Dipole;
-    b_is_Quadrupole = data2.is_Quadrupole;
-    b_is_Fluctuating = data2.is_Fluctuating;
+    bool b_is_Charge = data2.is_Charge;
+    bool b_is_Dipole = data2.is_Dipole;
+    bool b_is_Quadrupole = data2.is_Quadrupole;
+    bool b_is_Fluctuating = data2.is_Fluctuating;
 
     // Obtain all of the required radial function values from the
     // spline structures:
     
 
     if (a_is_Charge || b_is_Charge) {
-      v01 = v01s->getValueAt(rij);
+      v01 = v01s.getValueAt(rij);
     }
     if (a_is_Dipole || b_is_Dipole) {
-      v11 = v11s->getValueAt(rij);
-      v11or = ri * v11;
+      v11 = v11s.getValueAt(rij);
     }
     if (a_is_Quadrupole || b_is_Quadrupole) {
-      v21 = v21s->getValueAt(rij);
-      v22 = v22s->getValueAt(rij);
-      v22or = ri * v22;
+      RealType vals[2];
+      v2s.getAllValuesAt(rij, vals);
+      v21 = vals[0];
+      v22 = vals[1];
     }      
 
     if (a_is_Charge) {
@@ -1792,7 +1898,7 @@ namespace OpenMD {
     }
     
     if (b_is_Quadrupole) {
-      Q_a = a2->getQuadrupole() * mPoleConverter;
+      Q_b = a2->getQuadrupole() * mPoleConverter;
       trQb =  Q_b.trace();
       Qbr =   Q_b * rhat;
       rdQbr = dot(rhat, Qbr);
@@ -1808,7 +1914,7 @@ namespace OpenMD {
       initialize();
     }
     RealType v01, dv01;
-    v01s->getValueAndDerivativeAt(r, v01, dv01);
+    v01s.getValueAndDerivativeAt(r, v01, dv01);
     return dv01 * pre11_;
   }
   
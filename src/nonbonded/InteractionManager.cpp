@@ -466,13 +466,46 @@ namespace OpenMD {
       }
     }
 
+    // Pairs of atom types that are handled by one interaction which
+    // can evaluate packed batches of pairs:
+    batchHash_.resize(nTypes);
+    for (at = simTypes.begin(); at != simTypes.end(); ++at) {
+      atid1 = (*at)->getIdent();
+      batchHash_[atid1].resize(nTypes, NULL);
+      for (bt = simTypes.begin(); bt != simTypes.end(); ++bt) {
+        atid2 = (*bt)->getIdent();
+        set<NonBondedInteraction*>& s = interactions_[atid1][atid2];
+        if (s.size() == 1 && (*s.begin())->supportsBatch())
+          batchHash_[atid1][atid2] = *s.begin();
+      }
+    }
+
     initialized_ = true;
   }
 
+  NonBondedInteraction* InteractionManager::getBatchInteraction(int atid1,
+                                                                int atid2) {
+    if (!initialized_) initialize();
+    return batchHash_[atid1][atid2];
+  }
+
   void InteractionManager::setCutoffRadius(RealType rcut) {
 
     electrostatic_->setCutoffRadius(rcut);
     eam_->setCutoffRadius(rcut);
+
+    // The other kernels are set up along with the simulated atom
+    // types.  The electrostatic kernel needs the cutoff radius, so it
+    // is set up now, before any (possibly threaded) pair loop calls
+    // it.
+    if (!initialized_) initialize();
+
+    for (unsigned int i = 0; i < sHash_.size(); i++) {
+      if ((sHash_[i] & ELECTROSTATIC_INTERACTION) != 0) {
+        electrostatic_->initialize();
+        break;
+      }
+    }
   }
 
   void InteractionManager::doPrePair(InteractionData &idat){
@@ -584,9 +617,10 @@ namespace OpenMD {
     electrostatic_->calcSurfaceTerm(pot);
   }
 
-  void InteractionManager::doReciprocalSpaceSum(RealType &pot){
+  void InteractionManager::doReciprocalSpaceSum(RealType &pot,
+                                                Mat3x3d &virial){
     if (!initialized_) initialize();
-    electrostatic_->ReciprocalSpaceSum(pot);
+    electrostatic_->ReciprocalSpaceSum(pot, virial);
   }
 
   RealType InteractionManager::getSuggestedCutoffRadius(int *atid) {
@@ -83,10 +83,16 @@ namespace OpenMD {
     void doSkipCorrection(InteractionData &idat);
     void doSelfCorrection(SelfData &sdat);
     void doSurfaceTerm(RealType &surfacePot);
-    void doReciprocalSpaceSum(RealType &recipPot);
+    void doReciprocalSpaceSum(RealType &recipPot, Mat3x3d &recipVirial);
     void setCutoffRadius(RealType rCut);
     RealType getSuggestedCutoffRadius(int *atid1);   
     RealType getSuggestedCutoffRadius(AtomType *atype);
+    /**
+     * Returns the interaction for a pair of atom types if that pair
+     * can be evaluated with NonBondedInteraction::calcForceBatch (a
+     * single interaction which supports batches), or NULL otherwise.
+     */
+    NonBondedInteraction* getBatchInteraction(int atid1, int atid2);
     
   private:
     bool initialized_;
@@ -126,6 +132,9 @@ namespace OpenMD {
 
     /* sHash_ contains the self-interaction version of iHash_ */
     vector<int> sHash_;
+
+    /* batchHash_ holds the result of getBatchInteraction */
+    vector<vector<NonBondedInteraction*> > batchHash_;
   };
 }
 #endif
@@ -289,6 +289,46 @@ namespace OpenMD {
     
     return;
   }
+
+  void LJ::calcForceBatch(PairBatch &batch) {
+
+    if (!initialized_) initialize();
+
+    int n = batch.n;
+    RealType rcut = batch.rcut;
+    RealType sigmai[PairBatch::MaxPairs];
+    RealType epsilon[PairBatch::MaxPairs];
+
+    // gather the mixing parameters, then evaluate the packed pairs:
+    for (int k = 0; k < n; k++) {
+      LJInteractionData &mixer = MixingMap[LJtids[batch.atid1[k]]][LJtids[batch.atid2[k]]];
+      sigmai[k] = mixer.sigmai;
+      epsilon[k] = mixer.epsilon;
+    }
+
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+    for (int k = 0; k < n; k++) {
+      RealType myPot, myDeriv;
+      RealType myPotC = 0.0;
+      RealType myDerivC = 0.0;
+
+      getLJfunc(batch.rij[k] * sigmai[k], myPot, myDeriv);
+
+      if (batch.shiftedPot) {
+        getLJfunc(rcut * sigmai[k], myPotC, myDerivC);
+        myDerivC = 0.0;
+      } else if (batch.shiftedForce) {
+        getLJfunc(rcut * sigmai[k], myPotC, myDerivC);
+        myPotC = myPotC + myDerivC * (batch.rij[k] - rcut) * sigmai[k];
+      }
+
+      batch.vpair[k] = batch.vdwMult[k] * epsilon[k] * (myPot - myPotC);
+      batch.dudr[k] = batch.sw[k] * batch.vdwMult[k] * epsilon[k] *
+        (myDeriv - myDerivC) * sigmai[k];
+    }
+  }
   
   void LJ::getLJfunc(RealType r, RealType &pot, RealType &deriv) {
 
@@ -213,6 +213,52 @@ namespace OpenMD {
     return;
   }
 
+  void Mie::calcForceBatch(PairBatch &batch) {
+
+    if (!initialized_) initialize();
+
+    int n = batch.n;
+    RealType rcut = batch.rcut;
+    RealType sigmai[PairBatch::MaxPairs];
+    RealType epsilon[PairBatch::MaxPairs];
+    RealType nmScale[PairBatch::MaxPairs];
+    int nRep[PairBatch::MaxPairs];
+    int mAtt[PairBatch::MaxPairs];
+
+    for (int k = 0; k < n; k++) {
+      MieInteractionData &mixer = MixingMap[MieTids[batch.atid1[k]]][MieTids[batch.atid2[k]]];
+      sigmai[k] = mixer.sigmai;
+      epsilon[k] = mixer.epsilon;
+      nmScale[k] = mixer.nmScale;
+      nRep[k] = mixer.nRep;
+      mAtt[k] = mixer.mAtt;
+    }
+
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+    for (int k = 0; k < n; k++) {
+      RealType myPot, myDeriv;
+      RealType myPotC = 0.0;
+      RealType myDerivC = 0.0;
+
+      getMieFunc(batch.rij[k] * sigmai[k], nRep[k], mAtt[k], myPot, myDeriv);
+
+      if (batch.shiftedPot) {
+        getMieFunc(rcut * sigmai[k], nRep[k], mAtt[k], myPotC, myDerivC);
+        myDerivC = 0.0;
+      } else if (batch.shiftedForce) {
+        getMieFunc(rcut * sigmai[k], nRep[k], mAtt[k], myPotC, myDerivC);
+        myPotC = myPotC + myDerivC * (batch.rij[k] - rcut) * sigmai[k];
+      }
+
+      batch.vpair[k] = batch.vdwMult[k] * nmScale[k] * epsilon[k] *
+        (myPot - myPotC);
+      batch.dudr[k] = batch.sw[k] * batch.vdwMult[k] * nmScale[k] *
+        epsilon[k] * (myDeriv - myDerivC) * sigmai[k];
+    }
+  }
+
   void Mie::getMieFunc(const RealType &r, int &n, int &m,
                        RealType &pot, RealType &deriv) {
 
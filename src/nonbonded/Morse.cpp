@@ -255,6 +255,61 @@ namespace OpenMD {
     return;    
   }
 
+  void Morse::calcForceBatch(PairBatch &batch) {
+
+    if (!initialized_) initialize();
+
+    int n = batch.n;
+    RealType rcut = batch.rcut;
+    RealType De[PairBatch::MaxPairs];
+    RealType Re[PairBatch::MaxPairs];
+    RealType beta[PairBatch::MaxPairs];
+    RealType repulsive[PairBatch::MaxPairs];
+    RealType shifted[PairBatch::MaxPairs];
+
+    // the variant is folded into two 0/1 weights so that the
+    // evaluation loop below is free of branches:
+    for (int k = 0; k < n; k++) {
+      MorseInteractionData &mixer = MixingMap[Mtids[batch.atid1[k]]][Mtids[batch.atid2[k]]];
+      De[k] = mixer.De;
+      Re[k] = mixer.Re;
+      beta[k] = mixer.beta;
+      shifted[k] = (mixer.variant == mtShifted) ? 1.0 : 0.0;
+      repulsive[k] = (mixer.variant == mtRepulsive) ? 1.0 : 0.0;
+    }
+
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+    for (int k = 0; k < n; k++) {
+      RealType expfnc  = exp(-beta[k] * (batch.rij[k] - Re[k]));
+      RealType expfnc2 = expfnc * expfnc;
+      RealType expfncC  = exp(-beta[k] * (rcut - Re[k]));
+      RealType expfnc2C = expfncC * expfncC;
+
+      // mtShifted: V = De (e^2 - 2 e), mtRepulsive: V = De e^2
+      RealType myPot = De[k] * (expfnc2 - 2.0 * shifted[k] * expfnc);
+      RealType myDeriv = 2.0 * De[k] * beta[k] * (shifted[k] * expfnc - expfnc2);
+      RealType myPotC = 0.0;
+      RealType myDerivC = 0.0;
+
+      if (batch.shiftedPot) {
+        myPotC = De[k] * (expfnc2C - 2.0 * shifted[k] * expfncC);
+      } else if (batch.shiftedForce) {
+        myPotC = De[k] * (expfnc2C - 2.0 * shifted[k] * expfncC);
+        myDerivC = 2.0 * De[k] * beta[k] * (shifted[k] * expfncC - expfnc2C);
+        myPotC += myDerivC * (batch.rij[k] - rcut);
+      }
+
+      // unknown variants don't contribute anything
+      RealType known = shifted[k] + repulsive[k];
+
+      batch.vpair[k] = known * batch.vdwMult[k] * (myPot - myPotC);
+      batch.dudr[k] = known * batch.sw[k] * batch.vdwMult[k] *
+        (myDeriv - myDerivC);
+    }
+  }
+
   RealType Morse::getSuggestedCutoffRadius(pair<AtomType*, AtomType*> atypes) {
     if (!initialized_) initialize();   
     
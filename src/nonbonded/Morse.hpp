@@ -67,6 +67,8 @@ namespace OpenMD {
     void setSimulatedAtomTypes(set<AtomType*> &simtypes) {simTypes_ = simtypes; initialize();};
     void addExplicitInteraction(AtomType* atype1, AtomType* atype2, RealType De, RealType Re, RealType beta, MorseType mt);
     virtual void calcForce(InteractionData &idat);
+    virtual bool supportsBatch() { return true; }
+    virtual void calcForceBatch(PairBatch &batch);
     virtual string getName() {return name_;}
     virtual int getHash() { return MORSE_INTERACTION; }
     virtual RealType getSuggestedCutoffRadius(pair<AtomType*, AtomType*> atypes);
@@ -143,9 +143,36 @@ namespace OpenMD {
     RealType* skippedCharge2; /**< charge skipped on atom2 in pairwise interaction loop with atom1 */
     RealType* sPot1;           /**< site potential on first atom */
     RealType* sPot2;           /**< site potential on second atom */
+    RealType* pairDensity;    /**< cached densities of this pair (rho, drho/dr of atom1, then of atom2), or NULL */
     /*@}*/
   };
   
+  /**
+   * The PairBatch struct.
+   *
+   * This is used to hand a chunk of atom pairs that share a single
+   * van der Waals interaction to that interaction at once.  Inputs
+   * and outputs are packed arrays of length n, so that the kernels
+   * can be vectorized.  The switching function is evaluated (per
+   * cutoff group pair) by the caller.
+   */
+  struct PairBatch {
+    static const int MaxPairs = 64; /**< maximum number of pairs in a batch */
+    /*@{*/
+    int n;                    /**< number of pairs in this batch */
+    const int* atid1;         /**< atomType idents for the first atoms */
+    const int* atid2;         /**< atomType idents for the second atoms */
+    const RealType* rij;      /**< interatomic separations */
+    const RealType* sw;       /**< switching function values */
+    const RealType* vdwMult;  /**< multipliers for van der Waals interactions */
+    RealType rcut;            /**< cutoff radius */
+    bool shiftedPot;          /**< shift the potential up inside the cutoff? */
+    bool shiftedForce;        /**< shifted forces smoothly inside the cutoff? */
+    RealType* vpair;          /**< (output) unswitched pair potentials */
+    RealType* dudr;           /**< (output) derivatives of the switched potentials */
+    /*@}*/
+  };
+
   /** 
    * The SelfData struct.
    * 
@@ -188,6 +215,10 @@ namespace OpenMD {
     NonBondedInteraction() {}
     virtual ~NonBondedInteraction() {}
     virtual void calcForce(InteractionData &idat) = 0;
+    /** Can this interaction be evaluated with calcForceBatch? */
+    virtual bool supportsBatch() { return false; }
+    /** Evaluates a packed batch of pairs (only if supportsBatch()) */
+    virtual void calcForceBatch(PairBatch &batch) {}
     virtual InteractionFamily getFamily() = 0;
     virtual int getHash() = 0;
     virtual RealType getSuggestedCutoffRadius(pair<AtomType*, AtomType*> atypes) = 0;
@@ -204,6 +204,47 @@ namespace OpenMD {
     return;
   }
 
+  void RepulsivePower::calcForceBatch(PairBatch &batch) {
+
+    if (!initialized_) initialize();
+
+    int n = batch.n;
+    RealType rcut = batch.rcut;
+    RealType sigmai[PairBatch::MaxPairs];
+    RealType epsilon[PairBatch::MaxPairs];
+    int nRep[PairBatch::MaxPairs];
+
+    for (int k = 0; k < n; k++) {
+      RPInteractionData &mixer = MixingMap[RPtids[batch.atid1[k]]][RPtids[batch.atid2[k]]];
+      sigmai[k] = mixer.sigmai;
+      epsilon[k] = mixer.epsilon;
+      nRep[k] = mixer.nRep;
+    }
+
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+    for (int k = 0; k < n; k++) {
+      RealType myPot, myDeriv;
+      RealType myPotC = 0.0;
+      RealType myDerivC = 0.0;
+
+      getNRepulsionFunc(batch.rij[k] * sigmai[k], nRep[k], myPot, myDeriv);
+
+      if (batch.shiftedPot) {
+        getNRepulsionFunc(rcut * sigmai[k], nRep[k], myPotC, myDerivC);
+        myDerivC = 0.0;
+      } else if (batch.shiftedForce) {
+        getNRepulsionFunc(rcut * sigmai[k], nRep[k], myPotC, myDerivC);
+        myPotC = myPotC + myDerivC * (batch.rij[k] - rcut) * sigmai[k];
+      }
+
+      batch.vpair[k] = batch.vdwMult[k] * epsilon[k] * (myPot - myPotC);
+      batch.dudr[k] = batch.sw[k] * batch.vdwMult[k] * epsilon[k] *
+        (myDeriv - myDerivC) * sigmai[k];
+    }
+  }
+
   void RepulsivePower::getNRepulsionFunc(const RealType &r, int &n,
                                          RealType &pot, RealType &deriv) {
 
@@ -200,6 +200,8 @@ namespace OpenMD {
       
       mixer.V = V;
       mixer.phi = phi;
+      mixer.phiV = TabulatedSpline(*phi);
+      mixer.phiV.addColumn(*V);
 
       mixer.explicitlySet = false;
 
@@ -255,6 +257,8 @@ namespace OpenMD {
     
     mixer.V = V;
     mixer.phi = phi;
+    mixer.phiV = TabulatedSpline(*phi);
+    mixer.phiV.addColumn(*V);
     
     mixer.explicitlySet = true;
 
@@ -279,7 +283,14 @@ namespace OpenMD {
     RealType rcij = mixer.rCut;
 
     if ( *(idat.rij)  < rcij) {
-      RealType rho = mixer.phi->getValueAt( *(idat.rij) );
+      RealType rho;
+      if (idat.pairDensity != NULL) {
+        mixer.phiV.getValueAndDerivativeAt( *(idat.rij), idat.pairDensity[0],
+                                            idat.pairDensity[1] );
+        rho = idat.pairDensity[0];
+      } else {
+        rho = mixer.phiV.getValueAt( *(idat.rij) );
+      }
       *(idat.rho1) += rho;
       *(idat.rho2) += rho;
     } 
@@ -326,9 +337,21 @@ namespace OpenMD {
     if ( *(idat.rij)  < rcij) {
       RealType vcij = mixer.vCut; 
       RealType rhtmp, drhodr, vptmp, dvpdr;
+      RealType vals[2], derivs[2];
       
-      mixer.phi->getValueAndDerivativeAt( *(idat.rij), rhtmp, drhodr );      
-      mixer.V->getValueAndDerivativeAt( *(idat.rij), vptmp, dvpdr);
+      if (idat.pairDensity != NULL) {
+        // the density was cached by calcDensity, so only V is needed:
+        rhtmp = idat.pairDensity[0];
+        drhodr = idat.pairDensity[1];
+        mixer.phiV.getColumnValueAndDerivativeAt(1, *(idat.rij), vptmp,
+                                                 dvpdr);
+      } else {
+        mixer.phiV.getAllValuesAndDerivativesAt( *(idat.rij), vals, derivs );
+        rhtmp = vals[0];
+        drhodr = derivs[0];
+        vptmp = vals[1];
+        dvpdr = derivs[1];
+      }
       
       RealType pot_temp = vptmp - vcij;
       *(idat.vpair) += pot_temp;
@@ -46,6 +46,7 @@
 #include "nonbonded/NonBondedInteraction.hpp"
 #include "brains/ForceField.hpp"
 #include "math/CubicSpline.hpp"
+#include "math/TabulatedSpline.hpp"
 #include "types/SuttonChenAdapter.hpp"
 
 namespace OpenMD {
@@ -68,6 +69,7 @@ namespace OpenMD {
     RealType vCut;
     CubicSpline* V;
     CubicSpline* phi;
+    TabulatedSpline phiV;  /**< phi and V packed for the force loops */
     bool explicitlySet;
   };
     
@@ -0,0 +1,463 @@
+/*
+ * Copyright (c) 2005 The University of Notre Dame. All Rights Reserved.
+ *
+ * The University of Notre Dame grants you ("Licensee") a
+ * non-exclusive, royalty free, license to use, modify and
+ * redistribute this software in source and binary code form, provided
+ * that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * This software is provided "AS IS," without a warranty of any
+ * kind. All express or implied conditions, representations and
+ * warranties, including any implied warranty of merchantability,
+ * fitness for a particular purpose or non-infringement, are hereby
+ * excluded.  The University of Notre Dame and its licensors shall not
+ * be liable for any damages suffered by licensee as a result of
+ * using, modifying or distributing the software or its
+ * derivatives. In no event will the University of Notre Dame or its
+ * licensors be liable for any lost revenue, profit or data, or for
+ * direct, indirect, special, consequential, incidental or punitive
+ * damages, however caused and regardless of the theory of liability,
+ * arising out of the use of or inability to use software, even if the
+ * University of Notre Dame has been advised of the possibility of
+ * such damages.
+ *
+ * SUPPORT OPEN SCIENCE!  If you use OpenMD or its source code in your
+ * research, please cite the appropriate papers when you publish your
+ * work.  Good starting points are:
+ *                                                                      
+ * [1]  Meineke, et al., J. Comp. Chem. 26, 252-271 (2005).             
+ * [2]  Fennell & Gezelter, J. Chem. Phys. 124 234104 (2006).          
+ * [3]  Sun, Lin & Gezelter, J. Chem. Phys. 128, 234107 (2008).          
+ * [4]  Kuang & Gezelter,  J. Chem. Phys. 133, 164101 (2010).
+ * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
+ */
+
+#ifdef IS_MPI
+#include <mpi.h>
+#endif
+
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+#include "nonbonded/SPME.hpp"
+#include "utils/simError.h"
+#include "utils/Constants.hpp"
+
+namespace OpenMD {
+
+  SPME::SPME() : alpha_(0.0), gridSpacing_(1.0), order_(4), nComplex_(0),
+                 hmat_(0.0) {
+    K_[0] = K_[1] = K_[2] = 0;
+#ifdef HAVE_FFTW3_H
+    meshHat_ = NULL;
+#endif
+  }
+
+  SPME::~SPME() {
+#ifdef HAVE_FFTW3_H
+    if (meshHat_ != NULL) {
+      fftw_destroy_plan(forward_);
+      fftw_destroy_plan(backward_);
+      fftw_free(meshHat_);
+    }
+#endif
+  }
+
+  /**
+   * Returns the smallest mesh size >= minSize that has only 2, 3,
+   * and 5 as prime factors (these are the fastest FFT sizes).  The
+   * mesh must be at least as large as the B-spline support.
+   */
+  int SPME::goodMeshSize(int minSize) {
+    int n = max(minSize, order_);
+    while (true) {
+      int m = n;
+      while (m % 2 == 0) m /= 2;
+      while (m % 3 == 0) m /= 3;
+      while (m % 5 == 0) m /= 5;
+      if (m == 1) return n;
+      n++;
+    }
+  }
+
+  /**
+   * Computes the cardinal B-spline M_n(w + j) and its first three
+   * derivatives for j = 0 .. n-1, where 0 <= w < 1.  The derivatives
+   * use the identity dM_n(x)/dx = M_{n-1}(x) - M_{n-1}(x-1), so the
+   * recursion table keeps every order from 1 to n.
+   */
+  void SPME::fillBSplines(RealType w, RealType* M, RealType* dM,
+                          RealType* d2M, RealType* d3M) {
+    int n = order_;
+    // three zeros in front of each row so that the differences can
+    // reach back to j - 3:
+    int row = n + 3;
+    work_.assign(n * row, 0.0);
+
+    work_[3] = 1.0;
+    for (int p = 2; p <= n; p++) {
+      RealType* prev = &work_[(p-2)*row + 3];
+      RealType* cur = &work_[(p-1)*row + 3];
+      RealType div = 1.0 / RealType(p - 1);
+      for (int j = 0; j < p; j++) {
+        RealType x = w + RealType(j);
+        cur[j] = div * (x * prev[j] + (RealType(p) - x) * prev[j-1]);
+      }
+    }
+
+    RealType* M0 = &work_[(n-1)*row + 3];
+    RealType* M1 = &work_[(n-2)*row + 3];
+    RealType* M2 = &work_[(n-3)*row + 3];
+    RealType* M3 = &work_[(n-4)*row + 3];
+
+    for (int j = 0; j < n; j++) {
+      M[j] = M0[j];
+      dM[j] = M1[j] - M1[j-1];
+      d2M[j] = M2[j] - 2.0*M2[j-1] + M2[j-2];
+      d3M[j] = M3[j] - 3.0*M3[j-1] + 3.0*M3[j-2] - M3[j-3];
+    }
+  }
+
+  /**
+   * Squared moduli of the B-spline Euler exponential factors,
+   * |sum_k M_n(k+1) exp(2 pi i m k / K)|^2, which divide the
+   * influence function.
+   */
+  void SPME::computeModuli(int K, vector<RealType>& bmod) {
+    int n = order_;
+    vector<RealType> M(n), dM(n), d2M(n), d3M(n);
+    fillBSplines(0.0, &M[0], &dM[0], &d2M[0], &d3M[0]);
+
+    bmod.resize(K);
+    for (int m = 0; m < K; m++) {
+      RealType sc(0.0), ss(0.0);
+      for (int k = 0; k < n - 1; k++) {
+        RealType arg = 2.0 * Constants::PI * RealType(m * k) / RealType(K);
+        sc += M[k+1] * cos(arg);
+        ss += M[k+1] * sin(arg);
+      }
+      bmod[m] = sc*sc + ss*ss;
+    }
+    // Odd orders have a zero at m = K/2; interpolate across it.
+    for (int m = 0; m < K; m++) {
+      if (bmod[m] < 1.0e-7)
+        bmod[m] = 0.5 * (bmod[(m - 1 + K) % K] + bmod[(m + 1) % K]);
+    }
+  }
+
+  void SPME::setupMesh(const Mat3x3d& hmat) {
+    int K[3];
+    for (int a = 0; a < 3; a++) {
+      RealType len = Vector3d(hmat(0,a), hmat(1,a), hmat(2,a)).length();
+      K[a] = goodMeshSize(int(ceil(len / gridSpacing_)));
+    }
+
+    bool newMesh = (K[0] != K_[0] || K[1] != K_[1] || K[2] != K_[2]);
+
+    if (newMesh) {
+      for (int a = 0; a < 3; a++) {
+        K_[a] = K[a];
+        computeModuli(K_[a], bmod_[a]);
+      }
+      nComplex_ = K_[2] / 2 + 1;
+      mesh_.assign(K_[0] * K_[1] * K_[2], 0.0);
+
+#ifdef HAVE_FFTW3_H
+      if (meshHat_ != NULL) {
+        fftw_destroy_plan(forward_);
+        fftw_destroy_plan(backward_);
+        fftw_free(meshHat_);
+      }
+      meshHat_ = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) *
+                                             K_[0] * K_[1] * nComplex_);
+      forward_ = fftw_plan_dft_r2c_3d(K_[0], K_[1], K_[2], &mesh_[0],
+                                      meshHat_, FFTW_ESTIMATE);
+      backward_ = fftw_plan_dft_c2r_3d(K_[0], K_[1], K_[2], meshHat_,
+                                       &mesh_[0], FFTW_ESTIMATE);
+#endif
+    }
+
+    if (!newMesh && hmat_ == hmat) return;
+    hmat_ = hmat;
+
+    // The influence function exp(-pi^2 m^2 / alpha^2) / (pi V m^2 B(m))
+    // on the half mesh used by the real-to-complex transforms.
+
+    const RealType eConverter = 332.0637778;
+    Mat3x3d hinv = hmat.inverse();
+    RealType V = hmat.determinant();
+    RealType fac = Constants::PI * Constants::PI / (alpha_ * alpha_);
+    Vector3d m;
+    int mi, mj, mk;
+
+    influence_.resize(K_[0] * K_[1] * nComplex_);
+
+    for (int i = 0; i < K_[0]; i++) {
+      mi = (i <= K_[0] / 2) ? i : i - K_[0];
+      for (int j = 0; j < K_[1]; j++) {
+        mj = (j <= K_[1] / 2) ? j : j - K_[1];
+        for (int k = 0; k < nComplex_; k++) {
+          mk = k;
+          int idx = (i * K_[1] + j) * nComplex_ + k;
+          if (mi == 0 && mj == 0 && mk == 0) {
+            influence_[idx] = 0.0;
+            continue;
+          }
+          // reciprocal lattice vector (without the 2 pi):
+          for (int b = 0; b < 3; b++)
+            m[b] = mi * hinv(0,b) + mj * hinv(1,b) + mk * hinv(2,b);
+          RealType m2 = m.lengthSquare();
+          influence_[idx] = eConverter * exp(-fac * m2) /
+            (Constants::PI * V * m2 * bmod_[0][i] * bmod_[1][j] * bmod_[2][k]);
+        }
+      }
+    }
+  }
+
+  void SPME::calcReciprocalSpace(const Mat3x3d& hmat,
+                                 const vector<Vector3d>& pos,
+                                 const vector<RealType>& C,
+                                 const vector<Vector3d>& D,
+                                 const vector<Mat3x3d>& Q,
+                                 RealType& pot,
+                                 Mat3x3d& virial,
+                                 vector<Vector3d>& frc,
+                                 vector<Vector3d>& trq,
+                                 vector<RealType>& phi) {
+#ifndef HAVE_FFTW3_H
+    sprintf(painCave.errMsg,
+            "SPME::calcReciprocalSpace: OpenMD was built without FFTW3,\n"
+            "\twhich is required for the smooth particle mesh Ewald sum.\n");
+    painCave.severity = OPENMD_ERROR;
+    painCave.isFatal = 1;
+    simError();
+#else
+    int n = order_;
+    int nSites = pos.size();
+    bool doDipoles = !D.empty();
+    bool doQuadrupoles = !Q.empty();
+
+    setupMesh(hmat);
+
+    // J maps cartesian displacements onto the mesh coordinates, u = J r
+    Mat3x3d hinv = hmat.inverse();
+    Mat3x3d J;
+    for (int a = 0; a < 3; a++)
+      for (int b = 0; b < 3; b++)
+        J(a, b) = RealType(K_[a]) * hinv(a, b);
+    Mat3x3d Jt = J.transpose();
+
+    vector<RealType> M(3*n), dM(3*n), d2M(3*n), d3M(3*n);
+    vector<int> grid(3*n);
+    Vector3d s, du;
+    Mat3x3d qu;
+
+    frc.assign(nSites, V3Zero);
+    trq.assign(nSites, V3Zero);
+    phi.assign(nSites, 0.0);
+
+    std::fill(mesh_.begin(), mesh_.end(), 0.0);
+
+    // Spread the multipoles onto the mesh.  The dipoles and
+    // quadrupoles are transformed to mesh coordinates so that they
+    // act directly on the B-spline derivatives.
+
+    for (int i = 0; i < nSites; i++) {
+      s = hinv * pos[i];
+      for (int a = 0; a < 3; a++) {
+        RealType u = RealType(K_[a]) * (s[a] - floor(s[a]));
+        int k0 = int(u);
+        if (k0 >= K_[a]) k0 -= K_[a];
+        fillBSplines(u - floor(u), &M[a*n], &dM[a*n], &d2M[a*n], &d3M[a*n]);
+        for (int j = 0; j < n; j++)
+          grid[a*n + j] = (k0 - j + K_[a]) % K_[a];
+      }
+
+      if (doDipoles) du = J * D[i];
+      if (doQuadrupoles) qu = J * Q[i] * Jt;
+
+      for (int j0 = 0; j0 < n; j0++) {
+        for (int j1 = 0; j1 < n; j1++) {
+          int offset = (grid[j0] * K_[1] + grid[n + j1]) * K_[2];
+          for (int j2 = 0; j2 < n; j2++) {
+            RealType a0 = M[j0],   b0 = dM[j0],   c0 = d2M[j0];
+            RealType a1 = M[n+j1], b1 = dM[n+j1], c1 = d2M[n+j1];
+            RealType a2 = M[2*n+j2], b2 = dM[2*n+j2], c2 = d2M[2*n+j2];
+
+            RealType w = C[i] * a0 * a1 * a2;
+            if (doDipoles)
+              w += du[0]*b0*a1*a2 + du[1]*a0*b1*a2 + du[2]*a0*a1*b2;
+            if (doQuadrupoles)
+              w += qu(0,0)*c0*a1*a2 + qu(1,1)*a0*c1*a2 + qu(2,2)*a0*a1*c2
+                + (qu(0,1) + qu(1,0)) * b0*b1*a2
+                + (qu(0,2) + qu(2,0)) * b0*a1*b2
+                + (qu(1,2) + qu(2,1)) * a0*b1*b2;
+
+            mesh_[offset + grid[2*n + j2]] += w;
+          }
+        }
+      }
+    }
+
+#ifdef IS_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &mesh_[0], mesh_.size(), MPI_DOUBLE,
+                  MPI_SUM, MPI_COMM_WORLD);
+#endif
+
+    fftw_execute(forward_);
+
+    // Energy, mesh virial, and the convolution with the influence
+    // function.  Each mesh point contributes
+    // E(m) (1 - 2 (1 + pi^2 m^2 / alpha^2) m m / m^2) to the virial.
+    RealType energy(0.0);
+    Mat3x3d meshVirial(0.0);
+    RealType fac = Constants::PI * Constants::PI / (alpha_ * alpha_);
+    Vector3d m;
+    int nHat = K_[0] * K_[1] * nComplex_;
+    for (int idx = 0; idx < nHat; idx++) {
+      int k = idx % nComplex_;
+      int i = idx / (K_[1] * nComplex_);
+      int j = (idx / nComplex_) % K_[1];
+      RealType mult = (k == 0 || (K_[2] % 2 == 0 && k == K_[2] / 2)) ? 1.0 : 2.0;
+      RealType re = meshHat_[idx][0];
+      RealType im = meshHat_[idx][1];
+      RealType eM = 0.5 * mult * influence_[idx] * (re*re + im*im);
+      meshHat_[idx][0] *= influence_[idx];
+      meshHat_[idx][1] *= influence_[idx];
+      if (eM == 0.0) continue;
+
+      energy += eM;
+
+      int mi = (i <= K_[0] / 2) ? i : i - K_[0];
+      int mj = (j <= K_[1] / 2) ? j : j - K_[1];
+      for (int b = 0; b < 3; b++)
+        m[b] = mi * hinv(0,b) + mj * hinv(1,b) + k * hinv(2,b);
+      RealType m2 = m.lengthSquare();
+      RealType vfac = 2.0 * eM * (1.0 + fac * m2) / m2;
+      for (int a = 0; a < 3; a++) {
+        meshVirial(a, a) += eM;
+        for (int b = 0; b < 3; b++)
+          meshVirial(a, b) -= vfac * m[a] * m[b];
+      }
+    }
+    pot += energy;
+
+    // Every processor holds the whole mesh, but the virial is summed
+    // over the processors, so only one of them adds the mesh term:
+#ifdef IS_MPI
+    int myNode;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myNode);
+    if (myNode == 0)
+#endif
+      virial += meshVirial;
+
+    // mesh_ now holds the reciprocal space potential on the mesh
+    fftw_execute(backward_);
+
+    // Interpolate the potential, field, field gradient (and its
+    // derivative for the quadrupoles) back to the sites.
+
+    for (int i = 0; i < nSites; i++) {
+      s = hinv * pos[i];
+      for (int a = 0; a < 3; a++) {
+        RealType u = RealType(K_[a]) * (s[a] - floor(s[a]));
+        int k0 = int(u);
+        if (k0 >= K_[a]) k0 -= K_[a];
+        fillBSplines(u - floor(u), &M[a*n], &dM[a*n], &d2M[a*n], &d3M[a*n]);
+        for (int j = 0; j < n; j++)
+          grid[a*n + j] = (k0 - j + K_[a]) % K_[a];
+      }
+
+      RealType p(0.0);
+      Vector3d g(0.0);
+      Mat3x3d h(0.0);
+      // unique third derivatives: 000 111 222 001 002 011 022 112 122 012
+      RealType t[10] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+      for (int j0 = 0; j0 < n; j0++) {
+        for (int j1 = 0; j1 < n; j1++) {
+          int offset = (grid[j0] * K_[1] + grid[n + j1]) * K_[2];
+          for (int j2 = 0; j2 < n; j2++) {
+            RealType v = mesh_[offset + grid[2*n + j2]];
+            RealType a0 = M[j0],     b0 = dM[j0],     c0 = d2M[j0];
+            RealType a1 = M[n+j1],   b1 = dM[n+j1],   c1 = d2M[n+j1];
+            RealType a2 = M[2*n+j2], b2 = dM[2*n+j2], c2 = d2M[2*n+j2];
+
+            p += v * a0*a1*a2;
+            g[0] += v * b0*a1*a2;
+            g[1] += v * a0*b1*a2;
+            g[2] += v * a0*a1*b2;
+
+            if (doDipoles || doQuadrupoles) {
+              h(0,0) += v * c0*a1*a2;
+              h(1,1) += v * a0*c1*a2;
+              h(2,2) += v * a0*a1*c2;
+              h(0,1) += v * b0*b1*a2;
+              h(0,2) += v * b0*a1*b2;
+              h(1,2) += v * a0*b1*b2;
+            }
+            if (doQuadrupoles) {
+              t[0] += v * d3M[j0]*a1*a2;
+              t[1] += v * a0*d3M[n+j1]*a2;
+              t[2] += v * a0*a1*d3M[2*n+j2];
+              t[3] += v * c0*b1*a2;
+              t[4] += v * c0*a1*b2;
+              t[5] += v * b0*c1*a2;
+              t[6] += v * b0*a1*c2;
+              t[7] += v * a0*c1*b2;
+              t[8] += v * a0*b1*c2;
+              t[9] += v * b0*b1*b2;
+            }
+          }
+        }
+      }
+      h(1,0) = h(0,1);
+      h(2,0) = h(0,2);
+      h(2,1) = h(1,2);
+
+      // derivative of the site energy with respect to the mesh
+      // coordinates of the site:
+      Vector3d fu = C[i] * g;
+
+      if (doDipoles) {
+        du = J * D[i];
+        fu += h * du;
+        trq[i] -= cross(D[i], Vector3d(Jt * g));
+        virial += outProduct(D[i], Vector3d(Jt * g));
+      }
+
+      if (doQuadrupoles) {
+        qu = J * Q[i] * Jt;
+        fu[0] += t[0]*qu(0,0) + t[5]*qu(1,1) + t[6]*qu(2,2)
+          + t[3]*(qu(0,1) + qu(1,0)) + t[4]*(qu(0,2) + qu(2,0))
+          + t[9]*(qu(1,2) + qu(2,1));
+        fu[1] += t[3]*qu(0,0) + t[1]*qu(1,1) + t[8]*qu(2,2)
+          + t[5]*(qu(0,1) + qu(1,0)) + t[9]*(qu(0,2) + qu(2,0))
+          + t[7]*(qu(1,2) + qu(2,1));
+        fu[2] += t[4]*qu(0,0) + t[7]*qu(1,1) + t[2]*qu(2,2)
+          + t[9]*(qu(0,1) + qu(1,0)) + t[6]*(qu(0,2) + qu(2,0))
+          + t[8]*(qu(1,2) + qu(2,1));
+
+        // torque on a quadrupole in a field gradient G: -2 eps : (Q G)
+        Mat3x3d QG = Q[i] * (Jt * h * J);
+        trq[i] -= 2.0 * Vector3d(QG(1,2) - QG(2,1),
+                                 QG(2,0) - QG(0,2),
+                                 QG(0,1) - QG(1,0));
+        virial += 2.0 * QG;
+      }
+
+      frc[i] = -(Jt * fu);
+      phi[i] = p;
+    }
+#endif
+  }
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2009 The University of Notre Dame. All Rights Reserved.
+ *
+ * The University of Notre Dame grants you ("Licensee") a
+ * non-exclusive, royalty free, license to use, modify and
+ * redistribute this software in source and binary code form, provided
+ * that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * This software is provided "AS IS," without a warranty of any
+ * kind. All express or implied conditions, representations and
+ * warranties, including any implied warranty of merchantability,
+ * fitness for a particular purpose or non-infringement, are hereby
+ * excluded.  The University of Notre Dame and its licensors shall not
+ * be liable for any damages suffered by licensee as a result of
+ * using, modifying or distributing the software or its
+ * derivatives. In no event will the University of Notre Dame or its
+ * licensors be liable for any lost revenue, profit or data, or for
+ * direct, indirect, special, consequential, incidental or punitive
+ * damages, however caused and regardless of the theory of liability,
+ * arising out of the use of or inability to use software, even if the
+ * University of Notre Dame has been advised of the possibility of
+ * such damages.
+ *
+ * SUPPORT OPEN SCIENCE!  If you use OpenMD or its source code in your
+ * research, please cite the appropriate papers when you publish your
+ * work.  Good starting points are:
+ *                                                                      
+ * [1]  Meineke, et al., J. Comp. Chem. 26, 252-271 (2005).             
+ * [2]  Fennell & Gezelter, J. Chem. Phys. 124, 234104 (2006).          
+ * [3]  Sun, Lin & Gezelter, J. Chem. Phys. 128, 234107 (2008).          
+ * [4]  Kuang & Gezelter,  J. Chem. Phys. 133, 164101 (2010).
+ * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
+ */
+ 
+
+#ifndef NONBONDED_SPME_HPP
+#define NONBONDED_SPME_HPP
+
+#include "config.h"
+#include <vector>
+#include "math/Vector3.hpp"
+#include "math/SquareMatrix3.hpp"
+
+#ifdef HAVE_FFTW3_H
+#include <fftw3.h>
+#endif
+
+using namespace std;
+
+namespace OpenMD {
+
+  /**
+   * @class SPME
+   *
+   * Reciprocal-space part of the Smooth Particle Mesh Ewald sum
+   * (Essmann et al., J. Chem. Phys. 103, 8577 (1995)) for point
+   * charges, dipoles, and quadrupoles.
+   *
+   * The multipoles are spread onto a regular mesh using cardinal
+   * B-splines of order n (and their derivatives for the dipoles and
+   * quadrupoles), the mesh is convolved with the Ewald influence
+   * function using a 3D FFT, and the forces, torques, and site
+   * potentials are interpolated back from the convolved mesh using
+   * the same B-splines.  The cost is O(N n^3 + K log K) for N sites
+   * and K mesh points.
+   *
+   * In parallel, each processor spreads its own sites onto a copy of
+   * the whole mesh.  The meshes are summed, and each processor
+   * interpolates the forces on its own sites.
+   *
+   * The virial is the derivative of the energy with respect to a
+   * homogeneous strain of the box, holding the dipoles and
+   * quadrupoles fixed (the same convention as the real space pair
+   * virial).  It has a mesh term (Essmann et al., eq. 2.7) and, for
+   * the multipoles, a term from each site.
+   *
+   * Charges are in electrons, dipoles in electron-angstroms, and
+   * quadrupoles in electron-angstroms^2.  The energies are returned
+   * in kcal/mol.
+   */
+  class SPME {
+  public:
+    SPME();
+    ~SPME();
+
+    void setDampingAlpha(RealType alpha) { alpha_ = alpha; }
+    void setOrder(int order) { order_ = order; }
+    void setGridSpacing(RealType spacing) { gridSpacing_ = spacing; }
+    int getOrder() { return order_; }
+
+    /**
+     * Computes the reciprocal space energy of a set of sites, and
+     * the forces, torques, and electrostatic potentials at each of
+     * the sites.  frc, trq, and phi are overwritten.
+     *
+     * @param hmat the box matrix
+     * @param pos positions of the (local) sites
+     * @param C charges of the sites
+     * @param D dipoles of the sites (empty if there are no dipoles)
+     * @param Q quadrupoles of the sites (empty if there are none)
+     * @param pot the reciprocal space energy is added to pot
+     * @param virial the reciprocal space virial is added to virial
+     */
+    void calcReciprocalSpace(const Mat3x3d& hmat,
+                             const vector<Vector3d>& pos,
+                             const vector<RealType>& C,
+                             const vector<Vector3d>& D,
+                             const vector<Mat3x3d>& Q,
+                             RealType& pot,
+                             Mat3x3d& virial,
+                             vector<Vector3d>& frc,
+                             vector<Vector3d>& trq,
+                             vector<RealType>& phi);
+
+  private:
+    void setupMesh(const Mat3x3d& hmat);
+    void fillBSplines(RealType w, RealType* M, RealType* dM,
+                      RealType* d2M, RealType* d3M);
+    void computeModuli(int K, vector<RealType>& bmod);
+    int goodMeshSize(int minSize);
+
+    RealType alpha_;
+    RealType gridSpacing_;
+    int order_;
+
+    int K_[3];                  /**< mesh points along each box vector */
+    int nComplex_;              /**< K_[2]/2 + 1 complex points on the last axis */
+    Mat3x3d hmat_;              /**< box used to build the influence function */
+    vector<RealType> bmod_[3];  /**< B-spline moduli along each axis */
+    vector<RealType> influence_;/**< influence function on the half mesh */
+    vector<double> mesh_;       /**< real-space mesh (charges, then potentials) */
+    vector<RealType> work_;     /**< B-spline recursion table */
+#ifdef HAVE_FFTW3_H
+    fftw_complex* meshHat_;
+    fftw_plan forward_;
+    fftw_plan backward_;
+#endif
+  };
+}
+#endif
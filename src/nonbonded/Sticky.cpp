@@ -131,11 +131,13 @@ namespace OpenMD {
       CubicSpline* s = new CubicSpline();
       s->addPoint(mixer.rl, 1.0);
       s->addPoint(mixer.ru, 0.0);
+      s->generate();
       mixer.s = s;
 
       CubicSpline* sp = new CubicSpline();
       sp->addPoint(mixer.rlp, 1.0);
       sp->addPoint(mixer.rup, 0.0);
+      sp->generate();
       mixer.sp = sp;
 
       MixingMap[stid2].resize( nSticky_ );
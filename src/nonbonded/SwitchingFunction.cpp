@@ -142,6 +142,8 @@ namespace OpenMD {
       switchSpline_->addPoint(rin_, 1.0);
       switchSpline_->addPoint(rout_, 0.0);
     }
+    switchSpline_->generate();
+    switchTable_ = TabulatedSpline(*switchSpline_);
     haveSpline_ = true;
     return;
   }
@@ -160,7 +162,7 @@ namespace OpenMD {
       } else {
         in_switching_region = true;
         r = sqrt(r2);
-        switchSpline_->getValueAndDerivativeAt(r, sw, dswdr);
+        switchTable_.getValueAndDerivativeAt(r, sw, dswdr);
       }
     }
     return in_switching_region;
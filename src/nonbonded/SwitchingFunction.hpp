@@ -44,6 +44,7 @@
 #define NONBONDED_SWITCHINGFUNCTION_HPP
 
 #include "math/CubicSpline.hpp"
+#include "math/TabulatedSpline.hpp"
 
 using namespace std;
 namespace OpenMD {
@@ -71,6 +72,7 @@ namespace OpenMD {
     bool isCubic_;
     int np_;
     CubicSpline* switchSpline_;   
+    TabulatedSpline switchTable_; /**< packed switchSpline_ for getSwitch */
   };
 }                  
 #endif
@@ -49,6 +49,10 @@ namespace OpenMD{
                                              ForceManager* forceMan)
     : info_(info), forceMan_(forceMan), thermo(info) {   
     shake_ = new Shake(info_);
+
+    // setCoor restores the undeformed configuration with resetToPrevious
+    SnapshotManager* sman = info_->getSnapshotManager();
+    sman->requirePrevious(sman->getStorageLayout());
     
     if (info_->usesFluctuatingCharges()) {
       if (info_->getNFluctuatingCharges() > 0) {
@@ -51,6 +51,8 @@
 
 #include <config.h>
 #include <mpi.h>
+#include <vector>
+#include <algorithm>
 #include "math/SquareMatrix3.hpp"
 
 using namespace std;
@@ -211,6 +213,186 @@ namespace OpenMD{
     MPI_Comm myComm;
   }; 
 
+  /**
+   * @class PackedPlan
+   * Exchanges several per-object arrays that share one row or column
+   * distribution as a single message.  The arrays are registered with
+   * add() before each exchange, so the layout can change from step to
+   * step.  An exchange is posted with beginGather() or beginScatter()
+   * using the non-blocking MPI_Iallgatherv and MPI_Ireduce_scatter
+   * collectives, and local work may continue until finishGather() or
+   * finishScatter() waits for it and unpacks the data.  The data are
+   * packed when the exchange is posted, so only the registered arrays
+   * that receive results (and their sizes) are off limits in between.
+   *
+   * All registered types must be built from RealType (RealType,
+   * Vector3d, Mat3x3d, potVec, ...).
+   */
+  class PackedPlan {
+  public:
+
+    PackedPlan(MPI_Comm comm, int nObjects) : myComm(comm), stride_(0),
+                                              request_(MPI_REQUEST_NULL) {
+      int nCommProcs;
+      MPI_Comm_size( myComm, &nCommProcs );
+      MPI_Comm_rank( myComm, &myRank_ );
+
+      objCounts_.resize(nCommProcs, 0);
+      objDisplacements_.resize(nCommProcs, 0);
+      counts_.resize(nCommProcs, 0);
+      displacements_.resize(nCommProcs, 0);
+
+      MPI_Allgather(&nObjects, 1, MPI_INT, &objCounts_[0], 1, MPI_INT,
+                    myComm);
+
+      for (int i = 1; i < nCommProcs; i++) {
+        objDisplacements_[i] = objDisplacements_[i-1] + objCounts_[i-1];
+      }
+      nObjects_ = objDisplacements_[nCommProcs-1] + objCounts_[nCommProcs-1];
+    }
+
+    /** forgets the arrays registered for the previous exchange */
+    void clear() {
+      fields_.clear();
+      stride_ = 0;
+    }
+
+    /**
+     * Registers one array pair for the next exchange.  local is
+     * indexed by the objects on this processor and remote by all of
+     * the objects in the plan.  Gathers copy local into remote;
+     * scatters sum remote over the communicator and add the result
+     * into local.
+     */
+    template<typename T>
+    void add(vector<T>& local, vector<T>& remote) {
+      Field f;
+      f.local = local.empty() ? NULL : reinterpret_cast<RealType*>(&local[0]);
+      f.remote = remote.empty() ? NULL :
+        reinterpret_cast<RealType*>(&remote[0]);
+      f.length = MPITraits<T>::Length();
+      f.offset = stride_;
+      fields_.push_back(f);
+      stride_ += f.length;
+    }
+
+    bool empty() {
+      return fields_.empty();
+    }
+
+    void beginGather() {
+      setupCounts();
+      int n = objCounts_[myRank_];
+      sendBuffer_.resize(n * stride_);
+      recvBuffer_.resize(nObjects_ * stride_);
+
+      for (vector<Field>::iterator f = fields_.begin(); f != fields_.end();
+           ++f) {
+        if (n > 0)
+          copy(f->local, f->local + n * f->length,
+               sendBuffer_.begin() + f->offset * n);
+      }
+#if MPI_VERSION >= 3
+      MPI_Iallgatherv(bufferStart(sendBuffer_), n * stride_, MPI_REALTYPE,
+                      bufferStart(recvBuffer_), &counts_[0],
+                      &displacements_[0], MPI_REALTYPE, myComm, &request_);
+#else
+      MPI_Allgatherv(bufferStart(sendBuffer_), n * stride_, MPI_REALTYPE,
+                     bufferStart(recvBuffer_), &counts_[0],
+                     &displacements_[0], MPI_REALTYPE, myComm);
+#endif
+    }
+
+    void finishGather() {
+      MPI_Wait(&request_, MPI_STATUS_IGNORE);
+
+      for (vector<Field>::iterator f = fields_.begin(); f != fields_.end();
+           ++f) {
+        for (std::size_t p = 0; p < objCounts_.size(); p++) {
+          int n = objCounts_[p] * f->length;
+          if (n == 0) continue;
+          vector<RealType>::iterator src = recvBuffer_.begin() +
+            displacements_[p] + f->offset * objCounts_[p];
+          copy(src, src + n, f->remote + objDisplacements_[p] * f->length);
+        }
+      }
+    }
+
+    void beginScatter() {
+      setupCounts();
+      sendBuffer_.resize(nObjects_ * stride_);
+      recvBuffer_.resize(objCounts_[myRank_] * stride_);
+
+      for (vector<Field>::iterator f = fields_.begin(); f != fields_.end();
+           ++f) {
+        for (std::size_t p = 0; p < objCounts_.size(); p++) {
+          int n = objCounts_[p] * f->length;
+          if (n == 0) continue;
+          RealType* src = f->remote + objDisplacements_[p] * f->length;
+          copy(src, src + n, sendBuffer_.begin() + displacements_[p] +
+               f->offset * objCounts_[p]);
+        }
+      }
+#if MPI_VERSION >= 3
+      MPI_Ireduce_scatter(bufferStart(sendBuffer_), bufferStart(recvBuffer_),
+                          &counts_[0], MPI_REALTYPE, MPI_SUM, myComm,
+                          &request_);
+#else
+      MPI_Reduce_scatter(bufferStart(sendBuffer_), bufferStart(recvBuffer_),
+                         &counts_[0], MPI_REALTYPE, MPI_SUM, myComm);
+#endif
+    }
+
+    void finishScatter() {
+      MPI_Wait(&request_, MPI_STATUS_IGNORE);
+
+      int nObj = objCounts_[myRank_];
+      for (vector<Field>::iterator f = fields_.begin(); f != fields_.end();
+           ++f) {
+        int n = nObj * f->length;
+        vector<RealType>::iterator src = recvBuffer_.begin() + f->offset * nObj;
+        for (int i = 0; i < n; i++)
+          f->local[i] += src[i];
+      }
+    }
+
+    int getSize() {
+      return nObjects_;
+    }
+
+  private:
+    struct Field {
+      RealType* local;
+      RealType* remote;
+      int length;    ///< RealTypes per object
+      int offset;    ///< RealTypes per object in the preceding fields
+    };
+
+    void setupCounts() {
+      for (std::size_t p = 0; p < objCounts_.size(); p++) {
+        counts_[p] = objCounts_[p] * stride_;
+        displacements_[p] = objDisplacements_[p] * stride_;
+      }
+    }
+
+    RealType* bufferStart(vector<RealType>& v) {
+      return v.empty() ? NULL : &v[0];
+    }
+
+    MPI_Comm myComm;
+    int myRank_;
+    int nObjects_;                 ///< objects on all procs in the plan
+    int stride_;                   ///< RealTypes per object in one message
+    vector<Field> fields_;
+    vector<int> objCounts_;        ///< objects on each proc
+    vector<int> objDisplacements_;
+    vector<int> counts_;           ///< RealTypes from each proc
+    vector<int> displacements_;
+    vector<RealType> sendBuffer_;
+    vector<RealType> recvBuffer_;
+    MPI_Request request_;
+  };
+
 #endif
 }
 #endif
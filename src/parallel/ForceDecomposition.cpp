@@ -47,10 +47,12 @@
 #include "parallel/ForceDecomposition.hpp"
 #include "math/Vector3.hpp"
 
+#include <algorithm>
+
 using namespace std;
 namespace OpenMD {
 
-  ForceDecomposition::ForceDecomposition(SimInfo* info, InteractionManager* iMan) : info_(info), interactionMan_(iMan), needVelocities_(false) {
+  ForceDecomposition::ForceDecomposition(SimInfo* info, InteractionManager* iMan) : info_(info), interactionMan_(iMan), needVelocities_(false), nThreads_(1), prePairLoop_(false) {
 
     sman_ = info_->getSnapshotManager();
     storageLayout_ = sman_->getStorageLayout();
@@ -152,6 +154,46 @@ namespace OpenMD {
     }
   }
 
+  /**
+   * Packs (row, column, value) entries into compressed sparse row
+   * storage with a counting sort on the rows.  Each row's partners
+   * are sorted, and when a partner appears more than once, only the
+   * smallest value (i.e. the shortest topological path) is kept.
+   */
+  void ForceDecomposition::buildPairCSR(int nRows,
+                                        vector<pair<int, int> >& entries,
+                                        vector<int>& entryRows,
+                                        PairCSR& csr) {
+    vector<int> count(nRows + 1, 0);
+    for (unsigned int e = 0; e < entryRows.size(); e++)
+      count[entryRows[e] + 1]++;
+    for (int i = 0; i < nRows; i++)
+      count[i + 1] += count[i];
+
+    vector<pair<int, int> > sorted(entries.size());
+    vector<int> next(count.begin(), count.end() - 1);
+    for (unsigned int e = 0; e < entryRows.size(); e++)
+      sorted[next[entryRows[e]]++] = entries[e];
+
+    csr.start.assign(nRows + 1, 0);
+    csr.partner.clear();
+    csr.value.clear();
+    csr.partner.reserve(sorted.size());
+    csr.value.reserve(sorted.size());
+
+    for (int i = 0; i < nRows; i++) {
+      vector<pair<int, int> >::iterator first = sorted.begin() + count[i];
+      vector<pair<int, int> >::iterator last = sorted.begin() + count[i + 1];
+      std::sort(first, last);
+      for (vector<pair<int, int> >::iterator e = first; e != last; ++e) {
+        if (e != first && e->first == (e - 1)->first) continue;
+        csr.partner.push_back(e->first);
+        csr.value.push_back(e->second);
+      }
+      csr.start[i + 1] = csr.partner.size();
+    }
+  }
+
   bool ForceDecomposition::checkNeighborList() {
     RealType st2 = pow( skinThickness_ / 2.0, 2);
     std::size_t nGroups = snap_->cgData.position.size();
@@ -89,6 +89,12 @@ namespace OpenMD {
    * ForceDecomposition provides the interface for ForceLoop to do the
    * communication steps and to iterate using the correct set of atoms
    * and cutoff groups.
+   *
+   * distributeData and collectData may also be split into begin and
+   * finish halves so that the exchange is in flight while the caller
+   * does work that needs neither the row and column data nor the
+   * collected results (zeroing work arrays, the neighbor list check,
+   * reciprocal space sums).
    */
   class ForceDecomposition {
   public:
@@ -102,6 +108,10 @@ namespace OpenMD {
     virtual void collectIntermediateData() = 0;
     virtual void distributeIntermediateData() = 0;
     virtual void collectData() = 0;
+    virtual void beginDistributeData() { distributeData(); }
+    virtual void finishDistributeData() {}
+    virtual void beginCollectData() {}
+    virtual void finishCollectData() { collectData(); }
     virtual void collectSelfData() = 0;
     virtual potVec* getSelfPotential() { return &selfPot; }
     virtual potVec* getPairwisePotential() { return &pairwisePot; }
@@ -134,26 +144,33 @@ namespace OpenMD {
        
     // atom bookkeeping
     virtual int& getNAtomsInRow() = 0;
-    virtual vector<int>& getExcludesForAtom(int atom1) = 0;
     virtual bool skipAtomPair(int atom1, int atom2, int cg1, int cg2) = 0;
     virtual bool excludeAtomPair(int atom1, int atom2) = 0;
     virtual int getGlobalIDRow(int atom1) = 0;
     virtual int getGlobalIDCol(int atom2) = 0;
     virtual int getGlobalID(int atom1) = 0;
+    virtual int getAtypeIdentRow(int atom1) = 0;
+    virtual int getAtypeIdentCol(int atom2) = 0;
     
     virtual int getTopologicalDistance(int atom1, int atom2) = 0;
-    virtual void addForceToAtomRow(int atom1, Vector3d fg) = 0;
-    virtual void addForceToAtomColumn(int atom2, Vector3d fg) = 0;
+    virtual void addForceToAtomRow(int atom1, Vector3d fg, int tid = 0) = 0;
+    virtual void addForceToAtomColumn(int atom2, Vector3d fg, int tid = 0) = 0;
     virtual Vector3d& getAtomVelocityColumn(int atom2) = 0;
 
     // filling interaction blocks with pointers
-    virtual void fillInteractionData(InteractionData &idat, int atom1, int atom2, bool newAtom1 = true) = 0;
-    virtual void unpackInteractionData(InteractionData &idat, int atom1, int atom2) = 0;
+    virtual void fillInteractionData(InteractionData &idat, int atom1, int atom2, bool newAtom1 = true, int tid = 0) = 0;
+    virtual void unpackInteractionData(InteractionData &idat, int atom1, int atom2, int tid = 0) = 0;
 
     virtual void fillSelfData(SelfData &sdat, int atom1);
 
     virtual void addToHeatFlux(Vector3d hf);
     virtual void setHeatFlux(Vector3d hf);
+
+    // threaded pair loop support
+    virtual void setNumThreads(int nThreads) { nThreads_ = nThreads; }
+    int getNumThreads() { return nThreads_; }
+    virtual void setPrePairLoop(bool prePair) { prePairLoop_ = prePair; }
+    virtual void reduceThreadData() = 0;
     
   protected:
     SimInfo* info_;   
@@ -170,6 +187,15 @@ namespace OpenMD {
     RealType rList_;
     RealType rListSq_;
 
+    /** 
+     * Number of threads sharing the pair loop.  When this is larger
+     * than one, each thread (identified by tid) accumulates forces,
+     * torques, densities, and potentials into its own work arrays,
+     * and reduceThreadData() sums them onto the shared arrays.
+     */
+    int nThreads_;
+    bool prePairLoop_;  /**< densities are accumulated, not read */
+
     vector<int> idents;
     vector<int> regions;
     potVec pairwisePot;
@@ -181,16 +207,25 @@ namespace OpenMD {
 
 
     /** 
-     * The topological distance between two atomic sites is handled
-     * via two vector structures for speed.  These structures agnostic
-     * regarding the parallel decomposition.  The index for
-     * toposForAtom could be local or row, while the values could be
-     * local or column.  It will be up to the specific decomposition
-     * method to fill these.
+     * The excluded partners and topological distances of each atomic
+     * site are kept in compressed sparse row form.  The partners of
+     * atom i are partner[start[i]] ... partner[start[i+1]-1], sorted
+     * in increasing order, and topoDist.value holds the topological
+     * distance (1, 2, or 3) for each partner.  These structures are
+     * agnostic regarding the parallel decomposition.  The row index
+     * could be local or row, while the partners could be local or
+     * column.  It will be up to the specific decomposition method to
+     * fill these.
      */
-    vector<vector<int> > toposForAtom; 
-    vector<vector<int> > topoDist;                                       
-    vector<vector<int> > excludesForAtom;
+    struct PairCSR {
+      vector<int> start;
+      vector<int> partner;
+      vector<int> value;
+    };
+    PairCSR excludes_;
+    PairCSR topoDist_;
+    void buildPairCSR(int nRows, vector<pair<int, int> >& entries,
+                      vector<int>& entryRows, PairCSR& csr);
     vector<vector<int> > groupList_;
     vector<RealType> massFactors;
     vector<AtomType*> atypesLocal;
@@ -45,6 +45,8 @@
 #include "brains/SnapshotManager.hpp"
 #include "brains/PairList.hpp"
 
+#include <algorithm>
+
 using namespace std;
 namespace OpenMD {
 
@@ -99,6 +101,7 @@ namespace OpenMD {
     AtomLocalToGlobal = info_->getGlobalAtomIndices();
     cgLocalToGlobal = info_->getGlobalGroupIndices();
     vector<int> globalGroupMembership = info_->getGlobalGroupMembership();
+    int nGlobalAtoms = info_->getNGlobalAtoms();
 
     massFactors = info_->getMassFactors();
 
@@ -135,6 +138,11 @@ namespace OpenMD {
     cgPlanIntColumn = new Plan<int>(col, nGroups_);
     cgPlanVectorColumn = new Plan<Vector3d>(col, nGroups_);
 
+    AtomPackRow = new PackedPlan(row, nLocal_);
+    AtomPackColumn = new PackedPlan(col, nLocal_);
+    cgPackRow = new PackedPlan(row, nGroups_);
+    cgPackColumn = new PackedPlan(col, nGroups_);
+
     nAtomsInRow_ = AtomPlanIntRow->getSize();
     nAtomsInCol_ = AtomPlanIntColumn->getSize();
     nGroupsInRow_ = cgPlanIntRow->getSize();
@@ -200,94 +208,64 @@ namespace OpenMD {
     AtomPlanRealRow->gather(massFactors, massFactorsRow);
     AtomPlanRealColumn->gather(massFactors, massFactorsCol);
 
+    // Map each global cutoff group onto its row and column index, so
+    // that the group membership lists can be built in one pass over
+    // the atoms:
+    int nGlobalGroups = info_->getNGlobalCutoffGroups();
+    vector<int> globalToGroupRow(nGlobalGroups, -1);
+    vector<int> globalToGroupCol(nGlobalGroups, -1);
+    for (int i = 0; i < nGroupsInRow_; i++)
+      globalToGroupRow[cgRowToGlobal[i]] = i;
+    for (int i = 0; i < nGroupsInCol_; i++)
+      globalToGroupCol[cgColToGlobal[i]] = i;
+
     groupListRow_.clear();
     groupListRow_.resize(nGroupsInRow_);
-    for (int i = 0; i < nGroupsInRow_; i++) {
-      int gid = cgRowToGlobal[i];
-      for (int j = 0; j < nAtomsInRow_; j++) {
-        int aid = AtomRowToGlobal[j];
-        if (globalGroupMembership[aid] == gid)
-          groupListRow_[i].push_back(j);
-      }      
+    for (int j = 0; j < nAtomsInRow_; j++) {
+      int cg = globalToGroupRow[globalGroupMembership[AtomRowToGlobal[j]]];
+      if (cg != -1) groupListRow_[cg].push_back(j);
     }
 
     groupListCol_.clear();
     groupListCol_.resize(nGroupsInCol_);
-    for (int i = 0; i < nGroupsInCol_; i++) {
-      int gid = cgColToGlobal[i];
-      for (int j = 0; j < nAtomsInCol_; j++) {
-        int aid = AtomColToGlobal[j];
-        if (globalGroupMembership[aid] == gid)
-          groupListCol_[i].push_back(j);
-      }      
-    }
-
-    excludesForAtom.clear();
-    excludesForAtom.resize(nAtomsInRow_);
-    toposForAtom.clear();
-    toposForAtom.resize(nAtomsInRow_);
-    topoDist.clear();
-    topoDist.resize(nAtomsInRow_);
-    for (int i = 0; i < nAtomsInRow_; i++) {
-      int iglob = AtomRowToGlobal[i];
-
-      for (int j = 0; j < nAtomsInCol_; j++) {
-        int jglob = AtomColToGlobal[j];
-
-        if (excludes->hasPair(iglob, jglob)) 
-          excludesForAtom[i].push_back(j);       
-        
-        if (oneTwo->hasPair(iglob, jglob)) {
-          toposForAtom[i].push_back(j);
-          topoDist[i].push_back(1);
-        } else {
-          if (oneThree->hasPair(iglob, jglob)) {
-            toposForAtom[i].push_back(j);
-            topoDist[i].push_back(2);
-          } else {
-            if (oneFour->hasPair(iglob, jglob)) {
-              toposForAtom[i].push_back(j);
-              topoDist[i].push_back(3);
-            }
-          }
-        }
-      }      
-    }
-
+    for (int j = 0; j < nAtomsInCol_; j++) {
+      int cg = globalToGroupCol[globalGroupMembership[AtomColToGlobal[j]]];
+      if (cg != -1) groupListCol_[cg].push_back(j);
+    }
+
+    int nRows = nAtomsInRow_;
+    vector<int> globalToRow(nGlobalAtoms, -1);
+    vector<int> globalToCol(nGlobalAtoms, -1);
+    for (int i = 0; i < nAtomsInRow_; i++)
+      globalToRow[AtomRowToGlobal[i]] = i;
+    for (int j = 0; j < nAtomsInCol_; j++)
+      globalToCol[AtomColToGlobal[j]] = j;
 #else
-    excludesForAtom.clear();
-    excludesForAtom.resize(nLocal_);
-    toposForAtom.clear();
-    toposForAtom.resize(nLocal_);
-    topoDist.clear();
-    topoDist.resize(nLocal_);
+    int nGlobalGroups = info_->getNGlobalCutoffGroups();
+    int nRows = nLocal_;
+    vector<int> globalToRow(nGlobalAtoms, -1);
+    for (int i = 0; i < nLocal_; i++)
+      globalToRow[AtomLocalToGlobal[i]] = i;
+    vector<int>& globalToCol = globalToRow;
+#endif
 
-    for (int i = 0; i < nLocal_; i++) {
-      int iglob = AtomLocalToGlobal[i];
+    // The exclusion and 1-2, 1-3, and 1-4 lists were built by walking
+    // the bonds, bends, torsions, inversions and rigid bodies of each
+    // molecule, so a single pass over each list finds every pair that
+    // has one atom in our rows and the other in our columns.
 
-      for (int j = 0; j < nLocal_; j++) {
-        int jglob = AtomLocalToGlobal[j];
+    vector<pair<int, int> > entries;
+    vector<int> entryRows;
 
-        if (excludes->hasPair(iglob, jglob)) 
-          excludesForAtom[i].push_back(j);              
-        
-        if (oneTwo->hasPair(iglob, jglob)) {
-          toposForAtom[i].push_back(j);
-          topoDist[i].push_back(1);
-        } else {
-          if (oneThree->hasPair(iglob, jglob)) {
-            toposForAtom[i].push_back(j);
-            topoDist[i].push_back(2);
-          } else {
-            if (oneFour->hasPair(iglob, jglob)) {
-              toposForAtom[i].push_back(j);
-              topoDist[i].push_back(3);
-            }
-          }
-        }
-      }      
-    }
-#endif
+    collectPairs(excludes, 0, globalToRow, globalToCol, entries, entryRows);
+    buildPairCSR(nRows, entries, entryRows, excludes_);
+
+    entries.clear();
+    entryRows.clear();
+    collectPairs(oneTwo, 1, globalToRow, globalToCol, entries, entryRows);
+    collectPairs(oneThree, 2, globalToRow, globalToCol, entries, entryRows);
+    collectPairs(oneFour, 3, globalToRow, globalToCol, entries, entryRows);
+    buildPairCSR(nRows, entries, entryRows, topoDist_);
 
     // allocate memory for the parallel objects
     atypesLocal.resize(nLocal_);
@@ -295,24 +273,55 @@ namespace OpenMD {
     for (int i = 0; i < nLocal_; i++) 
       atypesLocal[i] = ff_->getAtomType(idents[i]);
 
+    vector<int> globalToGroup(nGlobalGroups, -1);
+    for (int i = 0; i < nGroups_; i++)
+      globalToGroup[cgLocalToGlobal[i]] = i;
+
     groupList_.clear();
     groupList_.resize(nGroups_);
-    for (int i = 0; i < nGroups_; i++) {
-      int gid = cgLocalToGlobal[i];
-      for (int j = 0; j < nLocal_; j++) {
-        int aid = AtomLocalToGlobal[j];
-        if (globalGroupMembership[aid] == gid) {
-          groupList_[i].push_back(j);
-        }
-      }      
-    }    
+    for (int j = 0; j < nLocal_; j++) {
+      int cg = globalToGroup[globalGroupMembership[AtomLocalToGlobal[j]]];
+      if (cg != -1) groupList_[cg].push_back(j);
+    }
   }
-    
+
+  /**
+   * Appends the pairs in a PairList that have one atom in our rows
+   * and the other in our columns.  Each entry is stored as (column,
+   * value), and entryRows holds the matching row index.
+   */
+  void ForceMatrixDecomposition::collectPairs(PairList* pairs, int value,
+                                              const vector<int>& globalToRow,
+                                              const vector<int>& globalToCol,
+                                              vector<pair<int, int> >& entries,
+                                              vector<int>& entryRows) {
+    // A molecule lives on a single processor, and the only processor
+    // that holds its atoms in both its rows and its columns is that
+    // owner, so the local PairLists are sufficient here.
+    for (PairList::const_iterator p = pairs->begin(); p != pairs->end(); ++p) {
+      int i = globalToRow[p->first];
+      int j = globalToCol[p->second];
+      if (i != -1 && j != -1) {
+        entryRows.push_back(i);
+        entries.push_back(make_pair(j, value));
+      }
+      i = globalToRow[p->second];
+      j = globalToCol[p->first];
+      if (i != -1 && j != -1) {
+        entryRows.push_back(i);
+        entries.push_back(make_pair(j, value));
+      }
+    }
+  }
+
   int ForceMatrixDecomposition::getTopologicalDistance(int atom1, int atom2) {
-    for (unsigned int j = 0; j < toposForAtom[atom1].size(); j++) {
-      if (toposForAtom[atom1][j] == atom2) 
-        return topoDist[atom1][j];
-    }                                           
+    vector<int>::iterator first = topoDist_.partner.begin() +
+      topoDist_.start[atom1];
+    vector<int>::iterator last = topoDist_.partner.begin() +
+      topoDist_.start[atom1 + 1];
+    vector<int>::iterator j = std::lower_bound(first, last, atom2);
+    if (j != last && *j == atom2)
+      return topoDist_.value[j - topoDist_.partner.begin()];
     return 0;
   }
 
@@ -447,6 +456,17 @@ namespace OpenMD {
 
 
   void ForceMatrixDecomposition::distributeData()  {
+    beginDistributeData();
+    finishDistributeData();
+  }
+
+  /**
+   * Packs everything the pair loop needs from the other processors
+   * into one message per row and column plan and posts the gathers.
+   * finishDistributeData() must be called before any row or column
+   * data is used.
+   */
+  void ForceMatrixDecomposition::beginDistributeData()  {
    
 #ifdef IS_MPI
 
@@ -457,66 +477,68 @@ namespace OpenMD {
     if(info_->getNCutoffGroups() != info_->getNAtoms())
       needsCG = false;
 
-    // gather up the atomic positions
-    AtomPlanVectorRow->gather(snap_->atomData.position, 
-                              atomRowData.position);
-    AtomPlanVectorColumn->gather(snap_->atomData.position, 
-                                 atomColData.position);
-    
-    // gather up the cutoff group positions
+    AtomPackRow->clear();
+    AtomPackColumn->clear();
+    cgPackRow->clear();
+    cgPackColumn->clear();
 
+    // the atomic positions
+    AtomPackRow->add(snap_->atomData.position, atomRowData.position);
+    AtomPackColumn->add(snap_->atomData.position, atomColData.position);
+    
+    // the cutoff group positions
     if (needsCG) {
-      cgPlanVectorRow->gather(snap_->cgData.position, 
-                              cgRowData.position);
-      
-      cgPlanVectorColumn->gather(snap_->cgData.position, 
-                                 cgColData.position);
+      cgPackRow->add(snap_->cgData.position, cgRowData.position);
+      cgPackColumn->add(snap_->cgData.position, cgColData.position);
     }
 
-
     if (needVelocities_) {
-      // gather up the atomic velocities
-      AtomPlanVectorColumn->gather(snap_->atomData.velocity, 
-                                   atomColData.velocity);
+      // the atomic velocities
+      AtomPackColumn->add(snap_->atomData.velocity, atomColData.velocity);
 
       if (needsCG) {        
-        cgPlanVectorColumn->gather(snap_->cgData.velocity, 
-                                   cgColData.velocity);
+        cgPackColumn->add(snap_->cgData.velocity, cgColData.velocity);
       }
     }
-
     
-    // if needed, gather the atomic rotation matrices
+    // if needed, the atomic rotation matrices
     if (storageLayout_ & DataStorage::dslAmat) {
-      AtomPlanMatrixRow->gather(snap_->atomData.aMat, 
-                                atomRowData.aMat);
-      AtomPlanMatrixColumn->gather(snap_->atomData.aMat, 
-                                   atomColData.aMat);
+      AtomPackRow->add(snap_->atomData.aMat, atomRowData.aMat);
+      AtomPackColumn->add(snap_->atomData.aMat, atomColData.aMat);
     }
 
-    // if needed, gather the atomic eletrostatic information
+    // if needed, the atomic eletrostatic information
     if (storageLayout_ & DataStorage::dslDipole) {
-      AtomPlanVectorRow->gather(snap_->atomData.dipole, 
-                                atomRowData.dipole);
-      AtomPlanVectorColumn->gather(snap_->atomData.dipole, 
-                                   atomColData.dipole);
+      AtomPackRow->add(snap_->atomData.dipole, atomRowData.dipole);
+      AtomPackColumn->add(snap_->atomData.dipole, atomColData.dipole);
     }
 
     if (storageLayout_ & DataStorage::dslQuadrupole) {
-      AtomPlanMatrixRow->gather(snap_->atomData.quadrupole, 
-                                atomRowData.quadrupole);
-      AtomPlanMatrixColumn->gather(snap_->atomData.quadrupole, 
-                                   atomColData.quadrupole);
+      AtomPackRow->add(snap_->atomData.quadrupole, atomRowData.quadrupole);
+      AtomPackColumn->add(snap_->atomData.quadrupole, 
+                          atomColData.quadrupole);
     }
         
-    // if needed, gather the atomic fluctuating charge values
+    // if needed, the atomic fluctuating charge values
     if (storageLayout_ & DataStorage::dslFlucQPosition) {
-      AtomPlanRealRow->gather(snap_->atomData.flucQPos, 
-                              atomRowData.flucQPos);
-      AtomPlanRealColumn->gather(snap_->atomData.flucQPos, 
-                                 atomColData.flucQPos);
+      AtomPackRow->add(snap_->atomData.flucQPos, atomRowData.flucQPos);
+      AtomPackColumn->add(snap_->atomData.flucQPos, atomColData.flucQPos);
     }
 
+    AtomPackRow->beginGather();
+    AtomPackColumn->beginGather();
+    if (!cgPackRow->empty()) cgPackRow->beginGather();
+    if (!cgPackColumn->empty()) cgPackColumn->beginGather();
+
+#endif      
+  }
+
+  void ForceMatrixDecomposition::finishDistributeData()  {
+#ifdef IS_MPI
+    AtomPackRow->finishGather();
+    AtomPackColumn->finishGather();
+    if (!cgPackRow->empty()) cgPackRow->finishGather();
+    if (!cgPackColumn->empty()) cgPackColumn->finishGather();
 #endif      
   }
   
@@ -529,31 +551,37 @@ namespace OpenMD {
     snap_ = sman_->getCurrentSnapshot();
     storageLayout_ = sman_->getStorageLayout();
 
+    AtomPackRow->clear();
+    AtomPackColumn->clear();
+
     if (storageLayout_ & DataStorage::dslDensity) {
-      
-      AtomPlanRealRow->scatter(atomRowData.density, 
-                               snap_->atomData.density);
-      
-      int n = snap_->atomData.density.size();
-      vector<RealType> rho_tmp(n, 0.0);
-      AtomPlanRealColumn->scatter(atomColData.density, rho_tmp);
-      for (int i = 0; i < n; i++)
-        snap_->atomData.density[i] += rho_tmp[i];
+      AtomPackRow->add(snap_->atomData.density, atomRowData.density);
+      AtomPackColumn->add(snap_->atomData.density, atomColData.density);
     }
 
     // this isn't necessary if we don't have polarizable atoms, but
     // we'll leave it here for now.
     if (storageLayout_ & DataStorage::dslElectricField) {
-      
-      AtomPlanVectorRow->scatter(atomRowData.electricField, 
-                                 snap_->atomData.electricField);
-      
-      int n = snap_->atomData.electricField.size();
-      vector<Vector3d> field_tmp(n, V3Zero);
-      AtomPlanVectorColumn->scatter(atomColData.electricField, 
-                                    field_tmp);
-      for (int i = 0; i < n; i++)
-        snap_->atomData.electricField[i] += field_tmp[i];
+      AtomPackRow->add(snap_->atomData.electricField, 
+                       atomRowData.electricField);
+      AtomPackColumn->add(snap_->atomData.electricField, 
+                          atomColData.electricField);
+    }
+
+    if (!AtomPackRow->empty()) {
+      // the row scatter overwrites the local values, the column
+      // scatter adds to them:
+      if (storageLayout_ & DataStorage::dslDensity) 
+        fill(snap_->atomData.density.begin(), 
+             snap_->atomData.density.end(), 0.0);
+      if (storageLayout_ & DataStorage::dslElectricField) 
+        fill(snap_->atomData.electricField.begin(), 
+             snap_->atomData.electricField.end(), V3Zero);
+
+      AtomPackRow->beginScatter();
+      AtomPackColumn->beginScatter();
+      AtomPackRow->finishScatter();
+      AtomPackColumn->finishScatter();
     }
 #endif
   }
@@ -567,181 +595,129 @@ namespace OpenMD {
     snap_ = sman_->getCurrentSnapshot();
     storageLayout_ = sman_->getStorageLayout();
 
+    AtomPackRow->clear();
+    AtomPackColumn->clear();
+
     if (storageLayout_ & DataStorage::dslFunctional) {
-      AtomPlanRealRow->gather(snap_->atomData.functional, 
-                              atomRowData.functional);
-      AtomPlanRealColumn->gather(snap_->atomData.functional, 
-                                 atomColData.functional);
+      AtomPackRow->add(snap_->atomData.functional, atomRowData.functional);
+      AtomPackColumn->add(snap_->atomData.functional, 
+                          atomColData.functional);
     }
     
     if (storageLayout_ & DataStorage::dslFunctionalDerivative) {
-      AtomPlanRealRow->gather(snap_->atomData.functionalDerivative, 
-                              atomRowData.functionalDerivative);
-      AtomPlanRealColumn->gather(snap_->atomData.functionalDerivative, 
-                                 atomColData.functionalDerivative);
+      AtomPackRow->add(snap_->atomData.functionalDerivative, 
+                       atomRowData.functionalDerivative);
+      AtomPackColumn->add(snap_->atomData.functionalDerivative, 
+                          atomColData.functionalDerivative);
+    }
+
+    if (!AtomPackRow->empty()) {
+      AtomPackRow->beginGather();
+      AtomPackColumn->beginGather();
+      AtomPackRow->finishGather();
+      AtomPackColumn->finishGather();
     }
 #endif
   }
   
   
   void ForceMatrixDecomposition::collectData() {
+    beginCollectData();
+    finishCollectData();
+  }
+
+  /**
+   * Packs the row and column results of the pair loop into one
+   * message per plan and posts the scatters.  Nothing in the local
+   * atomic data that the pair loop accumulates may be read until
+   * finishCollectData() has been called, but it may still be added
+   * to.
+   */
+  void ForceMatrixDecomposition::beginCollectData() {
 #ifdef IS_MPI
     snap_ = sman_->getCurrentSnapshot();
     storageLayout_ = sman_->getStorageLayout();
+    nLocal_ = snap_->getNumberOfAtoms();
 
-    int n = snap_->atomData.force.size();
-    vector<Vector3d> frc_tmp(n, V3Zero);
-    
-    AtomPlanVectorRow->scatter(atomRowData.force, frc_tmp);
-    for (int i = 0; i < n; i++) {
-      snap_->atomData.force[i] += frc_tmp[i];
-      frc_tmp[i] = 0.0;
-    }
-    
-    AtomPlanVectorColumn->scatter(atomColData.force, frc_tmp);
-    for (int i = 0; i < n; i++) {
-      snap_->atomData.force[i] += frc_tmp[i];
-    }
-        
-    if (storageLayout_ & DataStorage::dslTorque) {
+    pot_local.assign(nLocal_, Vector<RealType, N_INTERACTION_FAMILIES> (0.0));
+    expot_local.assign(nLocal_, 
+                       Vector<RealType, N_INTERACTION_FAMILIES> (0.0));
+    selepot_local.assign(nLocal_, 
+                         Vector<RealType, N_INTERACTION_FAMILIES> (0.0));
 
-      int nt = snap_->atomData.torque.size();
-      vector<Vector3d> trq_tmp(nt, V3Zero);
+    AtomPackRow->clear();
+    AtomPackColumn->clear();
 
-      AtomPlanVectorRow->scatter(atomRowData.torque, trq_tmp);
-      for (int i = 0; i < nt; i++) {
-        snap_->atomData.torque[i] += trq_tmp[i];
-        trq_tmp[i] = 0.0;
-      }
-      
-      AtomPlanVectorColumn->scatter(atomColData.torque, trq_tmp);
-      for (int i = 0; i < nt; i++)
-        snap_->atomData.torque[i] += trq_tmp[i];
+    AtomPackRow->add(snap_->atomData.force, atomRowData.force);
+    AtomPackColumn->add(snap_->atomData.force, atomColData.force);
+        
+    if (storageLayout_ & DataStorage::dslTorque) {
+      AtomPackRow->add(snap_->atomData.torque, atomRowData.torque);
+      AtomPackColumn->add(snap_->atomData.torque, atomColData.torque);
     }
 
     if (storageLayout_ & DataStorage::dslSkippedCharge) {
-
-      int ns = snap_->atomData.skippedCharge.size();
-      vector<RealType> skch_tmp(ns, 0.0);
-
-      AtomPlanRealRow->scatter(atomRowData.skippedCharge, skch_tmp);
-      for (int i = 0; i < ns; i++) {
-        snap_->atomData.skippedCharge[i] += skch_tmp[i];
-        skch_tmp[i] = 0.0;
-      }
-      
-      AtomPlanRealColumn->scatter(atomColData.skippedCharge, skch_tmp);
-      for (int i = 0; i < ns; i++) 
-        snap_->atomData.skippedCharge[i] += skch_tmp[i];
-            
+      AtomPackRow->add(snap_->atomData.skippedCharge, 
+                       atomRowData.skippedCharge);
+      AtomPackColumn->add(snap_->atomData.skippedCharge, 
+                          atomColData.skippedCharge);
     }
     
     if (storageLayout_ & DataStorage::dslFlucQForce) {
-
-      int nq = snap_->atomData.flucQFrc.size();
-      vector<RealType> fqfrc_tmp(nq, 0.0);
-
-      AtomPlanRealRow->scatter(atomRowData.flucQFrc, fqfrc_tmp);
-      for (int i = 0; i < nq; i++) {
-        snap_->atomData.flucQFrc[i] += fqfrc_tmp[i];
-        fqfrc_tmp[i] = 0.0;
-      }
-      
-      AtomPlanRealColumn->scatter(atomColData.flucQFrc, fqfrc_tmp);
-      for (int i = 0; i < nq; i++) 
-        snap_->atomData.flucQFrc[i] += fqfrc_tmp[i];
-            
+      AtomPackRow->add(snap_->atomData.flucQFrc, atomRowData.flucQFrc);
+      AtomPackColumn->add(snap_->atomData.flucQFrc, atomColData.flucQFrc);
     }
 
     if (storageLayout_ & DataStorage::dslElectricField) {
-
-      int nef = snap_->atomData.electricField.size();
-      vector<Vector3d> efield_tmp(nef, V3Zero);
-
-      AtomPlanVectorRow->scatter(atomRowData.electricField, efield_tmp);
-      for (int i = 0; i < nef; i++) {
-        snap_->atomData.electricField[i] += efield_tmp[i];
-        efield_tmp[i] = 0.0;
-      }
-      
-      AtomPlanVectorColumn->scatter(atomColData.electricField, efield_tmp);
-      for (int i = 0; i < nef; i++)
-        snap_->atomData.electricField[i] += efield_tmp[i];
+      AtomPackRow->add(snap_->atomData.electricField, 
+                       atomRowData.electricField);
+      AtomPackColumn->add(snap_->atomData.electricField, 
+                          atomColData.electricField);
     }
 
     if (storageLayout_ & DataStorage::dslSitePotential) {
-
-      int nsp = snap_->atomData.sitePotential.size();
-      vector<RealType> sp_tmp(nsp, 0.0);
-
-      AtomPlanRealRow->scatter(atomRowData.sitePotential, sp_tmp);
-      for (int i = 0; i < nsp; i++) {
-        snap_->atomData.sitePotential[i] += sp_tmp[i];
-        sp_tmp[i] = 0.0;
-      }
-      
-      AtomPlanRealColumn->scatter(atomColData.sitePotential, sp_tmp);
-      for (int i = 0; i < nsp; i++)
-        snap_->atomData.sitePotential[i] += sp_tmp[i];
+      AtomPackRow->add(snap_->atomData.sitePotential, 
+                       atomRowData.sitePotential);
+      AtomPackColumn->add(snap_->atomData.sitePotential, 
+                          atomColData.sitePotential);
     }
 
-    nLocal_ = snap_->getNumberOfAtoms();
-
-    vector<potVec> pot_temp(nLocal_, 
-                            Vector<RealType, N_INTERACTION_FAMILIES> (0.0));
-    vector<potVec> expot_temp(nLocal_, 
-                              Vector<RealType, N_INTERACTION_FAMILIES> (0.0));
-    vector<potVec> selepot_temp(nLocal_, 
-                                Vector<RealType, N_INTERACTION_FAMILIES> (0.0));
+    if (storageLayout_ & DataStorage::dslParticlePot) {
+      // This is the direct or embedding contribution to the particle
+      // pot.
+      AtomPackRow->add(snap_->atomData.particlePot, 
+                       atomRowData.particlePot);
+      AtomPackColumn->add(snap_->atomData.particlePot, 
+                          atomColData.particlePot);
+    }
 
     // scatter/gather pot_row into the members of my column
-          
-    AtomPlanPotRow->scatter(pot_row, pot_temp);
-    AtomPlanPotRow->scatter(expot_row, expot_temp);
-    AtomPlanPotRow->scatter(selepot_row, selepot_temp);
+    AtomPackRow->add(pot_local, pot_row);
+    AtomPackRow->add(expot_local, expot_row);
+    AtomPackRow->add(selepot_local, selepot_row);
 
-    for (std::size_t ii = 0;  ii < pot_temp.size(); ii++ ) 
-      pairwisePot += pot_temp[ii];
+    AtomPackColumn->add(pot_local, pot_col);
+    AtomPackColumn->add(expot_local, expot_col);
+    AtomPackColumn->add(selepot_local, selepot_col);
 
-    for (std::size_t ii = 0;  ii < expot_temp.size(); ii++ ) 
-      excludedPot += expot_temp[ii];
-    
-    for (std::size_t ii = 0;  ii < selepot_temp.size(); ii++ ) 
-      selectedPot += selepot_temp[ii];
-    
-    if (storageLayout_ & DataStorage::dslParticlePot) {
-      // This is the pairwise contribution to the particle pot.  The
-      // embedding contribution is added in each of the low level
-      // non-bonded routines.  In single processor, this is done in
-      // unpackInteractionData, not in collectData.
-      for (int ii = 0; ii < N_INTERACTION_FAMILIES; ii++) {
-        for (int i = 0; i < nLocal_; i++) {
-          // factor of two is because the total potential terms are divided
-          // by 2 in parallel due to row/ column scatter       
-          snap_->atomData.particlePot[i] += 2.0 * pot_temp[i](ii);
-        }
-      }
-    }
+    AtomPackRow->beginScatter();
+    AtomPackColumn->beginScatter();
+#endif
+  }
 
-    fill(pot_temp.begin(), pot_temp.end(), 
-         Vector<RealType, N_INTERACTION_FAMILIES> (0.0));
-    fill(expot_temp.begin(), expot_temp.end(), 
-         Vector<RealType, N_INTERACTION_FAMILIES> (0.0));
-    fill(selepot_temp.begin(), selepot_temp.end(), 
-         Vector<RealType, N_INTERACTION_FAMILIES> (0.0));
-      
-    AtomPlanPotColumn->scatter(pot_col, pot_temp);    
-    AtomPlanPotColumn->scatter(expot_col, expot_temp);
-    AtomPlanPotColumn->scatter(selepot_col, selepot_temp);    
-    
-    for (std::size_t ii = 0;  ii < pot_temp.size(); ii++ )
-      pairwisePot += pot_temp[ii];    
+  void ForceMatrixDecomposition::finishCollectData() {
+#ifdef IS_MPI
+    AtomPackRow->finishScatter();
+    AtomPackColumn->finishScatter();
 
-    for (std::size_t ii = 0;  ii < expot_temp.size(); ii++ )
-      excludedPot += expot_temp[ii];    
+    for (std::size_t ii = 0;  ii < pot_local.size(); ii++ ) 
+      pairwisePot += pot_local[ii];
 
-    for (std::size_t ii = 0;  ii < selepot_temp.size(); ii++ )
-      selectedPot += selepot_temp[ii];    
+    for (std::size_t ii = 0;  ii < expot_local.size(); ii++ ) 
+      excludedPot += expot_local[ii];
+    
+    for (std::size_t ii = 0;  ii < selepot_local.size(); ii++ ) 
+      selectedPot += selepot_local[ii];
     
     if (storageLayout_ & DataStorage::dslParticlePot) {
       // This is the pairwise contribution to the particle pot.  The
@@ -752,50 +728,25 @@ namespace OpenMD {
         for (int i = 0; i < nLocal_; i++) {
           // factor of two is because the total potential terms are divided
           // by 2 in parallel due to row/ column scatter       
-          snap_->atomData.particlePot[i] += 2.0 * pot_temp[i](ii);
+          snap_->atomData.particlePot[i] += 2.0 * pot_local[i](ii);
         }
       }
     }
-    
-    if (storageLayout_ & DataStorage::dslParticlePot) {
-      int npp = snap_->atomData.particlePot.size();
-      vector<RealType> ppot_temp(npp, 0.0);
-
-      // This is the direct or embedding contribution to the particle
-      // pot.
-      
-      AtomPlanRealRow->scatter(atomRowData.particlePot, ppot_temp);
-      for (int i = 0; i < npp; i++) {
-        snap_->atomData.particlePot[i] += ppot_temp[i];
-      }
-
-      fill(ppot_temp.begin(), ppot_temp.end(), 0.0);
-      
-      AtomPlanRealColumn->scatter(atomColData.particlePot, ppot_temp);
-      for (int i = 0; i < npp; i++) {
-        snap_->atomData.particlePot[i] += ppot_temp[i];
-      }
-    }
 
+    RealType pots[3 * N_INTERACTION_FAMILIES];
     for (int ii = 0; ii < N_INTERACTION_FAMILIES; ii++) {
-      RealType ploc1 = pairwisePot[ii];
-      RealType ploc2 = 0.0;
-      MPI_Allreduce(&ploc1, &ploc2, 1, MPI_REALTYPE, MPI_SUM, MPI_COMM_WORLD);
-      pairwisePot[ii] = ploc2;
+      pots[ii] = pairwisePot[ii];
+      pots[ii + N_INTERACTION_FAMILIES] = excludedPot[ii];
+      pots[ii + 2 * N_INTERACTION_FAMILIES] = selectedPot[ii];
     }
 
-    for (int ii = 0; ii < N_INTERACTION_FAMILIES; ii++) {
-      RealType ploc1 = excludedPot[ii];
-      RealType ploc2 = 0.0;
-      MPI_Allreduce(&ploc1, &ploc2, 1, MPI_REALTYPE, MPI_SUM, MPI_COMM_WORLD);
-      excludedPot[ii] = ploc2;
-    }
+    MPI_Allreduce(MPI_IN_PLACE, pots, 3 * N_INTERACTION_FAMILIES, 
+                  MPI_REALTYPE, MPI_SUM, MPI_COMM_WORLD);
 
     for (int ii = 0; ii < N_INTERACTION_FAMILIES; ii++) {
-      RealType ploc1 = selectedPot[ii];
-      RealType ploc2 = 0.0;
-      MPI_Allreduce(&ploc1, &ploc2, 1, MPI_REALTYPE, MPI_SUM, MPI_COMM_WORLD);
-      selectedPot[ii] = ploc2;
+      pairwisePot[ii] = pots[ii];
+      excludedPot[ii] = pots[ii + N_INTERACTION_FAMILIES];
+      selectedPot[ii] = pots[ii + 2 * N_INTERACTION_FAMILIES];
     }
 
     // Here be dragons.
@@ -961,10 +912,6 @@ namespace OpenMD {
     return d;    
   }
 
-  vector<int>& ForceMatrixDecomposition::getExcludesForAtom(int atom1) {
-    return excludesForAtom[atom1];
-  }
-
   /**
    * We need to exclude some overcounted interactions that result from
    * the parallel decomposition.
@@ -1017,40 +964,43 @@ namespace OpenMD {
    */
   bool ForceMatrixDecomposition::excludeAtomPair(int atom1, int atom2) {
 
-    // excludesForAtom was constructed to use row/column indices in the MPI
+    // excludes_ was constructed to use row/column indices in the MPI
     // version, and to use local IDs in the non-MPI version:
-    
-    for (vector<int>::iterator i = excludesForAtom[atom1].begin();
-         i != excludesForAtom[atom1].end(); ++i) {
-      if ( (*i) == atom2 ) return true;
-    }
 
-    return false;
+    return std::binary_search(excludes_.partner.begin() +
+                              excludes_.start[atom1],
+                              excludes_.partner.begin() +
+                              excludes_.start[atom1 + 1], atom2);
   }
 
 
-  void ForceMatrixDecomposition::addForceToAtomRow(int atom1, Vector3d fg){
-#ifdef IS_MPI
-    atomRowData.force[atom1] += fg;
-#else
-    snap_->atomData.force[atom1] += fg;
-#endif
+  void ForceMatrixDecomposition::addForceToAtomRow(int atom1, Vector3d fg,
+                                                   int tid){
+    getRowAccumulator(tid)->force[atom1] += fg;
   }
 
-  void ForceMatrixDecomposition::addForceToAtomColumn(int atom2, Vector3d fg){
-#ifdef IS_MPI
-    atomColData.force[atom2] += fg;
-#else
-    snap_->atomData.force[atom2] += fg;
-#endif
+  void ForceMatrixDecomposition::addForceToAtomColumn(int atom2, Vector3d fg,
+                                                      int tid){
+    getColumnAccumulator(tid)->force[atom2] += fg;
   }
 
     // filling interaction blocks with pointers
   void ForceMatrixDecomposition::fillInteractionData(InteractionData &idat, 
                                                      int atom1, int atom2,
-                                                     bool newAtom1) {
+                                                     bool newAtom1, int tid) {
 
-    idat.excluded = excludeAtomPair(atom1, atom2);
+    // Anything the low-level interactions accumulate goes into the
+    // work arrays of this thread.  Densities are only accumulated
+    // during the pre-pair loop, and are read-only afterwards.
+    DataStorage* rowAcc = getRowAccumulator(tid);
+    DataStorage* colAcc = getColumnAccumulator(tid);
+#ifdef IS_MPI
+    DataStorage* rhoRow = prePairLoop_ ? rowAcc : &atomRowData;
+    DataStorage* rhoCol = prePairLoop_ ? colAcc : &atomColData;
+#else
+    DataStorage* rhoRow = prePairLoop_ ? rowAcc : &(snap_->atomData);
+    DataStorage* rhoCol = rhoRow;
+#endif
 
     if (newAtom1) {
       
@@ -1070,8 +1020,8 @@ namespace OpenMD {
       }
       
       if (storageLayout_ & DataStorage::dslTorque) {
-        idat.t1 = &(atomRowData.torque[atom1]);
-        idat.t2 = &(atomColData.torque[atom2]);
+        idat.t1 = &(rowAcc->torque[atom1]);
+        idat.t2 = &(colAcc->torque[atom2]);
       }
       
       if (storageLayout_ & DataStorage::dslDipole) {
@@ -1085,8 +1035,8 @@ namespace OpenMD {
       }
       
       if (storageLayout_ & DataStorage::dslDensity) {
-        idat.rho1 = &(atomRowData.density[atom1]);
-        idat.rho2 = &(atomColData.density[atom2]);
+        idat.rho1 = &(rhoRow->density[atom1]);
+        idat.rho2 = &(rhoCol->density[atom2]);
       }
       
       if (storageLayout_ & DataStorage::dslFunctional) {
@@ -1100,13 +1050,13 @@ namespace OpenMD {
       }
       
       if (storageLayout_ & DataStorage::dslParticlePot) {
-        idat.particlePot1 = &(atomRowData.particlePot[atom1]);
-        idat.particlePot2 = &(atomColData.particlePot[atom2]);
+        idat.particlePot1 = &(rowAcc->particlePot[atom1]);
+        idat.particlePot2 = &(colAcc->particlePot[atom2]);
       }
       
       if (storageLayout_ & DataStorage::dslSkippedCharge) {              
-        idat.skippedCharge1 = &(atomRowData.skippedCharge[atom1]);
-        idat.skippedCharge2 = &(atomColData.skippedCharge[atom2]);
+        idat.skippedCharge1 = &(rowAcc->skippedCharge[atom1]);
+        idat.skippedCharge2 = &(colAcc->skippedCharge[atom2]);
       }
       
       if (storageLayout_ & DataStorage::dslFlucQPosition) {              
@@ -1131,8 +1081,8 @@ namespace OpenMD {
       }
       
       if (storageLayout_ & DataStorage::dslTorque) {
-        idat.t1 = &(snap_->atomData.torque[atom1]);
-        idat.t2 = &(snap_->atomData.torque[atom2]);
+        idat.t1 = &(rowAcc->torque[atom1]);
+        idat.t2 = &(colAcc->torque[atom2]);
       }
       
       if (storageLayout_ & DataStorage::dslDipole) {
@@ -1146,8 +1096,8 @@ namespace OpenMD {
       }
       
       if (storageLayout_ & DataStorage::dslDensity) {     
-        idat.rho1 = &(snap_->atomData.density[atom1]);
-        idat.rho2 = &(snap_->atomData.density[atom2]);
+        idat.rho1 = &(rhoRow->density[atom1]);
+        idat.rho2 = &(rhoCol->density[atom2]);
       }
       
       if (storageLayout_ & DataStorage::dslFunctional) {
@@ -1161,13 +1111,13 @@ namespace OpenMD {
       }
       
       if (storageLayout_ & DataStorage::dslParticlePot) {
-        idat.particlePot1 = &(snap_->atomData.particlePot[atom1]);
-        idat.particlePot2 = &(snap_->atomData.particlePot[atom2]);
+        idat.particlePot1 = &(rowAcc->particlePot[atom1]);
+        idat.particlePot2 = &(colAcc->particlePot[atom2]);
       }
       
       if (storageLayout_ & DataStorage::dslSkippedCharge) {
-        idat.skippedCharge1 = &(snap_->atomData.skippedCharge[atom1]);
-        idat.skippedCharge2 = &(snap_->atomData.skippedCharge[atom2]);
+        idat.skippedCharge1 = &(rowAcc->skippedCharge[atom1]);
+        idat.skippedCharge2 = &(colAcc->skippedCharge[atom2]);
       }
       
       if (storageLayout_ & DataStorage::dslFlucQPosition) {              
@@ -1192,7 +1142,7 @@ namespace OpenMD {
     }
     
     if (storageLayout_ & DataStorage::dslTorque) {
-      idat.t2 = &(atomColData.torque[atom2]);
+      idat.t2 = &(colAcc->torque[atom2]);
     }
 
     if (storageLayout_ & DataStorage::dslDipole) {
@@ -1204,7 +1154,7 @@ namespace OpenMD {
     }
 
     if (storageLayout_ & DataStorage::dslDensity) {
-      idat.rho2 = &(atomColData.density[atom2]);
+      idat.rho2 = &(rhoCol->density[atom2]);
     }
 
     if (storageLayout_ & DataStorage::dslFunctional) {
@@ -1216,11 +1166,11 @@ namespace OpenMD {
     }
 
     if (storageLayout_ & DataStorage::dslParticlePot) {
-      idat.particlePot2 = &(atomColData.particlePot[atom2]);
+      idat.particlePot2 = &(colAcc->particlePot[atom2]);
     }
 
     if (storageLayout_ & DataStorage::dslSkippedCharge) {              
-      idat.skippedCharge2 = &(atomColData.skippedCharge[atom2]);
+      idat.skippedCharge2 = &(colAcc->skippedCharge[atom2]);
     }
 
     if (storageLayout_ & DataStorage::dslFlucQPosition) {
@@ -1241,7 +1191,7 @@ namespace OpenMD {
     }
 
     if (storageLayout_ & DataStorage::dslTorque) {
-      idat.t2 = &(snap_->atomData.torque[atom2]);
+      idat.t2 = &(colAcc->torque[atom2]);
     }
 
     if (storageLayout_ & DataStorage::dslDipole) {
@@ -1253,7 +1203,7 @@ namespace OpenMD {
     }
 
     if (storageLayout_ & DataStorage::dslDensity) {     
-      idat.rho2 = &(snap_->atomData.density[atom2]);
+      idat.rho2 = &(rhoCol->density[atom2]);
     }
 
     if (storageLayout_ & DataStorage::dslFunctional) {
@@ -1265,11 +1215,11 @@ namespace OpenMD {
     }
 
     if (storageLayout_ & DataStorage::dslParticlePot) {
-      idat.particlePot2 = &(snap_->atomData.particlePot[atom2]);
+      idat.particlePot2 = &(colAcc->particlePot[atom2]);
     }
 
     if (storageLayout_ & DataStorage::dslSkippedCharge) {
-      idat.skippedCharge2 = &(snap_->atomData.skippedCharge[atom2]);
+      idat.skippedCharge2 = &(colAcc->skippedCharge[atom2]);
     }
 
     if (storageLayout_ & DataStorage::dslFlucQPosition) {              
@@ -1281,67 +1231,218 @@ namespace OpenMD {
   }
   
   void ForceMatrixDecomposition::unpackInteractionData(InteractionData &idat,
-                                                       int atom1, int atom2) {  
+                                                       int atom1, int atom2,
+                                                       int tid) {  
+    DataStorage* rowAcc = getRowAccumulator(tid);
+    DataStorage* colAcc = getColumnAccumulator(tid);
+
 #ifdef IS_MPI
-    pot_row[atom1] += RealType(0.5) *  *(idat.pot);
-    pot_col[atom2] += RealType(0.5) *  *(idat.pot);
-    expot_row[atom1] += RealType(0.5) *  *(idat.excludedPot);
-    expot_col[atom2] += RealType(0.5) *  *(idat.excludedPot);
-    selepot_row[atom1] += RealType(0.5) *  *(idat.selePot);
-    selepot_col[atom2] += RealType(0.5) *  *(idat.selePot);
+    vector<potVec>& potRow = (nThreads_ > 1) ? threadData_[tid].pot_row : pot_row;
+    vector<potVec>& potCol = (nThreads_ > 1) ? threadData_[tid].pot_col : pot_col;
+    vector<potVec>& expotRow = (nThreads_ > 1) ? threadData_[tid].expot_row : expot_row;
+    vector<potVec>& expotCol = (nThreads_ > 1) ? threadData_[tid].expot_col : expot_col;
+    vector<potVec>& selepotRow = (nThreads_ > 1) ? threadData_[tid].selepot_row : selepot_row;
+    vector<potVec>& selepotCol = (nThreads_ > 1) ? threadData_[tid].selepot_col : selepot_col;
+
+    potRow[atom1] += RealType(0.5) *  *(idat.pot);
+    potCol[atom2] += RealType(0.5) *  *(idat.pot);
+    expotRow[atom1] += RealType(0.5) *  *(idat.excludedPot);
+    expotCol[atom2] += RealType(0.5) *  *(idat.excludedPot);
+    selepotRow[atom1] += RealType(0.5) *  *(idat.selePot);
+    selepotCol[atom2] += RealType(0.5) *  *(idat.selePot);
+#else
+    potVec& pPot = (nThreads_ > 1) ? threadData_[tid].pairwisePot : pairwisePot;
+    potVec& ePot = (nThreads_ > 1) ? threadData_[tid].excludedPot : excludedPot;
+    potVec& sPot = (nThreads_ > 1) ? threadData_[tid].selectedPot : selectedPot;
+
+    pPot += *(idat.pot);
+    ePot += *(idat.excludedPot);
+    sPot += *(idat.selePot);
+
+    if (idat.doParticlePot) {
+      // This is the pairwise contribution to the particle pot.  The
+      // self and embedding contribution is added in each of the low
+      // level non-bonded routines.  In parallel, this calculation is
+      // done in collectData, not in unpackInteractionData.
+      rowAcc->particlePot[atom1] += *(idat.vpair) * *(idat.sw);
+      colAcc->particlePot[atom2] += *(idat.vpair) * *(idat.sw);
+    }
+#endif
 
-    atomRowData.force[atom1] += *(idat.f1);
-    atomColData.force[atom2] -= *(idat.f1);
+    rowAcc->force[atom1] += *(idat.f1);
+    colAcc->force[atom2] -= *(idat.f1);
 
     if (storageLayout_ & DataStorage::dslFlucQForce) {              
-      atomRowData.flucQFrc[atom1] -= *(idat.dVdFQ1);
-      atomColData.flucQFrc[atom2] -= *(idat.dVdFQ2);
+      rowAcc->flucQFrc[atom1] -= *(idat.dVdFQ1);
+      colAcc->flucQFrc[atom2] -= *(idat.dVdFQ2);
     }
 
     if (storageLayout_ & DataStorage::dslElectricField) {              
-      atomRowData.electricField[atom1] += *(idat.eField1);
-      atomColData.electricField[atom2] += *(idat.eField2);
+      rowAcc->electricField[atom1] += *(idat.eField1);
+      colAcc->electricField[atom2] += *(idat.eField2);
     }
 
     if (storageLayout_ & DataStorage::dslSitePotential) {              
-      atomRowData.sitePotential[atom1] += *(idat.sPot1);
-      atomColData.sitePotential[atom2] += *(idat.sPot2);
+      rowAcc->sitePotential[atom1] += *(idat.sPot1);
+      colAcc->sitePotential[atom2] += *(idat.sPot2);
     }
+  }
 
+  DataStorage* ForceMatrixDecomposition::getRowAccumulator(int tid) {
+    if (nThreads_ > 1) return &(threadData_[tid].rowData);
+#ifdef IS_MPI
+    return &atomRowData;
 #else
-    pairwisePot += *(idat.pot);
-    excludedPot += *(idat.excludedPot);
-    selectedPot += *(idat.selePot);
+    return &(snap_->atomData);
+#endif
+  }
 
-    snap_->atomData.force[atom1] += *(idat.f1);
-    snap_->atomData.force[atom2] -= *(idat.f1);
+  DataStorage* ForceMatrixDecomposition::getColumnAccumulator(int tid) {
+#ifdef IS_MPI
+    if (nThreads_ > 1) return &(threadData_[tid].colData);
+    return &atomColData;
+#else
+    return getRowAccumulator(tid);
+#endif
+  }
 
-    if (idat.doParticlePot) {
-      // This is the pairwise contribution to the particle pot.  The
-      // self and embedding contribution is added in each of the low
-      // level non-bonded routines.  In parallel, this calculation is
-      // done in collectData, not in unpackInteractionData.
-      snap_->atomData.particlePot[atom1] += *(idat.vpair) * *(idat.sw);
-      snap_->atomData.particlePot[atom2] += *(idat.vpair) * *(idat.sw);
-    }
-    
-    if (storageLayout_ & DataStorage::dslFlucQForce) {              
-      snap_->atomData.flucQFrc[atom1] -= *(idat.dVdFQ1);
-      snap_->atomData.flucQFrc[atom2] -= *(idat.dVdFQ2);
+  /**
+   * Allocates private work arrays for each thread of the pair loop.
+   * This must be called after distributeInitialData so that the row
+   * and column sizes are known.
+   */
+  void ForceMatrixDecomposition::setNumThreads(int nThreads) {
+    nThreads_ = max(1, nThreads);
+    threadData_.clear();
+    if (nThreads_ == 1) return;
+
+    threadLayout_ = storageLayout_ & (DataStorage::dslForce |
+                                      DataStorage::dslTorque |
+                                      DataStorage::dslParticlePot |
+                                      DataStorage::dslDensity |
+                                      DataStorage::dslSkippedCharge |
+                                      DataStorage::dslFlucQForce |
+                                      DataStorage::dslElectricField |
+                                      DataStorage::dslSitePotential);
+    threadLayout_ |= DataStorage::dslForce;
+
+    threadData_.resize(nThreads_);
+    for (int t = 0; t < nThreads_; t++) {
+      ThreadWorkArrays& w = threadData_[t];
+      w.pairwisePot = 0.0;
+      w.excludedPot = 0.0;
+      w.selectedPot = 0.0;
+#ifdef IS_MPI
+      w.rowData.resize(nAtomsInRow_);
+      w.rowData.setStorageLayout(threadLayout_);
+      w.colData.resize(nAtomsInCol_);
+      w.colData.setStorageLayout(threadLayout_);
+      w.pot_row.assign(nAtomsInRow_, potVec(0.0));
+      w.pot_col.assign(nAtomsInCol_, potVec(0.0));
+      w.expot_row.assign(nAtomsInRow_, potVec(0.0));
+      w.expot_col.assign(nAtomsInCol_, potVec(0.0));
+      w.selepot_row.assign(nAtomsInRow_, potVec(0.0));
+      w.selepot_col.assign(nAtomsInCol_, potVec(0.0));
+#else
+      w.rowData.resize(nLocal_);
+      w.rowData.setStorageLayout(threadLayout_);
+#endif
     }
+  }
 
-    if (storageLayout_ & DataStorage::dslElectricField) {              
-      snap_->atomData.electricField[atom1] += *(idat.eField1);
-      snap_->atomData.electricField[atom2] += *(idat.eField2);
+  /**
+   * Sums the private thread work arrays onto the shared row / column
+   * (or local) arrays, and zeroes the private copies so that they are
+   * ready for the next pass through the pair loop.  The atoms are
+   * divided among the threads, so each shared element is written by
+   * exactly one thread.
+   */
+  void ForceMatrixDecomposition::reduceThreadData() {
+    if (nThreads_ < 2) return;
+
+#ifdef IS_MPI
+    reduceStorage(atomRowData, nAtomsInRow_, true);
+    reduceStorage(atomColData, nAtomsInCol_, false);
+
+    for (int t = 0; t < nThreads_; t++) {
+      ThreadWorkArrays& w = threadData_[t];
+      for (int i = 0; i < nAtomsInRow_; i++) {
+        pot_row[i] += w.pot_row[i];
+        expot_row[i] += w.expot_row[i];
+        selepot_row[i] += w.selepot_row[i];
+      }
+      for (int i = 0; i < nAtomsInCol_; i++) {
+        pot_col[i] += w.pot_col[i];
+        expot_col[i] += w.expot_col[i];
+        selepot_col[i] += w.selepot_col[i];
+      }
+      fill(w.pot_row.begin(), w.pot_row.end(), potVec(0.0));
+      fill(w.pot_col.begin(), w.pot_col.end(), potVec(0.0));
+      fill(w.expot_row.begin(), w.expot_row.end(), potVec(0.0));
+      fill(w.expot_col.begin(), w.expot_col.end(), potVec(0.0));
+      fill(w.selepot_row.begin(), w.selepot_row.end(), potVec(0.0));
+      fill(w.selepot_col.begin(), w.selepot_col.end(), potVec(0.0));
     }
+#else
+    reduceStorage(snap_->atomData, nLocal_, true);
 
-    if (storageLayout_ & DataStorage::dslSitePotential) {              
-      snap_->atomData.sitePotential[atom1] += *(idat.sPot1);
-      snap_->atomData.sitePotential[atom2] += *(idat.sPot2);
+    for (int t = 0; t < nThreads_; t++) {
+      ThreadWorkArrays& w = threadData_[t];
+      pairwisePot += w.pairwisePot;
+      excludedPot += w.excludedPot;
+      selectedPot += w.selectedPot;
+      w.pairwisePot = 0.0;
+      w.excludedPot = 0.0;
+      w.selectedPot = 0.0;
     }
+#endif
+  }
 
+  void ForceMatrixDecomposition::reduceStorage(DataStorage& target, int n,
+                                               bool row) {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nThreads_) schedule(static)
 #endif
-    
+    for (int i = 0; i < n; i++) {
+      for (int t = 0; t < nThreads_; t++) {
+#ifdef IS_MPI
+        DataStorage& w = row ? threadData_[t].rowData : threadData_[t].colData;
+#else
+        DataStorage& w = threadData_[t].rowData;
+#endif
+        target.force[i] += w.force[i];
+        w.force[i] = V3Zero;
+
+        if (threadLayout_ & DataStorage::dslTorque) {
+          target.torque[i] += w.torque[i];
+          w.torque[i] = V3Zero;
+        }
+        if (threadLayout_ & DataStorage::dslParticlePot) {
+          target.particlePot[i] += w.particlePot[i];
+          w.particlePot[i] = 0.0;
+        }
+        if (threadLayout_ & DataStorage::dslDensity) {
+          target.density[i] += w.density[i];
+          w.density[i] = 0.0;
+        }
+        if (threadLayout_ & DataStorage::dslSkippedCharge) {
+          target.skippedCharge[i] += w.skippedCharge[i];
+          w.skippedCharge[i] = 0.0;
+        }
+        if (threadLayout_ & DataStorage::dslFlucQForce) {
+          target.flucQFrc[i] += w.flucQFrc[i];
+          w.flucQFrc[i] = 0.0;
+        }
+        if (threadLayout_ & DataStorage::dslElectricField) {
+          target.electricField[i] += w.electricField[i];
+          w.electricField[i] = V3Zero;
+        }
+        if (threadLayout_ & DataStorage::dslSitePotential) {
+          target.sitePotential[i] += w.sitePotential[i];
+          w.sitePotential[i] = 0.0;
+        }
+      }
+    }
   }
 
   /*
@@ -1688,6 +1789,22 @@ namespace OpenMD {
       return AtomLocalToGlobal[atom1];
 #else
       return atom1;
+#endif
+    }
+
+    int ForceMatrixDecomposition::getAtypeIdentRow(int atom1) {
+#ifdef IS_MPI
+      return identsRow[atom1];
+#else
+      return idents[atom1];
+#endif
+    }
+
+    int ForceMatrixDecomposition::getAtypeIdentCol(int atom2) {
+#ifdef IS_MPI
+      return identsCol[atom2];
+#else
+      return idents[atom2];
 #endif
     }
 } //end namespace OpenMD
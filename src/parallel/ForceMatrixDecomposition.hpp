@@ -46,6 +46,7 @@
 #include "parallel/ForceDecomposition.hpp"
 #include "math/SquareMatrix3.hpp"
 #include "brains/Snapshot.hpp"
+#include "brains/PairList.hpp"
 
 #ifdef IS_MPI
 #include "parallel/Communicator.hpp"
@@ -65,6 +66,10 @@ namespace OpenMD {
     void distributeIntermediateData();
     void collectSelfData();
     void collectData();
+    void beginDistributeData();
+    void finishDistributeData();
+    void beginCollectData();
+    void finishCollectData();
 
     // neighbor list routines
     void buildNeighborList(vector<int>& neighborList, vector<int>& point);
@@ -87,21 +92,63 @@ namespace OpenMD {
     // atom bookkeeping
     int& getNAtomsInRow();
     int getTopologicalDistance(int atom1, int atom2);
-    vector<int>& getExcludesForAtom(int atom1); 
     bool skipAtomPair(int atom1, int atom2, int cg1, int cg2);
     bool excludeAtomPair(int atom1, int atom2);
     int getGlobalIDRow(int atom1);
     int getGlobalIDCol(int atom1);
     int getGlobalID(int atom1);
-    void addForceToAtomRow(int atom1, Vector3d fg);
-    void addForceToAtomColumn(int atom2, Vector3d fg);
+    int getAtypeIdentRow(int atom1);
+    int getAtypeIdentCol(int atom2);
+    void addForceToAtomRow(int atom1, Vector3d fg, int tid = 0);
+    void addForceToAtomColumn(int atom2, Vector3d fg, int tid = 0);
     Vector3d& getAtomVelocityColumn(int atom2);
 
     // filling interaction blocks with pointers
-    void fillInteractionData(InteractionData &idat, int atom1, int atom2, bool newAtom1 = true);
-    void unpackInteractionData(InteractionData &idat, int atom1, int atom2);
+    void fillInteractionData(InteractionData &idat, int atom1, int atom2, bool newAtom1 = true, int tid = 0);
+    void unpackInteractionData(InteractionData &idat, int atom1, int atom2, int tid = 0);
+
+    // threaded pair loop support
+    void setNumThreads(int nThreads);
+    void reduceThreadData();
 
   private:     
+    /**
+     * Private work arrays for one thread of the pair loop.  Only the
+     * quantities that the pair loop accumulates are allocated.  In
+     * the serial version, rowData is indexed by local atom; in
+     * parallel, rowData and colData mirror atomRowData and
+     * atomColData.
+     */
+    struct ThreadWorkArrays {
+      DataStorage rowData;
+      potVec pairwisePot;
+      potVec excludedPot;
+      potVec selectedPot;
+#ifdef IS_MPI
+      DataStorage colData;
+      vector<potVec> pot_row;
+      vector<potVec> pot_col;
+      vector<potVec> expot_row;
+      vector<potVec> expot_col;
+      vector<potVec> selepot_row;
+      vector<potVec> selepot_col;
+#endif
+    };
+
+    void collectPairs(PairList* pairs, int value,
+                      const vector<int>& globalToRow,
+                      const vector<int>& globalToCol,
+                      vector<pair<int, int> >& entries,
+                      vector<int>& entryRows);
+
+    DataStorage* getRowAccumulator(int tid);
+    DataStorage* getColumnAccumulator(int tid);
+    void reduceStorage(DataStorage& target, int n, bool row);
+
+    vector<ThreadWorkArrays> threadData_;
+    int threadLayout_;
+
+
     int nLocal_;
     int nGroups_;
     vector<int> AtomLocalToGlobal;
@@ -140,6 +187,17 @@ namespace OpenMD {
     Plan<int>* cgPlanIntColumn;
     Plan<Vector3d>* cgPlanVectorColumn; 
 
+    // batched, non-blocking exchanges of everything sharing a layout
+    PackedPlan* AtomPackRow;
+    PackedPlan* AtomPackColumn;
+    PackedPlan* cgPackRow;
+    PackedPlan* cgPackColumn;
+
+    // local targets of the potential scatters in collectData
+    vector<potVec> pot_local;
+    vector<potVec> expot_local;
+    vector<potVec> selepot_local;
+
     // work arrays for assembling potential energy
     vector<potVec> pot_row;
     vector<potVec> pot_col;
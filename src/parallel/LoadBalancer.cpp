@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2005 The University of Notre Dame. All Rights Reserved.
+ *
+ * The University of Notre Dame grants you ("Licensee") a
+ * non-exclusive, royalty free, license to use, modify and
+ * redistribute this software in source and binary code form, provided
+ * that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * This software is provided "AS IS," without a warranty of any
+ * kind. All express or implied conditions, representations and
+ * warranties, including any implied warranty of merchantability,
+ * fitness for a particular purpose or non-infringement, are hereby
+ * excluded.  The University of Notre Dame and its licensors shall not
+ * be liable for any damages suffered by licensee as a result of
+ * using, modifying or distributing the software or its
+ * derivatives. In no event will the University of Notre Dame or its
+ * licensors be liable for any lost revenue, profit or data, or for
+ * direct, indirect, special, consequential, incidental or punitive
+ * damages, however caused and regardless of the theory of liability,
+ * arising out of the use of or inability to use software, even if the
+ * University of Notre Dame has been advised of the possibility of
+ * such damages.
+ *
+ * SUPPORT OPEN SCIENCE!  If you use OpenMD or its source code in your
+ * research, please cite the appropriate papers when you publish your
+ * work.  Good starting points are:
+ *                                                                      
+ * [1]  Meineke, et al., J. Comp. Chem. 26, 252-271 (2005).             
+ * [2]  Fennell & Gezelter, J. Chem. Phys. 124, 234104 (2006).          
+ * [3]  Sun, Lin & Gezelter, J. Chem. Phys. 128, 234107 (2008).          
+ * [4]  Kuang & Gezelter,  J. Chem. Phys. 133, 164101 (2010).
+ * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
+ */
+
+#ifdef IS_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+#include "parallel/LoadBalancer.hpp"
+#include "primitives/Molecule.hpp"
+#include "utils/CellList.hpp"
+
+using namespace std;
+namespace OpenMD {
+
+  LoadBalancer::LoadBalancer(SimInfo* info) : info_(info) {}
+
+  vector<RealType> LoadBalancer::getMoleculeCosts() {
+    Snapshot* snap = info_->getSnapshotManager()->getCurrentSnapshot();
+    Globals* simParams = info_->getSimParams();
+    bool usePBC = simParams->getUsePeriodicBoundaryConditions();
+
+    // The cutoff radius may still be left for the ForceManager to
+    // choose, so fall back on its default for electrostatic systems.
+    RealType rCut = simParams->haveCutoffRadius() ?
+      simParams->getCutoffRadius() : 12.0;
+    rCut += simParams->getSkinThickness();
+    RealType rCutSq = rCut * rCut;
+
+    vector<RealType> costs(info_->getNGlobalMolecules(), 0.0);
+
+    SimInfo::MoleculeIterator mi;
+    Molecule* mol;
+    Molecule::CutoffGroupIterator ci;
+    CutoffGroup* cg;
+
+    // the cutoff groups on this processor:
+    vector<RealType> localPos;
+    vector<int> localAtoms;
+    vector<int> localMols;
+
+    for (mol = info_->beginMolecule(mi); mol != NULL;
+         mol = info_->nextMolecule(mi)) {
+      costs[mol->getGlobalIndex()] += mol->getNAtoms();
+      for (cg = mol->beginCutoffGroup(ci); cg != NULL;
+           cg = mol->nextCutoffGroup(ci)) {
+        cg->updateCOM();
+        Vector3d pos = cg->getPos();
+        localPos.push_back(pos.x());
+        localPos.push_back(pos.y());
+        localPos.push_back(pos.z());
+        localAtoms.push_back(cg->getNumAtom());
+        localMols.push_back(mol->getGlobalIndex());
+      }
+    }
+
+    int nLocal = localAtoms.size();
+    int firstLocal = 0;
+    vector<RealType> allPos;
+    vector<int> allAtoms;
+
+#ifdef IS_MPI
+    int nProcessors, myRank;
+    MPI_Comm_size(MPI_COMM_WORLD, &nProcessors);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myRank);
+
+    vector<int> counts(nProcessors), displacements(nProcessors, 0);
+    MPI_Allgather(&nLocal, 1, MPI_INT, &counts[0], 1, MPI_INT,
+                  MPI_COMM_WORLD);
+    for (int i = 1; i < nProcessors; i++)
+      displacements[i] = displacements[i-1] + counts[i-1];
+    int nTotal = displacements[nProcessors-1] + counts[nProcessors-1];
+    firstLocal = displacements[myRank];
+
+    allAtoms.resize(nTotal);
+    MPI_Allgatherv(nLocal ? &localAtoms[0] : NULL, nLocal, MPI_INT,
+                   &allAtoms[0], &counts[0], &displacements[0], MPI_INT,
+                   MPI_COMM_WORLD);
+
+    for (int i = 0; i < nProcessors; i++) {
+      counts[i] *= 3;
+      displacements[i] *= 3;
+    }
+    allPos.resize(3 * nTotal);
+    MPI_Allgatherv(nLocal ? &localPos[0] : NULL, 3 * nLocal, MPI_REALTYPE,
+                   &allPos[0], &counts[0], &displacements[0], MPI_REALTYPE,
+                   MPI_COMM_WORLD);
+#else
+    allPos = localPos;
+    allAtoms = localAtoms;
+#endif
+
+    int nTotalGroups = allAtoms.size();
+    vector<Vector3d> centers(nTotalGroups);
+    for (int i = 0; i < nTotalGroups; i++) 
+      centers[i] = Vector3d(allPos[3*i], allPos[3*i+1], allPos[3*i+2]);
+
+    CellList cells;
+    cells.build(centers, snap->getHmat(), usePBC, rCut);
+
+    vector<int> neighbors;
+    if (!cells.isActive()) {
+      neighbors.resize(nTotalGroups);
+      for (int j = 0; j < nTotalGroups; j++) neighbors[j] = j;
+    }
+
+    for (int i = 0; i < nLocal; i++) {
+      int gi = firstLocal + i;
+      if (cells.isActive()) cells.getNeighbors(centers[gi], neighbors);
+
+      RealType pairs = 0.0;
+      for (vector<int>::iterator j = neighbors.begin(); j != neighbors.end();
+           ++j) {
+        if (*j == gi) continue;
+        Vector3d d = centers[*j] - centers[gi];
+        if (usePBC) snap->wrapVector(d);
+        if (d.lengthSquare() < rCutSq) pairs += allAtoms[*j];
+      }
+      costs[localMols[i]] += pairs * localAtoms[i];
+    }
+
+#ifdef IS_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &costs[0], costs.size(), MPI_REALTYPE,
+                  MPI_SUM, MPI_COMM_WORLD);
+#endif
+    return costs;
+  }
+
+  vector<int> LoadBalancer::divide(const vector<RealType>& costs,
+                                   int nProcessors) {
+    int nMols = costs.size();
+
+    vector<pair<RealType, int> > order(nMols);
+    for (int i = 0; i < nMols; i++)
+      order[i] = make_pair(-costs[i], i);
+    // stable ordering of equal costs keeps the division reproducible:
+    sort(order.begin(), order.end());
+
+    // processors by their current total cost, lightest on top:
+    priority_queue<pair<RealType, int>, vector<pair<RealType, int> >,
+                   greater<pair<RealType, int> > > loads;
+    for (int p = 0; p < nProcessors; p++)
+      loads.push(make_pair(0.0, p));
+
+    vector<int> molToProc(nMols, -1);
+    for (int i = 0; i < nMols; i++) {
+      pair<RealType, int> lightest = loads.top();
+      loads.pop();
+      molToProc[order[i].second] = lightest.second;
+      lightest.first -= order[i].first;
+      loads.push(lightest);
+    }
+    return molToProc;
+  }
+
+  RealType LoadBalancer::getImbalance(const vector<RealType>& costs,
+                                      const vector<int>& molToProc,
+                                      int nProcessors) {
+    vector<RealType> loads(nProcessors, 0.0);
+    RealType total = 0.0;
+    for (std::size_t i = 0; i < costs.size(); i++) {
+      loads[molToProc[i]] += costs[i];
+      total += costs[i];
+    }
+    if (total <= 0.0) return 1.0;
+    RealType heaviest = *max_element(loads.begin(), loads.end());
+    return heaviest * nProcessors / total;
+  }
+}
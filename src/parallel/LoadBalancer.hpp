@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2005 The University of Notre Dame. All Rights Reserved.
+ *
+ * The University of Notre Dame grants you ("Licensee") a
+ * non-exclusive, royalty free, license to use, modify and
+ * redistribute this software in source and binary code form, provided
+ * that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * This software is provided "AS IS," without a warranty of any
+ * kind. All express or implied conditions, representations and
+ * warranties, including any implied warranty of merchantability,
+ * fitness for a particular purpose or non-infringement, are hereby
+ * excluded.  The University of Notre Dame and its licensors shall not
+ * be liable for any damages suffered by licensee as a result of
+ * using, modifying or distributing the software or its
+ * derivatives. In no event will the University of Notre Dame or its
+ * licensors be liable for any lost revenue, profit or data, or for
+ * direct, indirect, special, consequential, incidental or punitive
+ * damages, however caused and regardless of the theory of liability,
+ * arising out of the use of or inability to use software, even if the
+ * University of Notre Dame has been advised of the possibility of
+ * such damages.
+ *
+ * SUPPORT OPEN SCIENCE!  If you use OpenMD or its source code in your
+ * research, please cite the appropriate papers when you publish your
+ * work.  Good starting points are:
+ *                                                                      
+ * [1]  Meineke, et al., J. Comp. Chem. 26, 252-271 (2005).             
+ * [2]  Fennell & Gezelter, J. Chem. Phys. 124, 234104 (2006).          
+ * [3]  Sun, Lin & Gezelter, J. Chem. Phys. 128, 234107 (2008).          
+ * [4]  Kuang & Gezelter,  J. Chem. Phys. 133, 164101 (2010).
+ * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
+ */
+ 
+#ifndef PARALLEL_LOADBALANCER_HPP
+#define PARALLEL_LOADBALANCER_HPP
+
+#include <vector>
+
+#include "config.h"
+#include "brains/SimInfo.hpp"
+
+namespace OpenMD {
+
+  /**
+   * @class LoadBalancer
+   * Estimates how much work each molecule brings to the non-bonded
+   * pair loop and divides the molecules among the processors so that
+   * every processor carries a similar share of it.
+   *
+   * The cost of a molecule is the number of atom pairs it takes part
+   * in, counted over the cutoff groups whose centers lie within the
+   * cutoff radius plus the neighbor list skin, plus one for each of
+   * its own atoms.  These costs follow the local density, so a
+   * molecule in a dense slab or nanoparticle weighs more than the same
+   * molecule in a vapor, which the atom counts used by
+   * SimCreator::divideMolecules can't distinguish.
+   */
+  class LoadBalancer {
+  public:
+    LoadBalancer(SimInfo* info);
+
+    /**
+     * Returns the cost of every molecule, indexed by global molecule
+     * index, from the positions in the current snapshot.  In parallel
+     * this is a collective call, and every processor receives the
+     * full array.
+     */
+    std::vector<RealType> getMoleculeCosts();
+
+    /**
+     * Assigns the molecules to processors, most expensive first, each
+     * to the processor with the smallest total cost so far.
+     * @return the processor of each molecule
+     */
+    std::vector<int> divide(const std::vector<RealType>& costs,
+                            int nProcessors);
+
+    /**
+     * Returns the largest total cost on any processor divided by the
+     * mean total cost.
+     */
+    RealType getImbalance(const std::vector<RealType>& costs,
+                          const std::vector<int>& molToProc,
+                          int nProcessors);
+
+  private:
+    SimInfo* info_;
+  };
+}
+#endif
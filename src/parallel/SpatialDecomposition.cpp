@@ -0,0 +1,1197 @@
+/*
+ * Copyright (c) 2005 The University of Notre Dame. All Rights Reserved.
+ *
+ * The University of Notre Dame grants you ("Licensee") a
+ * non-exclusive, royalty free, license to use, modify and
+ * redistribute this software in source and binary code form, provided
+ * that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * This software is provided "AS IS," without a warranty of any
+ * kind. All express or implied conditions, representations and
+ * warranties, including any implied warranty of merchantability,
+ * fitness for a particular purpose or non-infringement, are hereby
+ * excluded.  The University of Notre Dame and its licensors shall not
+ * be liable for any damages suffered by licensee as a result of
+ * using, modifying or distributing the software or its
+ * derivatives. In no event will the University of Notre Dame or its
+ * licensors be liable for any lost revenue, profit or data, or for
+ * direct, indirect, special, consequential, incidental or punitive
+ * damages, however caused and regardless of the theory of liability,
+ * arising out of the use of or inability to use software, even if the
+ * University of Notre Dame has been advised of the possibility of
+ * such damages.
+ *
+ * SUPPORT OPEN SCIENCE!  If you use OpenMD or its source code in your
+ * research, please cite the appropriate papers when you publish your
+ * work.  Good starting points are:
+ *                                                                      
+ * [1]  Meineke, et al., J. Comp. Chem. 26, 252-271 (2005).             
+ * [2]  Fennell & Gezelter, J. Chem. Phys. 124, 234104 (2006).          
+ * [3]  Sun, Lin & Gezelter, J. Chem. Phys. 128, 234107 (2008).          
+ * [4]  Kuang & Gezelter,  J. Chem. Phys. 133, 164101 (2010).
+ * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
+ */
+
+#ifdef IS_MPI
+#include <mpi.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "parallel/SpatialDecomposition.hpp"
+#include "brains/SnapshotManager.hpp"
+#include "utils/CellList.hpp"
+
+using namespace std;
+namespace OpenMD {
+
+  SpatialDecomposition::SpatialDecomposition(SimInfo* info,
+                                             InteractionManager* iMan) :
+    ForceDecomposition(info, iMan), threadLayout_(0), nLocal_(0),
+    nGroups_(0), myDomain_(0), nDomains_(1), domainsStale_(true),
+    nDomainAtoms_(0), nDomainGroups_(0) {
+  }
+
+  void SpatialDecomposition::distributeInitialData() {
+    snap_ = sman_->getCurrentSnapshot();
+    storageLayout_ = sman_->getStorageLayout();
+    ff_ = info_->getForceField();
+    nLocal_ = snap_->getNumberOfAtoms();
+    nGroups_ = info_->getNLocalCutoffGroups();
+
+    idents = info_->getIdentArray();
+    regions = info_->getRegions();
+    AtomLocalToGlobal = info_->getGlobalAtomIndices();
+    cgLocalToGlobal = info_->getGlobalGroupIndices();
+    vector<int> globalGroupMembership = info_->getGlobalGroupMembership();
+    int nGlobalAtoms = info_->getNGlobalAtoms();
+    int nGlobalGroups = info_->getNGlobalCutoffGroups();
+
+    massFactors = info_->getMassFactors();
+
+    if (needVelocities_)
+      snap_->cgData.setStorageLayout(DataStorage::dslPosition |
+                                     DataStorage::dslVelocity);
+    else
+      snap_->cgData.setStorageLayout(DataStorage::dslPosition);
+
+    atypesLocal.resize(nLocal_);
+    for (int i = 0; i < nLocal_; i++)
+      atypesLocal[i] = ff_->getAtomType(idents[i]);
+
+    vector<int> globalToGroup(nGlobalGroups, -1);
+    for (int i = 0; i < nGroups_; i++)
+      globalToGroup[cgLocalToGlobal[i]] = i;
+
+    groupList_.clear();
+    groupList_.resize(nGroups_);
+    for (int j = 0; j < nLocal_; j++) {
+      int cg = globalToGroup[globalGroupMembership[AtomLocalToGlobal[j]]];
+      if (cg != -1) groupList_[cg].push_back(j);
+    }
+
+    // The exclusions and topological distances of our atoms are kept
+    // by global index until we know which domains the partners land in.
+    vector<int> globalToLocal(nGlobalAtoms, -1);
+    for (int i = 0; i < nLocal_; i++)
+      globalToLocal[AtomLocalToGlobal[i]] = i;
+
+    vector<pair<int, int> > entries;
+    vector<int> entryRows;
+
+    collectPartners(info_->getExcludedInteractions(), 0, globalToLocal,
+                    entries, entryRows);
+    buildPairCSR(nLocal_, entries, entryRows, localExcludes_);
+
+    entries.clear();
+    entryRows.clear();
+    collectPartners(info_->getOneTwoInteractions(), 1, globalToLocal,
+                    entries, entryRows);
+    collectPartners(info_->getOneThreeInteractions(), 2, globalToLocal,
+                    entries, entryRows);
+    collectPartners(info_->getOneFourInteractions(), 3, globalToLocal,
+                    entries, entryRows);
+    buildPairCSR(nLocal_, entries, entryRows, localTopoDist_);
+
+    globalToDomain_.assign(nGlobalAtoms, -1);
+
+    domainData_.resize(0);
+    domainData_.setStorageLayout(storageLayout_);
+    domainGroupData_.resize(0);
+    domainGroupData_.setStorageLayout(snap_->cgData.getStorageLayout());
+
+    setupDomains();
+    domainsStale_ = true;
+  }
+
+  /**
+   * Appends the pairs in a PairList that involve one of our atoms.
+   * Each entry is stored as (global partner, value), and entryRows
+   * holds the matching local atom.  Molecules live on a single
+   * processor, so the local PairLists hold every pair of our atoms.
+   */
+  void SpatialDecomposition::collectPartners(PairList* pairs, int value,
+                                             const vector<int>& globalToLocal,
+                                             vector<pair<int, int> >& entries,
+                                             vector<int>& entryRows) {
+    for (PairList::const_iterator p = pairs->begin(); p != pairs->end(); ++p) {
+      int i = globalToLocal[p->first];
+      if (i != -1) {
+        entryRows.push_back(i);
+        entries.push_back(make_pair(p->second, value));
+      }
+      i = globalToLocal[p->second];
+      if (i != -1) {
+        entryRows.push_back(i);
+        entries.push_back(make_pair(p->first, value));
+      }
+    }
+  }
+
+  /**
+   * Chooses the processor grid.  Of all the ways to factor the number
+   * of processors into three, we take the one with the smallest halo
+   * of width rList around each domain.
+   */
+  void SpatialDecomposition::setupDomains() {
+    int nProc;
+    MPI_Comm_size(MPI_COMM_WORLD, &nProc);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myDomain_);
+
+    Mat3x3d box = snap_->getHmat();
+    Vector3d A = box.getColumn(0);
+    Vector3d B = box.getColumn(1);
+    Vector3d C = box.getColumn(2);
+    Vector3d AxB = cross(A, B);
+    Vector3d BxC = cross(B, C);
+    Vector3d CxA = cross(C, A);
+    AxB.normalize();
+    BxC.normalize();
+    CxA.normalize();
+    Vector3d W(abs(dot(A, BxC)), abs(dot(B, CxA)), abs(dot(C, AxB)));
+
+    RealType bestHalo = -1.0;
+    for (int px = 1; px <= nProc; px++) {
+      if (nProc % px != 0) continue;
+      for (int py = 1; py <= nProc / px; py++) {
+        if ((nProc / px) % py != 0) continue;
+        Vector3i p(px, py, nProc / (px * py));
+
+        // an undivided direction needs no halo
+        RealType inner = 1.0;
+        RealType outer = 1.0;
+        for (int k = 0; k < 3; k++) {
+          RealType l = W[k] / p[k];
+          inner *= l;
+          outer *= (p[k] > 1) ? l + 2.0 * rList_ : l;
+        }
+        if (bestHalo < 0.0 || outer - inner < bestHalo) {
+          bestHalo = outer - inner;
+          nDomains_ = p;
+        }
+      }
+    }
+
+    sprintf(painCave.errMsg,
+            "SpatialDecomposition: dividing the box into a %d x %d x %d\n"
+            "\tgrid of domains.\n", nDomains_.x(), nDomains_.y(),
+            nDomains_.z());
+    painCave.severity = OPENMD_INFO;
+    painCave.isFatal = 0;
+    simError();
+  }
+
+  /**
+   * Sends each of our cutoff groups to the domain that holds its
+   * center and to every domain within rList of it, and receives the
+   * home groups and ghosts of our own domain, with everything about
+   * them that stays fixed until the next neighbor list rebuild.
+   */
+  void SpatialDecomposition::assignDomains() {
+    int nProc;
+    MPI_Comm_size(MPI_COMM_WORLD, &nProc);
+
+    Mat3x3d box = snap_->getHmat();
+    Mat3x3d invBox = snap_->getInvHmat();
+    Vector3d A = box.getColumn(0);
+    Vector3d B = box.getColumn(1);
+    Vector3d C = box.getColumn(2);
+    Vector3d AxB = cross(A, B);
+    Vector3d BxC = cross(B, C);
+    Vector3d CxA = cross(C, A);
+    AxB.normalize();
+    BxC.normalize();
+    CxA.normalize();
+
+    // The halo in scaled coordinates.  Two points closer than rList
+    // differ by less than rList / W in each scaled coordinate, where W
+    // is the perpendicular width of the box in that direction.
+    Vector3d halo(rList_ / abs(dot(A, BxC)), rList_ / abs(dot(B, CxA)),
+                  rList_ / abs(dot(C, AxB)));
+
+    vector<vector<int> > groupsTo(nProc);
+    vector<vector<int> > homeTo(nProc);
+    vector<int> near[3];
+    Vector3d scaled;
+    Vector3i home;
+
+    for (int i = 0; i < nGroups_; i++) {
+      scaled = invBox * snap_->cgData.position[i];
+      for (int k = 0; k < 3; k++) {
+        scaled[k] -= roundMe(scaled[k]);
+        scaled[k] += 0.5;
+        if (scaled[k] >= 1.0) scaled[k] -= 1.0;
+        home[k] = min(int(nDomains_[k] * scaled[k]), nDomains_[k] - 1);
+
+        near[k].clear();
+        for (int d = 0; d < nDomains_[k]; d++) {
+          RealType lo = RealType(d) / nDomains_[k];
+          RealType hi = RealType(d + 1) / nDomains_[k];
+          // periodic distances up to the bottom and down to the top
+          RealType up = lo - scaled[k];
+          if (up < 0.0) up += 1.0;
+          RealType down = scaled[k] - hi;
+          if (down < 0.0) down += 1.0;
+          if (d == home[k] || min(up, down) <= halo[k])
+            near[k].push_back(d);
+        }
+      }
+
+      for (unsigned int a = 0; a < near[0].size(); a++) {
+        for (unsigned int b = 0; b < near[1].size(); b++) {
+          for (unsigned int c = 0; c < near[2].size(); c++) {
+            Vector3i dom(near[0][a], near[1][b], near[2][c]);
+            int r = Vlinear(dom, nDomains_);
+            groupsTo[r].push_back(i);
+            homeTo[r].push_back(dom == home ? 1 : 0);
+          }
+        }
+      }
+    }
+
+    // Each group travels as (global index, number of atoms, home?),
+    // followed by (global index, ident, region, exclusions,
+    // topological partners) for each of its atoms.
+    vector<int> sendCounts(nProc, 0);
+    vector<int> recvCounts(nProc, 0);
+    vector<vector<int> > sendInts;
+
+    sendRanks_.clear();
+    sendGroups_.clear();
+    sendAtoms_.clear();
+
+    for (int r = 0; r < nProc; r++) {
+      if (groupsTo[r].empty()) continue;
+      sendRanks_.push_back(r);
+      sendGroups_.push_back(groupsTo[r]);
+      sendAtoms_.push_back(vector<int>());
+      sendInts.push_back(vector<int>());
+      vector<int>& atoms = sendAtoms_.back();
+      vector<int>& ints = sendInts.back();
+
+      for (unsigned int g = 0; g < groupsTo[r].size(); g++) {
+        vector<int>& members = groupList_[groupsTo[r][g]];
+        ints.push_back(cgLocalToGlobal[groupsTo[r][g]]);
+        ints.push_back(members.size());
+        ints.push_back(homeTo[r][g]);
+
+        for (vector<int>::iterator ia = members.begin();
+             ia != members.end(); ++ia) {
+          int atom = *ia;
+          atoms.push_back(atom);
+          ints.push_back(AtomLocalToGlobal[atom]);
+          ints.push_back(idents[atom]);
+          ints.push_back(regions[atom]);
+
+          int first = localExcludes_.start[atom];
+          int last = localExcludes_.start[atom + 1];
+          ints.push_back(last - first);
+          ints.insert(ints.end(), localExcludes_.partner.begin() + first,
+                      localExcludes_.partner.begin() + last);
+
+          first = localTopoDist_.start[atom];
+          last = localTopoDist_.start[atom + 1];
+          ints.push_back(last - first);
+          for (int e = first; e < last; e++) {
+            ints.push_back(localTopoDist_.partner[e]);
+            ints.push_back(localTopoDist_.value[e]);
+          }
+        }
+      }
+      sendCounts[r] = ints.size();
+    }
+
+    MPI_Alltoall(&sendCounts[0], 1, MPI_INT, &recvCounts[0], 1, MPI_INT,
+                 MPI_COMM_WORLD);
+
+    recvRanks_.clear();
+    vector<vector<int> > recvInts;
+    for (int r = 0; r < nProc; r++) {
+      if (recvCounts[r] == 0) continue;
+      recvRanks_.push_back(r);
+      recvInts.push_back(vector<int>(recvCounts[r]));
+    }
+
+    exchange(sendRanks_, sendInts, recvRanks_, recvInts, 1);
+
+    // forget the previous domain
+    for (int i = 0; i < nDomainAtoms_; i++)
+      globalToDomain_[AtomDomainToGlobal[i]] = -1;
+
+    nDomainAtoms_ = 0;
+    nDomainGroups_ = 0;
+    homeGroup_.clear();
+    groupListDomain_.clear();
+    AtomDomainToGlobal.clear();
+    cgDomainToGlobal.clear();
+    identsDomain.clear();
+    regionsDomain.clear();
+    recvGroupStart_.assign(recvRanks_.size() + 1, 0);
+    recvAtomStart_.assign(recvRanks_.size() + 1, 0);
+
+    // partners by global index until every domain atom is known
+    vector<pair<int, int> > excludeEntries;
+    vector<int> excludeRows;
+    vector<pair<int, int> > topoEntries;
+    vector<int> topoRows;
+
+    for (unsigned int n = 0; n < recvRanks_.size(); n++) {
+      recvGroupStart_[n] = nDomainGroups_;
+      recvAtomStart_[n] = nDomainAtoms_;
+      vector<int>& ints = recvInts[n];
+      std::size_t pos = 0;
+
+      while (pos < ints.size()) {
+        cgDomainToGlobal.push_back(ints[pos++]);
+        int nAtoms = ints[pos++];
+        homeGroup_.push_back(ints[pos++]);
+        groupListDomain_.push_back(vector<int>());
+
+        for (int a = 0; a < nAtoms; a++) {
+          groupListDomain_.back().push_back(nDomainAtoms_);
+          AtomDomainToGlobal.push_back(ints[pos++]);
+          identsDomain.push_back(ints[pos++]);
+          regionsDomain.push_back(ints[pos++]);
+
+          int nPartners = ints[pos++];
+          for (int e = 0; e < nPartners; e++) {
+            excludeRows.push_back(nDomainAtoms_);
+            excludeEntries.push_back(make_pair(ints[pos++], 0));
+          }
+          nPartners = ints[pos++];
+          for (int e = 0; e < nPartners; e++) {
+            topoRows.push_back(nDomainAtoms_);
+            topoEntries.push_back(make_pair(ints[pos], ints[pos + 1]));
+            pos += 2;
+          }
+          nDomainAtoms_++;
+        }
+        nDomainGroups_++;
+      }
+    }
+    recvGroupStart_[recvRanks_.size()] = nDomainGroups_;
+    recvAtomStart_[recvRanks_.size()] = nDomainAtoms_;
+
+    for (int i = 0; i < nDomainAtoms_; i++)
+      globalToDomain_[AtomDomainToGlobal[i]] = i;
+
+    // Only the partners that made it into this domain matter here.
+    vector<pair<int, int> > entries;
+    vector<int> entryRows;
+    for (unsigned int e = 0; e < excludeEntries.size(); e++) {
+      int j = globalToDomain_[excludeEntries[e].first];
+      if (j != -1) {
+        entryRows.push_back(excludeRows[e]);
+        entries.push_back(make_pair(j, 0));
+      }
+    }
+    buildPairCSR(nDomainAtoms_, entries, entryRows, excludes_);
+
+    entries.clear();
+    entryRows.clear();
+    for (unsigned int e = 0; e < topoEntries.size(); e++) {
+      int j = globalToDomain_[topoEntries[e].first];
+      if (j != -1) {
+        entryRows.push_back(topoRows[e]);
+        entries.push_back(make_pair(j, topoEntries[e].second));
+      }
+    }
+    buildPairCSR(nDomainAtoms_, entries, entryRows, topoDist_);
+
+    vector<vector<RealType> > sendMass(sendRanks_.size());
+    vector<vector<RealType> > recvMass(recvRanks_.size());
+    for (unsigned int n = 0; n < sendRanks_.size(); n++)
+      for (unsigned int a = 0; a < sendAtoms_[n].size(); a++)
+        sendMass[n].push_back(massFactors[sendAtoms_[n][a]]);
+    for (unsigned int n = 0; n < recvRanks_.size(); n++)
+      recvMass[n].resize(recvAtomStart_[n + 1] - recvAtomStart_[n]);
+
+    exchange(sendRanks_, sendMass, recvRanks_, recvMass, 2);
+
+    massFactorsDomain.clear();
+    for (unsigned int n = 0; n < recvRanks_.size(); n++)
+      massFactorsDomain.insert(massFactorsDomain.end(), recvMass[n].begin(),
+                               recvMass[n].end());
+
+    domainData_.resize(nDomainAtoms_);
+    domainGroupData_.resize(nDomainGroups_);
+    allocateThreadData();
+    zeroDomainArrays();
+  }
+
+  template<typename T>
+  void SpatialDecomposition::exchange(const vector<int>& sendTo,
+                                      vector<vector<T> >& sendBuf,
+                                      const vector<int>& recvFrom,
+                                      vector<vector<T> >& recvBuf, int tag) {
+    vector<MPI_Request> requests(sendTo.size() + recvFrom.size());
+    int nr = 0;
+
+    for (unsigned int n = 0; n < recvFrom.size(); n++) {
+      MPI_Irecv(recvBuf[n].empty() ? NULL : &recvBuf[n][0],
+                recvBuf[n].size(), MPITraits<T>::Type(), recvFrom[n], tag,
+                MPI_COMM_WORLD, &requests[nr++]);
+    }
+    for (unsigned int n = 0; n < sendTo.size(); n++) {
+      MPI_Isend(sendBuf[n].empty() ? NULL : &sendBuf[n][0],
+                sendBuf[n].size(), MPITraits<T>::Type(), sendTo[n], tag,
+                MPI_COMM_WORLD, &requests[nr++]);
+    }
+    if (nr > 0)
+      MPI_Waitall(nr, &requests[0], MPI_STATUSES_IGNORE);
+  }
+
+  void SpatialDecomposition::sendToDomains(DataStorage& local,
+                                           DataStorage& domain,
+                                           int whichArrays, bool groups) {
+    whichArrays &= local.getStorageLayout() & domain.getStorageLayout();
+
+    // the arrays go one after the other in each message
+    vector<int> arrays;
+    vector<int> widths;
+    int width = 0;
+    for (int which = DataStorage::dslPosition;
+         which <= DataStorage::dslSitePotential; which <<= 1) {
+      if (whichArrays & which) {
+        arrays.push_back(which);
+        widths.push_back(DataStorage::getBytesPerStuntDouble(which) /
+                         sizeof(RealType));
+        width += widths.back();
+      }
+    }
+    if (width == 0) return;
+
+    vector<vector<RealType> > sendBuf(sendRanks_.size());
+    vector<vector<RealType> > recvBuf(recvRanks_.size());
+
+    for (unsigned int n = 0; n < sendRanks_.size(); n++) {
+      vector<int>& objects = groups ? sendGroups_[n] : sendAtoms_[n];
+      sendBuf[n].resize(objects.size() * width);
+      RealType* buf = sendBuf[n].empty() ? NULL : &sendBuf[n][0];
+      for (unsigned int f = 0; f < arrays.size(); f++) {
+        RealType* src = local.getArrayPointer(arrays[f]);
+        int w = widths[f];
+        for (unsigned int i = 0; i < objects.size(); i++, buf += w)
+          memcpy(buf, src + objects[i] * w, w * sizeof(RealType));
+      }
+    }
+
+    vector<int>& start = groups ? recvGroupStart_ : recvAtomStart_;
+    for (unsigned int n = 0; n < recvRanks_.size(); n++)
+      recvBuf[n].resize((start[n + 1] - start[n]) * width);
+
+    exchange(sendRanks_, sendBuf, recvRanks_, recvBuf, groups ? 3 : 4);
+
+    // each processor's atoms are contiguous in the domain arrays
+    for (unsigned int n = 0; n < recvRanks_.size(); n++) {
+      int count = start[n + 1] - start[n];
+      RealType* buf = recvBuf[n].empty() ? NULL : &recvBuf[n][0];
+      for (unsigned int f = 0; f < arrays.size(); f++) {
+        int w = widths[f];
+        memcpy(domain.getArrayPointer(arrays[f]) + start[n] * w, buf,
+               count * w * sizeof(RealType));
+        buf += count * w;
+      }
+    }
+  }
+
+  void SpatialDecomposition::returnFromDomains(DataStorage& domain,
+                                               DataStorage& local,
+                                               int whichArrays) {
+    whichArrays &= local.getStorageLayout() & domain.getStorageLayout();
+
+    vector<int> arrays;
+    vector<int> widths;
+    int width = 0;
+    for (int which = DataStorage::dslPosition;
+         which <= DataStorage::dslSitePotential; which <<= 1) {
+      if (whichArrays & which) {
+        arrays.push_back(which);
+        widths.push_back(DataStorage::getBytesPerStuntDouble(which) /
+                         sizeof(RealType));
+        width += widths.back();
+      }
+    }
+    if (width == 0) return;
+
+    // the messages retrace the paths of sendToDomains
+    vector<vector<RealType> > sendBuf(recvRanks_.size());
+    vector<vector<RealType> > recvBuf(sendRanks_.size());
+
+    for (unsigned int n = 0; n < recvRanks_.size(); n++) {
+      int first = recvAtomStart_[n];
+      int count = recvAtomStart_[n + 1] - first;
+      sendBuf[n].resize(count * width);
+      RealType* buf = sendBuf[n].empty() ? NULL : &sendBuf[n][0];
+      for (unsigned int f = 0; f < arrays.size(); f++) {
+        int w = widths[f];
+        memcpy(buf, domain.getArrayPointer(arrays[f]) + first * w,
+               count * w * sizeof(RealType));
+        buf += count * w;
+      }
+    }
+
+    for (unsigned int n = 0; n < sendRanks_.size(); n++)
+      recvBuf[n].resize(sendAtoms_[n].size() * width);
+
+    exchange(recvRanks_, sendBuf, sendRanks_, recvBuf, 5);
+
+    // an atom held by several domains collects from each of them
+    for (unsigned int n = 0; n < sendRanks_.size(); n++) {
+      vector<int>& objects = sendAtoms_[n];
+      RealType* buf = recvBuf[n].empty() ? NULL : &recvBuf[n][0];
+      for (unsigned int f = 0; f < arrays.size(); f++) {
+        RealType* dst = local.getArrayPointer(arrays[f]);
+        int w = widths[f];
+        for (unsigned int i = 0; i < objects.size(); i++, buf += w)
+          for (int k = 0; k < w; k++)
+            dst[objects[i] * w + k] += buf[k];
+      }
+    }
+  }
+
+  void SpatialDecomposition::zeroWorkArrays() {
+    pairwisePot = 0.0;
+    selfPot = 0.0;
+    excludedPot = 0.0;
+    excludedSelfPot = 0.0;
+    selectedPot = 0.0;
+    selectedSelfPot = 0.0;
+
+    zeroDomainArrays();
+
+    if (storageLayout_ & DataStorage::dslParticlePot) {
+      fill(snap_->atomData.particlePot.begin(),
+           snap_->atomData.particlePot.end(), 0.0);
+    }
+
+    if (storageLayout_ & DataStorage::dslDensity) {
+      fill(snap_->atomData.density.begin(),
+           snap_->atomData.density.end(), 0.0);
+    }
+
+    if (storageLayout_ & DataStorage::dslFunctional) {
+      fill(snap_->atomData.functional.begin(),
+           snap_->atomData.functional.end(), 0.0);
+    }
+
+    if (storageLayout_ & DataStorage::dslFunctionalDerivative) {
+      fill(snap_->atomData.functionalDerivative.begin(),
+           snap_->atomData.functionalDerivative.end(), 0.0);
+    }
+
+    if (storageLayout_ & DataStorage::dslSkippedCharge) {
+      fill(snap_->atomData.skippedCharge.begin(),
+           snap_->atomData.skippedCharge.end(), 0.0);
+    }
+
+    if (storageLayout_ & DataStorage::dslElectricField) {
+      fill(snap_->atomData.electricField.begin(),
+           snap_->atomData.electricField.end(), V3Zero);
+    }
+    if (storageLayout_ & DataStorage::dslSitePotential) {
+      fill(snap_->atomData.sitePotential.begin(),
+           snap_->atomData.sitePotential.end(), 0.0);
+    }
+  }
+
+  void SpatialDecomposition::zeroDomainArrays() {
+    if (storageLayout_ & DataStorage::dslForce)
+      fill(domainData_.force.begin(), domainData_.force.end(), V3Zero);
+
+    if (storageLayout_ & DataStorage::dslTorque)
+      fill(domainData_.torque.begin(), domainData_.torque.end(), V3Zero);
+
+    if (storageLayout_ & DataStorage::dslParticlePot)
+      fill(domainData_.particlePot.begin(), domainData_.particlePot.end(),
+           0.0);
+
+    if (storageLayout_ & DataStorage::dslDensity)
+      fill(domainData_.density.begin(), domainData_.density.end(), 0.0);
+
+    if (storageLayout_ & DataStorage::dslFunctional)
+      fill(domainData_.functional.begin(), domainData_.functional.end(),
+           0.0);
+
+    if (storageLayout_ & DataStorage::dslFunctionalDerivative)
+      fill(domainData_.functionalDerivative.begin(),
+           domainData_.functionalDerivative.end(), 0.0);
+
+    if (storageLayout_ & DataStorage::dslSkippedCharge)
+      fill(domainData_.skippedCharge.begin(),
+           domainData_.skippedCharge.end(), 0.0);
+
+    if (storageLayout_ & DataStorage::dslFlucQForce)
+      fill(domainData_.flucQFrc.begin(), domainData_.flucQFrc.end(), 0.0);
+
+    if (storageLayout_ & DataStorage::dslElectricField)
+      fill(domainData_.electricField.begin(),
+           domainData_.electricField.end(), V3Zero);
+
+    if (storageLayout_ & DataStorage::dslSitePotential)
+      fill(domainData_.sitePotential.begin(),
+           domainData_.sitePotential.end(), 0.0);
+  }
+
+  void SpatialDecomposition::distributeData() {
+    beginDistributeData();
+    finishDistributeData();
+  }
+
+  /**
+   * Nothing can be sent ahead here: the neighbor list check that
+   * follows decides whether the domains are rebuilt first.
+   */
+  void SpatialDecomposition::beginDistributeData() {
+    snap_ = sman_->getCurrentSnapshot();
+    storageLayout_ = sman_->getStorageLayout();
+  }
+
+  void SpatialDecomposition::finishDistributeData() {
+    snap_ = sman_->getCurrentSnapshot();
+    storageLayout_ = sman_->getStorageLayout();
+
+    if (domainsStale_) {
+      assignDomains();
+      domainsStale_ = false;
+    }
+
+    int atomArrays = DataStorage::dslPosition | DataStorage::dslAmat |
+      DataStorage::dslDipole | DataStorage::dslQuadrupole |
+      DataStorage::dslFlucQPosition;
+    int groupArrays = DataStorage::dslPosition;
+    if (needVelocities_) {
+      atomArrays |= DataStorage::dslVelocity;
+      groupArrays |= DataStorage::dslVelocity;
+    }
+
+    sendToDomains(snap_->atomData, domainData_, atomArrays, false);
+    sendToDomains(snap_->cgData, domainGroupData_, groupArrays, true);
+  }
+
+  bool SpatialDecomposition::checkNeighborList() {
+    bool update = ForceDecomposition::checkNeighborList();
+    if (update) domainsStale_ = true;
+    return update;
+  }
+
+  /* collects information obtained during the pre-pair loop onto local
+   * data structures.
+   */
+  void SpatialDecomposition::collectIntermediateData() {
+    snap_ = sman_->getCurrentSnapshot();
+    storageLayout_ = sman_->getStorageLayout();
+
+    returnFromDomains(domainData_, snap_->atomData,
+                      DataStorage::dslDensity |
+                      DataStorage::dslElectricField);
+
+    // the fields have been delivered; collectData should only carry
+    // what the pair loop adds to them
+    if (storageLayout_ & DataStorage::dslElectricField)
+      fill(domainData_.electricField.begin(),
+           domainData_.electricField.end(), V3Zero);
+  }
+
+  /*
+   * redistributes information obtained during the pre-pair loop out to
+   * the domains
+   */
+  void SpatialDecomposition::distributeIntermediateData() {
+    snap_ = sman_->getCurrentSnapshot();
+    storageLayout_ = sman_->getStorageLayout();
+
+    sendToDomains(snap_->atomData, domainData_,
+                  DataStorage::dslFunctional |
+                  DataStorage::dslFunctionalDerivative, false);
+  }
+
+  void SpatialDecomposition::collectData() {
+    snap_ = sman_->getCurrentSnapshot();
+    storageLayout_ = sman_->getStorageLayout();
+
+    returnFromDomains(domainData_, snap_->atomData,
+                      DataStorage::dslForce | DataStorage::dslTorque |
+                      DataStorage::dslSkippedCharge |
+                      DataStorage::dslFlucQForce |
+                      DataStorage::dslElectricField |
+                      DataStorage::dslSitePotential |
+                      DataStorage::dslParticlePot);
+
+    // every pair was computed on exactly one processor
+    RealType pots[3 * N_INTERACTION_FAMILIES];
+    for (int ii = 0; ii < N_INTERACTION_FAMILIES; ii++) {
+      pots[ii] = pairwisePot[ii];
+      pots[ii + N_INTERACTION_FAMILIES] = excludedPot[ii];
+      pots[ii + 2 * N_INTERACTION_FAMILIES] = selectedPot[ii];
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, pots, 3 * N_INTERACTION_FAMILIES,
+                  MPI_REALTYPE, MPI_SUM, MPI_COMM_WORLD);
+
+    for (int ii = 0; ii < N_INTERACTION_FAMILIES; ii++) {
+      pairwisePot[ii] = pots[ii];
+      excludedPot[ii] = pots[ii + N_INTERACTION_FAMILIES];
+      selectedPot[ii] = pots[ii + 2 * N_INTERACTION_FAMILIES];
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, &snap_->frameData.conductiveHeatFlux[0], 3,
+                  MPI_REALTYPE, MPI_SUM, MPI_COMM_WORLD);
+  }
+
+  /**
+   * Collects information obtained during the post-pair (and embedding
+   * functional) loops onto local data structures.
+   */
+  void SpatialDecomposition::collectSelfData() {
+    snap_ = sman_->getCurrentSnapshot();
+    storageLayout_ = sman_->getStorageLayout();
+
+    RealType pots[3 * N_INTERACTION_FAMILIES];
+    for (int ii = 0; ii < N_INTERACTION_FAMILIES; ii++) {
+      pots[ii] = selfPot[ii];
+      pots[ii + N_INTERACTION_FAMILIES] = excludedSelfPot[ii];
+      pots[ii + 2 * N_INTERACTION_FAMILIES] = selectedSelfPot[ii];
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, pots, 3 * N_INTERACTION_FAMILIES,
+                  MPI_REALTYPE, MPI_SUM, MPI_COMM_WORLD);
+
+    for (int ii = 0; ii < N_INTERACTION_FAMILIES; ii++) {
+      selfPot[ii] = pots[ii];
+      excludedSelfPot[ii] = pots[ii + N_INTERACTION_FAMILIES];
+      selectedSelfPot[ii] = pots[ii + 2 * N_INTERACTION_FAMILIES];
+    }
+  }
+
+  int& SpatialDecomposition::getNAtomsInRow() {
+    return nDomainAtoms_;
+  }
+
+  vector<int>& SpatialDecomposition::getAtomsInGroupRow(int cg1) {
+    return groupListDomain_[cg1];
+  }
+
+  vector<int>& SpatialDecomposition::getAtomsInGroupColumn(int cg2) {
+    return groupListDomain_[cg2];
+  }
+
+  Vector3d SpatialDecomposition::getIntergroupVector(int cg1, int cg2) {
+    Vector3d d = domainGroupData_.position[cg2] -
+      domainGroupData_.position[cg1];
+    if (usePeriodicBoundaryConditions_) {
+      snap_->wrapVector(d);
+    }
+    return d;
+  }
+
+  Vector3d& SpatialDecomposition::getGroupVelocityColumn(int cg2) {
+    return domainGroupData_.velocity[cg2];
+  }
+
+  Vector3d& SpatialDecomposition::getAtomVelocityColumn(int atom2) {
+    return domainData_.velocity[atom2];
+  }
+
+  Vector3d SpatialDecomposition::getAtomToGroupVectorRow(int atom1,
+                                                         int cg1) {
+    Vector3d d = domainGroupData_.position[cg1] -
+      domainData_.position[atom1];
+    if (usePeriodicBoundaryConditions_) {
+      snap_->wrapVector(d);
+    }
+    return d;
+  }
+
+  Vector3d SpatialDecomposition::getAtomToGroupVectorColumn(int atom2,
+                                                            int cg2) {
+    Vector3d d = domainGroupData_.position[cg2] -
+      domainData_.position[atom2];
+    if (usePeriodicBoundaryConditions_) {
+      snap_->wrapVector(d);
+    }
+    return d;
+  }
+
+  RealType& SpatialDecomposition::getMassFactorRow(int atom1) {
+    return massFactorsDomain[atom1];
+  }
+
+  RealType& SpatialDecomposition::getMassFactorColumn(int atom2) {
+    return massFactorsDomain[atom2];
+  }
+
+  Vector3d SpatialDecomposition::getInteratomicVector(int atom1, int atom2) {
+    Vector3d d = domainData_.position[atom2] - domainData_.position[atom1];
+    if (usePeriodicBoundaryConditions_) {
+      snap_->wrapVector(d);
+    }
+    return d;
+  }
+
+  /**
+   * Each pair of groups is only visited once, so the only pairs to
+   * skip are those within a single group, which the neighbor list
+   * visits in both orders.
+   */
+  bool SpatialDecomposition::skipAtomPair(int atom1, int atom2,
+                                          int cg1, int cg2) {
+    int unique_id_1 = AtomDomainToGlobal[atom1];
+    int unique_id_2 = AtomDomainToGlobal[atom2];
+
+    if (unique_id_1 == unique_id_2) return true;
+    if (cg1 == cg2 && unique_id_1 < unique_id_2) return true;
+    return false;
+  }
+
+  bool SpatialDecomposition::excludeAtomPair(int atom1, int atom2) {
+    return std::binary_search(excludes_.partner.begin() +
+                              excludes_.start[atom1],
+                              excludes_.partner.begin() +
+                              excludes_.start[atom1 + 1], atom2);
+  }
+
+  int SpatialDecomposition::getTopologicalDistance(int atom1, int atom2) {
+    vector<int>::iterator first = topoDist_.partner.begin() +
+      topoDist_.start[atom1];
+    vector<int>::iterator last = topoDist_.partner.begin() +
+      topoDist_.start[atom1 + 1];
+    vector<int>::iterator j = std::lower_bound(first, last, atom2);
+    if (j != last && *j == atom2)
+      return topoDist_.value[j - topoDist_.partner.begin()];
+    return 0;
+  }
+
+  void SpatialDecomposition::addForceToAtomRow(int atom1, Vector3d fg,
+                                               int tid) {
+    getAccumulator(tid)->force[atom1] += fg;
+  }
+
+  void SpatialDecomposition::addForceToAtomColumn(int atom2, Vector3d fg,
+                                                  int tid) {
+    getAccumulator(tid)->force[atom2] += fg;
+  }
+
+  void SpatialDecomposition::fillInteractionData(InteractionData &idat,
+                                                 int atom1, int atom2,
+                                                 bool newAtom1, int tid) {
+    DataStorage* acc = getAccumulator(tid);
+    DataStorage* rho = prePairLoop_ ? acc : &domainData_;
+
+    if (newAtom1) {
+      idat.atid1 = identsDomain[atom1];
+
+      if (storageLayout_ & DataStorage::dslAmat)
+        idat.A1 = &(domainData_.aMat[atom1]);
+
+      if (storageLayout_ & DataStorage::dslTorque)
+        idat.t1 = &(acc->torque[atom1]);
+
+      if (storageLayout_ & DataStorage::dslDipole)
+        idat.dipole1 = &(domainData_.dipole[atom1]);
+
+      if (storageLayout_ & DataStorage::dslQuadrupole)
+        idat.quadrupole1 = &(domainData_.quadrupole[atom1]);
+
+      if (storageLayout_ & DataStorage::dslDensity)
+        idat.rho1 = &(rho->density[atom1]);
+
+      if (storageLayout_ & DataStorage::dslFunctional)
+        idat.frho1 = &(domainData_.functional[atom1]);
+
+      if (storageLayout_ & DataStorage::dslFunctionalDerivative)
+        idat.dfrho1 = &(domainData_.functionalDerivative[atom1]);
+
+      if (storageLayout_ & DataStorage::dslParticlePot)
+        idat.particlePot1 = &(acc->particlePot[atom1]);
+
+      if (storageLayout_ & DataStorage::dslSkippedCharge)
+        idat.skippedCharge1 = &(acc->skippedCharge[atom1]);
+
+      if (storageLayout_ & DataStorage::dslFlucQPosition)
+        idat.flucQ1 = &(domainData_.flucQPos[atom1]);
+    }
+
+    idat.atid2 = identsDomain[atom2];
+
+    if (regionsDomain[atom1] >= 0 && regionsDomain[atom2] >= 0) {
+      idat.sameRegion = (regionsDomain[atom1] == regionsDomain[atom2]);
+    } else {
+      idat.sameRegion = false;
+    }
+
+    if (storageLayout_ & DataStorage::dslAmat)
+      idat.A2 = &(domainData_.aMat[atom2]);
+
+    if (storageLayout_ & DataStorage::dslTorque)
+      idat.t2 = &(acc->torque[atom2]);
+
+    if (storageLayout_ & DataStorage::dslDipole)
+      idat.dipole2 = &(domainData_.dipole[atom2]);
+
+    if (storageLayout_ & DataStorage::dslQuadrupole)
+      idat.quadrupole2 = &(domainData_.quadrupole[atom2]);
+
+    if (storageLayout_ & DataStorage::dslDensity)
+      idat.rho2 = &(rho->density[atom2]);
+
+    if (storageLayout_ & DataStorage::dslFunctional)
+      idat.frho2 = &(domainData_.functional[atom2]);
+
+    if (storageLayout_ & DataStorage::dslFunctionalDerivative)
+      idat.dfrho2 = &(domainData_.functionalDerivative[atom2]);
+
+    if (storageLayout_ & DataStorage::dslParticlePot)
+      idat.particlePot2 = &(acc->particlePot[atom2]);
+
+    if (storageLayout_ & DataStorage::dslSkippedCharge)
+      idat.skippedCharge2 = &(acc->skippedCharge[atom2]);
+
+    if (storageLayout_ & DataStorage::dslFlucQPosition)
+      idat.flucQ2 = &(domainData_.flucQPos[atom2]);
+  }
+
+  void SpatialDecomposition::unpackInteractionData(InteractionData &idat,
+                                                   int atom1, int atom2,
+                                                   int tid) {
+    DataStorage* acc = getAccumulator(tid);
+
+    potVec& pPot = (nThreads_ > 1) ? threadData_[tid].pairwisePot : pairwisePot;
+    potVec& ePot = (nThreads_ > 1) ? threadData_[tid].excludedPot : excludedPot;
+    potVec& sPot = (nThreads_ > 1) ? threadData_[tid].selectedPot : selectedPot;
+
+    pPot += *(idat.pot);
+    ePot += *(idat.excludedPot);
+    sPot += *(idat.selePot);
+
+    if (idat.doParticlePot) {
+      // The pairwise contribution to the particle pot goes back to
+      // the owners of the atoms with the forces in collectData.
+      acc->particlePot[atom1] += *(idat.vpair) * *(idat.sw);
+      acc->particlePot[atom2] += *(idat.vpair) * *(idat.sw);
+    }
+
+    acc->force[atom1] += *(idat.f1);
+    acc->force[atom2] -= *(idat.f1);
+
+    if (storageLayout_ & DataStorage::dslFlucQForce) {
+      acc->flucQFrc[atom1] -= *(idat.dVdFQ1);
+      acc->flucQFrc[atom2] -= *(idat.dVdFQ2);
+    }
+
+    if (storageLayout_ & DataStorage::dslElectricField) {
+      acc->electricField[atom1] += *(idat.eField1);
+      acc->electricField[atom2] += *(idat.eField2);
+    }
+
+    if (storageLayout_ & DataStorage::dslSitePotential) {
+      acc->sitePotential[atom1] += *(idat.sPot1);
+      acc->sitePotential[atom2] += *(idat.sPot2);
+    }
+  }
+
+  DataStorage* SpatialDecomposition::getAccumulator(int tid) {
+    if (nThreads_ > 1) return &(threadData_[tid].data);
+    return &domainData_;
+  }
+
+  /**
+   * The thread work arrays follow the size of the domain, so they are
+   * allocated in assignDomains once the domain is known.
+   */
+  void SpatialDecomposition::setNumThreads(int nThreads) {
+    nThreads_ = max(1, nThreads);
+    threadLayout_ = storageLayout_ & (DataStorage::dslForce |
+                                      DataStorage::dslTorque |
+                                      DataStorage::dslParticlePot |
+                                      DataStorage::dslDensity |
+                                      DataStorage::dslSkippedCharge |
+                                      DataStorage::dslFlucQForce |
+                                      DataStorage::dslElectricField |
+                                      DataStorage::dslSitePotential);
+    threadLayout_ |= DataStorage::dslForce;
+    allocateThreadData();
+  }
+
+  void SpatialDecomposition::allocateThreadData() {
+    threadData_.clear();
+    if (nThreads_ == 1) return;
+
+    threadData_.resize(nThreads_);
+    for (int t = 0; t < nThreads_; t++) {
+      ThreadWorkArrays& w = threadData_[t];
+      w.pairwisePot = 0.0;
+      w.excludedPot = 0.0;
+      w.selectedPot = 0.0;
+      w.data.resize(nDomainAtoms_);
+      w.data.setStorageLayout(threadLayout_);
+    }
+  }
+
+  /**
+   * Sums the private thread work arrays onto the domain arrays and
+   * zeroes them for the next pass through the pair loop.
+   */
+  void SpatialDecomposition::reduceThreadData() {
+    if (nThreads_ < 2) return;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nThreads_) schedule(static)
+#endif
+    for (int i = 0; i < nDomainAtoms_; i++) {
+      for (int t = 0; t < nThreads_; t++) {
+        DataStorage& w = threadData_[t].data;
+        domainData_.force[i] += w.force[i];
+        w.force[i] = V3Zero;
+
+        if (threadLayout_ & DataStorage::dslTorque) {
+          domainData_.torque[i] += w.torque[i];
+          w.torque[i] = V3Zero;
+        }
+        if (threadLayout_ & DataStorage::dslParticlePot) {
+          domainData_.particlePot[i] += w.particlePot[i];
+          w.particlePot[i] = 0.0;
+        }
+        if (threadLayout_ & DataStorage::dslDensity) {
+          domainData_.density[i] += w.density[i];
+          w.density[i] = 0.0;
+        }
+        if (threadLayout_ & DataStorage::dslSkippedCharge) {
+          domainData_.skippedCharge[i] += w.skippedCharge[i];
+          w.skippedCharge[i] = 0.0;
+        }
+        if (threadLayout_ & DataStorage::dslFlucQForce) {
+          domainData_.flucQFrc[i] += w.flucQFrc[i];
+          w.flucQFrc[i] = 0.0;
+        }
+        if (threadLayout_ & DataStorage::dslElectricField) {
+          domainData_.electricField[i] += w.electricField[i];
+          w.electricField[i] = V3Zero;
+        }
+        if (threadLayout_ & DataStorage::dslSitePotential) {
+          domainData_.sitePotential[i] += w.sitePotential[i];
+          w.sitePotential[i] = 0.0;
+        }
+      }
+    }
+
+    for (int t = 0; t < nThreads_; t++) {
+      ThreadWorkArrays& w = threadData_[t];
+      pairwisePot += w.pairwisePot;
+      excludedPot += w.excludedPot;
+      selectedPot += w.selectedPot;
+      w.pairwisePot = 0.0;
+      w.excludedPot = 0.0;
+      w.selectedPot = 0.0;
+    }
+  }
+
+  /*
+   * buildNeighborList
+   *
+   * Constructs the Verlet neighbor list of the home groups of this
+   * domain.  A home group j1 is paired with a group j2 (home or ghost)
+   * only if j2 has the larger global index, or is j1 itself, so that
+   * each pair of groups is computed on exactly one processor.
+   */
+  void SpatialDecomposition::buildNeighborList(vector<int>& neighborList,
+                                               vector<int>& point) {
+    neighborList.clear();
+    point.clear();
+    point.resize(nDomainGroups_ + 1);
+    int len = 0;
+
+    snap_ = sman_->getCurrentSnapshot();
+
+    CellList cells;
+    cells.build(domainGroupData_.position, snap_->getHmat(),
+                usePeriodicBoundaryConditions_, rList_);
+
+    vector<int> candidates;
+    if (!cells.isActive()) {
+      for (int j2 = 0; j2 < nDomainGroups_; j2++)
+        candidates.push_back(j2);
+    }
+
+    Vector3d rs, dr;
+    for (int j1 = 0; j1 < nDomainGroups_; j1++) {
+      point[j1] = len;
+      if (!homeGroup_[j1]) continue;
+
+      rs = domainGroupData_.position[j1];
+      if (cells.isActive()) cells.getNeighbors(rs, candidates);
+
+      for (vector<int>::iterator j2 = candidates.begin();
+           j2 != candidates.end(); ++j2) {
+        if ((*j2) != j1 && cgDomainToGlobal[*j2] < cgDomainToGlobal[j1])
+          continue;
+
+        dr = domainGroupData_.position[(*j2)] - rs;
+        if (usePeriodicBoundaryConditions_) {
+          snap_->wrapVector(dr);
+        }
+        if (dr.lengthSquare() < rListSq_) {
+          neighborList.push_back( (*j2) );
+          ++len;
+        }
+      }
+    }
+    point[nDomainGroups_] = len;
+
+    // save the local cutoff group positions for the check that is
+    // done on each loop:
+    saved_CG_positions_.clear();
+    saved_CG_positions_.reserve(nGroups_);
+    for (int i = 0; i < nGroups_; i++)
+      saved_CG_positions_.push_back(snap_->cgData.position[i]);
+  }
+
+  int SpatialDecomposition::getGlobalIDRow(int atom1) {
+    return AtomDomainToGlobal[atom1];
+  }
+
+  int SpatialDecomposition::getGlobalIDCol(int atom2) {
+    return AtomDomainToGlobal[atom2];
+  }
+
+  int SpatialDecomposition::getGlobalID(int atom1) {
+    return AtomLocalToGlobal[atom1];
+  }
+
+  int SpatialDecomposition::getAtypeIdentRow(int atom1) {
+    return identsDomain[atom1];
+  }
+
+  int SpatialDecomposition::getAtypeIdentCol(int atom2) {
+    return identsDomain[atom2];
+  }
+}
+#endif
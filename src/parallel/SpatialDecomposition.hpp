@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2005 The University of Notre Dame. All Rights Reserved.
+ *
+ * The University of Notre Dame grants you ("Licensee") a
+ * non-exclusive, royalty free, license to use, modify and
+ * redistribute this software in source and binary code form, provided
+ * that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * This software is provided "AS IS," without a warranty of any
+ * kind. All express or implied conditions, representations and
+ * warranties, including any implied warranty of merchantability,
+ * fitness for a particular purpose or non-infringement, are hereby
+ * excluded.  The University of Notre Dame and its licensors shall not
+ * be liable for any damages suffered by licensee as a result of
+ * using, modifying or distributing the software or its
+ * derivatives. In no event will the University of Notre Dame or its
+ * licensors be liable for any lost revenue, profit or data, or for
+ * direct, indirect, special, consequential, incidental or punitive
+ * damages, however caused and regardless of the theory of liability,
+ * arising out of the use of or inability to use software, even if the
+ * University of Notre Dame has been advised of the possibility of
+ * such damages.
+ *
+ * SUPPORT OPEN SCIENCE!  If you use OpenMD or its source code in your
+ * research, please cite the appropriate papers when you publish your
+ * work.  Good starting points are:
+ *                                                                      
+ * [1]  Meineke, et al., J. Comp. Chem. 26, 252-271 (2005).             
+ * [2]  Fennell & Gezelter, J. Chem. Phys. 124, 234104 (2006).          
+ * [3]  Sun, Lin & Gezelter, J. Chem. Phys. 128, 234107 (2008).          
+ * [4]  Kuang & Gezelter,  J. Chem. Phys. 133, 164101 (2010).
+ * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
+ */
+
+#ifndef PARALLEL_SPATIALDECOMPOSITION_HPP
+#define PARALLEL_SPATIALDECOMPOSITION_HPP
+
+#ifdef IS_MPI
+
+#include "parallel/ForceDecomposition.hpp"
+#include "parallel/Communicator.hpp"
+#include "math/SquareMatrix3.hpp"
+#include "brains/Snapshot.hpp"
+#include "brains/PairList.hpp"
+
+using namespace std;
+namespace OpenMD {
+
+  /**
+   * @class SpatialDecomposition
+   *
+   * A domain decomposition of the non-bonded pair loop.  The periodic
+   * box is cut into a grid of domains in scaled coordinates, one per
+   * processor, and each cutoff group belongs to the domain that holds
+   * its center.  When the neighbor list is rebuilt, every cutoff group
+   * (with all of its atoms) is sent to its home domain and, as a ghost,
+   * to every other domain that lies within rList (the cutoff radius
+   * plus the skin) of it.  Each processor then computes the pairs
+   * involving its home groups, and the forces, torques and other
+   * accumulated quantities are sent back to the processors that own
+   * the atoms.  The data exchanged per step scale with the surface
+   * of a domain rather than with the N / sqrt(P) atoms of a row or
+   * column in ForceMatrixDecomposition.
+   *
+   * Molecules stay on the processor that SimCreator assigned them to,
+   * so the integrators, constraints and rigid bodies are untouched;
+   * only the pair loop follows the domains.  A pair of cutoff groups
+   * is computed once: by the home domain of the group with the
+   * smaller global index, which always holds the other group either
+   * as a home group or as a ghost.  Inside the domain, the rows and
+   * columns are the same set of atoms, so the pair loop runs the same
+   * way it does on a single processor.
+   */
+  class SpatialDecomposition : public ForceDecomposition {
+  public:
+    SpatialDecomposition(SimInfo* info, InteractionManager* iMan);
+
+    void distributeInitialData();
+    void zeroWorkArrays();
+    void distributeData();
+    void collectIntermediateData();
+    void distributeIntermediateData();
+    void collectSelfData();
+    void collectData();
+    void beginDistributeData();
+    void finishDistributeData();
+
+    // neighbor list routines
+    bool checkNeighborList();
+    void buildNeighborList(vector<int>& neighborList, vector<int>& point);
+
+    // group bookkeeping
+    Vector3d& getGroupVelocityColumn(int cg2);
+
+    // Group->atom bookkeeping
+    vector<int>& getAtomsInGroupRow(int cg1);
+    vector<int>& getAtomsInGroupColumn(int cg2);
+    Vector3d getAtomToGroupVectorRow(int atom1, int cg1);
+    Vector3d getAtomToGroupVectorColumn(int atom2, int cg2);
+    RealType& getMassFactorRow(int atom1);
+    RealType& getMassFactorColumn(int atom2);
+
+    // spatial data
+    Vector3d getIntergroupVector(int cg1, int cg2);
+    Vector3d getInteratomicVector(int atom1, int atom2);
+
+    // atom bookkeeping
+    int& getNAtomsInRow();
+    int getTopologicalDistance(int atom1, int atom2);
+    bool skipAtomPair(int atom1, int atom2, int cg1, int cg2);
+    bool excludeAtomPair(int atom1, int atom2);
+    int getGlobalIDRow(int atom1);
+    int getGlobalIDCol(int atom2);
+    int getGlobalID(int atom1);
+    int getAtypeIdentRow(int atom1);
+    int getAtypeIdentCol(int atom2);
+    void addForceToAtomRow(int atom1, Vector3d fg, int tid = 0);
+    void addForceToAtomColumn(int atom2, Vector3d fg, int tid = 0);
+    Vector3d& getAtomVelocityColumn(int atom2);
+
+    // filling interaction blocks with pointers
+    void fillInteractionData(InteractionData &idat, int atom1, int atom2, bool newAtom1 = true, int tid = 0);
+    void unpackInteractionData(InteractionData &idat, int atom1, int atom2, int tid = 0);
+
+    // threaded pair loop support
+    void setNumThreads(int nThreads);
+    void reduceThreadData();
+
+  private:
+    /**
+     * Private work arrays for one thread of the pair loop, indexed by
+     * domain atom.
+     */
+    struct ThreadWorkArrays {
+      DataStorage data;
+      potVec pairwisePot;
+      potVec excludedPot;
+      potVec selectedPot;
+    };
+
+    void collectPartners(PairList* pairs, int value,
+                         const vector<int>& globalToLocal,
+                         vector<pair<int, int> >& entries,
+                         vector<int>& entryRows);
+    void setupDomains();
+    void assignDomains();
+    void allocateThreadData();
+    void zeroDomainArrays();
+    DataStorage* getAccumulator(int tid);
+
+    /**
+     * Copies the arrays in whichArrays (a bitwise or of DataStorage
+     * layouts) of the owned atoms or cutoff groups into the domains
+     * holding them.
+     */
+    void sendToDomains(DataStorage& local, DataStorage& domain,
+                       int whichArrays, bool groups);
+    /**
+     * Adds the arrays in whichArrays of the domain atoms back onto
+     * the owned atoms.
+     */
+    void returnFromDomains(DataStorage& domain, DataStorage& local,
+                           int whichArrays);
+
+    /**
+     * Posts one message to each processor in sendTo and receives one
+     * from each processor in recvFrom.  The receive buffers must
+     * already have the right sizes.
+     */
+    template<typename T>
+    void exchange(const vector<int>& sendTo, vector<vector<T> >& sendBuf,
+                  const vector<int>& recvFrom, vector<vector<T> >& recvBuf,
+                  int tag);
+
+    vector<ThreadWorkArrays> threadData_;
+    int threadLayout_;
+
+    int nLocal_;
+    int nGroups_;
+    int myDomain_;
+    Vector3i nDomains_;        /**< the processor grid */
+    bool domainsStale_;        /**< domain membership must be rebuilt */
+
+    vector<int> AtomLocalToGlobal;
+    vector<int> cgLocalToGlobal;
+
+    /**
+     * The excluded partners and topological distances of the owned
+     * atoms, by global index.  These travel with an atom to each
+     * domain that holds it, since a domain can hold atoms from
+     * molecules that live on other processors.
+     */
+    PairCSR localExcludes_;
+    PairCSR localTopoDist_;
+
+    // the processors we send owned groups to, and what we send them
+    vector<int> sendRanks_;
+    vector<vector<int> > sendGroups_;
+    vector<vector<int> > sendAtoms_;
+
+    // the processors holding the groups in our domain, and where
+    // their groups and atoms start in the domain arrays
+    vector<int> recvRanks_;
+    vector<int> recvGroupStart_;
+    vector<int> recvAtomStart_;
+
+    int nDomainAtoms_;
+    int nDomainGroups_;
+    DataStorage domainData_;
+    DataStorage domainGroupData_;
+    vector<char> homeGroup_;   /**< is this domain group a home group? */
+    vector<vector<int> > groupListDomain_;
+    vector<int> AtomDomainToGlobal;
+    vector<int> cgDomainToGlobal;
+    vector<int> identsDomain;
+    vector<int> regionsDomain;
+    vector<RealType> massFactorsDomain;
+    vector<int> globalToDomain_;
+  };
+
+}
+#endif
+#endif
@@ -1936,15 +1936,14 @@ namespace OpenMD {
     if (!doRNEMD_) return;
     trialCount_++;
 
-    // object evaluator:
-    evaluator_.loadScriptString(rnemdObjectSelection_);
-    seleMan_.setSelectionSet(evaluator_.evaluate());
-
-    evaluatorA_.loadScriptString(selectionA_);
-    evaluatorB_.loadScriptString(selectionB_);
-
-    seleManA_.setSelectionSet(evaluatorA_.evaluate());
-    seleManB_.setSelectionSet(evaluatorB_.evaluate());
+    // The scripts were loaded by the constructor, and only selections
+    // that depend on the configuration need to be evaluated again:
+    if (evaluator_.isDynamic())
+      seleMan_.setSelectionSet(evaluator_.evaluate());
+    if (evaluatorA_.isDynamic())
+      seleManA_.setSelectionSet(evaluatorA_.evaluate());
+    if (evaluatorB_.isDynamic())
+      seleManB_.setSelectionSet(evaluatorB_.evaluate());
 
     commonA_ = seleManA_ & seleMan_;
     commonB_ = seleManB_ & seleMan_;
@@ -1996,7 +1995,8 @@ namespace OpenMD {
     Vector3d u = angularMomentumFluxVector_;
     u.normalize();
 
-    outputSeleMan_.setSelectionSet(outputEvaluator_.evaluate());
+    if (outputEvaluator_.isDynamic())
+      outputSeleMan_.setSelectionSet(outputEvaluator_.evaluate());
 
     int selei(0);
     StuntDouble* sd;
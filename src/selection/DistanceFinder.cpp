@@ -44,6 +44,8 @@
 #include <mpi.h>
 #endif
 
+#include <algorithm>
+
 #include "selection/DistanceFinder.hpp"
 #include "primitives/Molecule.hpp"
 
@@ -114,265 +116,182 @@ namespace OpenMD {
   }
 
   SelectionSet DistanceFinder::find(const SelectionSet& bs, RealType distance) {
-    StuntDouble* center;
-    Vector3d centerPos;
     Snapshot* currSnapshot = info_->getSnapshotManager()->getCurrentSnapshot();
-    SelectionSet bsResult(nObjects_);   
-    assert(bsResult.size() == bs.size());
-    
-#ifdef IS_MPI
-    int mol;
-    int proc;
-    RealType data[3];
-    int worldRank;
-    MPI_Comm_rank( MPI_COMM_WORLD, &worldRank);
-#endif
-
-    
-    for (unsigned int j = 0; j < stuntdoubles_.size(); ++j) {
-      if (stuntdoubles_[j] != NULL) {
-        if (stuntdoubles_[j]->isRigidBody()) {
-          RigidBody* rb = static_cast<RigidBody*>(stuntdoubles_[j]);
-          rb->updateAtoms();
-        }
-      }
-    }
-            
-    SelectionSet bsTemp = bs;
-    bsTemp = bsTemp.parallelReduce();
-
-    for(int i = 0; i < bsTemp.bitsets_[STUNTDOUBLE].size(); ++i) {
-      if (bsTemp.bitsets_[STUNTDOUBLE][i]) {
-             
-#ifdef IS_MPI
-        
-        // Now, if we own stuntdouble i, we can use the position, but in
-        // parallel, we'll need to let everyone else know what that
-        // position is!
-        
-        mol = info_->getGlobalMolMembership(i);
-        proc = info_->getMolToProc(mol);        
-        
-        if (proc == worldRank) {
-          center = stuntdoubles_[i];
-          centerPos = center->getPos();
-          data[0] = centerPos.x();
-          data[1] = centerPos.y();
-          data[2] = centerPos.z();
-          MPI_Bcast(data, 3, MPI_REALTYPE, proc, MPI_COMM_WORLD);
-        } else {
-          MPI_Bcast(data, 3, MPI_REALTYPE, proc, MPI_COMM_WORLD);
-          centerPos = Vector3d(data);
-        }
-#else
-        center = stuntdoubles_[i];
-        centerPos = center->getPos();
-#endif               
-        for (unsigned int j = 0; j < molecules_.size(); ++j) {
-          if (molecules_[j] != NULL) {
-            Vector3d r =centerPos - molecules_[j]->getCom();
-            currSnapshot->wrapVector(r);
-            if (r.length() <= distance) {
-              bsResult.bitsets_[MOLECULE].setBitOn(j);
-            }
-          }
-        }
-        for (unsigned int j = 0; j < stuntdoubles_.size(); ++j) {
-          if (stuntdoubles_[j] != NULL) {
-            Vector3d r =centerPos - stuntdoubles_[j]->getPos();
-            currSnapshot->wrapVector(r);
-            if (r.length() <= distance) {
-              bsResult.bitsets_[STUNTDOUBLE].setBitOn(j);
-            }
-          }
-        }
-        for (unsigned int j = 0; j < bonds_.size(); ++j) {
-          if (bonds_[j] != NULL) {
-            Vector3d loc = bonds_[j]->getAtomA()->getPos();
-            loc += bonds_[j]->getAtomB()->getPos();
-            loc = loc / 2.0;
-            Vector3d r = centerPos - loc;
-            currSnapshot->wrapVector(r);
-            if (r.length() <= distance) {
-              bsResult.bitsets_[BOND].setBitOn(j);
-            }
-          }
-        }
-        for (unsigned int j = 0; j < bends_.size(); ++j) {
-          if (bends_[j] != NULL) {          
-            Vector3d loc = bends_[j]->getAtomA()->getPos();
-            loc += bends_[j]->getAtomB()->getPos();
-            loc += bends_[j]->getAtomC()->getPos();
-            loc = loc / 3.0;
-            Vector3d r = centerPos - loc;
-            currSnapshot->wrapVector(r);
-            if (r.length() <= distance) {
-              bsResult.bitsets_[BEND].setBitOn(j);
-            }
-          }
-        }
-        for (unsigned int j = 0; j < torsions_.size(); ++j) {
-          if (torsions_[j] != NULL) {
-            Vector3d loc = torsions_[j]->getAtomA()->getPos();
-            loc += torsions_[j]->getAtomB()->getPos();
-            loc += torsions_[j]->getAtomC()->getPos();
-            loc += torsions_[j]->getAtomD()->getPos();
-            loc = loc / 4.0;
-            Vector3d r = centerPos - loc;
-            currSnapshot->wrapVector(r);
-            if (r.length() <= distance) {
-              bsResult.bitsets_[TORSION].setBitOn(j);
-            }
-          }
-        }
-        for (unsigned int j = 0; j < inversions_.size(); ++j) {
-          if (inversions_[j] != NULL) {
-            Vector3d loc = inversions_[j]->getAtomA()->getPos();
-            loc += inversions_[j]->getAtomB()->getPos();
-            loc += inversions_[j]->getAtomC()->getPos();
-            loc += inversions_[j]->getAtomD()->getPos();
-            loc = loc / 4.0;
-            Vector3d r = centerPos - loc;
-            currSnapshot->wrapVector(r);
-            if (r.length() <= distance) {
-              bsResult.bitsets_[INVERSION].setBitOn(j);
-            }
-          }
-        }
-      }
-    }
-    return bsResult;
+    return findWithin(bs, distance, currSnapshot, -1);
   }
   
-  
   SelectionSet DistanceFinder::find(const SelectionSet& bs, RealType distance, int frame ) {
-    StuntDouble * center;
-    Vector3d centerPos;
     Snapshot* currSnapshot = info_->getSnapshotManager()->getSnapshot(frame);
+    return findWithin(bs, distance, currSnapshot, frame);
+  }
+
+  Vector3d DistanceFinder::getPos(StuntDouble* sd, int frame) {
+    return (frame < 0) ? sd->getPos() : sd->getPos(frame);
+  }
+
+  SelectionSet DistanceFinder::findWithin(const SelectionSet& bs, 
+                                          RealType distance, 
+                                          Snapshot* currSnapshot, int frame) {
     SelectionSet bsResult(nObjects_);   
     assert(bsResult.size() == bs.size());
 
-#ifdef IS_MPI
-    int mol;
-    int proc;
-    RealType data[3];
-    int worldRank;
-    MPI_Comm_rank( MPI_COMM_WORLD, &worldRank);
-#endif
- 
     for (unsigned int j = 0; j < stuntdoubles_.size(); ++j) {
       if (stuntdoubles_[j] != NULL) {        
         if (stuntdoubles_[j]->isRigidBody()) {
           RigidBody* rb = static_cast<RigidBody*>(stuntdoubles_[j]);
-          rb->updateAtoms(frame);
+          if (frame < 0) 
+            rb->updateAtoms();
+          else
+            rb->updateAtoms(frame);
         }
       }
     }
     
     SelectionSet bsTemp = bs;
     bsTemp = bsTemp.parallelReduce();
+
+    centers_.clear();
     
+#ifdef IS_MPI
+    // Every processor knows which stuntdoubles are centers, and
+    // therefore how many center positions each processor will
+    // contribute, so a single gather collects all of the centers.
+    int nproc;
+    int worldRank;
+    MPI_Comm_size( MPI_COMM_WORLD, &nproc);
+    MPI_Comm_rank( MPI_COMM_WORLD, &worldRank);
+
+    std::vector<int> coordsOnProc(nproc, 0);
+    std::vector<int> displacements(nproc, 0);
+    std::vector<RealType> coords;
+
     for(int i = 0; i < bsTemp.bitsets_[STUNTDOUBLE].size(); ++i) {
       if (bsTemp.bitsets_[STUNTDOUBLE][i]) {
-        
-        // Now, if we own stuntdouble i, we can use the position, but in
-        // parallel, we'll need to let everyone else know what that
-        // position is!
-        
-#ifdef IS_MPI
-        mol = info_->getGlobalMolMembership(i);
-        proc = info_->getMolToProc(mol);
-        
+        int mol = info_->getGlobalMolMembership(i);
+        int proc = info_->getMolToProc(mol);
+        coordsOnProc[proc] += 3;
         if (proc == worldRank) {
-          center = stuntdoubles_[i];
-          centerPos = center->getPos(frame);
-          data[0] = centerPos.x();
-          data[1] = centerPos.y();
-          data[2] = centerPos.z();          
-          MPI_Bcast(data, 3, MPI_REALTYPE, proc, MPI_COMM_WORLD);
-        } else {
-          MPI_Bcast(data, 3, MPI_REALTYPE, proc, MPI_COMM_WORLD);
-          centerPos = Vector3d(data);
+          Vector3d centerPos = getPos(stuntdoubles_[i], frame);
+          coords.push_back(centerPos.x());
+          coords.push_back(centerPos.y());
+          coords.push_back(centerPos.z());
         }
+      }
+    }
+
+    for (int iproc = 1; iproc < nproc; iproc++)
+      displacements[iproc] = displacements[iproc-1] + coordsOnProc[iproc-1];
+
+    int nCoords = displacements[nproc-1] + coordsOnProc[nproc-1];
+    if (nCoords == 0) return bsResult;
+
+    std::vector<RealType> globalCoords(nCoords);
+    coords.resize(std::max(coordsOnProc[worldRank], 1));
+
+    MPI_Allgatherv(&coords[0], coordsOnProc[worldRank], MPI_REALTYPE,
+                   &globalCoords[0], &coordsOnProc[0], &displacements[0],
+                   MPI_REALTYPE, MPI_COMM_WORLD);
+
+    for (int i = 0; i < nCoords; i += 3) 
+      centers_.push_back(Vector3d(globalCoords[i], globalCoords[i+1], 
+                                  globalCoords[i+2]));
 #else
-        center = stuntdoubles_[i];
-        centerPos = center->getPos(frame);
+    for(int i = 0; i < bsTemp.bitsets_[STUNTDOUBLE].size(); ++i) {
+      if (bsTemp.bitsets_[STUNTDOUBLE][i]) {
+        centers_.push_back(getPos(stuntdoubles_[i], frame));
+      }
+    }
+    if (centers_.empty()) return bsResult;
 #endif
-        for (unsigned int j = 0; j < molecules_.size(); ++j) {
-          if (molecules_[j] != NULL) {
-            Vector3d r =centerPos - molecules_[j]->getCom(frame);
-            currSnapshot->wrapVector(r);
-            if (r.length() <= distance) {
-              bsResult.bitsets_[MOLECULE].setBitOn(j);
-            }
-          }
+
+    // Bin the centers once, so that each object only needs to be
+    // compared with the centers in the neighboring cells.
+    centerCells_.build(centers_, currSnapshot->getHmat(),
+                       info_->getSimParams()->getUsePeriodicBoundaryConditions(),
+                       distance);
+                    
+    for (unsigned int j = 0; j < molecules_.size(); ++j) {
+      if (molecules_[j] != NULL) {
+        Vector3d loc = (frame < 0) ? molecules_[j]->getCom() : 
+          molecules_[j]->getCom(frame);
+        if (isNear(loc, distance, currSnapshot)) {
+          bsResult.bitsets_[MOLECULE].setBitOn(j);
+        }
+      }
+    }
+    for (unsigned int j = 0; j < stuntdoubles_.size(); ++j) {
+      if (stuntdoubles_[j] != NULL) {
+        if (isNear(getPos(stuntdoubles_[j], frame), distance, currSnapshot)) {
+          bsResult.bitsets_[STUNTDOUBLE].setBitOn(j);
         }
-        
-        for (unsigned int j = 0; j < stuntdoubles_.size(); ++j) {
-          if (stuntdoubles_[j] != NULL) {          
-            Vector3d r =centerPos - stuntdoubles_[j]->getPos(frame);
-            currSnapshot->wrapVector(r);
-            if (r.length() <= distance) {
-              bsResult.bitsets_[STUNTDOUBLE].setBitOn(j);
-            }
-          }
+      }
+    }
+    for (unsigned int j = 0; j < bonds_.size(); ++j) {
+      if (bonds_[j] != NULL) {
+        Vector3d loc = getPos(bonds_[j]->getAtomA(), frame);
+        loc += getPos(bonds_[j]->getAtomB(), frame);
+        loc = loc / 2.0;
+        if (isNear(loc, distance, currSnapshot)) {
+          bsResult.bitsets_[BOND].setBitOn(j);
         }
-        for (unsigned int j = 0; j < bonds_.size(); ++j) {
-          if (bonds_[j] != NULL) {
-            Vector3d loc = bonds_[j]->getAtomA()->getPos(frame);
-            loc += bonds_[j]->getAtomB()->getPos(frame);
-            loc = loc / 2.0;
-            Vector3d r = centerPos - loc;
-            currSnapshot->wrapVector(r);
-            if (r.length() <= distance) {
-              bsResult.bitsets_[BOND].setBitOn(j);
-            }
-          }
+      }
+    }
+    for (unsigned int j = 0; j < bends_.size(); ++j) {
+      if (bends_[j] != NULL) {
+        Vector3d loc = getPos(bends_[j]->getAtomA(), frame);
+        loc += getPos(bends_[j]->getAtomB(), frame);
+        loc += getPos(bends_[j]->getAtomC(), frame);
+        loc = loc / 3.0;
+        if (isNear(loc, distance, currSnapshot)) {
+          bsResult.bitsets_[BEND].setBitOn(j);
         }
-        for (unsigned int j = 0; j < bends_.size(); ++j) {
-          if (bends_[j] != NULL) {
-            Vector3d loc = bends_[j]->getAtomA()->getPos(frame);
-            loc += bends_[j]->getAtomB()->getPos(frame);
-            loc += bends_[j]->getAtomC()->getPos(frame);
-            loc = loc / 3.0;
-            Vector3d r = centerPos - loc;
-            currSnapshot->wrapVector(r);
-            if (r.length() <= distance) {
-              bsResult.bitsets_[BEND].setBitOn(j);
-            }
-          }
+      }
+    }
+    for (unsigned int j = 0; j < torsions_.size(); ++j) {
+      if (torsions_[j] != NULL) {
+        Vector3d loc = getPos(torsions_[j]->getAtomA(), frame);
+        loc += getPos(torsions_[j]->getAtomB(), frame);
+        loc += getPos(torsions_[j]->getAtomC(), frame);
+        loc += getPos(torsions_[j]->getAtomD(), frame);
+        loc = loc / 4.0;
+        if (isNear(loc, distance, currSnapshot)) {
+          bsResult.bitsets_[TORSION].setBitOn(j);
         }
-        for (unsigned int j = 0; j < torsions_.size(); ++j) {
-          if (torsions_[j] != NULL) {
-            Vector3d loc = torsions_[j]->getAtomA()->getPos(frame);
-            loc += torsions_[j]->getAtomB()->getPos(frame);
-            loc += torsions_[j]->getAtomC()->getPos(frame);
-            loc += torsions_[j]->getAtomD()->getPos(frame);
-            loc = loc / 4.0;
-            Vector3d r = centerPos - loc;
-            currSnapshot->wrapVector(r);
-            if (r.length() <= distance) {
-              bsResult.bitsets_[TORSION].setBitOn(j);
-            }
-          }
+      }
+    }
+    for (unsigned int j = 0; j < inversions_.size(); ++j) {
+      if (inversions_[j] != NULL) {
+        Vector3d loc = getPos(inversions_[j]->getAtomA(), frame);
+        loc += getPos(inversions_[j]->getAtomB(), frame);
+        loc += getPos(inversions_[j]->getAtomC(), frame);
+        loc += getPos(inversions_[j]->getAtomD(), frame);
+        loc = loc / 4.0;
+        if (isNear(loc, distance, currSnapshot)) {
+          bsResult.bitsets_[INVERSION].setBitOn(j);
         }
-        for (unsigned int j = 0; j < inversions_.size(); ++j) {
-          if (inversions_[j] != NULL) {
-            Vector3d loc = inversions_[j]->getAtomA()->getPos(frame);
-            loc += inversions_[j]->getAtomB()->getPos(frame);
-            loc += inversions_[j]->getAtomC()->getPos(frame);
-            loc += inversions_[j]->getAtomD()->getPos(frame);
-            loc = loc / 4.0;
-            Vector3d r = centerPos - loc;
-            currSnapshot->wrapVector(r);
-            if (r.length() <= distance) {
-              bsResult.bitsets_[INVERSION].setBitOn(j);
-            }
-          }
-        }      
       }
     }
     return bsResult;    
   }
+
+  bool DistanceFinder::isNear(const Vector3d& loc, RealType distance,
+                              Snapshot* currSnapshot) {
+    if (centerCells_.isActive()) {
+      centerCells_.getNeighbors(loc, neighbors_);
+      for (std::vector<int>::iterator n = neighbors_.begin(); 
+           n != neighbors_.end(); ++n) {
+        Vector3d r = centers_[*n] - loc;
+        currSnapshot->wrapVector(r);
+        if (r.length() <= distance) return true;
+      }
+    } else {
+      for (std::vector<Vector3d>::iterator c = centers_.begin(); 
+           c != centers_.end(); ++c) {
+        Vector3d r = (*c) - loc;
+        currSnapshot->wrapVector(r);
+        if (r.length() <= distance) return true;
+      }
+    }
+    return false;
+  }
 }
-  
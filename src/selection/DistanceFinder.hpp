@@ -48,6 +48,7 @@
 #include "primitives/Bend.hpp"
 #include "primitives/Torsion.hpp"
 #include "primitives/Inversion.hpp"
+#include "utils/CellList.hpp"
 namespace OpenMD {
 
   class DistanceFinder {
@@ -65,7 +66,21 @@ namespace OpenMD {
     std::vector<Inversion*> inversions_;
     std::vector<Molecule*> molecules_;
     vector<int> nObjects_;
-        
+
+  private:
+    /**
+     * Selects every object within distance of a selected stuntdouble.
+     * frame is the snapshot number, or -1 for the current snapshot.
+     */
+    SelectionSet findWithin(const SelectionSet& bs, RealType distance,
+                            Snapshot* currSnapshot, int frame);
+    /** Returns true if loc is within distance of one of the centers */
+    bool isNear(const Vector3d& loc, RealType distance, Snapshot* currSnapshot);
+    Vector3d getPos(StuntDouble* sd, int frame);
+
+    std::vector<Vector3d> centers_;
+    CellList centerCells_;
+    std::vector<int> neighbors_;
   };
 
 }
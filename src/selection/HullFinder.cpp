@@ -126,6 +126,8 @@ namespace OpenMD {
     }
 #ifdef HAVE_QHULL
     surfaceMesh_ = new ConvexHull();
+#else
+    surfaceMesh_ = NULL;
 #endif
   }
 
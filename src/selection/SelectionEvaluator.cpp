@@ -40,6 +40,7 @@
  * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
  */
 
+#include <set>
 #include <stack>
 #include "selection/SelectionEvaluator.hpp"
 #include "primitives/Atom.hpp"
@@ -55,8 +56,8 @@ namespace OpenMD {
 
   SelectionEvaluator::SelectionEvaluator(SimInfo* si) 
     : info(si), nameFinder(info), distanceFinder(info), hullFinder(info),
-      alphaHullFinder(info), indexFinder(info), isLoaded_(false),
-      hasSurfaceArea_(false) {
+      alphaHullFinder(info), indexFinder(info), currentStatement_(-1),
+      hasLastSelection_(false), isLoaded_(false), hasSurfaceArea_(false) {
     nObjects.push_back(info->getNGlobalAtoms() + info->getNGlobalRigidBodies());
     nObjects.push_back(info->getNGlobalBonds());
     nObjects.push_back(info->getNGlobalBends());
@@ -97,6 +98,9 @@ namespace OpenMD {
       }
     }
 
+    findStaticSpans();
+    hasLastSelection_ = false;
+
     isLoaded_ = true;
     return true;
   }
@@ -179,9 +183,32 @@ namespace OpenMD {
     std::stack<SelectionSet> stack; 
     vector<int> bsSize = bs.size();
    
+    // Only the statement being selected or defined uses the stored
+    // static sets; nested expressions (e.g. variable lookups) don't.
+    std::vector<int>* spans = NULL;
+    std::map<int, SelectionSet>* staticSets = NULL;
+    if (currentStatement_ >= 0) {
+      spans = &staticSpans_[currentStatement_];
+      staticSets = &staticSets_[currentStatement_];
+      currentStatement_ = -1;
+    }
+    int spanStart = -1;
+    int spanEnd = -1;
+   
     for (unsigned int pc = pcStart; pc < code.size(); ++pc) {
       Token instruction = code[pc];
 
+      if (spans != NULL && (*spans)[pc] >= 0) {
+        std::map<int, SelectionSet>::iterator i = staticSets->find(pc);
+        if (i != staticSets->end()) {
+          stack.push(i->second);
+          pc = (*spans)[pc];
+          continue;
+        }
+        spanStart = pc;
+        spanEnd = (*spans)[pc];
+      }
+
       switch (instruction.tok) {
       case Token::expressionBegin:
         break;
@@ -240,6 +267,11 @@ namespace OpenMD {
       default:
         unrecognizedExpression();
       }
+
+      if (int(pc) == spanEnd) {
+        (*staticSets)[spanStart] = stack.top();
+        spanEnd = -1;
+      }
     }
     if (stack.size() != 1)
       evalError("atom expression compiler error - stack over/underflow");
@@ -253,9 +285,32 @@ namespace OpenMD {
     SelectionSet bs = createSelectionSets();
     std::stack<SelectionSet> stack; 
    
+    // Only the statement being selected or defined uses the stored
+    // static sets; nested expressions (e.g. variable lookups) don't.
+    std::vector<int>* spans = NULL;
+    std::map<int, SelectionSet>* staticSets = NULL;
+    if (currentStatement_ >= 0) {
+      spans = &staticSpans_[currentStatement_];
+      staticSets = &staticSets_[currentStatement_];
+      currentStatement_ = -1;
+    }
+    int spanStart = -1;
+    int spanEnd = -1;
+   
     for (unsigned int pc = pcStart; pc < code.size(); ++pc) {
       Token instruction = code[pc];
 
+      if (spans != NULL && (*spans)[pc] >= 0) {
+        std::map<int, SelectionSet>::iterator i = staticSets->find(pc);
+        if (i != staticSets->end()) {
+          stack.push(i->second);
+          pc = (*spans)[pc];
+          continue;
+        }
+        spanStart = pc;
+        spanEnd = (*spans)[pc];
+      }
+
       switch (instruction.tok) {
       case Token::expressionBegin:
         break;
@@ -314,6 +369,11 @@ namespace OpenMD {
       default:
         unrecognizedExpression();
       }
+
+      if (int(pc) == spanEnd) {
+        (*staticSets)[spanStart] = stack.top();
+        spanEnd = -1;
+      }
     }
     if (stack.size() != 1)
       evalError("atom expression compiler error - stack over/underflow");
@@ -785,9 +845,9 @@ namespace OpenMD {
     assert(statement.size() >= 3);
     
     std::string variable = boost::any_cast<std::string>(statement[1].value);
-    
-    variables.insert(VariablesType::value_type(variable, 
-                                               expression(statement, 2)));
+
+    currentStatement_ = pc - 1;
+    variables[variable] = expression(statement, 2);
   }
   
 
@@ -823,10 +883,12 @@ namespace OpenMD {
   }
 
   void SelectionEvaluator::select(SelectionSet& bs){
+    currentStatement_ = pc - 1;
     bs = expression(statement, 1);
   }
 
   void SelectionEvaluator::select(SelectionSet& bs, int frame){
+    currentStatement_ = pc - 1;
     bs = expression(statement, 1, frame);
   }
   
@@ -865,6 +927,131 @@ namespace OpenMD {
     return false;
   }    
 
+  void SelectionEvaluator::findStaticSpans() {
+    staticSpans_.clear();
+    staticSets_.clear();
+    staticSpans_.resize(aatoken.size());
+    staticSets_.resize(aatoken.size());
+    // variables defined by dynamic expressions are dynamic themselves
+    std::set<std::string> dynamicVariables;
+
+    for (unsigned int i = 0; i < aatoken.size(); ++i) {
+      staticSpans_[i].assign(aatoken[i].size(), -1);
+      if (aatoken[i].empty()) continue;
+
+      switch (aatoken[i][0].tok) {
+      case Token::select:
+        findStaticSpans(aatoken[i], 1, dynamicVariables, staticSpans_[i]);
+        break;
+      case Token::define:
+        if (findStaticSpans(aatoken[i], 2, dynamicVariables, staticSpans_[i]))
+          dynamicVariables.insert(boost::any_cast<std::string>(aatoken[i][1].value));
+        break;
+      default:
+        break;
+      }
+    }
+  }
+
+  /**
+   * Walks the postfix code of one statement, tracking the first token
+   * of each sub-expression on the stack and whether it depends on
+   * positions.  A static sub-expression is marked as a span when it
+   * is consumed by a dynamic one, or when it is the whole statement.
+   * Returns true if the statement as a whole is dynamic.
+   */
+  bool SelectionEvaluator::findStaticSpans(const std::vector<Token>& code,
+                                           int pcStart, 
+                                           const std::set<std::string>& dynamicVariables,
+                                           std::vector<int>& spans) {
+    // each entry: (first token, last token) and whether it is dynamic
+    std::vector<std::pair<std::pair<int, int>, bool> > stack;
+    std::pair<std::pair<int, int>, bool> a, b;
+
+    for (unsigned int pc = pcStart; pc < code.size(); ++pc) {
+      switch (code[pc].tok) {
+      case Token::expressionBegin:
+      case Token::expressionEnd:
+        break;
+      case Token::all:
+      case Token::none:
+      case Token::name:
+      case Token::index:
+        stack.push_back(std::make_pair(std::make_pair(pc, pc), false));
+        break;
+      case Token::identifier:
+        stack.push_back(std::make_pair(std::make_pair(pc, pc), 
+                                       dynamicVariables.count(boost::any_cast<std::string>(code[pc].value)) > 0));
+        break;
+      case Token::opLT:
+      case Token::opLE:
+      case Token::opGE:
+      case Token::opGT:
+      case Token::opEQ:
+      case Token::opNE:
+        // comparisons of masses don't change from frame to frame:
+        stack.push_back(std::make_pair(std::make_pair(pc, pc), 
+                                       (code[pc].intValue & Token::dynamic) != 0));
+        break;
+      case Token::hull:
+      case Token::alphahull:
+        stack.push_back(std::make_pair(std::make_pair(pc, pc), true));
+        break;
+      case Token::opNot:
+        if (stack.empty()) return true;
+        stack.back().first.second = pc;
+        break;
+      case Token::within:
+        if (stack.empty()) return true;
+        if (!stack.back().second) 
+          spans[stack.back().first.first] = stack.back().first.second;
+        stack.back().first.second = pc;
+        stack.back().second = true;
+        break;
+      case Token::opOr:
+      case Token::opAnd:
+        if (stack.size() < 2) return true;
+        b = stack.back();
+        stack.pop_back();
+        a = stack.back();
+        stack.pop_back();
+        if (a.second || b.second) {
+          if (!a.second) spans[a.first.first] = a.first.second;
+          if (!b.second) spans[b.first.first] = b.first.second;
+        }
+        stack.push_back(std::make_pair(std::make_pair(a.first.first, int(pc)),
+                                       a.second || b.second));
+        break;
+      default:
+        // leave anything unfamiliar to be evaluated every time
+        std::fill(spans.begin(), spans.end(), -1);
+        return true;
+      }
+    }
+
+    if (stack.size() != 1) return true;
+    if (!stack.back().second) 
+      spans[stack.back().first.first] = stack.back().first.second;
+    return stack.back().second;
+  }
+
+  void SelectionEvaluator::recordChanges(const SelectionSet& bs) {
+    if (hasLastSelection_) {
+      changes_ = bs ^ lastSelection_;
+    } else {
+      changes_ = bs;
+      hasLastSelection_ = true;
+    }
+    lastSelection_ = bs;
+  }
+
+  bool SelectionEvaluator::hasChanged() {
+    for (int i = 0; i < N_SELECTIONTYPES; i++) {
+      if (changes_.bitsets_[i].any()) return true;
+    }
+    return false;
+  }
+
   void SelectionEvaluator::clearDefinitionsAndLoadPredefined() {
     variables.clear();
     //load predefine
@@ -882,7 +1069,9 @@ namespace OpenMD {
       pc = 0;
       instructionDispatchLoop(bs);
     }
-    return bs.parallelReduce();
+    bs = bs.parallelReduce();
+    recordChanges(bs);
+    return bs;
   }
 
   SelectionSet SelectionEvaluator::evaluate(int frame) {
@@ -891,7 +1080,9 @@ namespace OpenMD {
       pc = 0;
       instructionDispatchLoop(bs, frame);
     }
-    return bs.parallelReduce();
+    bs = bs.parallelReduce();
+    recordChanges(bs);
+    return bs;
   }
 
   SelectionSet SelectionEvaluator::indexInstruction(const boost::any& value) {
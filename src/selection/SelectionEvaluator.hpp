@@ -44,6 +44,7 @@
 #define SELECTION_SELECTIONEVALUATOR_HPP
 
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 #include <fstream>
@@ -83,6 +84,21 @@ namespace OpenMD {
       return isDynamic_;
     }
 
+    /**
+     * Returns the objects which entered or left the selection during
+     * the most recent evaluation, relative to the evaluation before
+     * it.  After the first evaluation, every selected object counts as
+     * a change.
+     */
+    SelectionSet getChanges() {
+      return changes_;
+    }
+
+    /**
+     * Tests if the most recent evaluation changed the selection.
+     */
+    bool hasChanged();
+
     bool hadRuntimeError() const{
       return error;
     }
@@ -201,6 +217,11 @@ namespace OpenMD {
 
         
     bool containDynamicToken(const std::vector<Token>& tokens);
+    void findStaticSpans();
+    bool findStaticSpans(const std::vector<Token>& code, int pcStart,
+                         const std::set<std::string>& dynamicVariables,
+                         std::vector<int>& spans);
+    void recordChanges(const SelectionSet& bs);
 
     RealType getCharge(Atom* atom);
     RealType getCharge(Atom* atom, int frame);
@@ -236,6 +257,22 @@ namespace OpenMD {
     typedef std::map<std::string, boost::any > VariablesType;
     VariablesType variables;
 
+    /**
+     * Sub-expressions that don't depend on positions (names, indices,
+     * and any algebra on them) give the same set on every evaluation,
+     * so the largest of them in each statement are evaluated once and
+     * remembered.  staticSpans_[s][p] is the last token of such a
+     * sub-expression starting at token p of statement s (or -1), and
+     * staticSets_[s] holds the evaluated sets keyed by starting token.
+     */
+    std::vector<std::vector<int> > staticSpans_;
+    std::vector<std::map<int, SelectionSet> > staticSets_;
+    int currentStatement_;
+
+    SelectionSet lastSelection_;
+    SelectionSet changes_;
+    bool hasLastSelection_;
+
     bool isDynamic_;
     bool isLoaded_;
     bool hasSurfaceArea_;
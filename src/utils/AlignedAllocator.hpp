@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2005 The University of Notre Dame. All Rights Reserved.
+ *
+ * The University of Notre Dame grants you ("Licensee") a
+ * non-exclusive, royalty free, license to use, modify and
+ * redistribute this software in source and binary code form, provided
+ * that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * This software is provided "AS IS," without a warranty of any
+ * kind. All express or implied conditions, representations and
+ * warranties, including any implied warranty of merchantability,
+ * fitness for a particular purpose or non-infringement, are hereby
+ * excluded.  The University of Notre Dame and its licensors shall not
+ * be liable for any damages suffered by licensee as a result of
+ * using, modifying or distributing the software or its
+ * derivatives. In no event will the University of Notre Dame or its
+ * licensors be liable for any lost revenue, profit or data, or for
+ * direct, indirect, special, consequential, incidental or punitive
+ * damages, however caused and regardless of the theory of liability,
+ * arising out of the use of or inability to use software, even if the
+ * University of Notre Dame has been advised of the possibility of
+ * such damages.
+ *
+ * SUPPORT OPEN SCIENCE!  If you use OpenMD or its source code in your
+ * research, please cite the appropriate papers when you publish your
+ * work.  Good starting points are:
+ *                                                                      
+ * [1]  Meineke, et al., J. Comp. Chem. 26, 252-271 (2005).             
+ * [2]  Fennell & Gezelter, J. Chem. Phys. 124, 234104 (2006).          
+ * [3]  Sun, Lin & Gezelter, J. Chem. Phys. 128, 234107 (2008).          
+ * [4]  Kuang & Gezelter,  J. Chem. Phys. 133, 164101 (2010).
+ * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
+ */
+ 
+/**
+ * @file AlignedAllocator.hpp
+ * @version 1.0
+ */ 
+
+#ifndef UTILS_ALIGNEDALLOCATOR_HPP
+#define UTILS_ALIGNEDALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace OpenMD {
+
+  /**
+   * @class AlignedAllocator
+   * A standard-conforming allocator that returns memory aligned on
+   * an Alignment byte boundary (a cache line by default), so that
+   * std::vector storage can be handed to vectorized loops.  The
+   * pointer returned by malloc is stashed just ahead of the aligned
+   * block, which keeps this portable to platforms without
+   * posix_memalign.
+   */
+  template<typename T, std::size_t Alignment = 64>
+  class AlignedAllocator {
+  public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template<typename U>
+    struct rebind {
+      typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator() {}
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    pointer address(reference x) const { return &x; }
+    const_pointer address(const_reference x) const { return &x; }
+
+    size_type max_size() const {
+      return (size_type(-1) - Alignment - sizeof(void*)) / sizeof(T);
+    }
+
+    pointer allocate(size_type n, const void* = 0) {
+      if (n == 0) return NULL;
+      if (n > max_size()) throw std::bad_alloc();
+
+      void* raw = std::malloc(n * sizeof(T) + Alignment + sizeof(void*));
+      if (raw == NULL) throw std::bad_alloc();
+
+      std::size_t addr = reinterpret_cast<std::size_t>(raw) + sizeof(void*);
+      addr = (addr + Alignment - 1) & ~(Alignment - 1);
+      void** aligned = reinterpret_cast<void**>(addr);
+      aligned[-1] = raw;
+      return reinterpret_cast<pointer>(aligned);
+    }
+
+    void deallocate(pointer p, size_type) {
+      if (p != NULL) std::free(reinterpret_cast<void**>(p)[-1]);
+    }
+
+    void construct(pointer p, const T& val) { new(p) T(val); }
+    void destroy(pointer p) { p->~T(); }
+  };
+
+  template<typename T, typename U, std::size_t Alignment>
+  bool operator==(const AlignedAllocator<T, Alignment>&,
+                  const AlignedAllocator<U, Alignment>&) {
+    return true;
+  }
+
+  template<typename T, typename U, std::size_t Alignment>
+  bool operator!=(const AlignedAllocator<T, Alignment>&,
+                  const AlignedAllocator<U, Alignment>&) {
+    return false;
+  }
+}
+#endif //UTILS_ALIGNEDALLOCATOR_HPP
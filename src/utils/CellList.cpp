@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2005 The University of Notre Dame. All Rights Reserved.
+ *
+ * The University of Notre Dame grants you ("Licensee") a
+ * non-exclusive, royalty free, license to use, modify and
+ * redistribute this software in source and binary code form, provided
+ * that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * This software is provided "AS IS," without a warranty of any
+ * kind. All express or implied conditions, representations and
+ * warranties, including any implied warranty of merchantability,
+ * fitness for a particular purpose or non-infringement, are hereby
+ * excluded.  The University of Notre Dame and its licensors shall not
+ * be liable for any damages suffered by licensee as a result of
+ * using, modifying or distributing the software or its
+ * derivatives. In no event will the University of Notre Dame or its
+ * licensors be liable for any lost revenue, profit or data, or for
+ * direct, indirect, special, consequential, incidental or punitive
+ * damages, however caused and regardless of the theory of liability,
+ * arising out of the use of or inability to use software, even if the
+ * University of Notre Dame has been advised of the possibility of
+ * such damages.
+ *
+ * SUPPORT OPEN SCIENCE!  If you use OpenMD or its source code in your
+ * research, please cite the appropriate papers when you publish your
+ * work.  Good starting points are:
+ *                                                                      
+ * [1]  Meineke, et al., J. Comp. Chem. 26, 252-271 (2005).             
+ * [2]  Fennell & Gezelter, J. Chem. Phys. 124, 234104 (2006).          
+ * [3]  Sun, Lin & Gezelter, J. Chem. Phys. 128, 234107 (2008).          
+ * [4]  Kuang & Gezelter,  J. Chem. Phys. 133, 164101 (2010).
+ * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
+ */
+
+#include <algorithm>
+
+#include "utils/CellList.hpp"
+#include "utils/Utility.hpp"
+
+namespace OpenMD {
+
+  CellList::CellList() : active_(false), usePBC_(true), nCells_(0, 0, 0) {}
+
+  void CellList::build(const std::vector<Vector3d>& positions,
+                       const Mat3x3d& hmat, bool usePBC, RealType rCut) {
+    active_ = false;
+    usePBC_ = usePBC;
+    cellStart_.clear();
+    cellMembers_.clear();
+
+    int nPositions = positions.size();
+    if (nPositions == 0 || rCut <= 0.0) return;
+
+    Mat3x3d box(0.0);
+
+    if (usePBC_) {
+      box = hmat;
+      origin_ = V3Zero;
+    } else {
+      Vector3d lo = positions[0];
+      Vector3d hi = positions[0];
+      for (int i = 1; i < nPositions; i++) {
+        for (int j = 0; j < 3; j++) {
+          lo[j] = std::min(lo[j], positions[i][j]);
+          hi[j] = std::max(hi[j], positions[i][j]);
+        }
+      }
+      // a flat or single-point set still needs a box one cutoff wide:
+      for (int j = 0; j < 3; j++) 
+        box(j, j) = std::max(hi[j] - lo[j], rCut);
+      origin_ = lo;
+    }
+    invBox_ = box.inverse();
+
+    Vector3d A = box.getColumn(0);
+    Vector3d B = box.getColumn(1);
+    Vector3d C = box.getColumn(2);
+
+    // Required for triclinic cells
+    Vector3d AxB = cross(A, B);
+    Vector3d BxC = cross(B, C);
+    Vector3d CxA = cross(C, A);
+
+    // unit vectors perpendicular to the faces of the triclinic cell:
+    AxB.normalize();
+    BxC.normalize();
+    CxA.normalize();
+
+    // A set of perpendicular lengths in triclinic cells:
+    RealType Wa = abs(dot(A, BxC));
+    RealType Wb = abs(dot(B, CxA));
+    RealType Wc = abs(dot(C, AxB));
+
+    nCells_.x() = int( Wa / rCut );
+    nCells_.y() = int( Wb / rCut );
+    nCells_.z() = int( Wc / rCut );
+
+    // In a periodic box, the cell offsets would revisit cells if
+    // there were fewer than three cells along any direction.
+    int nMin = usePBC_ ? 3 : 1;
+    for (int j = 0; j < 3; j++) {
+      if (nCells_[j] < nMin) {
+        if (usePBC_) return;
+        nCells_[j] = nMin;
+      }
+    }
+
+    // Sparse sets in large boxes would waste time on empty cells, so
+    // keep the number of cells comparable to the number of positions.
+    // Merging cells only makes them wider than the cutoff.
+    RealType nCtot = RealType(nCells_.x()) * nCells_.y() * nCells_.z();
+    RealType maxCells = std::max(27, 2 * nPositions);
+    if (nCtot > maxCells) {
+      RealType shrink = pow(nCtot / maxCells, 1.0 / 3.0);
+      for (int j = 0; j < 3; j++) 
+        nCells_[j] = std::max(nMin, int(nCells_[j] / shrink));
+    }
+
+    int nCells = nCells_.x() * nCells_.y() * nCells_.z();
+
+    // bin the positions with a counting sort:
+    std::vector<int> cellOf(nPositions);
+    cellStart_.assign(nCells + 1, 0);
+    for (int i = 0; i < nPositions; i++) {
+      cellOf[i] = Vlinear(getCell(positions[i]), nCells_);
+      cellStart_[cellOf[i] + 1]++;
+    }
+    for (int c = 0; c < nCells; c++) 
+      cellStart_[c + 1] += cellStart_[c];
+
+    std::vector<int> fill(cellStart_.begin(), cellStart_.end() - 1);
+    cellMembers_.resize(nPositions);
+    for (int i = 0; i < nPositions; i++) 
+      cellMembers_[fill[cellOf[i]]++] = i;
+
+    active_ = true;
+  }
+
+  Vector3i CellList::getCell(const Vector3d& pos) const {
+    // scaled positions relative to the box vectors
+    Vector3d scaled = invBox_ * (pos - origin_);
+    Vector3i whichCell;
+
+    for (int j = 0; j < 3; j++) {
+      if (usePBC_) {
+        // wrap the vector back into the unit box by subtracting
+        // integer box numbers
+        scaled[j] -= roundMe(scaled[j]);
+        scaled[j] += 0.5;
+      }
+      whichCell[j] = int(nCells_[j] * scaled[j]);
+      // positions exactly on the upper boundary (or, without periodic
+      // boundaries, outside the binned region) go to the edge cells
+      whichCell[j] = std::max(0, std::min(nCells_[j] - 1, whichCell[j]));
+    }
+    return whichCell;
+  }
+
+  void CellList::getNeighbors(const Vector3d& pos, 
+                              std::vector<int>& neighbors) const {
+    neighbors.clear();
+    if (!active_) return;
+
+    Vector3i whichCell = getCell(pos);
+    Vector3i m2v;
+
+    for (int dz = -1; dz <= 1; dz++) {
+      m2v.z() = whichCell.z() + dz;
+      if (usePBC_) {
+        m2v.z() = (m2v.z() + nCells_.z()) % nCells_.z();
+      } else if (m2v.z() < 0 || m2v.z() >= nCells_.z()) {
+        continue;
+      }
+      for (int dy = -1; dy <= 1; dy++) {
+        m2v.y() = whichCell.y() + dy;
+        if (usePBC_) {
+          m2v.y() = (m2v.y() + nCells_.y()) % nCells_.y();
+        } else if (m2v.y() < 0 || m2v.y() >= nCells_.y()) {
+          continue;
+        }
+        for (int dx = -1; dx <= 1; dx++) {
+          m2v.x() = whichCell.x() + dx;
+          if (usePBC_) {
+            m2v.x() = (m2v.x() + nCells_.x()) % nCells_.x();
+          } else if (m2v.x() < 0 || m2v.x() >= nCells_.x()) {
+            continue;
+          }
+          int m2 = Vlinear(m2v, nCells_);
+          neighbors.insert(neighbors.end(), 
+                           cellMembers_.begin() + cellStart_[m2],
+                           cellMembers_.begin() + cellStart_[m2 + 1]);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2005 The University of Notre Dame. All Rights Reserved.
+ *
+ * The University of Notre Dame grants you ("Licensee") a
+ * non-exclusive, royalty free, license to use, modify and
+ * redistribute this software in source and binary code form, provided
+ * that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * This software is provided "AS IS," without a warranty of any
+ * kind. All express or implied conditions, representations and
+ * warranties, including any implied warranty of merchantability,
+ * fitness for a particular purpose or non-infringement, are hereby
+ * excluded.  The University of Notre Dame and its licensors shall not
+ * be liable for any damages suffered by licensee as a result of
+ * using, modifying or distributing the software or its
+ * derivatives. In no event will the University of Notre Dame or its
+ * licensors be liable for any lost revenue, profit or data, or for
+ * direct, indirect, special, consequential, incidental or punitive
+ * damages, however caused and regardless of the theory of liability,
+ * arising out of the use of or inability to use software, even if the
+ * University of Notre Dame has been advised of the possibility of
+ * such damages.
+ *
+ * SUPPORT OPEN SCIENCE!  If you use OpenMD or its source code in your
+ * research, please cite the appropriate papers when you publish your
+ * work.  Good starting points are:
+ *                                                                      
+ * [1]  Meineke, et al., J. Comp. Chem. 26, 252-271 (2005).             
+ * [2]  Fennell & Gezelter, J. Chem. Phys. 124, 234104 (2006).          
+ * [3]  Sun, Lin & Gezelter, J. Chem. Phys. 128, 234107 (2008).          
+ * [4]  Kuang & Gezelter,  J. Chem. Phys. 133, 164101 (2010).
+ * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
+ */
+ 
+/**
+ * @file CellList.hpp
+ * @version 1.0
+ */ 
+
+#ifndef UTILS_CELLLIST_HPP
+#define UTILS_CELLLIST_HPP
+
+#include <vector>
+
+#include "config.h"
+#include "math/Vector3.hpp"
+#include "math/SquareMatrix3.hpp"
+
+namespace OpenMD {
+
+  /**
+   * @class CellList
+   * Bins a set of positions into cells at least as wide as a cutoff
+   * radius, so that every position within the cutoff of a query point
+   * lies in the 27 cells surrounding the cell of that point.
+   *
+   * With periodic boundaries the cells tile the (possibly triclinic)
+   * simulation box, sized by the perpendicular widths of the box in
+   * the same way as ForceMatrixDecomposition::buildNeighborList.
+   * Without periodic boundaries, the cells tile the bounding box of
+   * the binned positions and do not wrap.
+   *
+   * The list only narrows the candidates; callers still have to test
+   * the actual separation of each candidate pair.
+   */
+  class CellList {
+  public:
+    CellList();
+
+    /**
+     * Bins positions into cells.
+     * @param positions the positions to bin; neighbor indices refer
+     * to this vector.
+     * @param hmat the box matrix (only used with periodic boundaries)
+     * @param usePBC whether the box is periodic
+     * @param rCut the cutoff radius
+     */
+    void build(const std::vector<Vector3d>& positions, const Mat3x3d& hmat,
+               bool usePBC, RealType rCut);
+
+    /**
+     * Returns false if the cells can't be used (an empty set, no
+     * cutoff, or a periodic box narrower than three cutoffs), in
+     * which case the caller should fall back to visiting every pair.
+     */
+    bool isActive() const { return active_; }
+
+    /**
+     * Fills neighbors with the indices of all binned positions which
+     * may lie within the cutoff of pos.
+     */
+    void getNeighbors(const Vector3d& pos, std::vector<int>& neighbors) const;
+
+  private:
+    Vector3i getCell(const Vector3d& pos) const;
+
+    bool active_;
+    bool usePBC_;
+    Vector3d origin_;
+    Mat3x3d invBox_;
+    Vector3i nCells_;
+    /* members of cell c are cellMembers_[cellStart_[c]..cellStart_[c+1]) */
+    std::vector<int> cellStart_;
+    std::vector<int> cellMembers_;
+  };
+}
+#endif
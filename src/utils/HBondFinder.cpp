@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2005 The University of Notre Dame. All Rights Reserved.
+ *
+ * The University of Notre Dame grants you ("Licensee") a
+ * non-exclusive, royalty free, license to use, modify and
+ * redistribute this software in source and binary code form, provided
+ * that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * This software is provided "AS IS," without a warranty of any
+ * kind. All express or implied conditions, representations and
+ * warranties, including any implied warranty of merchantability,
+ * fitness for a particular purpose or non-infringement, are hereby
+ * excluded.  The University of Notre Dame and its licensors shall not
+ * be liable for any damages suffered by licensee as a result of
+ * using, modifying or distributing the software or its
+ * derivatives. In no event will the University of Notre Dame or its
+ * licensors be liable for any lost revenue, profit or data, or for
+ * direct, indirect, special, consequential, incidental or punitive
+ * damages, however caused and regardless of the theory of liability,
+ * arising out of the use of or inability to use software, even if the
+ * University of Notre Dame has been advised of the possibility of
+ * such damages.
+ *
+ * SUPPORT OPEN SCIENCE!  If you use OpenMD or its source code in your
+ * research, please cite the appropriate papers when you publish your
+ * work.  Good starting points are:
+ *                                                                      
+ * [1]  Meineke, et al., J. Comp. Chem. 26, 252-271 (2005).             
+ * [2]  Fennell & Gezelter, J. Chem. Phys. 124, 234104 (2006).          
+ * [3]  Sun, Lin & Gezelter, J. Chem. Phys. 128, 234107 (2008).          
+ * [4]  Kuang & Gezelter,  J. Chem. Phys. 133, 164101 (2010).
+ * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
+ */
+
+#include <algorithm>
+
+#include "utils/HBondFinder.hpp"
+#include "utils/Constants.hpp"
+
+namespace OpenMD {
+
+  HBondFinder::HBondFinder(SimInfo* info, RealType OOCut, RealType thetaCut,
+                           RealType OHCut) :
+    info_(info), snap_(NULL), OOCut_(OOCut), thetaCut_(thetaCut),
+    OHCut_(OHCut) {}
+
+  void HBondFinder::findHBonds(Snapshot* snap) {
+    Molecule* mol;
+    SimInfo::MoleculeIterator mi;
+    std::vector<Molecule::HBondDonor*>::iterator hbdi;
+    Molecule::HBondDonor* hbd;
+    std::vector<Atom*>::iterator hbai;
+    Atom* hba;
+    Vector3d dPos, hPos;
+    HBond hb;
+
+    snap_ = snap;
+    hBonds_.clear();
+    acceptorMols_.clear();
+    acceptors_.clear();
+    acceptorPos_.clear();
+
+    for (mol = info_->beginMolecule(mi); mol != NULL;
+         mol = info_->nextMolecule(mi)) {
+      for (hba = mol->beginHBondAcceptor(hbai); hba != NULL;
+           hba = mol->nextHBondAcceptor(hbai)) {
+        acceptorMols_.push_back(mol);
+        acceptors_.push_back(hba);
+        acceptorPos_.push_back(hba->getPos());
+      }
+    }
+    if (acceptors_.empty()) return;
+
+    cellList_.build(acceptorPos_, snap_->getHmat(),
+                    info_->getSimParams()->getUsePeriodicBoundaryConditions(),
+                    OOCut_);
+
+    if (!cellList_.isActive()) {
+      // box too small for the cells; every acceptor is a candidate
+      neighbors_.resize(acceptors_.size());
+      for (unsigned int i = 0; i < acceptors_.size(); ++i)
+        neighbors_[i] = i;
+    }
+
+    for (mol = info_->beginMolecule(mi); mol != NULL;
+         mol = info_->nextMolecule(mi)) {
+      for (hbd = mol->beginHBondDonor(hbdi); hbd != NULL;
+           hbd = mol->nextHBondDonor(hbdi)) {
+
+        dPos = hbd->donorAtom->getPos();
+        hPos = hbd->donatedHydrogen->getPos();
+
+        if (cellList_.isActive()) {
+          cellList_.getNeighbors(dPos, neighbors_);
+          // visit the candidates in molecule order:
+          std::sort(neighbors_.begin(), neighbors_.end());
+        }
+
+        for (std::vector<int>::iterator n = neighbors_.begin();
+             n != neighbors_.end(); ++n) {
+          if (isHBond(dPos, hPos, acceptorPos_[*n])) {
+            hb.donorMol = mol;
+            hb.donor = hbd;
+            hb.acceptorMol = acceptorMols_[*n];
+            hb.acceptor = acceptors_[*n];
+            hBonds_.push_back(hb);
+          }
+        }
+      }
+    }
+  }
+
+  bool HBondFinder::isHBond(const Vector3d& donorPos,
+                            const Vector3d& hydrogenPos,
+                            const Vector3d& acceptorPos) {
+      
+    Vector3d DA = acceptorPos - donorPos;
+    snap_->wrapVector(DA);
+    RealType DAdist = DA.length();
+        
+    // Distance criteria: are the donor and acceptor atoms
+    // close enough?
+    if (DAdist < OOCut_) {
+      Vector3d DH = hydrogenPos - donorPos; 
+      snap_->wrapVector(DH);
+      RealType DHdist = DH.length();
+
+      if (OHCut_ > 0.0) {
+        Vector3d HA = acceptorPos - hydrogenPos;
+        snap_->wrapVector(HA);
+        if (HA.length() >= OHCut_) return false;
+      }
+          
+      RealType ctheta = dot(DH, DA) / (DHdist * DAdist);
+      RealType theta = acos(ctheta) * 180.0 / Constants::PI;
+      
+      // Angle criteria: are the D-H and D-A and vectors close?
+      if (theta < thetaCut_) {
+        return true;
+      }
+    }
+    return false;
+  }
+}
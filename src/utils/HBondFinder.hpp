@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2005 The University of Notre Dame. All Rights Reserved.
+ *
+ * The University of Notre Dame grants you ("Licensee") a
+ * non-exclusive, royalty free, license to use, modify and
+ * redistribute this software in source and binary code form, provided
+ * that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * This software is provided "AS IS," without a warranty of any
+ * kind. All express or implied conditions, representations and
+ * warranties, including any implied warranty of merchantability,
+ * fitness for a particular purpose or non-infringement, are hereby
+ * excluded.  The University of Notre Dame and its licensors shall not
+ * be liable for any damages suffered by licensee as a result of
+ * using, modifying or distributing the software or its
+ * derivatives. In no event will the University of Notre Dame or its
+ * licensors be liable for any lost revenue, profit or data, or for
+ * direct, indirect, special, consequential, incidental or punitive
+ * damages, however caused and regardless of the theory of liability,
+ * arising out of the use of or inability to use software, even if the
+ * University of Notre Dame has been advised of the possibility of
+ * such damages.
+ *
+ * SUPPORT OPEN SCIENCE!  If you use OpenMD or its source code in your
+ * research, please cite the appropriate papers when you publish your
+ * work.  Good starting points are:
+ *                                                                      
+ * [1]  Meineke, et al., J. Comp. Chem. 26, 252-271 (2005).             
+ * [2]  Fennell & Gezelter, J. Chem. Phys. 124, 234104 (2006).          
+ * [3]  Sun, Lin & Gezelter, J. Chem. Phys. 128, 234107 (2008).          
+ * [4]  Kuang & Gezelter,  J. Chem. Phys. 133, 164101 (2010).
+ * [5]  Vardeman, Stocker & Gezelter, J. Chem. Theory Comput. 7, 834 (2011).
+ */
+
+/**
+ * @file HBondFinder.hpp
+ * @version 1.0
+ */ 
+
+#ifndef UTILS_HBONDFINDER_HPP
+#define UTILS_HBONDFINDER_HPP
+
+#include <vector>
+
+#include "brains/SimInfo.hpp"
+#include "brains/Snapshot.hpp"
+#include "primitives/Molecule.hpp"
+#include "utils/CellList.hpp"
+
+namespace OpenMD {
+
+  /**
+   * @class HBondFinder
+   * Finds the hydrogen bonds in a configuration using geometric
+   * criteria.  A donor D-H and an acceptor A are hydrogen bonded if
+   *
+   *   |DA| < OOCut, the angle between DH and DA is below thetaCut
+   *   (in degrees), and |HA| < OHCut.
+   *
+   * The acceptors are binned in a CellList keyed on OOCut, so each
+   * donor is only tested against the acceptors in its neighborhood
+   * instead of every acceptor in the system.
+   */
+  class HBondFinder {
+  public:
+    struct HBond {
+      Molecule* donorMol;
+      Molecule::HBondDonor* donor;
+      Molecule* acceptorMol;
+      Atom* acceptor;
+    };
+
+    /**
+     * @param OHCut the hydrogen-acceptor cutoff; a non-positive value
+     * skips the hydrogen-acceptor distance test.
+     */
+    HBondFinder(SimInfo* info, RealType OOCut, RealType thetaCut,
+                RealType OHCut);
+
+    /**
+     * Finds all of the hydrogen bonds between the molecules in the
+     * snapshot.  The bonds are grouped by donor, with the donors in
+     * molecule order and the acceptors of each donor in molecule
+     * order, which is the order that pairwise loops over molecules
+     * would visit them.
+     */
+    void findHBonds(Snapshot* snap);
+
+    const std::vector<HBond>& getHBonds() const { return hBonds_; }
+
+    bool isHBond(const Vector3d& donorPos, const Vector3d& hydrogenPos,
+                 const Vector3d& acceptorPos);
+
+  private:
+    SimInfo* info_;
+    Snapshot* snap_;
+    RealType OOCut_;
+    RealType thetaCut_;
+    RealType OHCut_;
+
+    std::vector<Molecule*> acceptorMols_;
+    std::vector<Atom*> acceptors_;
+    std::vector<Vector3d> acceptorPos_;
+    CellList cellList_;
+    std::vector<int> neighbors_;
+
+    std::vector<HBond> hBonds_;
+  };
+}
+#endif
@@ -242,6 +242,14 @@ namespace OpenMD {
    */
   class LocalIndexManager {
   public:
+
+    /**
+     * Returns every index to the pool.  Only safe once all of the
+     * objects holding local indices have been destroyed.
+     */
+    void clear() {
+      *this = LocalIndexManager();
+    }
         
     int getNextAtomIndex() {
       return atomIndexContainer_.pop();
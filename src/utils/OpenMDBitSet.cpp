@@ -47,67 +47,126 @@
 #include <algorithm>
 #include <cassert>
 #include <string>
-#include <iterator>
 
 #include "utils/OpenMDBitSet.hpp"
-#include "utils/Algorithm.hpp"
 
 namespace OpenMD {
+
+  namespace {
+    inline int popCount(uint64_t w) {
+#ifdef __GNUC__
+      return __builtin_popcountll(w);
+#else
+      int count = 0;
+      for (; w; ++count) w &= w - 1;
+      return count;
+#endif
+    }
+
+    /** index of the lowest on bit in a non-zero word */
+    inline int lowestBit(uint64_t w) {
+#ifdef __GNUC__
+      return __builtin_ctzll(w);
+#else
+      int i = 0;
+      while (!(w & 1)) {
+        w >>= 1;
+        ++i;
+      }
+      return i;
+#endif
+    }
+
+    /** mask of the bits from bit (inclusive) to the top of the word */
+    inline uint64_t maskFrom(int bit) {
+      return ~uint64_t(0) << bit;
+    }
+
+    /** mask of the bits below bit (exclusive), bit in [1, 64] */
+    inline uint64_t maskBelow(int bit) {
+      return bit == 64 ? ~uint64_t(0) : (uint64_t(1) << bit) - 1;
+    }
+  }
+
   int OpenMDBitSet::countBits() {
-#ifdef __RWSTD    
-    //For the compiler(Sun, MSVC6.0) binding with RougeWave STL Library, we need to use old-style
-    // std::count which is error-prone.
     int count = 0;
-    std::count(bitset_.begin(), bitset_.end(), true, count);
+    for (std::size_t i = 0; i < words_.size(); ++i)
+      count += popCount(words_[i]);
     return count;
-#else
-    return std::count(bitset_.begin(), bitset_.end(), true);
-#endif
   }
 
   void OpenMDBitSet::flip(int fromIndex, int toIndex) {
     assert(fromIndex <= toIndex);
     assert(fromIndex >=0);
     assert(toIndex <= size());
-    std::vector<bool>::iterator first = bitset_.begin() + fromIndex;
-    std::vector<bool>::iterator last = bitset_.begin() + toIndex;
+    if (fromIndex == toIndex) return;
 
-    std::transform(first, last, first, std::logical_not<bool>());
-        
+    int first = wordIndex(fromIndex);
+    int last = wordIndex(toIndex - 1);
+    uint64_t firstMask = maskFrom(fromIndex % wordBits);
+    uint64_t lastMask = maskBelow((toIndex - 1) % wordBits + 1);
+
+    if (first == last) {
+      words_[first] ^= firstMask & lastMask;
+      return;
+    }
+    words_[first] ^= firstMask;
+    for (int i = first + 1; i < last; ++i)
+      words_[i] = ~words_[i];
+    words_[last] ^= lastMask;
   }
 
   OpenMDBitSet OpenMDBitSet::get(int fromIndex, int toIndex) {
     assert(fromIndex <= toIndex);
     assert(fromIndex >=0);
     assert(toIndex <= size());
-    std::vector<bool>::iterator first = bitset_.begin() + fromIndex;
-    std::vector<bool>::iterator last = bitset_.begin() + toIndex;
 
-    OpenMDBitSet result;
-    std::copy(first, last, std::back_inserter(result.bitset_));
+    OpenMDBitSet result(toIndex - fromIndex);
+    for (int i = findOnBit(fromIndex); i != -1 && i < toIndex;
+         i = nextOnBit(i)) {
+      result.setBitOn(i - fromIndex);
+    }
     return result;
   }
 
   bool OpenMDBitSet::none() {
-    std::vector<bool>::iterator i = std::find(bitset_.begin(), bitset_.end(), true);
-    return i == bitset_.end() ? true : false;
+    for (std::size_t i = 0; i < words_.size(); ++i)
+      if (words_[i]) return false;
+    return true;
   }
-    
+
+  int OpenMDBitSet::findOffBit(int fromIndex) const {
+    if (fromIndex >= size()) return -1;
+
+    int i = wordIndex(fromIndex);
+    uint64_t w = ~words_[i] & maskFrom(fromIndex % wordBits);
+    while (!w) {
+      if (++i == static_cast<int>(words_.size())) return -1;
+      w = ~words_[i];
+    }
+    int bit = i * wordBits + lowestBit(w);
+    // the off bits past the end of the set don't count
+    return bit < size() ? bit : -1;
+  }
+
+  int OpenMDBitSet::findOnBit(int fromIndex) const {
+    if (fromIndex >= size()) return -1;
+
+    int i = wordIndex(fromIndex);
+    uint64_t w = words_[i] & maskFrom(fromIndex % wordBits);
+    while (!w) {
+      if (++i == static_cast<int>(words_.size())) return -1;
+      w = words_[i];
+    }
+    return i * wordBits + lowestBit(w);
+  }
+
   int OpenMDBitSet::nextOffBit(int fromIndex) const {
     if (fromIndex <= -1) {
       //in case -1 or other negative number is passed to this function
       return -1;
     }
-    
-    ++fromIndex;
-    while (fromIndex < size()) {
-      if (!bitset_[fromIndex]) {
-	return fromIndex;
-      }
-      ++fromIndex;
-    }
-
-    return -1;
+    return findOffBit(fromIndex + 1);
   }
 
   int OpenMDBitSet::nextOnBit(int fromIndex) const {
@@ -115,49 +174,65 @@ namespace OpenMD {
       //in case -1 or other negative number is passed to this function
       return -1;
     }
-
-    ++fromIndex;
-    while (fromIndex < size()) {
-      if (bitset_[fromIndex]) {
-	return fromIndex;
-      }
-      ++fromIndex;
-    }
-
-    return -1;
+    return findOnBit(fromIndex + 1);
   }
 
+  // In parallel, some bit sets (e.g. the IndexFinder sets for
+  // molecules on other processors) are never sized, so the logical
+  // operators only touch the words the two sets have in common.
+
   void OpenMDBitSet::andOperator (const OpenMDBitSet& bs) {
     assert(size() == bs.size());
-
-    std::transform(bs.bitset_.begin(), bs.bitset_.end(), bitset_.begin(), bitset_.begin(), std::logical_and<bool>());
+    std::size_t n = std::min(words_.size(), bs.words_.size());
+    for (std::size_t i = 0; i < n; ++i)
+      words_[i] &= bs.words_[i];
   }
 
   void OpenMDBitSet::orOperator (const OpenMDBitSet& bs) {
     assert(size() == bs.size());
-    std::transform(bs.bitset_.begin(), bs.bitset_.end(), bitset_.begin(), bitset_.begin(), std::logical_or<bool>());    
+    std::size_t n = std::min(words_.size(), bs.words_.size());
+    for (std::size_t i = 0; i < n; ++i)
+      words_[i] |= bs.words_[i];
   }
 
   void OpenMDBitSet::xorOperator (const OpenMDBitSet& bs) {
     assert(size() == bs.size());
-    std::transform(bs.bitset_.begin(), bs.bitset_.end(), bitset_.begin(), bitset_.begin(), OpenMD::logical_xor<bool>());        
+    std::size_t n = std::min(words_.size(), bs.words_.size());
+    for (std::size_t i = 0; i < n; ++i)
+      words_[i] ^= bs.words_[i];
   }
    
   void OpenMDBitSet::setBits(int fromIndex, int toIndex, bool value) {
     assert(fromIndex <= toIndex);
     assert(fromIndex >=0);
     assert(toIndex <= size());
-    std::vector<bool>::iterator first = bitset_.begin() + fromIndex;
-    std::vector<bool>::iterator last = bitset_.begin() + toIndex;
-    std::fill(first, last, value);
+    if (fromIndex == toIndex) return;
+
+    int first = wordIndex(fromIndex);
+    int last = wordIndex(toIndex - 1);
+    uint64_t firstMask = maskFrom(fromIndex % wordBits);
+    uint64_t lastMask = maskBelow((toIndex - 1) % wordBits + 1);
+    uint64_t fill = value ? ~uint64_t(0) : 0;
+
+    if (first == last) {
+      uint64_t mask = firstMask & lastMask;
+      words_[first] = (words_[first] & ~mask) | (fill & mask);
+      return;
+    }
+    words_[first] = (words_[first] & ~firstMask) | (fill & firstMask);
+    std::fill(words_.begin() + first + 1, words_.begin() + last, fill);
+    words_[last] = (words_[last] & ~lastMask) | (fill & lastMask);
+  }
+
+  void OpenMDBitSet::clearTail() {
+    if (nBits_ % wordBits)
+      words_.back() &= maskBelow(nBits_ % wordBits);
   }
 
   void OpenMDBitSet::resize(int nbits) {
-    int oldSize = size();
-    bitset_.resize(nbits);
-    if (nbits > oldSize) {
-      std::fill(bitset_.begin()+oldSize, bitset_.end(), false);
-    }
+    nBits_ = nbits;
+    words_.resize(nWords(nbits), 0);
+    clearTail();
   }
 
   OpenMDBitSet operator| (const OpenMDBitSet& bs1, const OpenMDBitSet& bs2) {
@@ -194,32 +269,19 @@ namespace OpenMD {
 
   bool operator== (const OpenMDBitSet & bs1, const OpenMDBitSet &bs2) {
     assert(bs1.size() == bs2.size());
-    return std::equal(bs1.bitset_.begin(), bs1.bitset_.end(), bs2.bitset_.begin());
+    return bs1.words_ == bs2.words_;
   }  
 
   OpenMDBitSet OpenMDBitSet::parallelReduce() {
-    OpenMDBitSet result;
+    OpenMDBitSet result(*this);
 
 #ifdef IS_MPI
-
-    // This is necessary because std::vector<bool> isn't really a
-    // std::vector, so we can't pass the address of the first element
-    // to the MPI call that follows.  We first have to convert to a
-    // std::vector<int> to do the logical_or Allreduce call, then back
-    // convert it into the vector<bool>.
-
-    std::vector<int> bsInt(bitset_.begin(), bitset_.end());
-
-    MPI_Allreduce(MPI_IN_PLACE, &bsInt[0], 
-                  bsInt.size(), MPI_INT, MPI_LOR, MPI_COMM_WORLD);
-
-    std::transform(bsInt.begin(), bsInt.end(), 
-                   std::back_inserter( result.bitset_ ), to_bool<int>());
-#else
-
-    // Not in MPI?  Just return a copy of the current bitset:
-    std::copy(bitset_.begin(), bitset_.end(), 
-              std::back_inserter( result.bitset_ ));
+    // The tail bits are off on every processor, so a bitwise OR of
+    // the packed words is the logical OR of the bit sets.
+    if (!result.words_.empty()) {
+      MPI_Allreduce(MPI_IN_PLACE, &result.words_[0], result.words_.size(),
+                    MPI_UINT64_T, MPI_BOR, MPI_COMM_WORLD);
+    }
 #endif
 
     return result;
@@ -231,7 +293,7 @@ namespace OpenMD {
   //}
 
   std::ostream& operator<< ( std::ostream& os, const OpenMDBitSet& bs) {
-    for (unsigned int i = 0; i < bs.bitset_.size(); ++i) {
+    for (int i = 0; i < bs.size(); ++i) {
       std::string val = bs[i] ? "true" : "false";
       os << "OpenMDBitSet[" << i <<"] = " << val << std::endl; 
     }
@@ -45,24 +45,30 @@
 
 #include <iostream>
 #include <vector>
+#include <stdint.h>
+
 namespace OpenMD {
 
   /**
    * @class OpenMDBitSet OpenMDBitSet.hpp "OpenMDBitSet.hpp"
-   * @brief OpenMDBitSet is a wrapper class of std::vector<bool> to act as a growable std::bitset 
+   * @brief OpenMDBitSet is a growable std::bitset
+   *
+   * The bits are packed into 64-bit words so that the logical
+   * operations, counting and searching work a word at a time.  Bits
+   * past size() in the last word are always kept off.
    */
   class OpenMDBitSet {
   public:
     /** */
-    OpenMDBitSet() {}
+    OpenMDBitSet() : nBits_(0) {}
     /** */
-    OpenMDBitSet(int nbits) : bitset_(nbits) {clearAll(); }
+    OpenMDBitSet(int nbits) : nBits_(nbits), words_(nWords(nbits), 0) {}
 
     /** Returns the number of bits set to true in this OpenMDBitSet.  */
     int countBits();
 
     /** Sets the bit at the specified index to to the complement of its current value. */
-    void flip(int bitIndex) {  bitset_[bitIndex] = !bitset_[bitIndex];  }
+    void flip(int bitIndex) {  words_[wordIndex(bitIndex)] ^= bitMask(bitIndex);  }
  
     /** Sets each bit from the specified fromIndex(inclusive) to the specified toIndex(exclusive) to the complement of its current value. */
     void flip(int fromIndex, int toIndex); 
@@ -71,7 +77,7 @@ namespace OpenMD {
     void flip() { flip(0, size()); }
         
     /** Returns the value of the bit with the specified index. */
-    bool get(int bitIndex) {  return bitset_[bitIndex];  }
+    bool get(int bitIndex) {  return (*this)[bitIndex];  }
         
     /** Returns a new OpenMDBitSet composed of bits from this OpenMDBitSet from fromIndex(inclusive) to toIndex(exclusive). */
     OpenMDBitSet get(int fromIndex, int toIndex); 
@@ -82,12 +88,12 @@ namespace OpenMD {
     /** Returns true if no bits are set to true */
     bool none();
 
-    int firstOffBit() const { return !bitset_[0] ? 0 : nextOffBit(0); }
+    int firstOffBit() const { return findOffBit(0); }
         
     /** Returns the index of the first bit that is set to false that occurs on or after the specified starting index.*/
     int nextOffBit(int fromIndex) const; 
 
-    int firstOnBit() const { return bitset_[0] ? 0 : nextOnBit(0); }
+    int firstOnBit() const { return findOnBit(0); }
         
     /** Returns the index of the first bit that is set to true that occurs on or after the specified starting index. */
     int nextOnBit(int fromIndex) const; 
@@ -115,7 +121,7 @@ namespace OpenMD {
     void setAll() {  setRangeOn(0, size());  }        
         
     /** Returns the number of bits of space actually in use by this OpenMDBitSet to represent bit values. */
-    int size() const {  return bitset_.size();  }
+    int size() const {  return nBits_;  }
 
     /** Changes the size of OpenMDBitSet*/
     void resize(int nbits);
@@ -131,7 +137,9 @@ namespace OpenMD {
 
     OpenMDBitSet parallelReduce();
         
-    bool operator[] (int bitIndex)  const {  return bitset_[bitIndex];  }
+    bool operator[] (int bitIndex)  const {
+      return (words_[wordIndex(bitIndex)] & bitMask(bitIndex)) != 0;
+    }
     friend OpenMDBitSet operator| (const OpenMDBitSet& bs1, const OpenMDBitSet& bs2);
     friend OpenMDBitSet operator& (const OpenMDBitSet& bs1, const OpenMDBitSet& bs2);
     friend OpenMDBitSet operator^ (const OpenMDBitSet& bs1, const OpenMDBitSet& bs2);
@@ -145,12 +153,32 @@ namespace OpenMD {
   private:
 
     /** Sets the bit at the specified index to the specified value. */
-    void setBit(int bitIndex, bool value) { bitset_[bitIndex] = value; }
+    void setBit(int bitIndex, bool value) {
+      if (value)
+        words_[wordIndex(bitIndex)] |= bitMask(bitIndex);
+      else
+        words_[wordIndex(bitIndex)] &= ~bitMask(bitIndex);
+    }
         
     /** Sets the bits from the specified fromIndex(inclusive) to the specified toIndex(exclusive) to the specified value. */
     void setBits(int fromIndex, int toIndex, bool value);
         
-    std::vector<bool> bitset_;
+    /** Returns the index of the first on (off) bit at or after fromIndex, or -1 */
+    int findOnBit(int fromIndex) const;
+    int findOffBit(int fromIndex) const;
+
+    /** Turns off the unused bits past nBits_ in the last word */
+    void clearTail();
+
+    static const int wordBits = 64;
+    static int nWords(int nbits) { return (nbits + wordBits - 1) / wordBits; }
+    static int wordIndex(int bitIndex) { return bitIndex / wordBits; }
+    static uint64_t bitMask(int bitIndex) {
+      return uint64_t(1) << (bitIndex % wordBits);
+    }
+
+    int nBits_;
+    std::vector<uint64_t> words_;
   }; 
 
 }